@@ -9,24 +9,148 @@
 #ifndef OPENMVG_CAMERAS_CAMERA_UNDISTORT_IMAGE_HPP
 #define OPENMVG_CAMERAS_CAMERA_UNDISTORT_IMAGE_HPP
 
-#include <limits>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/cameras/Camera_undistortion_lut.hpp"
 #include "openMVG/image/image_container.hpp"
-#include "openMVG/image/sample.hpp"
+#include "openMVG/image/image_remap.hpp"
 
 namespace openMVG
 {
 namespace cameras
 {
 
+/**
+* @brief Compute the undistortion map of a camera (the distorted position of
+* each pixel of the undistorted image)
+* @param cam Input intrinsic parameter used to undistort image
+* @param width Width of the undistorted image
+* @param height Height of the undistorted image
+* @param offset_x Undistorted coordinates of the top left pixel
+* @param offset_y Undistorted coordinates of the top left pixel
+* @param source_width Width of the distorted images
+* @param source_height Height of the distorted images
+* @param[out] map Distorted position of each undistorted pixel
+*/
+inline void ComputeUndistortionMap(
+  const IntrinsicBase * cam,
+  const int width,
+  const int height,
+  const int offset_x,
+  const int offset_y,
+  const int source_width,
+  const int source_height,
+  image::Remap_Map & map)
+{
+  map.resize( width, height, source_width, source_height );
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for ( int j = 0; j < height; ++j )
+    for ( int i = 0; i < width; ++i )
+    {
+      const Vec2 undisto_pix( i + offset_x, j + offset_y );
+      // compute coordinates with distortion
+      const Vec2 disto_pix = cam->get_d_pixel( undisto_pix );
+      map.Set( j, i, disto_pix( 0 ), disto_pix( 1 ) );
+    }
+}
+
+/**
+* @brief Thread-safe collection of undistortion maps.
+* A map is computed at its first request and is shared by the cameras that have
+* the same parameters, so undistorting the images of a camera costs only the
+* sampling pass. The least recently used maps are released when the capacity
+* is reached.
+*/
+class Undistortion_Map_Cache
+{
+public:
+  explicit Undistortion_Map_Cache(const size_t capacity = 8)
+    : capacity_(std::max<size_t>(capacity, 1))
+  {}
+
+  /**
+  * @brief Return the map that undistorts the images of a camera (UndistortImage)
+  * @param cam Camera model
+  * @param width Width of the images
+  * @param height Height of the images
+  */
+  std::shared_ptr<const image::Remap_Map> Get
+  (
+    const IntrinsicBase * cam,
+    const int width,
+    const int height
+  )
+  {
+    // The parameters are part of the key: a hash collision must not return
+    // the map of another camera
+    const Key key{cam->hashValue(), width, height, cam->getType(), cam->getParams()};
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++clock_;
+    auto it = maps_.find(key);
+    if (it != maps_.end())
+    {
+      it->second.last_use = clock_;
+      return it->second.map;
+    }
+    // The map is computed outside of the lock (it is multi-threaded)
+    lock.unlock();
+    auto map = std::make_shared<image::Remap_Map>();
+    ComputeUndistortionMap( cam, width, height, 0, 0, width, height, *map );
+    lock.lock();
+
+    auto & entry = maps_[key];
+    if (!entry.map) // no other thread computed it meanwhile
+      entry.map = map;
+    entry.last_use = ++clock_;
+    while (maps_.size() > capacity_)
+    {
+      auto oldest = std::min_element(maps_.begin(), maps_.end(),
+        [](const std::map<Key, Entry>::value_type & a,
+           const std::map<Key, Entry>::value_type & b)
+        { return a.second.last_use < b.second.last_use; });
+      maps_.erase(oldest);
+    }
+    return entry.map;
+  }
+
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maps_.clear();
+  }
+
+private:
+  using Key = std::tuple<std::size_t, int, int, EINTRINSIC, std::vector<double>>;
+  struct Entry
+  {
+    std::shared_ptr<const image::Remap_Map> map;
+    uint64_t last_use = 0;
+  };
+
+  const size_t capacity_;
+  std::mutex mutex_;
+  uint64_t clock_ = 0;
+  std::map<Key, Entry> maps_;
+};
+
 /**
 * @brief  Undistort an image according a given camera & its distortion model
 * @param imageIn Input image
 * @param cam Input intrinsic parameter used to undistort image
 * @param[out] image_ud Output undistorted image
 * @param fillcolor color used to fill pixels where no input pixel is found
+* @note Use an Undistortion_Map_Cache & image::Remap to undistort several
+*  images of the same camera.
 */
 template <typename Image>
 void UndistortImage(
@@ -41,23 +165,10 @@ void UndistortImage(
   }
   else // There is distortion
   {
-    image_ud.resize( imageIn.Width(), imageIn.Height(), true, fillcolor );
-    const image::Sampler2d<image::SamplerLinear> sampler;
-#ifdef OPENMVG_USE_OPENMP
-    #pragma omp parallel for
-#endif
-    for ( int j = 0; j < imageIn.Height(); ++j )
-      for ( int i = 0; i < imageIn.Width(); ++i )
-      {
-        const Vec2 undisto_pix( i, j );
-        // compute coordinates with distortion
-        const Vec2 disto_pix = cam->get_d_pixel( undisto_pix );
-        // pick pixel if it is in the image domain
-        if ( imageIn.Contains( disto_pix( 1 ), disto_pix( 0 ) ) )
-        {
-          image_ud( j, i ) = sampler( imageIn, disto_pix( 1 ), disto_pix( 0 ) );
-        }
-      }
+    image::Remap_Map map;
+    ComputeUndistortionMap( cam, imageIn.Width(), imageIn.Height(), 0, 0,
+                            imageIn.Width(), imageIn.Height(), map );
+    image::Remap( imageIn, map, image_ud, image::ERemap_Interpolation::BILINEAR, fillcolor );
   }
 }
 
@@ -87,27 +198,37 @@ void UndistortImageResized(
   else // There is distortion
   {
     // 1 - Compute size of the Undistorted image
-    int min_x = std::numeric_limits<int>::max();
-    int min_y = std::numeric_limits<int>::max();
-    int max_x = std::numeric_limits<int>::lowest();
-    int max_y = std::numeric_limits<int>::lowest();
+    // (the inverse distortion of every pixel is interpolated in a lookup table)
+    const Inverse_Distortion_LUT lut( *cam );
+    std::vector<int>
+      row_min_x( imageIn.Height(), std::numeric_limits<int>::max() ),
+      row_min_y( imageIn.Height(), std::numeric_limits<int>::max() ),
+      row_max_x( imageIn.Height(), std::numeric_limits<int>::lowest() ),
+      row_max_y( imageIn.Height(), std::numeric_limits<int>::lowest() );
 
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for
+#endif
     for (int id_row = 0; id_row < imageIn.Height(); ++id_row )
     {
       for (int id_col = 0; id_col < imageIn.Width(); ++id_col )
       {
         const Vec2 dist_pix( id_col , id_row );
-        const Vec2 undist_pix = cam->get_ud_pixel( dist_pix );
+        const Vec2 undist_pix = lut.get_ud_pixel( dist_pix );
 
         const int x = static_cast<int>( undist_pix[0] );
         const int y = static_cast<int>( undist_pix[1] );
 
-        min_x = std::min( x , min_x );
-        min_y = std::min( y , min_y );
-        max_x = std::max( x , max_x );
-        max_y = std::max( y , max_y );
+        row_min_x[id_row] = std::min( x , row_min_x[id_row] );
+        row_min_y[id_row] = std::min( y , row_min_y[id_row] );
+        row_max_x[id_row] = std::max( x , row_max_x[id_row] );
+        row_max_y[id_row] = std::max( y , row_max_y[id_row] );
       }
     }
+    const int min_x = *std::min_element( row_min_x.cbegin(), row_min_x.cend() );
+    const int min_y = *std::min_element( row_min_y.cbegin(), row_min_y.cend() );
+    const int max_x = *std::max_element( row_max_x.cbegin(), row_max_x.cend() );
+    const int max_y = *std::max_element( row_max_y.cbegin(), row_max_y.cend() );
 
     // Ensure size is at least 1 pixel (width and height)
     const int computed_size_x = std::max( 1 , max_x - min_x + 1 );
@@ -118,29 +239,10 @@ void UndistortImageResized(
     const uint32_t real_size_y = std::min( max_ud_height , (uint32_t)computed_size_y );
 
     // 2 - Compute inverse projection to fill the output image
-    image_ud.resize( real_size_x , real_size_y , true, fillcolor );
-    const image::Sampler2d<image::SamplerLinear> sampler;
-
-#ifdef OPENMVG_USE_OPENMP
-    #pragma omp parallel for
-#endif
-    for ( int j = 0; j < real_size_y; ++j )
-      for ( int i = 0; i < real_size_x; ++i )
-      {
-        const Vec2 undisto_pix( i + min_x , j + min_y );
-        // compute coordinates with distortion
-        const Vec2 disto_pix = cam->get_d_pixel( undisto_pix );
-
-        // pick pixel if it is in the image domain
-        if ( imageIn.Contains( disto_pix( 1 ), disto_pix( 0 ) ) &&
-             (! std::isnan( disto_pix[0] )) &&
-             (! std::isnan( disto_pix[1] )) &&
-             (! std::isinf( disto_pix[0] )) &&
-             (! std::isinf( disto_pix[1] )) )
-        {
-          image_ud( j, i ) = sampler( imageIn, disto_pix( 1 ), disto_pix( 0 ) );
-        }
-      }
+    image::Remap_Map map;
+    ComputeUndistortionMap( cam, real_size_x, real_size_y, min_x, min_y,
+                            imageIn.Width(), imageIn.Height(), map );
+    image::Remap( imageIn, map, image_ud, image::ERemap_Interpolation::BILINEAR, fillcolor );
   }
 }
 
@@ -0,0 +1,223 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_CAMERAS_CAMERA_UNDISTORTION_LUT_HPP
+#define OPENMVG_CAMERAS_CAMERA_UNDISTORTION_LUT_HPP
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace openMVG
+{
+namespace cameras
+{
+
+/**
+* @brief Lookup table of the inverse distortion (get_ud_pixel) of a camera.
+*
+* The exact (iterative) inversion is computed once on a regular grid of the
+* distorted image domain. A query is a bilinear interpolation of the grid,
+* followed by a few Newton steps on the forward distortion model (get_d_pixel)
+* that use the Jacobian of the interpolated map.
+* Points outside the grid use the exact inversion.
+* With the default settings the returned points are within 1e-4 pixel of the
+* iterative inversion (the bisection of the radial models is itself only
+* accurate to ~1e-5 pixel near the principal point). The speed-up is the
+* largest for the cameras whose inversion is a bisection (radial models).
+*
+* The table keeps a copy of the camera: it stays valid if the source camera is
+* modified (see IsValidFor).
+*/
+class Inverse_Distortion_LUT
+{
+public:
+  /**
+  * @brief Build the table
+  * @param cam Camera model
+  * @param grid_step Distance between two grid nodes (in pixels)
+  * @param max_refinement_iterations Maximum number of Newton steps per query
+  * @param refinement_tolerance Stop the refinement when the reprojection
+  *  error of the undistorted point is below this value (in pixels)
+  */
+  explicit Inverse_Distortion_LUT
+  (
+    const IntrinsicBase & cam,
+    const int grid_step = 8,
+    const int max_refinement_iterations = 2,
+    const double refinement_tolerance = 1e-8
+  ):
+    cam_(cam.clone()),
+    hash_(cam.hashValue()),
+    step_(std::max(grid_step, 1)),
+    max_refinement_iterations_(max_refinement_iterations),
+    refinement_tolerance_(refinement_tolerance)
+  {
+    // One cell of margin around the image domain
+    origin_ = Vec2(-step_, -step_);
+    nb_cols_ = static_cast<int>(std::ceil(cam.w() / static_cast<double>(step_))) + 3;
+    nb_rows_ = static_cast<int>(std::ceil(cam.h() / static_cast<double>(step_))) + 3;
+    nodes_.resize(2, nb_cols_ * nb_rows_);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int row = 0; row < nb_rows_; ++row)
+    {
+      for (int col = 0; col < nb_cols_; ++col)
+      {
+        nodes_.col(row * nb_cols_ + col) =
+          cam_->get_ud_pixel(origin_ + Vec2(col * step_, row * step_));
+      }
+    }
+  }
+
+  /// Tell if the table was built with the same camera parameters
+  /// (the hash is only a quick rejection test, the parameters are compared)
+  bool IsValidFor(const IntrinsicBase & cam) const
+  {
+    return hash_ == cam.hashValue() &&
+      cam_->getType() == cam.getType() &&
+      cam_->w() == cam.w() && cam_->h() == cam.h() &&
+      cam_->getParams() == cam.getParams();
+  }
+
+  const IntrinsicBase & camera() const { return *cam_; }
+
+  /**
+  * @brief Return the un-distorted pixel (with removed distortion)
+  * @param p Input distorted pixel
+  * @return Point without distortion
+  */
+  Vec2 get_ud_pixel(const Vec2 & p) const
+  {
+    // Position in the grid
+    const Vec2 grid_position = (p - origin_) / step_;
+    const double col_floor = std::floor(grid_position(0));
+    const double row_floor = std::floor(grid_position(1));
+    if (!(col_floor >= 0 && row_floor >= 0 &&
+          col_floor < nb_cols_ - 1 && row_floor < nb_rows_ - 1))
+    {
+      return cam_->get_ud_pixel(p);
+    }
+    const int col = static_cast<int>(col_floor);
+    const int row = static_cast<int>(row_floor);
+    const double dx = grid_position(0) - col_floor;
+    const double dy = grid_position(1) - row_floor;
+
+    // Bilinear interpolation of the inverse map & of its Jacobian
+    const int index = row * nb_cols_ + col;
+    const Vec2 n00 = nodes_.col(index), n10 = nodes_.col(index + 1),
+      n01 = nodes_.col(index + nb_cols_), n11 = nodes_.col(index + nb_cols_ + 1);
+    Vec2 ud = (1. - dy) * ((1. - dx) * n00 + dx * n10) + dy * ((1. - dx) * n01 + dx * n11);
+    if (!ud.allFinite()) // the inversion failed around a node
+      return cam_->get_ud_pixel(p);
+    Eigen::Matrix2d inverse_jacobian;
+    inverse_jacobian.col(0) = ((1. - dy) * (n10 - n00) + dy * (n11 - n01)) / step_;
+    inverse_jacobian.col(1) = ((1. - dx) * (n01 - n00) + dx * (n11 - n10)) / step_;
+
+    // Newton refinement on the forward model: get_d_pixel(ud) == p
+    for (int i = 0; i < max_refinement_iterations_; ++i)
+    {
+      const Vec2 residual = p - cam_->get_d_pixel(ud);
+      if (residual.lpNorm<Eigen::Infinity>() < refinement_tolerance_)
+        break;
+      ud += inverse_jacobian * residual;
+    }
+    return ud;
+  }
+
+  /**
+  * @brief Batched un-distortion of points
+  * @param points Input distorted pixels (one per column)
+  * @param[out] ud_points Points without distortion
+  */
+  void get_ud_pixels(const Mat2X & points, Mat2X & ud_points) const
+  {
+    ud_points.resize(2, points.cols());
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for if (points.cols() > 1024)
+#endif
+    for (int i = 0; i < static_cast<int>(points.cols()); ++i)
+    {
+      ud_points.col(i) = get_ud_pixel(points.col(i));
+    }
+  }
+
+  Mat2X get_ud_pixels(const Mat2X & points) const
+  {
+    Mat2X ud_points;
+    get_ud_pixels(points, ud_points);
+    return ud_points;
+  }
+
+private:
+  std::unique_ptr<IntrinsicBase> cam_;
+  std::size_t hash_;
+  int step_;
+  int max_refinement_iterations_;
+  double refinement_tolerance_;
+  // Grid of the undistorted positions of the nodes (row major)
+  Vec2 origin_;
+  int nb_cols_, nb_rows_;
+  Mat2X nodes_;
+};
+
+/**
+* @brief Thread-safe collection of Inverse_Distortion_LUT.
+* A table is built at its first request and is shared by the cameras that have
+* the same parameters (a camera with new parameters gets a new table).
+* At most max_tables tables are kept (the oldest one is dropped first).
+*/
+class Inverse_Distortion_LUT_Cache
+{
+public:
+  explicit Inverse_Distortion_LUT_Cache
+  (
+    const int grid_step = 8,
+    const std::size_t max_tables = 16
+  ):
+    grid_step_(grid_step),
+    max_tables_(std::max<std::size_t>(max_tables, 1))
+  {}
+
+  /// Return the table of a camera (build it if required)
+  std::shared_ptr<const Inverse_Distortion_LUT> Get(const IntrinsicBase & cam)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & lut : luts_)
+    {
+      if (lut->IsValidFor(cam))
+        return lut;
+    }
+    if (luts_.size() == max_tables_)
+      luts_.pop_front();
+    luts_.push_back(std::make_shared<const Inverse_Distortion_LUT>(cam, grid_step_));
+    return luts_.back();
+  }
+
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    luts_.clear();
+  }
+
+private:
+  const int grid_step_;
+  const std::size_t max_tables_;
+  std::mutex mutex_;
+  std::deque<std::shared_ptr<const Inverse_Distortion_LUT>> luts_;
+};
+
+} // namespace cameras
+} // namespace openMVG
+
+#endif // #ifndef OPENMVG_CAMERAS_CAMERA_UNDISTORTION_LUT_HPP
@@ -0,0 +1,135 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole_Brown.hpp"
+#include "openMVG/cameras/Camera_Pinhole_Fisheye.hpp"
+#include "openMVG/cameras/Camera_Pinhole_Radial.hpp"
+#include "openMVG/cameras/Camera_undistortion_lut.hpp"
+
+#include "testing/testing.h"
+
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+
+// Random distorted pixels (in the image domain and slightly outside)
+Mat2X RandomPixels(const IntrinsicBase & cam, const int nb_points)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double>
+    rand_x(-10.0, cam.w() + 10.0),
+    rand_y(-10.0, cam.h() + 10.0);
+  Mat2X points(2, nb_points);
+  for (int i = 0; i < nb_points; ++i)
+    points.col(i) << rand_x(random_generator), rand_y(random_generator);
+  return points;
+}
+
+// Compare the table to the iterative inversion
+// Return the maximal difference (in pixels)
+// (see openMVG_sample_cameras_undistortion_lut for a timing benchmark)
+// Note: the radial bisection stops on an absolute squared radius threshold, it
+// is only accurate to ~1e-5 pixel near the principal point.
+double CompareLUT(const IntrinsicBase & cam)
+{
+  const Mat2X points = RandomPixels(cam, 2000);
+  Mat2X ud_points(2, points.cols());
+  for (int i = 0; i < points.cols(); ++i)
+    ud_points.col(i) = cam.get_ud_pixel(points.col(i));
+
+  const Inverse_Distortion_LUT lut(cam);
+  const Mat2X lut_ud_points = lut.get_ud_pixels(points);
+  return (ud_points - lut_ud_points).cwiseAbs().maxCoeff();
+}
+
+TEST(Inverse_Distortion_LUT, Radial_K3) {
+  const Pinhole_Intrinsic_Radial_K3 cam(1000, 1000, 1000, 500, 500, -0.245442, 0.112603, 0.);
+  EXPECT_TRUE(CompareLUT(cam) < 1e-4);
+}
+
+TEST(Inverse_Distortion_LUT, Brown_T2) {
+  const Pinhole_Intrinsic_Brown_T2 cam(1000, 1000, 1000, 500, 500,
+    -0.054, 0.014, 0.006, 0.001, -0.001);
+  EXPECT_TRUE(CompareLUT(cam) < 1e-4);
+}
+
+TEST(Inverse_Distortion_LUT, Fisheye) {
+  const Pinhole_Intrinsic_Fisheye cam(1000, 1000, 1000, 500, 500,
+    -0.054, 0.014, 0.006, 0.011);
+  EXPECT_TRUE(CompareLUT(cam) < 1e-4);
+}
+
+TEST(Inverse_Distortion_LUT, Batched) {
+  const Pinhole_Intrinsic_Brown_T2 cam(1000, 1000, 1000, 500, 500,
+    -0.054, 0.014, 0.006, 0.001, -0.001);
+  const Inverse_Distortion_LUT lut(cam);
+  const Mat2X points = RandomPixels(cam, 2000);
+  const Mat2X ud_points = lut.get_ud_pixels(points);
+  for (int i = 0; i < points.cols(); ++i)
+  {
+    // The batched & single point queries are the same
+    EXPECT_MATRIX_NEAR(ud_points.col(i), lut.get_ud_pixel(points.col(i)), 0.0);
+    // get_ud_pixel inverts get_d_pixel
+    EXPECT_MATRIX_NEAR(points.col(i), cam.get_d_pixel(ud_points.col(i)), 1e-6);
+  }
+}
+
+TEST(Inverse_Distortion_LUT, Cache) {
+  Pinhole_Intrinsic_Radial_K3 cam(1000, 1000, 1000, 500, 500, -0.245442, 0.112603, 0.);
+  const Pinhole_Intrinsic_Radial_K3 same_cam = cam;
+
+  Inverse_Distortion_LUT_Cache cache;
+  const std::shared_ptr<const Inverse_Distortion_LUT> lut = cache.Get(cam);
+  EXPECT_TRUE(lut->IsValidFor(cam));
+  // The cameras with the same parameters share their table
+  EXPECT_TRUE(lut == cache.Get(same_cam));
+
+  // The table of a modified camera is rebuilt, the previous one stays valid
+  std::vector<double> params = cam.getParams();
+  params[3] = -0.2;
+  cam.updateFromParams(params);
+  EXPECT_FALSE(lut->IsValidFor(cam));
+  const std::shared_ptr<const Inverse_Distortion_LUT> new_lut = cache.Get(cam);
+  EXPECT_TRUE(new_lut != lut);
+  EXPECT_TRUE(new_lut->IsValidFor(cam));
+  const Vec2 pt(10.0, 20.0);
+  EXPECT_MATRIX_NEAR(same_cam.get_ud_pixel(pt), lut->get_ud_pixel(pt), 1e-6);
+  EXPECT_MATRIX_NEAR(cam.get_ud_pixel(pt), new_lut->get_ud_pixel(pt), 1e-6);
+
+  // The cameras are compared by their parameters (not only by their hash)
+  const Pinhole_Intrinsic_Brown_T2 other_cam(1000, 1000, 1000, 500, 500, 0., 0., 0., 0., 0.);
+  EXPECT_FALSE(lut->IsValidFor(other_cam));
+  EXPECT_FALSE(new_lut->IsValidFor(other_cam));
+  EXPECT_TRUE(cache.Get(other_cam)->IsValidFor(other_cam));
+}
+
+TEST(Inverse_Distortion_LUT, Cache_Capacity) {
+  Inverse_Distortion_LUT_Cache cache(32, 2);
+  Pinhole_Intrinsic_Radial_K3 cam(100, 100, 100, 50, 50, -0.2, 0., 0.);
+  const std::shared_ptr<const Inverse_Distortion_LUT> first_lut = cache.Get(cam);
+  for (const double k1 : {-0.1, -0.05})
+  {
+    std::vector<double> params = cam.getParams();
+    params[3] = k1;
+    cam.updateFromParams(params);
+    EXPECT_TRUE(cache.Get(cam)->IsValidFor(cam));
+  }
+  // The oldest table was dropped: a new table is built for the first camera
+  const Pinhole_Intrinsic_Radial_K3 first_cam(100, 100, 100, 50, 50, -0.2, 0., 0.);
+  const std::shared_ptr<const Inverse_Distortion_LUT> lut = cache.Get(first_cam);
+  EXPECT_TRUE(lut != first_lut);
+  EXPECT_TRUE(lut->IsValidFor(first_cam));
+  // The last tables are kept
+  EXPECT_TRUE(lut == cache.Get(first_cam));
+  EXPECT_TRUE(cache.Get(cam)->IsValidFor(cam));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
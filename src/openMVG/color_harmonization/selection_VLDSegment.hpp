@@ -23,14 +23,21 @@ namespace color_harmonization {
 class commonDataByPair_VLDSegment  : public commonDataByPair
 {
   public:
+  /**
+   * \param[in] imageL, imageR Optional gray images already decoded
+   *  (if not provided the images are read from the sLeftImage and sRightImage files).
+   */
   commonDataByPair_VLDSegment( const std::string & sLeftImage,
                                const std::string & sRightImage,
                                const std::vector<matching::IndMatch>& vec_PutativeMatches,
                                const std::vector<features::SIOPointFeature >& vec_featsL,
-                               const std::vector<features::SIOPointFeature >& vec_featsR):
+                               const std::vector<features::SIOPointFeature >& vec_featsR,
+                               const image::Image<unsigned char> * imageL = nullptr,
+                               const image::Image<unsigned char> * imageR = nullptr):
            commonDataByPair( sLeftImage, sRightImage ),
            _vec_featsL( vec_featsL ), _vec_featsR( vec_featsR ),
-           _vec_PutativeMatches( vec_PutativeMatches )
+           _vec_PutativeMatches( vec_PutativeMatches ),
+           _imageL( imageL ), _imageR( imageR )
   {}
 
   ~commonDataByPair_VLDSegment() override = default;
@@ -50,11 +57,13 @@ class commonDataByPair_VLDSegment  : public commonDataByPair
     std::vector<matching::IndMatch> vec_KVLDMatches;
 
     image::Image<unsigned char> imageL, imageR;
-    image::ReadImage( _sLeftImage.c_str(), &imageL );
-    image::ReadImage( _sRightImage.c_str(), &imageR );
+    if ( !_imageL )
+      image::ReadImage( _sLeftImage.c_str(), &imageL );
+    if ( !_imageR )
+      image::ReadImage( _sRightImage.c_str(), &imageR );
 
-    image::Image<float> imgA ( imageL.GetMat().cast<float>() );
-    image::Image<float> imgB(imageR.GetMat().cast<float>());
+    image::Image<float> imgA ( ( _imageL ? *_imageL : imageL ).GetMat().cast<float>() );
+    image::Image<float> imgB( ( _imageR ? *_imageR : imageR ).GetMat().cast<float>() );
 
     std::vector<Pair> matchesFiltered, matchesPair;
 
@@ -114,6 +123,8 @@ private:
   std::vector<features::SIOPointFeature > _vec_featsL, _vec_featsR;
   // Left and Right corresponding index (putatives matches)
   std::vector<matching::IndMatch> _vec_PutativeMatches;
+  // Left and Right gray images (optional)
+  const image::Image<unsigned char> * _imageL, * _imageR;
 };
 
 }  // namespace color_harmonization
@@ -8,6 +8,8 @@
 
 #include "openMVG/exif/exif_IO_EasyExif.hpp"
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <limits>
 #include <sstream>
@@ -59,27 +61,80 @@ Exif_IO_EasyExif::Exif_IO_EasyExif( const std::string & sFileName ):
   open( sFileName );
 }
 
+Exif_IO_EasyExif::~Exif_IO_EasyExif() = default;
+
 bool Exif_IO_EasyExif::open( const std::string & sFileName )
 {
-  // Read the file into a buffer
+  bHaveExifInfo_ = false;
+  (*pimpl_).get().clear();
+
+  // Read only the JPEG header segments, up to the EXIF (APP1) segment.
+  // The image data is never read.
   FILE *fp = fopen( sFileName.c_str(), "rb" );
   if ( !fp )
   {
     return false;
   }
-  fseek( fp, 0, SEEK_END );
-  unsigned long fsize = ftell( fp );
-  rewind( fp );
-  std::vector<unsigned char> buf( fsize );
-  if ( fread( &buf[0], 1, fsize, fp ) != fsize )
+  std::vector<unsigned char> buf;
+  unsigned char marker[4];
+  // All JPEG files start with 0xFFD8
+  if ( fread( marker, 1, 2, fp ) == 2 && marker[0] == 0xFF && marker[1] == 0xD8 )
   {
-    fclose( fp );
-    return false;
+    while ( fread( marker, 1, 2, fp ) == 2 && marker[0] == 0xFF )
+    {
+      // Skip the fill bytes
+      while ( marker[1] == 0xFF && fread( &marker[1], 1, 1, fp ) == 1 ) {}
+      // Standalone markers (no segment length)
+      if ( marker[1] == 0x01 || ( marker[1] >= 0xD0 && marker[1] <= 0xD7 ) )
+      {
+        continue;
+      }
+      // Start of scan or end of image: there is no more header segment
+      if ( marker[1] == 0xDA || marker[1] == 0xD9 )
+      {
+        break;
+      }
+      if ( fread( &marker[2], 1, 2, fp ) != 2 )
+      {
+        break;
+      }
+      const unsigned section_length = ( marker[2] << 8 ) | marker[3];
+      if ( section_length < 2 )
+      {
+        break;
+      }
+      if ( marker[1] == 0xE1 )
+      {
+        buf.resize( section_length - 2 );
+        if ( fread( buf.data(), 1, buf.size(), fp ) != buf.size() )
+        {
+          buf.clear();
+          break;
+        }
+        // Keep the first APP1 segment that is an EXIF segment (not XMP)
+        if ( buf.size() >= 6 && std::equal( buf.cbegin(), buf.cbegin() + 6, "Exif\0\0" ) )
+        {
+          break;
+        }
+        buf.clear();
+      }
+      else if ( fseek( fp, section_length - 2, SEEK_CUR ) != 0 )
+      {
+        break;
+      }
+    }
   }
   fclose( fp );
 
   // Parse EXIF
-  bHaveExifInfo_ = ( (*pimpl_).get().parseFrom( &buf[0], fsize ) == PARSE_EXIF_SUCCESS );
+  return parseExifSegment( buf.data(), buf.size() );
+}
+
+bool Exif_IO_EasyExif::parseExifSegment( const unsigned char * segment, size_t size )
+{
+  (*pimpl_).get().clear();
+  bHaveExifInfo_ = segment && size > 0
+    && (*pimpl_).get().parseFromEXIFSegment( segment, static_cast<unsigned>( size ) ) == PARSE_EXIF_SUCCESS;
 
   return bHaveExifInfo_;
 }
@@ -37,6 +37,11 @@ class Exif_IO_EasyExif : public Exif_IO
     */
     explicit Exif_IO_EasyExif( const std::string & sFileName );
 
+    /**
+    * @brief Destructor
+    */
+    ~Exif_IO_EasyExif() override;
+
     /**
     * @brief Open and populate EXIF data
     * @param sFileName path of the image to analyze
@@ -45,6 +50,15 @@ class Exif_IO_EasyExif : public Exif_IO
     */
     bool open( const std::string & sFileName ) override;
 
+    /**
+    * @brief Populate EXIF data from an EXIF segment already read from the file
+    * @param segment EXIF segment (starting with "Exif\0\0")
+    * @param size Size of the EXIF segment (in bytes)
+    * @retval true if the EXIF segment could be parsed correctly
+    * @retval false if the EXIF segment could not be parsed
+    */
+    bool parseExifSegment( const unsigned char * segment, size_t size );
+
     /**
     * @brief Get image width
     * @return Width of the image (in pixel)
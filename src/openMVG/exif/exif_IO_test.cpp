@@ -11,7 +11,9 @@
 #include "testing/testing.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
 
 using namespace std;
@@ -74,6 +76,30 @@ TEST(Matching, Exif_IO_easyexif_Read_GPS_Data)
   EXPECT_NEAR( 31, exif_io->getFocalLengthIn35mm(), 1e-2);
 }
 
+TEST(Matching, Exif_IO_easyexif_ParseExifSegment)
+{
+  // Extract the EXIF segment from the JPEG file
+  const std::string sImg_gps = std::string(THIS_SOURCE_DIR) + "/image_data/gps_tag.jpg";
+  std::ifstream stream( sImg_gps, std::ios::binary );
+  const std::string data( (std::istreambuf_iterator<char>( stream )), std::istreambuf_iterator<char>() );
+  const size_t pos = data.find( std::string( "Exif\0\0", 6 ) );
+  EXPECT_TRUE( pos != std::string::npos && pos >= 2 );
+  const size_t segment_length =
+    ( static_cast<unsigned char>( data[pos - 2] ) << 8 ) + static_cast<unsigned char>( data[pos - 1] ) - 2;
+
+  Exif_IO_EasyExif exif_io;
+  EXPECT_FALSE( exif_io.parseExifSegment( nullptr, 0 ) );
+  EXPECT_TRUE( exif_io.parseExifSegment(
+    reinterpret_cast<const unsigned char *>( &data[pos] ), segment_length ) );
+
+  // Same data as the one read from the file
+  const Exif_IO_EasyExif exif_io_file( sImg_gps );
+  EXPECT_EQ( exif_io_file.allExifData(), exif_io.allExifData() );
+  double val;
+  EXPECT_TRUE(exif_io.GPSLatitude(&val));
+  EXPECT_NEAR(47.5129, val, 1e-4);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -10,8 +10,11 @@
 #define OPENMVG_EXIF_SENSOR_WIDTH_PARSE_DATABASE_HPP
 
 #include <algorithm>
+#include <cctype>
 #include <fstream>
+#include <limits>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "openMVG/exif/sensor_width_database/datasheet.hpp"
@@ -76,4 +79,114 @@ bool getInfo
   return existInDatabase;
 }
 
+// Hashed index of the sensor width database.
+// It retrieves the same datasheet as getInfo (the first database entry that
+// matches the camera model, see Datasheet::operator==) without comparing the
+// camera model to every database entry.
+class Datasheet_Index
+{
+public:
+  explicit Datasheet_Index( const std::vector<Datasheet>& vec_database )
+    : vec_database_( vec_database )
+  {
+    for ( size_t i = 0; i < vec_database_.size(); ++i )
+    {
+      const std::string model = toLower( vec_database_[i].model_ );
+      model_index_[model].push_back( i );
+      // Index the entries that have a digit based sub model by {maker, sub model}
+      std::vector<std::string> vec_model;
+      stl::split( model, ' ', vec_model );
+      const auto it_digit = std::find_if( vec_model.cbegin(), vec_model.cend(), &hasDigit );
+      if ( it_digit != vec_model.cend() )
+      {
+        digit_index_[getMaker( model ) + ' ' + *it_digit].push_back( i );
+      }
+      else
+      {
+        no_digit_entries_.push_back( i );
+      }
+    }
+  }
+
+  // Retrieve camera 'Datasheet' information for the given camera model name
+  //  iff it is found in the database
+  bool getInfo
+  (
+    const std::string & sModel,
+    Datasheet& datasheetContent
+  ) const
+  {
+    static const size_t npos = std::numeric_limits<size_t>::max();
+    size_t best = npos;
+
+    const std::string model = toLower( sModel );
+    const bool has_digit = hasDigit( model );
+
+    // Entries compared with the full model string
+    const auto it_model = model_index_.find( model );
+    if ( it_model != model_index_.cend() )
+    {
+      for ( const size_t i : it_model->second )
+      {
+        if ( !has_digit || std::binary_search( no_digit_entries_.cbegin(), no_digit_entries_.cend(), i ) )
+        {
+          best = i;
+          break;
+        }
+      }
+    }
+    // Entries compared with their digit based sub model
+    if ( has_digit )
+    {
+      const std::string maker = getMaker( model );
+      std::vector<std::string> vec_model;
+      stl::split( model, ' ', vec_model );
+      for ( const std::string & sub_model : vec_model )
+      {
+        if ( !hasDigit( sub_model ) )
+          continue;
+        const auto it_digit = digit_index_.find( maker + ' ' + sub_model );
+        if ( it_digit != digit_index_.cend() )
+        {
+          best = std::min( best, it_digit->second.front() );
+        }
+      }
+    }
+
+    if ( best == npos )
+    {
+      return false;
+    }
+    datasheetContent = vec_database_[best];
+    return true;
+  }
+
+private:
+  static std::string toLower( std::string s )
+  {
+    std::transform( s.begin(), s.end(), s.begin(), ::tolower );
+    return s;
+  }
+
+  static bool hasDigit( const std::string & s )
+  {
+    return std::find_if( s.cbegin(), s.cend(),
+      []( const char c ) { return std::isdigit( static_cast<unsigned char>( c ) ) != 0; } ) != s.cend();
+  }
+
+  // Camera maker substring [0->first space]
+  static std::string getMaker( const std::string & model )
+  {
+    return model.substr( 0, model.find( ' ' ) );
+  }
+
+  const std::vector<Datasheet> & vec_database_;
+  // Lower case model -> entry ids (increasing order)
+  std::unordered_map<std::string, std::vector<size_t>> model_index_;
+  // "maker digit_sub_model" -> entry ids (increasing order)
+  std::unordered_map<std::string, std::vector<size_t>> digit_index_;
+  // Entries without digit based sub model (increasing order)
+  std::vector<size_t> no_digit_entries_;
+};
+
 #endif // OPENMVG_EXIF_SENSOR_WIDTH_PARSE_DATABASE_HPP
@@ -129,6 +129,36 @@ TEST(Matching, ParseDatabaseCanon_EOS_M)
   EXPECT_EQ( 22.3, datasheet.sensorSize_ );
 }
 
+TEST(Matching, DatasheetIndex)
+{
+  std::vector<Datasheet> vec_database;
+  const std::string sfileDatabase = stlplus::create_filespec( std::string(THIS_SOURCE_DIR), sDatabase );
+  EXPECT_TRUE( parseDatabase( sfileDatabase, vec_database ) );
+  const Datasheet_Index database_index( vec_database );
+
+  // The index must retrieve the same datasheet as the linear search
+  std::vector<std::string> vec_model = {
+    "Canon PowerShot SD900", "Canon EOS 5D Mark II", "Canon EOS M", "canon eos m",
+    "Canon DIGITAL IXUS 70", "KODAK Z612 ZOOM DIGITAL CAMERA", "Kodak EasyShare Z612",
+    "NotExistModel", "Canon", "Canon EOS", "" };
+  for ( size_t i = 0; i < vec_database.size(); i += 13 )
+  {
+    vec_model.push_back( vec_database[i].model_ );
+    vec_model.push_back( vec_database[i].model_ + " Extra 2" );
+  }
+  for ( const std::string & sModel : vec_model )
+  {
+    Datasheet datasheet, datasheet_index;
+    const bool found = getInfo( sModel, vec_database, datasheet );
+    EXPECT_EQ( found, database_index.getInfo( sModel, datasheet_index ) );
+    if ( found )
+    {
+      EXPECT_EQ( datasheet.model_, datasheet_index.model_ );
+      EXPECT_EQ( datasheet.sensorSize_, datasheet_index.sensorSize_ );
+    }
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
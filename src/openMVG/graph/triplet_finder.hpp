@@ -11,12 +11,16 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
-#include <set>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
+
 #include "openMVG/types.hpp"
 
 namespace openMVG
@@ -96,6 +100,201 @@ inline std::ostream & operator<<( std::ostream & os, const Triplet & t )
   return os;
 }
 
+namespace internal
+{
+
+/**
+* @brief Degree ordered forward adjacency of a graph (CSR storage).
+* The nodes are ranked by ascending degree and each edge is oriented toward
+*  its highest ranked node. Each triangle (u < v < w in rank) is then found
+*  once, from u, by intersecting the small sorted forward lists of u and v
+*  (compact-forward algorithm).
+*/
+class Forward_Adjacency
+{
+public:
+  template <typename IterablePairs>
+  explicit Forward_Adjacency( const IterablePairs & pairs )
+  {
+    // Contiguous node indexes
+    for (const auto & edge : pairs)
+    {
+      node_ids_.push_back(static_cast<IndexT>(edge.first));
+      node_ids_.push_back(static_cast<IndexT>(edge.second));
+    }
+    std::sort(node_ids_.begin(), node_ids_.end());
+    node_ids_.erase(std::unique(node_ids_.begin(), node_ids_.end()), node_ids_.end());
+    const auto node_index = [this](const IndexT id) -> uint32_t
+    {
+      return std::lower_bound(node_ids_.cbegin(), node_ids_.cend(), id) - node_ids_.cbegin();
+    };
+
+    // Unique undirected edges (self loops are ignored)
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (const auto & edge : pairs)
+    {
+      const uint32_t a = node_index(static_cast<IndexT>(edge.first));
+      const uint32_t b = node_index(static_cast<IndexT>(edge.second));
+      if (a != b)
+        edges.emplace_back(std::min(a, b), std::max(a, b));
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // Rank the nodes by ascending degree
+    const uint32_t node_count = NodeCount();
+    std::vector<uint32_t> degree(node_count, 0);
+    for (const auto & edge : edges)
+    {
+      ++degree[edge.first];
+      ++degree[edge.second];
+    }
+    rank_to_node_.resize(node_count);
+    for (uint32_t i = 0; i < node_count; ++i)
+      rank_to_node_[i] = i;
+    std::sort(rank_to_node_.begin(), rank_to_node_.end(),
+      [&degree](const uint32_t a, const uint32_t b)
+      { return degree[a] < degree[b] || (degree[a] == degree[b] && a < b); });
+    std::vector<uint32_t> rank(node_count);
+    for (uint32_t i = 0; i < node_count; ++i)
+      rank[rank_to_node_[i]] = i;
+
+    // Forward adjacency (indexed by rank): the neighbors of higher rank
+    offsets_.assign(node_count + 1, 0);
+    for (const auto & edge : edges)
+      ++offsets_[std::min(rank[edge.first], rank[edge.second]) + 1];
+    for (uint32_t i = 0; i < node_count; ++i)
+      offsets_[i + 1] += offsets_[i];
+    neighbors_.resize(edges.size());
+    std::vector<std::size_t> position(offsets_.cbegin(), offsets_.cend() - 1);
+    for (const auto & edge : edges)
+    {
+      const uint32_t r1 = rank[edge.first], r2 = rank[edge.second];
+      neighbors_[position[std::min(r1, r2)]++] = std::max(r1, r2);
+    }
+    for (uint32_t i = 0; i < node_count; ++i)
+      std::sort(neighbors_.begin() + offsets_[i], neighbors_.begin() + offsets_[i + 1]);
+  }
+
+  uint32_t NodeCount() const { return static_cast<uint32_t>(node_ids_.size()); }
+
+  /**
+  * @brief Visit the triangles whose lowest ranked node is u
+  * @param u Node rank
+  * @param functor Called for each triplet (i<j<k)
+  * @return the number of visited triplets
+  */
+  template <typename TripletFunctor>
+  std::size_t VisitTriangles( const uint32_t u, TripletFunctor && functor ) const
+  {
+    std::size_t triplet_count = 0;
+    const uint32_t * u_end = neighbors_.data() + offsets_[u + 1];
+    for (const uint32_t * v_it = neighbors_.data() + offsets_[u]; v_it != u_end; ++v_it)
+    {
+      const uint32_t v = *v_it;
+      const uint32_t * v_end = neighbors_.data() + offsets_[v + 1];
+      // Since u < v, the common neighbors are after v in the list of u
+      const uint32_t * it_u = v_it + 1;
+      const uint32_t * it_v = neighbors_.data() + offsets_[v];
+      while (it_u != u_end && it_v != v_end)
+      {
+        if (*it_u < *it_v)
+          ++it_u;
+        else if (*it_v < *it_u)
+          ++it_v;
+        else
+        {
+          std::array<IndexT, 3> triplet_indexes {{
+            node_ids_[rank_to_node_[u]],
+            node_ids_[rank_to_node_[v]],
+            node_ids_[rank_to_node_[*it_u]]}};
+          // sort the triplet indexes as i<j<k (monotonic ascending sorting)
+          std::sort(triplet_indexes.begin(), triplet_indexes.end());
+          functor(Triplet(triplet_indexes[0], triplet_indexes[1], triplet_indexes[2]));
+          ++triplet_count;
+          ++it_u;
+          ++it_v;
+        }
+      }
+    }
+    return triplet_count;
+  }
+
+private:
+  std::vector<IndexT> node_ids_; // contiguous index to node id
+  std::vector<uint32_t> rank_to_node_;
+  std::vector<std::size_t> offsets_; // CSR offsets (per rank)
+  std::vector<uint32_t> neighbors_; // CSR forward neighbors (ranks)
+};
+
+/// Store the triplets of each node at their final position in the vector
+/// (offsets: per node offset of its first triplet, the last one is the count)
+inline void StoreTriplets
+(
+  const Forward_Adjacency & adjacency,
+  const std::vector<std::size_t> & offsets,
+  std::vector<Triplet> & triplets
+)
+{
+  triplets.resize(offsets.back(), Triplet(0, 0, 0));
+  const int node_count = static_cast<int>(adjacency.NodeCount());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for (int u = 0; u < node_count; ++u)
+  {
+    std::size_t position = offsets[u];
+    adjacency.VisitTriangles(u, [&](const Triplet & triplet)
+      { triplets[position++] = triplet; });
+  }
+}
+
+/// Other containers: the triplets are stored in a vector, then added one by one
+template <class TTripletContainer>
+void StoreTriplets
+(
+  const Forward_Adjacency & adjacency,
+  const std::vector<std::size_t> & offsets,
+  TTripletContainer & triplets
+)
+{
+  std::vector<Triplet> all_triplets;
+  StoreTriplets(adjacency, offsets, all_triplets);
+  for (const Triplet & triplet : all_triplets)
+    triplets.emplace_back(triplet.i, triplet.j, triplet.k);
+}
+
+} // namespace internal
+
+/**
+* @brief Enumerate the triplets contained in the graph build from IterablePairs
+*  and stream them to a functor (the triplets are not stored).
+* The triangles are listed in parallel with the compact-forward algorithm over
+*  a degree ordered CSR adjacency.
+* @param[in] pairs A list of pairs
+* @param[in] functor Called for each triplet (i<j<k). It is called concurrently
+*  by the OpenMP threads and must be thread safe.
+* @return the number of triplets found in the graph
+**/
+template <typename IterablePairs, typename TripletFunctor>
+std::size_t ForEachTriplet
+(
+  const IterablePairs & pairs,
+  TripletFunctor && functor
+)
+{
+  const internal::Forward_Adjacency adjacency(pairs);
+  std::size_t triplet_count = 0;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64) reduction(+:triplet_count)
+#endif
+  for (int u = 0; u < static_cast<int>(adjacency.NodeCount()); ++u)
+  {
+    triplet_count += adjacency.VisitTriangles(u, functor);
+  }
+  return triplet_count;
+}
+
 /**
 * @brief Return triplets contained in the graph build from IterablePairs
 * @param[in] pairs A list of pairs
@@ -111,52 +310,24 @@ bool ListTriplets
 {
   triplets.clear();
 
-  // Build an adjacency list corresponding to the edge list
-  std::unordered_map<IndexT, std::set<IndexT>> adjacency_list;
-  for (const auto & edge : pairs)
-  {
-    adjacency_list[edge.first].insert(edge.second);
-    adjacency_list[edge.second].insert(edge.first);
-  }
+  const internal::Forward_Adjacency adjacency(pairs);
+  const int node_count = static_cast<int>(adjacency.NodeCount());
 
-  std::vector<IndexT> node_candidate_for_triplet;
-
-  // List the pair and find all triplets thanks to the adjacency list
-  for (const auto & edge_it : pairs)
+  // Count the triplets per node, then fill them at their final position
+  //  (the order does not depend on the threads scheduling)
+  std::vector<std::size_t> offsets(node_count + 1, 0);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for (int u = 0; u < node_count; ++u)
   {
-    // Find any targeting edge that contains the first and the second node index
-    const auto & node1_edges = adjacency_list.find(edge_it.first)->second;
-    const auto & node2_edges = adjacency_list.find(edge_it.second)->second;
-
-    // Compute the intersection between the two adjacency lists to find
-    //  triplets (it will list the nodes that are connected to the first and
-    //  second)
-    node_candidate_for_triplet.clear();
-    std::set_intersection(node1_edges.cbegin(),
-                          node1_edges.cend(),
-                          node2_edges.cbegin(),
-                          node2_edges.cend(),
-                          std::back_inserter(node_candidate_for_triplet));
-    // Add a triplet
-    for (const auto & node_index_it : node_candidate_for_triplet)
-    {
-      std::array<IndexT, 3> triplet_indexes {{
-        static_cast<IndexT>(edge_it.first),
-        static_cast<IndexT>(edge_it.second),
-        node_index_it}};
-      // sort the triplet indexes as i<j<k (monotonic ascending sorting)
-      std::sort(triplet_indexes.begin(), triplet_indexes.end());
-      triplets.emplace_back(triplet_indexes[0],
-                            triplet_indexes[1],
-                            triplet_indexes[2]);
-    }
-
-    // Since we have already listed all the triplets than contain this edge.
-    // We can now remove the edge from the adjacency graph to reduce the
-    // node array size for the next iterations.
-    adjacency_list[edge_it.first].erase(edge_it.second);
-    adjacency_list[edge_it.second].erase(edge_it.first);
+    offsets[u + 1] = adjacency.VisitTriangles(u, [](const Triplet &) {});
   }
+  for (int u = 0; u < node_count; ++u)
+    offsets[u + 1] += offsets[u];
+
+  // A std::vector output is filled in place (no intermediate copy)
+  internal::StoreTriplets(adjacency, offsets, triplets);
   return ( !triplets.empty() );
 }
 
@@ -11,7 +11,12 @@
 #include "CppUnitLite/TestHarness.h"
 #include "testing/testing.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <random>
+#include <set>
+#include <tuple>
 #include <vector>
 
 using namespace openMVG::graph;
@@ -187,6 +192,48 @@ TEST(TripletFinder, test_for_triplet) {
   }
 }
 
+TEST(TripletFinder, random_graph) {
+
+  // Compare the listed triplets to a brute force enumeration
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_int_distribution<int> node(0, 59);
+  std::set<std::pair<int,int>> edges;
+  Pairs pairs;
+  for (int i = 0; i < 600; ++i)
+  {
+    const int a = node(random_generator), b = node(random_generator);
+    pairs.emplace_back(a, b); // duplicates, reversed edges and self loops
+    if (a != b)
+      edges.emplace(std::min(a, b), std::max(a, b));
+  }
+
+  std::vector<Triplet> brute_force_triplets;
+  for (int i = 0; i < 60; ++i)
+    for (int j = i + 1; j < 60; ++j)
+      for (int k = j + 1; k < 60; ++k)
+        if (edges.count({i, j}) && edges.count({i, k}) && edges.count({j, k}))
+          brute_force_triplets.emplace_back(i, j, k);
+
+  std::vector<Triplet> vec_triplets;
+  EXPECT_TRUE(ListTriplets(pairs, vec_triplets));
+  EXPECT_EQ(brute_force_triplets.size(), vec_triplets.size());
+  std::sort(vec_triplets.begin(), vec_triplets.end(),
+    [](const Triplet & a, const Triplet & b)
+    { return std::tie(a.i, a.j, a.k) < std::tie(b.i, b.j, b.k); });
+  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  {
+    EXPECT_EQ(brute_force_triplets[i].i, vec_triplets[i].i);
+    EXPECT_EQ(brute_force_triplets[i].j, vec_triplets[i].j);
+    EXPECT_EQ(brute_force_triplets[i].k, vec_triplets[i].k);
+  }
+
+  // Streamed enumeration
+  std::atomic<size_t> streamed_count(0);
+  EXPECT_EQ(brute_force_triplets.size(),
+    ForEachTriplet(pairs, [&](const Triplet &) { ++streamed_count; }));
+  EXPECT_EQ(brute_force_triplets.size(), streamed_count);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -8,7 +8,10 @@
 
 #include "openMVG/image/image_io.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <string>
 
 extern "C" {
@@ -635,6 +638,16 @@ bool ReadImageHeader(const char * filename, ImageHeader * imgheader)
 {
   const Format f = GetFormat(filename);
 
+  // Fast path: parse the header bytes, without going through the image libraries
+  ImageMetadata metadata;
+  if (imgheader && f != Unknown
+      && ReadImageMetadata(filename, &metadata) && metadata.format == f)
+  {
+    imgheader->width = metadata.width;
+    imgheader->height = metadata.height;
+    return true;
+  }
+
   switch (f) {
     case Pnm:
       return Read_PNM_ImageHeader(filename, imgheader);
@@ -734,12 +747,11 @@ bool Read_JPG_ImageHeader(const char * filename, ImageHeader * imgheader)
   jpeg_create_decompress(&cinfo);
   jpeg_stdio_src(&cinfo, file);
   jpeg_read_header(&cinfo, TRUE);
-  jpeg_start_decompress(&cinfo);
 
   if (imgheader)
   {
-    imgheader->width = cinfo.output_width;
-    imgheader->height = cinfo.output_height;
+    imgheader->width = cinfo.image_width;
+    imgheader->height = cinfo.image_height;
     bStatus = true;
   }
 
@@ -864,5 +876,330 @@ bool Read_TIFF_ImageHeader(const char * filename, ImageHeader * imgheader)
   return bStatus;
 }
 
+
+namespace {
+
+// Bounded reader of an image file header.
+// The first bytes of the file are read at once, the structures stored further
+// (i.e. large APP segments or a TIFF directory written after the pixel data)
+// are read on demand.
+class Header_Reader
+{
+public:
+  explicit Header_Reader(FILE * file)
+    : file_(file), prefix_(65536)
+  {
+    prefix_.resize(fread(prefix_.data(), 1, prefix_.size(), file_));
+  }
+
+  // Reader over an in memory buffer (i.e. an EXIF segment)
+  Header_Reader(const unsigned char * data, size_t size)
+    : file_(nullptr), prefix_(data, data + size)
+  {
+  }
+
+  // Copy size bytes found at the offset position
+  bool Read(size_t offset, size_t size, unsigned char * data) const
+  {
+    if (offset <= prefix_.size() && size <= prefix_.size() - offset)
+    {
+      std::copy(prefix_.cbegin() + offset, prefix_.cbegin() + offset + size, data);
+      return true;
+    }
+    return file_
+      && fseek(file_, static_cast<long>(offset), SEEK_SET) == 0
+      && fread(data, 1, size, file_) == size;
+  }
+
+  bool Read(size_t offset, size_t size, std::vector<unsigned char> & data) const
+  {
+    data.resize(size);
+    return size == 0 || Read(offset, size, data.data());
+  }
+
+  const std::vector<unsigned char> & Prefix() const { return prefix_; }
+
+private:
+  FILE * file_;
+  std::vector<unsigned char> prefix_;
+};
+
+inline uint16_t ReadUint16(const unsigned char * p, bool big_endian)
+{
+  return big_endian ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0];
+}
+
+inline uint32_t ReadUint32(const unsigned char * p, bool big_endian)
+{
+  return big_endian ?
+    (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3] :
+    (uint32_t(p[3]) << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+// Tags of the first image file directory of a TIFF structure
+struct Tiff_IFD0
+{
+  int width = 0;
+  int height = 0;
+  int samples_per_pixel = 1;
+  int orientation = 1;
+};
+
+bool ReadTiffIFD0(const Header_Reader & reader, Tiff_IFD0 * ifd0)
+{
+  unsigned char header[8];
+  if (!reader.Read(0, 8, header))
+    return false;
+  bool big_endian;
+  if (header[0] == 'I' && header[1] == 'I')
+    big_endian = false;
+  else if (header[0] == 'M' && header[1] == 'M')
+    big_endian = true;
+  else
+    return false;
+  if (ReadUint16(header + 2, big_endian) != 42)
+    return false;
+
+  const uint32_t ifd_offset = ReadUint32(header + 4, big_endian);
+  unsigned char count[2];
+  std::vector<unsigned char> entries;
+  if (!reader.Read(ifd_offset, 2, count)
+      || !reader.Read(size_t(ifd_offset) + 2, 12 * size_t(ReadUint16(count, big_endian)), entries))
+    return false;
+
+  for (size_t i = 0; i < entries.size(); i += 12)
+  {
+    const unsigned char * entry = &entries[i];
+    // The tags of interest are single SHORT or LONG values stored in the entry
+    uint32_t value;
+    switch (ReadUint16(entry + 2, big_endian))
+    {
+      case 3: value = ReadUint16(entry + 8, big_endian); break;
+      case 4: value = ReadUint32(entry + 8, big_endian); break;
+      default: continue;
+    }
+    switch (ReadUint16(entry, big_endian))
+    {
+      case 256: ifd0->width = value; break;
+      case 257: ifd0->height = value; break;
+      case 274: ifd0->orientation = value; break;
+      case 277: ifd0->samples_per_pixel = value; break;
+    }
+  }
+  return true;
+}
+
+bool ReadJpgMetadata(const Header_Reader & reader, ImageMetadata * metadata)
+{
+  size_t offset = 2; // Skip the SOI marker
+  unsigned char marker[4];
+  while (reader.Read(offset, 2, marker) && marker[0] == 0xFF)
+  {
+    // Skip the fill bytes
+    while (marker[1] == 0xFF)
+    {
+      if (!reader.Read(++offset + 1, 1, &marker[1]))
+        return false;
+    }
+    offset += 2;
+    // Standalone markers (no segment length)
+    if (marker[1] == 0x01 || (marker[1] >= 0xD0 && marker[1] <= 0xD7))
+      continue;
+    // Start of scan or end of image: there is no frame header
+    if (marker[1] == 0xDA || marker[1] == 0xD9)
+      return false;
+    if (!reader.Read(offset, 2, &marker[2]))
+      return false;
+    const size_t segment_length = (marker[2] << 8) | marker[3];
+    if (segment_length < 2)
+      return false;
+
+    if (marker[1] == 0xE1 && metadata->exif.empty())
+    {
+      // Keep the first APP1 segment that is an EXIF segment (not XMP)
+      std::vector<unsigned char> segment;
+      if (!reader.Read(offset + 2, segment_length - 2, segment))
+        return false;
+      if (segment.size() >= 6 && std::equal(segment.cbegin(), segment.cbegin() + 6, "Exif\0\0"))
+        metadata->exif.swap(segment);
+    }
+    // Start of frame markers (0xC4, 0xC8 and 0xCC are not frame headers)
+    else if (marker[1] >= 0xC0 && marker[1] <= 0xCF
+             && marker[1] != 0xC4 && marker[1] != 0xC8 && marker[1] != 0xCC)
+    {
+      // precision (1), height (2), width (2), number of components (1)
+      unsigned char frame[6];
+      if (segment_length < 8 || !reader.Read(offset + 2, 6, frame))
+        return false;
+      metadata->height = (frame[1] << 8) | frame[2];
+      metadata->width = (frame[3] << 8) | frame[4];
+      metadata->depth = frame[5];
+      return true;
+    }
+    offset += segment_length;
+  }
+  return false;
+}
+
+bool ReadPngMetadata(const Header_Reader & reader, ImageMetadata * metadata)
+{
+  size_t offset = 8; // Skip the PNG signature
+  int color_type = -1;
+  bool b_transparency = false;
+  unsigned char chunk[8];
+  while (reader.Read(offset, 8, chunk))
+  {
+    const size_t chunk_length = ReadUint32(chunk, true);
+    if (memcmp(chunk + 4, "IHDR", 4) == 0)
+    {
+      // width (4), height (4), bit depth (1), color type (1)
+      unsigned char header[10];
+      if (chunk_length < 13 || !reader.Read(offset + 8, 10, header))
+        return false;
+      metadata->width = ReadUint32(header, true);
+      metadata->height = ReadUint32(header + 4, true);
+      color_type = header[9];
+    }
+    else if (color_type == -1) // IHDR must be the first chunk
+      return false;
+    else if (memcmp(chunk + 4, "tRNS", 4) == 0)
+      b_transparency = true;
+    else if (memcmp(chunk + 4, "eXIf", 4) == 0 && metadata->exif.empty())
+    {
+      // The chunk stores the TIFF structure only.
+      // Its length is not trusted: it is bounded like a JPEG APP1 segment.
+      std::vector<unsigned char> segment;
+      if (chunk_length > 65535 || !reader.Read(offset + 8, chunk_length, segment))
+        return false;
+      metadata->exif.assign("Exif\0\0", "Exif\0\0" + 6);
+      metadata->exif.insert(metadata->exif.end(), segment.cbegin(), segment.cend());
+    }
+    else if (memcmp(chunk + 4, "IDAT", 4) == 0)
+    {
+      // The image data is expanded to 8 bit gray, gray alpha, RGB or RGBA pixels
+      switch (color_type)
+      {
+        case 0: metadata->depth = b_transparency ? 2 : 1; break; // Gray
+        case 2: // RGB
+        case 3: metadata->depth = b_transparency ? 4 : 3; break; // Palette
+        case 4: metadata->depth = 2; break; // Gray alpha
+        case 6: metadata->depth = 4; break; // RGBA
+        default: return false;
+      }
+      return true;
+    }
+    offset += 12 + chunk_length; // length, type, data and CRC
+  }
+  return false;
+}
+
+bool ReadPnmMetadata(const Header_Reader & reader, ImageMetadata * metadata)
+{
+  // Parse the width, height and maxValue tokens of the header,
+  // discarding all comments (everything from '#' to '\n' inclusive), where
+  // comments *may occur inside tokens*. Each token must be terminated with a
+  // whitespace character.
+  const std::vector<unsigned char> & header = reader.Prefix();
+  int values[3], valuesIndex = 0;
+  std::string token;
+  for (size_t i = 2; valuesIndex < 3 && i < header.size(); ++i) // Skip the magic number
+  {
+    const unsigned char nextChar = header[i];
+    if (isspace(nextChar))
+    {
+      if (!token.empty()) // this white space delimits a token
+      {
+        values[valuesIndex++] = atoi(token.c_str());
+        token.clear();
+      }
+    }
+    else if (isdigit(nextChar))
+    {
+      token += nextChar;
+      if (token.size() > 10) // tokens should never be this long
+        return false;
+    }
+    else if (nextChar == '#')
+    {
+      while (i < header.size() && header[i] != '\n')
+        ++i;
+    }
+    else
+    {
+      // Encountered a non-whitespace, non-digit outside a comment - bail out.
+      return false;
+    }
+  }
+  // to conform with current image class
+  if (valuesIndex != 3 || values[2] > 255)
+    return false;
+  metadata->width = values[0];
+  metadata->height = values[1];
+  metadata->depth = (header[1] == '5') ? 1 : 3;
+  return true;
+}
+
+} // namespace
+
+bool ReadImageMetadata(const char * filename, ImageMetadata * metadata)
+{
+  if (!metadata)
+    return false;
+  *metadata = ImageMetadata();
+  metadata->width = metadata->height = 0;
+
+  FILE *file = fopen(filename, "rb");
+  if (!file)
+    return false;
+
+  bool bStatus = false;
+  {
+    const Header_Reader reader(file);
+    const std::vector<unsigned char> & prefix = reader.Prefix();
+    static const unsigned char png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (prefix.size() >= 3 && prefix[0] == 0xFF && prefix[1] == 0xD8 && prefix[2] == 0xFF)
+    {
+      metadata->format = Jpg;
+      bStatus = ReadJpgMetadata(reader, metadata);
+    }
+    else if (prefix.size() >= 8 && std::equal(prefix.cbegin(), prefix.cbegin() + 8, png_signature))
+    {
+      metadata->format = Png;
+      bStatus = ReadPngMetadata(reader, metadata);
+    }
+    else if (prefix.size() >= 2 && prefix[0] == 'P' && (prefix[1] == '5' || prefix[1] == '6'))
+    {
+      metadata->format = Pnm;
+      bStatus = ReadPnmMetadata(reader, metadata);
+    }
+    else
+    {
+      Tiff_IFD0 ifd0;
+      if (ReadTiffIFD0(reader, &ifd0))
+      {
+        metadata->format = Tiff;
+        metadata->width = ifd0.width;
+        metadata->height = ifd0.height;
+        metadata->depth = ifd0.samples_per_pixel;
+        metadata->orientation = ifd0.orientation;
+        bStatus = true;
+      }
+    }
+  }
+  fclose(file);
+
+  // Orientation of the JPEG and PNG images
+  Tiff_IFD0 exif_ifd0;
+  if (bStatus && metadata->exif.size() > 6
+      && ReadTiffIFD0(Header_Reader(metadata->exif.data() + 6, metadata->exif.size() - 6), &exif_ifd0))
+  {
+    metadata->orientation = exif_ifd0.orientation;
+  }
+  if (metadata->orientation < 1 || metadata->orientation > 8)
+    metadata->orientation = 1;
+
+  return bStatus && metadata->width > 0 && metadata->height > 0;
+}
+
 }  // namespace image
 }  // namespace openMVG
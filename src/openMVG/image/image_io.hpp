@@ -319,6 +319,39 @@ struct ImageHeader
 */
 bool ReadImageHeader( const char * path , ImageHeader * hdr );
 
+/**
+* @brief  structure used to know the image properties stored in the file header
+* @note: width and height are the stored dimensions (the EXIF orientation is not applied)
+*/
+struct ImageMetadata : public ImageHeader
+{
+  /// Image format (detected from the file signature)
+  Format format = Unknown;
+
+  /// Number of channels of the decoded image (1: gray, 2: gray + alpha, 3: rgb, 4: rgba)
+  int depth = 0;
+
+  /// EXIF orientation [1, 8] (1 if unknown)
+  int orientation = 1;
+
+  /// Raw EXIF segment (starting with "Exif\0\0"), empty if the file has no EXIF data
+  std::vector<unsigned char> exif;
+};
+
+/**
+* @brief Read the image properties and the EXIF data from the file header
+* @note Only the header bytes are read (the pixel data is never decoded):
+*  - JPEG: segments up to the frame header (SOF),
+*  - PNG: chunks up to the first image data chunk (IDAT),
+*  - TIFF: first image file directory (IFD0),
+*  - PNM: the text header.
+* @param path Input image file path
+* @param[out] metadata Output metadata
+* @retval true If the header is correctly read
+* @retval false If the file cannot be opened or its header is not recognized
+*/
+bool ReadImageMetadata( const char * path , ImageMetadata * metadata );
+
 /**
 * @brief Read PNG image header from a file
 * @param path Input image file path
@@ -0,0 +1,729 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/image/image_io_strip.hpp"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <future>
+#include <vector>
+
+extern "C" {
+  #include "png.h"
+  #include "tiffio.h"
+  #include "jpeglib.h"
+}
+
+#include "openMVG/system/logger.hpp"
+
+namespace openMVG {
+namespace image {
+
+namespace {
+
+//--
+// Row decoders
+//--
+
+struct Row_Decoder
+{
+  virtual ~Row_Decoder() = default;
+  virtual bool ReadRow( int row_index, unsigned char * row ) = 0;
+  int width = 0;
+  int height = 0;
+  int depth = 0;
+};
+
+struct Jpeg_Error_Manager
+{
+  struct jpeg_error_mgr pub;
+  jmp_buf setjmp_buffer;
+};
+
+METHODDEF(void)
+jpeg_strip_error (j_common_ptr cinfo)
+{
+  Jpeg_Error_Manager *myerr = (Jpeg_Error_Manager*) (cinfo->err);
+  (*cinfo->err->output_message) (cinfo);
+  longjmp(myerr->setjmp_buffer, 1);
+}
+
+class Jpeg_Row_Decoder : public Row_Decoder
+{
+public:
+  ~Jpeg_Row_Decoder() override
+  {
+    if (created_)
+      jpeg_destroy_decompress(&cinfo_);
+    if (file_)
+      fclose(file_);
+  }
+
+  bool Open( const char * filename )
+  {
+    file_ = fopen(filename, "rb");
+    if (!file_)
+      return false;
+
+    cinfo_.err = jpeg_std_error(&jerr_.pub);
+    jerr_.pub.error_exit = &jpeg_strip_error;
+    if (setjmp(jerr_.setjmp_buffer)) {
+      OPENMVG_LOG_ERROR << "Error JPG: Failed to decompress.";
+      return false;
+    }
+    jpeg_create_decompress(&cinfo_);
+    created_ = true;
+    jpeg_stdio_src(&cinfo_, file_);
+    jpeg_read_header(&cinfo_, TRUE);
+    jpeg_start_decompress(&cinfo_);
+
+    width = cinfo_.output_width;
+    height = cinfo_.output_height;
+    depth = cinfo_.output_components;
+    return true;
+  }
+
+  bool ReadRow( int, unsigned char * row ) override
+  {
+    if (setjmp(jerr_.setjmp_buffer)) {
+      OPENMVG_LOG_ERROR << "Error JPG: Failed to decompress.";
+      return false;
+    }
+    JSAMPROW scanline[1] = { row };
+    return jpeg_read_scanlines(&cinfo_, scanline, 1) == 1;
+  }
+
+private:
+  FILE * file_ = nullptr;
+  bool created_ = false;
+  jpeg_decompress_struct cinfo_;
+  Jpeg_Error_Manager jerr_;
+};
+
+class Png_Row_Decoder : public Row_Decoder
+{
+public:
+  ~Png_Row_Decoder() override
+  {
+    if (png_ptr_)
+      png_destroy_read_struct(&png_ptr_, info_ptr_ ? &info_ptr_ : nullptr, nullptr);
+    if (file_)
+      fclose(file_);
+  }
+
+  bool Open( const char * filename )
+  {
+    file_ = fopen(filename, "rb");
+    if (!file_)
+      return false;
+
+    // first check the eight byte PNG signature
+    png_byte pbSig[8];
+    if (fread(pbSig, 1, 8, file_) != 8 || png_sig_cmp(pbSig, 0, 8))
+      return false;
+
+    png_ptr_ = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (!png_ptr_)
+      return false;
+    info_ptr_ = png_create_info_struct(png_ptr_);
+    if (!info_ptr_)
+      return false;
+    if (setjmp(png_jmpbuf(png_ptr_)))
+      return false;
+
+    png_init_io(png_ptr_, file_);
+    png_set_sig_bytes(png_ptr_, 8);
+    png_read_info(png_ptr_, info_ptr_);
+
+    png_uint_32 wPNG, hPNG;
+    int iBitDepth, iColorType, iInterlaceType;
+    png_get_IHDR(png_ptr_, info_ptr_, &wPNG, &hPNG, &iBitDepth,
+      &iColorType, &iInterlaceType, nullptr, nullptr);
+    // The passes of an interlaced image cannot be read by rows
+    if (iInterlaceType != PNG_INTERLACE_NONE)
+      return false;
+
+    // expand images of all color-type to 8-bit (same as ReadPngStream)
+    if (iColorType == PNG_COLOR_TYPE_PALETTE)
+      png_set_expand(png_ptr_);
+    if (iBitDepth < 8)
+      png_set_expand(png_ptr_);
+    if (png_get_valid(png_ptr_, info_ptr_, PNG_INFO_tRNS))
+      png_set_expand(png_ptr_);
+    if (iBitDepth == 16)
+      png_set_strip_16(png_ptr_);
+    double dGamma;
+    if (png_get_gAMA(png_ptr_, info_ptr_, &dGamma))
+      png_set_gamma(png_ptr_, (double) 2.2, dGamma);
+    png_read_update_info(png_ptr_, info_ptr_);
+
+    width = wPNG;
+    height = hPNG;
+    depth = png_get_channels(png_ptr_, info_ptr_);
+    return png_get_rowbytes(png_ptr_, info_ptr_) == static_cast<size_t>(width * depth);
+  }
+
+  bool ReadRow( int, unsigned char * row ) override
+  {
+    if (setjmp(png_jmpbuf(png_ptr_)))
+      return false;
+    png_read_row(png_ptr_, row, nullptr);
+    return true;
+  }
+
+private:
+  FILE * file_ = nullptr;
+  png_structp png_ptr_ = nullptr;
+  png_infop info_ptr_ = nullptr;
+};
+
+class Tiff_Row_Decoder : public Row_Decoder
+{
+public:
+  ~Tiff_Row_Decoder() override
+  {
+    if (tiff_)
+      TIFFClose(tiff_);
+  }
+
+  bool Open( const char * filename )
+  {
+    tiff_ = TIFFOpen(filename, "r");
+    if (!tiff_)
+      return false;
+
+    uint32 w = 0, h = 0;
+    uint16 bps = 0, spp = 0, planar = PLANARCONFIG_CONTIG, photometric = 0,
+      orientation = ORIENTATION_TOPLEFT;
+    TIFFGetField(tiff_, TIFFTAG_IMAGEWIDTH, &w);
+    TIFFGetField(tiff_, TIFFTAG_IMAGELENGTH, &h);
+    TIFFGetField(tiff_, TIFFTAG_BITSPERSAMPLE, &bps);
+    TIFFGetField(tiff_, TIFFTAG_SAMPLESPERPIXEL, &spp);
+    TIFFGetField(tiff_, TIFFTAG_PLANARCONFIG, &planar);
+    TIFFGetField(tiff_, TIFFTAG_PHOTOMETRIC, &photometric);
+    TIFFGetField(tiff_, TIFFTAG_ORIENTATION, &orientation);
+
+    // Only the images whose scanlines are the pixels are read by rows
+    // (the other layouts are handled by ReadImage)
+    if (TIFFIsTiled(tiff_) || bps != 8 || planar != PLANARCONFIG_CONTIG ||
+        orientation != ORIENTATION_TOPLEFT)
+      return false;
+    if (!((spp == 1 && photometric == PHOTOMETRIC_MINISBLACK) ||
+          ((spp == 3 || spp == 4) && photometric == PHOTOMETRIC_RGB)))
+      return false;
+
+    width = w;
+    height = h;
+    depth = spp;
+    return TIFFScanlineSize(tiff_) == static_cast<tsize_t>(width * depth);
+  }
+
+  bool ReadRow( int row_index, unsigned char * row ) override
+  {
+    return TIFFReadScanline(tiff_, row, row_index) >= 0;
+  }
+
+private:
+  TIFF * tiff_ = nullptr;
+};
+
+//--
+// Row encoders
+//--
+
+struct Row_Encoder
+{
+  virtual ~Row_Encoder() = default;
+  virtual bool WriteRow( int row_index, const unsigned char * row ) = 0;
+  virtual bool Finish() = 0;
+};
+
+class Jpeg_Row_Encoder : public Row_Encoder
+{
+public:
+  ~Jpeg_Row_Encoder() override
+  {
+    if (created_)
+      jpeg_destroy_compress(&cinfo_);
+    if (file_)
+      fclose(file_);
+  }
+
+  bool Open( const char * filename, int w, int h, int depth, int quality )
+  {
+    if (quality < 0 || quality > 100)
+      OPENMVG_LOG_ERROR << "The quality parameter should be between 0 and 100";
+    if (depth != 1 && depth != 3) {
+      OPENMVG_LOG_ERROR << "Unsupported number of channels in file";
+      return false;
+    }
+    file_ = fopen(filename, "wb");
+    if (!file_) {
+      OPENMVG_LOG_ERROR << "Couldn't open " << filename << " fopen returned 0";
+      return false;
+    }
+
+    cinfo_.err = jpeg_std_error(&jerr_.pub);
+    jerr_.pub.error_exit = &jpeg_strip_error;
+    if (setjmp(jerr_.setjmp_buffer))
+      return false;
+    jpeg_create_compress(&cinfo_);
+    created_ = true;
+    jpeg_stdio_dest(&cinfo_, file_);
+
+    cinfo_.image_width = w;
+    cinfo_.image_height = h;
+    cinfo_.input_components = depth;
+    cinfo_.in_color_space = (depth == 3) ? JCS_RGB : JCS_GRAYSCALE;
+    jpeg_set_defaults(&cinfo_);
+    jpeg_set_quality(&cinfo_, quality, TRUE);
+    jpeg_start_compress(&cinfo_, TRUE);
+    return true;
+  }
+
+  bool WriteRow( int, const unsigned char * row ) override
+  {
+    if (setjmp(jerr_.setjmp_buffer))
+      return false;
+    JSAMPROW scanline[1] = { const_cast<JSAMPLE*>(row) };
+    return jpeg_write_scanlines(&cinfo_, scanline, 1) == 1;
+  }
+
+  bool Finish() override
+  {
+    if (setjmp(jerr_.setjmp_buffer))
+      return false;
+    jpeg_finish_compress(&cinfo_);
+    return fflush(file_) == 0;
+  }
+
+private:
+  FILE * file_ = nullptr;
+  bool created_ = false;
+  jpeg_compress_struct cinfo_;
+  Jpeg_Error_Manager jerr_;
+};
+
+class Png_Row_Encoder : public Row_Encoder
+{
+public:
+  ~Png_Row_Encoder() override
+  {
+    if (png_ptr_)
+      png_destroy_write_struct(&png_ptr_, info_ptr_ ? &info_ptr_ : nullptr);
+    if (file_)
+      fclose(file_);
+  }
+
+  bool Open( const char * filename, int w, int h, int depth )
+  {
+    // color types are defined at png.h:841+.
+    int colour;
+    switch (depth)
+    {
+      case 4: colour = PNG_COLOR_TYPE_RGBA;
+        break;
+      case 3: colour = PNG_COLOR_TYPE_RGB;
+        break;
+      case 1: colour = PNG_COLOR_TYPE_GRAY;
+        break;
+      default:
+        return false;
+    }
+    file_ = fopen(filename, "wb");
+    if (!file_) {
+      OPENMVG_LOG_ERROR << "Couldn't open " << filename << " fopen returned 0";
+      return false;
+    }
+    png_ptr_ = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (!png_ptr_)
+      return false;
+    info_ptr_ = png_create_info_struct(png_ptr_);
+    if (!info_ptr_)
+      return false;
+    if (setjmp(png_jmpbuf(png_ptr_)))
+      return false;
+
+    png_init_io(png_ptr_, file_);
+    png_set_IHDR(png_ptr_, info_ptr_, w, h,
+        8, colour, PNG_INTERLACE_NONE,
+        PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png_ptr_, info_ptr_);
+    return true;
+  }
+
+  bool WriteRow( int, const unsigned char * row ) override
+  {
+    if (setjmp(png_jmpbuf(png_ptr_)))
+      return false;
+    png_write_row(png_ptr_, const_cast<png_bytep>(row));
+    return true;
+  }
+
+  bool Finish() override
+  {
+    if (setjmp(png_jmpbuf(png_ptr_)))
+      return false;
+    png_write_end(png_ptr_, nullptr);
+    return fflush(file_) == 0;
+  }
+
+private:
+  FILE * file_ = nullptr;
+  png_structp png_ptr_ = nullptr;
+  png_infop info_ptr_ = nullptr;
+};
+
+class Tiff_Row_Encoder : public Row_Encoder
+{
+public:
+  ~Tiff_Row_Encoder() override
+  {
+    if (tiff_)
+      TIFFClose(tiff_);
+  }
+
+  bool Open( const char * filename, int w, int h, int depth )
+  {
+    tiff_ = TIFFOpen(filename, "w");
+    if (!tiff_) {
+      OPENMVG_LOG_ERROR << "Couldn't open " << filename << " fopen returned 0";
+      return false;
+    }
+    TIFFSetField(tiff_, TIFFTAG_IMAGEWIDTH, w);
+    TIFFSetField(tiff_, TIFFTAG_IMAGELENGTH, h);
+    TIFFSetField(tiff_, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tiff_, TIFFTAG_PHOTOMETRIC,
+      depth == 1 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB);
+    TIFFSetField(tiff_, TIFFTAG_BITSPERSAMPLE, 8);
+    TIFFSetField(tiff_, TIFFTAG_SAMPLESPERPIXEL, depth);
+    TIFFSetField(tiff_, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+    TIFFSetField(tiff_, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
+    TIFFSetField(tiff_, TIFFTAG_ROWSPERSTRIP, 16);
+    return true;
+  }
+
+  bool WriteRow( int row_index, const unsigned char * row ) override
+  {
+    return TIFFWriteScanline(tiff_, const_cast<unsigned char*>(row), row_index) >= 0;
+  }
+
+  bool Finish() override
+  {
+    const bool bOk = TIFFFlush(tiff_) == 1;
+    TIFFClose(tiff_);
+    tiff_ = nullptr;
+    return bOk;
+  }
+
+private:
+  TIFF * tiff_ = nullptr;
+};
+
+} // namespace
+
+//--
+// Image_Strip_Reader
+//--
+
+struct Image_Strip_Reader::Impl
+{
+  std::unique_ptr<Row_Decoder> decoder;
+  int next_row = 0;
+};
+
+Image_Strip_Reader::Image_Strip_Reader() = default;
+
+Image_Strip_Reader::~Image_Strip_Reader() = default;
+
+bool Image_Strip_Reader::Open( const char * path )
+{
+  Close();
+  std::unique_ptr<Row_Decoder> decoder;
+  switch (GetFormat(path))
+  {
+    case Jpg:
+    {
+      std::unique_ptr<Jpeg_Row_Decoder> jpeg_decoder(new Jpeg_Row_Decoder);
+      if (jpeg_decoder->Open(path))
+        decoder = std::move(jpeg_decoder);
+    }
+    break;
+    case Png:
+    {
+      std::unique_ptr<Png_Row_Decoder> png_decoder(new Png_Row_Decoder);
+      if (png_decoder->Open(path))
+        decoder = std::move(png_decoder);
+    }
+    break;
+    case Tiff:
+    {
+      std::unique_ptr<Tiff_Row_Decoder> tiff_decoder(new Tiff_Row_Decoder);
+      if (tiff_decoder->Open(path))
+        decoder = std::move(tiff_decoder);
+    }
+    break;
+    default:
+    break;
+  }
+  if (!decoder)
+    return false;
+  impl_.reset(new Impl);
+  impl_->decoder = std::move(decoder);
+  return true;
+}
+
+void Image_Strip_Reader::Close()
+{
+  impl_.reset();
+}
+
+bool Image_Strip_Reader::IsOpen() const { return impl_ != nullptr; }
+
+int Image_Strip_Reader::Width() const { return impl_ ? impl_->decoder->width : 0; }
+
+int Image_Strip_Reader::Height() const { return impl_ ? impl_->decoder->height : 0; }
+
+int Image_Strip_Reader::Depth() const { return impl_ ? impl_->decoder->depth : 0; }
+
+int Image_Strip_Reader::NextRow() const { return impl_ ? impl_->next_row : 0; }
+
+bool Image_Strip_Reader::ReadRows( int nb_rows, unsigned char * data )
+{
+  if (!impl_ || nb_rows < 0 || impl_->next_row + nb_rows > Height())
+    return false;
+  const size_t row_bytes = static_cast<size_t>(Width()) * Depth();
+  for (int i = 0; i < nb_rows; ++i, ++impl_->next_row)
+  {
+    if (!impl_->decoder->ReadRow(impl_->next_row, data + i * row_bytes))
+      return false;
+  }
+  return true;
+}
+
+//--
+// Image_Strip_Writer
+//--
+
+struct Image_Strip_Writer::Impl
+{
+  std::unique_ptr<Row_Encoder> encoder;
+  int width = 0;
+  int height = 0;
+  int depth = 0;
+  int next_row = 0;
+};
+
+Image_Strip_Writer::Image_Strip_Writer() = default;
+
+Image_Strip_Writer::~Image_Strip_Writer() = default;
+
+bool Image_Strip_Writer::Open( const char * path, int w, int h, int depth, int quality )
+{
+  impl_.reset();
+  std::unique_ptr<Row_Encoder> encoder;
+  switch (GetFormat(path))
+  {
+    case Jpg:
+    {
+      std::unique_ptr<Jpeg_Row_Encoder> jpeg_encoder(new Jpeg_Row_Encoder);
+      if (jpeg_encoder->Open(path, w, h, depth, quality))
+        encoder = std::move(jpeg_encoder);
+    }
+    break;
+    case Png:
+    {
+      std::unique_ptr<Png_Row_Encoder> png_encoder(new Png_Row_Encoder);
+      if (png_encoder->Open(path, w, h, depth))
+        encoder = std::move(png_encoder);
+    }
+    break;
+    case Tiff:
+    {
+      std::unique_ptr<Tiff_Row_Encoder> tiff_encoder(new Tiff_Row_Encoder);
+      if (tiff_encoder->Open(path, w, h, depth))
+        encoder = std::move(tiff_encoder);
+    }
+    break;
+    default:
+      OPENMVG_LOG_ERROR << "Unsupported image format for row writing: " << path;
+    break;
+  }
+  if (!encoder)
+    return false;
+  impl_.reset(new Impl);
+  impl_->encoder = std::move(encoder);
+  impl_->width = w;
+  impl_->height = h;
+  impl_->depth = depth;
+  return true;
+}
+
+bool Image_Strip_Writer::WriteRows( int nb_rows, const unsigned char * data )
+{
+  if (!impl_ || nb_rows < 0 || impl_->next_row + nb_rows > impl_->height)
+    return false;
+  const size_t row_bytes = static_cast<size_t>(impl_->width) * impl_->depth;
+  for (int i = 0; i < nb_rows; ++i, ++impl_->next_row)
+  {
+    if (!impl_->encoder->WriteRow(impl_->next_row, data + i * row_bytes))
+      return false;
+  }
+  return true;
+}
+
+bool Image_Strip_Writer::Close()
+{
+  if (!impl_)
+    return false;
+  const bool bOk = impl_->next_row == impl_->height && impl_->encoder->Finish();
+  impl_.reset();
+  return bOk;
+}
+
+bool Image_Strip_Writer::IsOpen() const { return impl_ != nullptr; }
+
+int Image_Strip_Writer::NextRow() const { return impl_ ? impl_->next_row : 0; }
+
+//--
+// Remap by strips
+//--
+
+template <typename T>
+bool RemapImageFile
+(
+  Image_Strip_Reader & reader,
+  Image_Strip_Writer & writer,
+  const Remap_Map & map,
+  const ERemap_Interpolation interpolation,
+  const int strip_height
+)
+{
+  const int nb_strips = (map.Height() + strip_height - 1) / strip_height;
+
+  // Source rows used by each strip
+  std::vector<int> source_begin(nb_strips), source_end(nb_strips);
+  std::vector<bool> has_source(nb_strips);
+  for (int i = 0; i < nb_strips; ++i)
+  {
+    const int first_row = i * strip_height;
+    has_source[i] = RemapSourceRows(map, first_row,
+      std::min(strip_height, map.Height() - first_row), interpolation,
+      source_begin[i], source_end[i]);
+  }
+  // First source row used by a strip or by the next ones
+  // (the rows before it can be released)
+  std::vector<int> first_used_row(nb_strips + 1, map.SourceHeight());
+  for (int i = nb_strips - 1; i >= 0; --i)
+  {
+    first_used_row[i] = has_source[i] ?
+      std::min(first_used_row[i + 1], source_begin[i]) : first_used_row[i + 1];
+  }
+
+  // Band of decoded source rows [band_first_row, reader.NextRow())
+  Image<T> band(map.SourceWidth(), 0), next_band;
+  int band_first_row = 0;
+  std::vector<T> discarded_row(map.SourceWidth());
+
+  // The previous strip is encoded while the current one is decoded & resampled
+  Image<T> strips[2];
+  std::future<bool> pending_write;
+  bool bOk = true;
+
+  for (int i = 0; i < nb_strips && bOk; ++i)
+  {
+    const int first_row = i * strip_height;
+    const int nb_rows = std::min(strip_height, map.Height() - first_row);
+
+    // Update the band of source rows
+    const int band_end = reader.NextRow();
+    const int new_band_end = has_source[i] ? std::max(band_end, source_end[i]) : band_end;
+    const int new_band_first_row = std::max(band_first_row,
+      std::min(first_used_row[i], new_band_end));
+    if (new_band_end != band_end || new_band_first_row != band_first_row)
+    {
+      next_band.resize(map.SourceWidth(), new_band_end - new_band_first_row, false);
+      // Keep the decoded rows still used
+      for (int row = std::max(band_first_row, new_band_first_row); row < band_end; ++row)
+      {
+        std::copy(band.data() + static_cast<size_t>(row - band_first_row) * band.Width(),
+                  band.data() + static_cast<size_t>(row - band_first_row + 1) * band.Width(),
+                  next_band.data() + static_cast<size_t>(row - new_band_first_row) * band.Width());
+      }
+      // Decode the new rows (the ones that are not used are skipped)
+      for (int row = band_end; row < new_band_end && bOk; ++row)
+      {
+        T * row_data = (row < new_band_first_row) ? discarded_row.data() :
+          next_band.data() + static_cast<size_t>(row - new_band_first_row) * band.Width();
+        bOk = reader.ReadRows(1, reinterpret_cast<unsigned char*>(row_data));
+      }
+      band.swap(next_band);
+      band_first_row = new_band_first_row;
+    }
+    if (!bOk)
+      break;
+
+    // Resample the strip
+    Image<T> & strip = strips[i % 2];
+    strip.resize(map.Width(), nb_rows, false);
+    RemapStrip(band, band_first_row, map, first_row, strip, interpolation, T(0));
+
+    // Encode it once the previous strip is written
+    if (pending_write.valid())
+      bOk = pending_write.get();
+    if (bOk)
+    {
+      pending_write = std::async(std::launch::async, [&writer, &strip]
+      {
+        return writer.WriteRows(strip.Height(), reinterpret_cast<const unsigned char*>(strip.data()));
+      });
+    }
+  }
+  if (pending_write.valid())
+    bOk &= pending_write.get();
+  return writer.Close() && bOk;
+}
+
+bool RemapImageFile
+(
+  const char * src_path,
+  const char * dst_path,
+  const Remap_Map & map,
+  const ERemap_Interpolation interpolation,
+  const int strip_height
+)
+{
+  Image_Strip_Reader reader;
+  if (!reader.Open(src_path))
+    return false;
+  if (reader.Width() != map.SourceWidth() || reader.Height() != map.SourceHeight())
+  {
+    OPENMVG_LOG_ERROR << "The image size does not match the remap size: " << src_path;
+    return false;
+  }
+  Image_Strip_Writer writer;
+  if (!writer.Open(dst_path, map.Width(), map.Height(), reader.Depth()))
+    return false;
+
+  const int nb_rows = std::max(1, strip_height);
+  switch (reader.Depth())
+  {
+    case 1:
+      return RemapImageFile<unsigned char>(reader, writer, map, interpolation, nb_rows);
+    case 3:
+      return RemapImageFile<RGBColor>(reader, writer, map, interpolation, nb_rows);
+    case 4:
+      return RemapImageFile<RGBAColor>(reader, writer, map, interpolation, nb_rows);
+    default:
+      return false;
+  }
+}
+
+} // namespace image
+} // namespace openMVG
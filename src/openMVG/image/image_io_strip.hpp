@@ -0,0 +1,134 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_IMAGE_IMAGE_IO_STRIP_HPP
+#define OPENMVG_IMAGE_IMAGE_IO_STRIP_HPP
+
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/image/image_remap.hpp"
+
+#include <memory>
+
+namespace openMVG
+{
+namespace image
+{
+
+/**
+* @brief Sequential reader of the rows of an image file.
+* The rows are decoded on demand with the scanline APIs of the codecs, so an
+* image can be processed without holding all its pixels in memory.
+* Handled formats: JPEG, non interlaced PNG, 8-bit TIFF stored by strips.
+* The pixels are 8-bit channels (1: gray, 3: RGB, 4: RGBA) like ReadImage.
+*/
+class Image_Strip_Reader
+{
+public:
+  Image_Strip_Reader();
+  ~Image_Strip_Reader();
+
+  /**
+  * @brief Open an image file
+  * @param path Input path of the image
+  * @retval true If the image can be read by rows
+  * @retval false If the file cannot be opened or its format cannot be read by rows
+  */
+  bool Open( const char * path );
+
+  void Close();
+
+  bool IsOpen() const;
+
+  int Width() const;
+  int Height() const;
+  /// Number of channels
+  int Depth() const;
+
+  /// Index of the next row to be read
+  int NextRow() const;
+
+  /**
+  * @brief Read the next rows
+  * @param nb_rows Number of rows
+  * @param[out] data Output buffer (nb_rows * Width() * Depth() bytes)
+  * @retval true If the rows are read
+  * @retval false If there is a decoding error or not enough rows
+  */
+  bool ReadRows( int nb_rows, unsigned char * data );
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/**
+* @brief Sequential writer of the rows of an image file.
+* Handled formats: JPEG, PNG, TIFF.
+*/
+class Image_Strip_Writer
+{
+public:
+  Image_Strip_Writer();
+  ~Image_Strip_Writer();
+
+  /**
+  * @brief Create an image file (the format is given by the file extension)
+  * @param path Output path of the image
+  * @param w Width of the image
+  * @param h Height of the image
+  * @param depth Number of channels (1, 3 or 4)
+  * @param quality JPG quality
+  */
+  bool Open( const char * path, int w, int h, int depth, int quality = 90 );
+
+  /**
+  * @brief Write the next rows
+  * @param nb_rows Number of rows
+  * @param data Input buffer (nb_rows * w * depth bytes)
+  */
+  bool WriteRows( int nb_rows, const unsigned char * data );
+
+  /// Finish the file (fails if all the rows were not written)
+  bool Close();
+
+  bool IsOpen() const;
+
+  /// Index of the next row to be written
+  int NextRow() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/**
+* @brief Remap an image file to another image file by strips of rows.
+* Only the source rows used by the current output strip are kept in memory:
+* the source is decoded while the previous output strip is encoded.
+* @param src_path Input image path (its size must be the map source size)
+* @param dst_path Output image path (of the size of the map)
+* @param map Source position of each output pixel
+* @param interpolation Interpolation method
+* @param strip_height Number of rows of an output strip
+* @retval true If the image is remapped
+* @retval false If the source cannot be read by rows (see Image_Strip_Reader)
+*  or if there was an error
+*/
+bool RemapImageFile
+(
+  const char * src_path,
+  const char * dst_path,
+  const Remap_Map & map,
+  const ERemap_Interpolation interpolation = ERemap_Interpolation::BILINEAR,
+  const int strip_height = 64
+);
+
+} // namespace image
+} // namespace openMVG
+
+#endif // OPENMVG_IMAGE_IMAGE_IO_STRIP_HPP
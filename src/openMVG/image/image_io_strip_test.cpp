@@ -0,0 +1,132 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/image/image_io_strip.hpp"
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <string>
+
+using namespace openMVG;
+using namespace openMVG::image;
+
+static Image<RGBColor> TestImage()
+{
+  Image<RGBColor> image(61, 47);
+  for (int i = 0; i < image.Height(); ++i)
+    for (int j = 0; j < image.Width(); ++j)
+      image(i, j) = RGBColor(4 * i, 4 * j, (i * j) % 256);
+  return image;
+}
+
+// Undistortion like map (the source rows of a strip are not monotonic)
+static Remap_Map TestMap(const int width, const int height)
+{
+  Remap_Map map(width, height, width, height);
+  const double cx = width / 2., cy = height / 2.;
+  for (int i = 0; i < height; ++i)
+    for (int j = 0; j < width; ++j)
+    {
+      const double x = (j - cx) / cx, y = (i - cy) / cx;
+      const double r2 = x * x + y * y;
+      const double scale = 1. - 0.2 * r2;
+      map.Set(i, j, cx + x * scale * cx, cy + y * scale * cx);
+    }
+  return map;
+}
+
+TEST(Image_Strip_Reader, SameAsReadImage) {
+  const Image<RGBColor> image = TestImage();
+  Image<unsigned char> gray;
+  ConvertPixelType(image, &gray);
+
+  for (const std::string extension : {"png", "jpg", "tif"})
+  {
+    const std::string filename = "test_strip_reader." + extension;
+    EXPECT_TRUE(WriteImage(filename.c_str(), image));
+    Image<RGBColor> read_image;
+    EXPECT_TRUE(ReadImage(filename.c_str(), &read_image));
+
+    Image_Strip_Reader reader;
+    EXPECT_TRUE(reader.Open(filename.c_str()));
+    EXPECT_EQ(image.Width(), reader.Width());
+    EXPECT_EQ(image.Height(), reader.Height());
+    EXPECT_EQ(3, reader.Depth());
+    Image<RGBColor> strip_image(reader.Width(), reader.Height());
+    // Read by strips of various heights
+    int nb_rows = 1;
+    while (reader.NextRow() < reader.Height())
+    {
+      nb_rows = std::min(nb_rows + 3, reader.Height() - reader.NextRow());
+      const int first_row = reader.NextRow();
+      EXPECT_TRUE(reader.ReadRows(nb_rows,
+        reinterpret_cast<unsigned char*>(strip_image.data() + first_row * reader.Width())));
+    }
+    EXPECT_FALSE(reader.ReadRows(1, reinterpret_cast<unsigned char*>(strip_image.data())));
+    EXPECT_TRUE(read_image == strip_image);
+  }
+
+  // Gray image
+  EXPECT_TRUE(WriteImage("test_strip_reader_gray.png", gray));
+  Image_Strip_Reader reader;
+  EXPECT_TRUE(reader.Open("test_strip_reader_gray.png"));
+  EXPECT_EQ(1, reader.Depth());
+  Image<unsigned char> strip_gray(reader.Width(), reader.Height());
+  EXPECT_TRUE(reader.ReadRows(reader.Height(), strip_gray.data()));
+  EXPECT_TRUE(gray == strip_gray);
+}
+
+TEST(Image_Strip_Writer, SameAsWriteImage) {
+  const Image<RGBColor> image = TestImage();
+  Image_Strip_Writer writer;
+  EXPECT_TRUE(writer.Open("test_strip_writer.png", image.Width(), image.Height(), 3));
+  const unsigned char * data = reinterpret_cast<const unsigned char*>(image.data());
+  EXPECT_TRUE(writer.WriteRows(10, data));
+  EXPECT_TRUE(writer.WriteRows(image.Height() - 10, data + 10 * image.Width() * 3));
+  EXPECT_FALSE(writer.WriteRows(1, data));
+  EXPECT_TRUE(writer.Close());
+
+  Image<RGBColor> read_image;
+  EXPECT_TRUE(ReadImage("test_strip_writer.png", &read_image));
+  EXPECT_TRUE(read_image == image);
+
+  // An incomplete image is an error
+  EXPECT_TRUE(writer.Open("test_strip_writer_incomplete.png", image.Width(), image.Height(), 3));
+  EXPECT_TRUE(writer.WriteRows(10, data));
+  EXPECT_FALSE(writer.Close());
+}
+
+TEST(RemapImageFile, SameAsRemap) {
+  const Image<RGBColor> image = TestImage();
+  EXPECT_TRUE(WriteImage("test_remap_file_src.png", image));
+  const Remap_Map map = TestMap(image.Width(), image.Height());
+
+  for (const ERemap_Interpolation interpolation :
+    {ERemap_Interpolation::NEAREST, ERemap_Interpolation::BILINEAR, ERemap_Interpolation::BICUBIC})
+  {
+    Image<RGBColor> remapped;
+    EXPECT_TRUE(Remap(image, map, remapped, interpolation, BLACK));
+    for (const int strip_height : {1, 7, 64})
+    {
+      EXPECT_TRUE(RemapImageFile("test_remap_file_src.png", "test_remap_file_dst.png",
+        map, interpolation, strip_height));
+      Image<RGBColor> strip_remapped;
+      EXPECT_TRUE(ReadImage("test_remap_file_dst.png", &strip_remapped));
+      EXPECT_TRUE(remapped == strip_remapped);
+    }
+  }
+
+  // Size mismatch
+  const Remap_Map other_map = TestMap(image.Width() + 1, image.Height());
+  EXPECT_FALSE(RemapImageFile("test_remap_file_src.png", "test_remap_file_dst.png", other_map));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -14,6 +14,7 @@
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <vector>
 
 using namespace openMVG;
 using namespace openMVG::image;
@@ -260,6 +261,158 @@ TEST(ImageHeader, AllFormats) {
   }
 }
 
+TEST(ImageMetadata, AllFormats) {
+  const std::vector<std::string> ext_Type = {"jpg", "png", "tif", "pgm", "ppm"};
+  const std::vector<Format> format_Type = {Jpg, Png, Tiff, Pnm, Pnm};
+  for (size_t i=0; i < ext_Type.size(); ++i)
+  {
+    const std::string filename = "img_metadata." + ext_Type[i];
+
+    // Gray images
+    if (ext_Type[i] != "ppm")
+    {
+      EXPECT_TRUE(WriteImage(filename.c_str(), Image<unsigned char>(12, 7)));
+      ImageMetadata metadata;
+      EXPECT_TRUE(ReadImageMetadata(filename.c_str(), &metadata));
+      EXPECT_EQ(format_Type[i], metadata.format);
+      EXPECT_EQ(12, metadata.width);
+      EXPECT_EQ(7, metadata.height);
+      EXPECT_EQ(1, metadata.depth);
+      EXPECT_EQ(1, metadata.orientation);
+      EXPECT_TRUE(metadata.exif.empty());
+      remove(filename.c_str());
+    }
+
+    // RGB images
+    if (ext_Type[i] != "pgm")
+    {
+      EXPECT_TRUE(WriteImage(filename.c_str(), Image<RGBColor>(12, 7)));
+      ImageMetadata metadata;
+      EXPECT_TRUE(ReadImageMetadata(filename.c_str(), &metadata));
+      EXPECT_EQ(format_Type[i], metadata.format);
+      EXPECT_EQ(12, metadata.width);
+      EXPECT_EQ(7, metadata.height);
+      EXPECT_EQ(3, metadata.depth);
+      remove(filename.c_str());
+    }
+  }
+
+  // RGBA images
+  for (const std::string filename : {"img_metadata.png", "img_metadata.tif"})
+  {
+    EXPECT_TRUE(WriteImage(filename.c_str(), Image<RGBAColor>(12, 7)));
+    ImageMetadata metadata;
+    EXPECT_TRUE(ReadImageMetadata(filename.c_str(), &metadata));
+    EXPECT_EQ(4, metadata.depth);
+    remove(filename.c_str());
+  }
+
+  // Header with comments
+  ImageMetadata metadata;
+  const std::string pgm_filename = string(THIS_SOURCE_DIR) + "/image_test/two_pixels_gray.pgm";
+  EXPECT_TRUE(ReadImageMetadata(pgm_filename.c_str(), &metadata));
+  EXPECT_EQ(2, metadata.width);
+  EXPECT_EQ(1, metadata.height);
+
+  // The format is read from the file signature, not from the extension
+  const std::string png_filename = string(THIS_SOURCE_DIR) + "/image_test/two_pixels_color.png";
+  EXPECT_TRUE(ReadImageMetadata(png_filename.c_str(), &metadata));
+  EXPECT_EQ(Png, metadata.format);
+  EXPECT_FALSE(ReadImageMetadata("img_metadata_missing.jpg", &metadata));
+}
+
+TEST(ImageMetadata, Jpg_Exif) {
+  const std::string filename = "img_metadata_exif.jpg";
+  EXPECT_TRUE(WriteImage(filename.c_str(), Image<RGBColor>(12, 7, true, RGBColor(20, 127, 255))));
+
+  // Insert an EXIF segment (orientation: 6) after the SOI marker
+  const std::vector<unsigned char> exif_segment = {
+    0xFF, 0xE1, 0x00, 0x22,
+    'E', 'x', 'i', 'f', 0, 0,
+    'M', 'M', 0x00, 0x2A, 0x00, 0x00, 0x00, 0x08, // TIFF header
+    0x00, 0x01, // IFD0 entries
+    0x01, 0x12, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00}; // Next IFD
+  {
+    FILE * file = fopen(filename.c_str(), "rb");
+    std::vector<unsigned char> jpg;
+    int c;
+    while ((c = fgetc(file)) != EOF)
+      jpg.push_back(c);
+    fclose(file);
+    jpg.insert(jpg.begin() + 2, exif_segment.cbegin(), exif_segment.cend());
+    file = fopen(filename.c_str(), "wb");
+    fwrite(jpg.data(), 1, jpg.size(), file);
+    fclose(file);
+  }
+
+  ImageMetadata metadata;
+  EXPECT_TRUE(ReadImageMetadata(filename.c_str(), &metadata));
+  EXPECT_EQ(Jpg, metadata.format);
+  EXPECT_EQ(12, metadata.width);
+  EXPECT_EQ(7, metadata.height);
+  EXPECT_EQ(3, metadata.depth);
+  EXPECT_EQ(6, metadata.orientation);
+  EXPECT_EQ(exif_segment.size() - 4, metadata.exif.size());
+
+  // The image is still readable, and its header is the same
+  Image<RGBColor> image;
+  ImageHeader imgHeader;
+  EXPECT_TRUE(ReadImage(filename.c_str(), &image));
+  EXPECT_TRUE(ReadImageHeader(filename.c_str(), &imgHeader));
+  EXPECT_TRUE(Read_JPG_ImageHeader(filename.c_str(), &imgHeader));
+  EXPECT_EQ(image.Width(), imgHeader.width);
+  EXPECT_EQ(image.Height(), imgHeader.height);
+  remove(filename.c_str());
+}
+
+TEST(ImageMetadata, Png_Exif) {
+  const std::string filename = "img_metadata_exif.png";
+  EXPECT_TRUE(WriteImage(filename.c_str(), Image<RGBColor>(12, 7, true, RGBColor(20, 127, 255))));
+  std::vector<unsigned char> png;
+  {
+    FILE * file = fopen(filename.c_str(), "rb");
+    int c;
+    while ((c = fgetc(file)) != EOF)
+      png.push_back(c);
+    fclose(file);
+  }
+
+  // Insert an eXIf chunk (orientation: 6) after the IHDR chunk
+  // (signature (8) + IHDR chunk (25)); its CRC is not checked.
+  const auto WriteExifPng = [&](const std::vector<unsigned char> & exif_chunk)
+  {
+    std::vector<unsigned char> exif_png = png;
+    exif_png.insert(exif_png.begin() + 33, exif_chunk.cbegin(), exif_chunk.cend());
+    FILE * file = fopen(filename.c_str(), "wb");
+    fwrite(exif_png.data(), 1, exif_png.size(), file);
+    fclose(file);
+  };
+  std::vector<unsigned char> exif_chunk = {
+    0x00, 0x00, 0x00, 0x1A,
+    'e', 'X', 'I', 'f',
+    'M', 'M', 0x00, 0x2A, 0x00, 0x00, 0x00, 0x08, // TIFF header
+    0x00, 0x01, // IFD0 entries
+    0x01, 0x12, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, // Next IFD
+    0x00, 0x00, 0x00, 0x00}; // CRC
+  WriteExifPng(exif_chunk);
+
+  ImageMetadata metadata;
+  EXPECT_TRUE(ReadImageMetadata(filename.c_str(), &metadata));
+  EXPECT_EQ(Png, metadata.format);
+  EXPECT_EQ(12, metadata.width);
+  EXPECT_EQ(7, metadata.height);
+  EXPECT_EQ(6, metadata.orientation);
+  EXPECT_EQ(6 + 0x1A, metadata.exif.size());
+
+  // A corrupted chunk length is rejected (nothing is read or allocated)
+  exif_chunk[0] = 0xFF;
+  WriteExifPng(exif_chunk);
+  EXPECT_FALSE(ReadImageMetadata(filename.c_str(), &metadata));
+  remove(filename.c_str());
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -0,0 +1,492 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_IMAGE_IMAGE_REMAP_HPP
+#define OPENMVG_IMAGE_IMAGE_REMAP_HPP
+
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/pixel_types.hpp"
+#include "openMVG/image/sample.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace openMVG
+{
+namespace image
+{
+
+/**
+* @brief Source position of each pixel of a remapped image.
+*
+* The map generation (i.e. a camera model evaluation) is separated from the
+* sampling: a map can be computed once and used to resample many images of the
+* same size (see Remap).
+* The positions are stored as fixed-point coordinates (1/256 pixel). The
+* positions outside the source image domain (or not finite) are invalid: the
+* corresponding pixels are not written by Remap.
+*/
+class Remap_Map
+{
+public:
+  /// Number of bits of the fractional part of the coordinates
+  static const int fraction_bits = 8;
+  static const int32_t fraction_one = 1 << fraction_bits;
+  static const int32_t invalid = std::numeric_limits<int32_t>::min();
+
+  Remap_Map() = default;
+
+  /**
+  * @brief Create a map with invalid positions
+  * @param width Width of the remapped image
+  * @param height Height of the remapped image
+  * @param source_width Width of the sampled image
+  * @param source_height Height of the sampled image
+  */
+  Remap_Map(int width, int height, int source_width, int source_height)
+  {
+    resize(width, height, source_width, source_height);
+  }
+
+  void resize(int width, int height, int source_width, int source_height)
+  {
+    width_ = width;
+    height_ = height;
+    source_width_ = source_width;
+    source_height_ = source_height;
+    x_.assign(static_cast<size_t>(width) * height, int32_t(invalid));
+    y_.assign(static_cast<size_t>(width) * height, int32_t(invalid));
+  }
+
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+  int SourceWidth() const { return source_width_; }
+  int SourceHeight() const { return source_height_; }
+
+  /// Set the source position (x, y) of the pixel (row, col)
+  void Set(int row, int col, double x, double y)
+  {
+    const size_t index = static_cast<size_t>(row) * width_ + col;
+    // Same domain as Image::Contains(y, x) on the truncated coordinates
+    if (x > -1.0 && x < source_width_ && y > -1.0 && y < source_height_)
+    {
+      x_[index] = static_cast<int32_t>(std::lround(x * fraction_one));
+      y_[index] = static_cast<int32_t>(std::lround(y * fraction_one));
+    }
+    else // out of the domain or NaN
+    {
+      x_[index] = y_[index] = invalid;
+    }
+  }
+
+  bool IsValid(int row, int col) const
+  {
+    return x_[static_cast<size_t>(row) * width_ + col] != invalid;
+  }
+
+  /// Fixed-point coordinates of a row
+  const int32_t * RowX(int row) const { return &x_[static_cast<size_t>(row) * width_]; }
+  const int32_t * RowY(int row) const { return &y_[static_cast<size_t>(row) * width_]; }
+
+  /// Memory used by the map (in bytes)
+  size_t MemoryUsage() const
+  {
+    return (x_.capacity() + y_.capacity()) * sizeof(int32_t);
+  }
+
+private:
+  int width_ = 0, height_ = 0;
+  int source_width_ = 0, source_height_ = 0;
+  std::vector<int32_t> x_, y_;
+};
+
+/// Interpolation of the fast Remap paths
+enum class ERemap_Interpolation
+{
+  NEAREST,  // Same as Sampler2d<SamplerNearest>
+  BILINEAR, // Same as Sampler2d<SamplerLinear>
+  BICUBIC   // Same as Sampler2d<SamplerCubic> (sharpness -0.5)
+};
+
+namespace internal
+{
+
+/// Channel layout of the pixel types (a pixel is an array of channels)
+template <typename T>
+struct Remap_Pixel
+{
+  using channel_type = T;
+  static const int channels = 1;
+};
+
+template <typename T>
+struct Remap_Pixel<Rgb<T>>
+{
+  using channel_type = T;
+  static const int channels = 3;
+};
+
+template <typename T>
+struct Remap_Pixel<Rgba<T>>
+{
+  using channel_type = T;
+  static const int channels = 4;
+};
+
+/// Weights of a separable kernel of KernelWidth taps for each fixed-point fraction
+template <int KernelWidth>
+struct Remap_Kernel_Table
+{
+  // First tap relative to the floor of the coordinate
+  int first_tap;
+  std::array<std::array<float, KernelWidth>, Remap_Map::fraction_one> weights;
+
+  template <typename SamplerFunc>
+  Remap_Kernel_Table(const SamplerFunc & sampler, int first_tap_)
+    : first_tap(first_tap_)
+  {
+    double w[KernelWidth];
+    for (int f = 0; f < Remap_Map::fraction_one; ++f)
+    {
+      sampler(f / static_cast<double>(Remap_Map::fraction_one), w);
+      for (int k = 0; k < KernelWidth; ++k)
+        weights[f][k] = static_cast<float>(w[k]);
+    }
+  }
+};
+
+/**
+* @brief Resample a row of an image.
+* The taps of the pixels far from the image border are read without any test;
+* near the border the taps outside the image are ignored and the weights are
+* normalized (Sampler2d behavior).
+* @param src Source image rows [src_first_row, src_first_row + src.Height())
+*  (all the source rows of the image or a band that contains the rows used by
+*  this row)
+*/
+template <int KernelWidth, typename T>
+void RemapRow
+(
+  const Image<T> & src,
+  const int src_first_row,
+  const Remap_Map & map,
+  const Remap_Kernel_Table<KernelWidth> & kernel,
+  const int row,
+  T * out_row
+)
+{
+  using channel_type = typename Remap_Pixel<T>::channel_type;
+  const int C = Remap_Pixel<T>::channels;
+  static_assert(sizeof(T) == C * sizeof(channel_type), "Unsupported pixel layout");
+
+  const int src_width = src.Width(), src_height = src.Height();
+  const channel_type * src_data = reinterpret_cast<const channel_type *>(src.data());
+  channel_type * out_data = reinterpret_cast<channel_type *>(out_row);
+  const int32_t * row_x = map.RowX(row);
+  const int32_t * row_y = map.RowY(row);
+
+  for (int col = 0; col < map.Width(); ++col)
+  {
+    if (row_x[col] == Remap_Map::invalid)
+      continue;
+    // Integer & fractional parts (the valid coordinates are > -1)
+    const int32_t shifted_x = row_x[col] + Remap_Map::fraction_one;
+    const int32_t shifted_y = row_y[col] + Remap_Map::fraction_one;
+    const int x0 = (shifted_x >> Remap_Map::fraction_bits) - 1 + kernel.first_tap;
+    const int y0 = (shifted_y >> Remap_Map::fraction_bits) - 1 + kernel.first_tap - src_first_row;
+    const float * wx = kernel.weights[shifted_x & (Remap_Map::fraction_one - 1)].data();
+    const float * wy = kernel.weights[shifted_y & (Remap_Map::fraction_one - 1)].data();
+
+    float accumulator[C] = {0.f};
+    if (x0 >= 0 && y0 >= 0 && x0 + KernelWidth <= src_width && y0 + KernelWidth <= src_height)
+    {
+      // Inside: no test, no normalization
+      for (int i = 0; i < KernelWidth; ++i)
+      {
+        const channel_type * tap = src_data + (static_cast<size_t>(y0 + i) * src_width + x0) * C;
+        for (int j = 0; j < KernelWidth; ++j)
+        {
+          const float w = wx[j] * wy[i];
+          for (int c = 0; c < C; ++c)
+            accumulator[c] += w * static_cast<float>(tap[j * C + c]);
+        }
+      }
+    }
+    else
+    {
+      // Border: ignore the taps outside the image
+      float total_weight = 0.f;
+      for (int i = 0; i < KernelWidth; ++i)
+      {
+        const int y = y0 + i;
+        if (y < 0 || y >= src_height)
+          continue;
+        for (int j = 0; j < KernelWidth; ++j)
+        {
+          const int x = x0 + j;
+          if (x < 0 || x >= src_width)
+            continue;
+          const float w = wx[j] * wy[i];
+          const channel_type * tap = src_data + (static_cast<size_t>(y) * src_width + x) * C;
+          for (int c = 0; c < C; ++c)
+            accumulator[c] += w * static_cast<float>(tap[c]);
+          total_weight += w;
+        }
+      }
+      if (total_weight <= 0.2f)
+      {
+        for (int c = 0; c < C; ++c)
+          accumulator[c] = 0.f;
+      }
+      else
+      {
+        for (int c = 0; c < C; ++c)
+          accumulator[c] /= total_weight;
+      }
+    }
+    for (int c = 0; c < C; ++c)
+      out_data[col * C + c] = RealPixel<channel_type>::convert_from_real(accumulator[c]);
+  }
+}
+
+template <int KernelWidth, typename T>
+void Remap
+(
+  const Image<T> & src,
+  const int src_first_row,
+  const Remap_Map & map,
+  const Remap_Kernel_Table<KernelWidth> & kernel,
+  const int first_row,
+  Image<T> & out
+)
+{
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int row = 0; row < out.Height(); ++row)
+  {
+    RemapRow(src, src_first_row, map, kernel, first_row + row, out.data() + static_cast<size_t>(row) * out.Width());
+  }
+}
+
+/// Dispatch the interpolation to its kernel table
+template <typename T>
+void Remap
+(
+  const Image<T> & src,
+  const int src_first_row,
+  const Remap_Map & map,
+  const ERemap_Interpolation interpolation,
+  const int first_row,
+  Image<T> & out
+)
+{
+  switch (interpolation)
+  {
+    case ERemap_Interpolation::NEAREST:
+    {
+      static const Remap_Kernel_Table<2> kernel(SamplerNearest(), 0);
+      Remap(src, src_first_row, map, kernel, first_row, out);
+    }
+    break;
+    case ERemap_Interpolation::BILINEAR:
+    {
+      static const Remap_Kernel_Table<2> kernel(SamplerLinear(), 0);
+      Remap(src, src_first_row, map, kernel, first_row, out);
+    }
+    break;
+    case ERemap_Interpolation::BICUBIC:
+    {
+      static const Remap_Kernel_Table<4> kernel(SamplerCubic(), -1);
+      Remap(src, src_first_row, map, kernel, first_row, out);
+    }
+    break;
+  }
+}
+
+} // namespace internal
+
+/**
+* @brief Resample an image at the positions of a map
+* @param src Input image (its size must be the map source size)
+* @param map Source position of each output pixel
+* @param[out] out Output image (of the size of the map)
+* @param interpolation Interpolation method
+* @param fill Value of the pixels without a valid source position
+* @return false if the image size does not match the map
+*/
+template <typename T>
+bool Remap
+(
+  const Image<T> & src,
+  const Remap_Map & map,
+  Image<T> & out,
+  const ERemap_Interpolation interpolation = ERemap_Interpolation::BILINEAR,
+  const T fill = T(0)
+)
+{
+  if (src.Width() != map.SourceWidth() || src.Height() != map.SourceHeight())
+    return false;
+
+  out.resize(map.Width(), map.Height(), true, fill);
+  internal::Remap(src, 0, map, interpolation, 0, out);
+  return true;
+}
+
+/**
+* @brief Source rows used to remap some rows of a map
+* @param map Source position of each output pixel
+* @param first_row First row of the map
+* @param nb_rows Number of rows
+* @param interpolation Interpolation method
+* @param[out] source_begin First source row
+* @param[out] source_end Last source row + 1
+* @return false if the rows have no valid position
+*/
+inline bool RemapSourceRows
+(
+  const Remap_Map & map,
+  const int first_row,
+  const int nb_rows,
+  const ERemap_Interpolation interpolation,
+  int & source_begin,
+  int & source_end
+)
+{
+  int32_t min_y = std::numeric_limits<int32_t>::max();
+  int32_t max_y = std::numeric_limits<int32_t>::min();
+  for (int row = first_row; row < first_row + nb_rows; ++row)
+  {
+    const int32_t * row_x = map.RowX(row);
+    const int32_t * row_y = map.RowY(row);
+    for (int col = 0; col < map.Width(); ++col)
+    {
+      if (row_x[col] != Remap_Map::invalid)
+      {
+        min_y = std::min(min_y, row_y[col]);
+        max_y = std::max(max_y, row_y[col]);
+      }
+    }
+  }
+  if (min_y > max_y)
+  {
+    source_begin = source_end = 0;
+    return false;
+  }
+  // Rows of the kernel taps
+  const int first_tap = (interpolation == ERemap_Interpolation::BICUBIC) ? -1 : 0;
+  const int nb_taps = (interpolation == ERemap_Interpolation::BICUBIC) ? 4 : 2;
+  const int floor_min = ((min_y + Remap_Map::fraction_one) >> Remap_Map::fraction_bits) - 1;
+  const int floor_max = ((max_y + Remap_Map::fraction_one) >> Remap_Map::fraction_bits) - 1;
+  source_begin = std::max(0, floor_min + first_tap);
+  source_end = std::min(map.SourceHeight(), floor_max + first_tap + nb_taps);
+  return true;
+}
+
+/**
+* @brief Resample some rows of a map from a band of source rows
+* (to remap an image without loading it entirely, see RemapSourceRows)
+* @param src_band Source rows [src_first_row, src_first_row + src_band.Height())
+* @param src_first_row First source row of the band
+* @param map Source position of each output pixel
+* @param first_row First row of the map to remap
+* @param[out] out_strip Output rows [first_row, first_row + out_strip.Height())
+* @param interpolation Interpolation method
+* @param fill Value of the pixels without a valid source position
+* @return false if the band does not match the map
+*/
+template <typename T>
+bool RemapStrip
+(
+  const Image<T> & src_band,
+  const int src_first_row,
+  const Remap_Map & map,
+  const int first_row,
+  Image<T> & out_strip,
+  const ERemap_Interpolation interpolation = ERemap_Interpolation::BILINEAR,
+  const T fill = T(0)
+)
+{
+  if (src_band.Width() != map.SourceWidth() ||
+      first_row < 0 || first_row + out_strip.Height() > map.Height())
+    return false;
+
+  out_strip.resize(map.Width(), out_strip.Height(), true, fill);
+  internal::Remap(src_band, src_first_row, map, interpolation, first_row, out_strip);
+  return true;
+}
+
+/**
+* @brief Resample an image at the positions of a map with any Sampler2d
+* (the fast paths are used for the nearest & bilinear samplers)
+*/
+template <typename T, typename SamplerFunc>
+bool Remap
+(
+  const Image<T> & src,
+  const Remap_Map & map,
+  Image<T> & out,
+  const Sampler2d<SamplerFunc> & sampler,
+  const T fill = T(0)
+)
+{
+  if (src.Width() != map.SourceWidth() || src.Height() != map.SourceHeight())
+    return false;
+
+  out.resize(map.Width(), map.Height(), true, fill);
+  const float scale = 1.f / Remap_Map::fraction_one;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int row = 0; row < map.Height(); ++row)
+  {
+    const int32_t * row_x = map.RowX(row);
+    const int32_t * row_y = map.RowY(row);
+    for (int col = 0; col < map.Width(); ++col)
+    {
+      if (row_x[col] != Remap_Map::invalid)
+        out(row, col) = sampler(src, row_y[col] * scale, row_x[col] * scale);
+    }
+  }
+  return true;
+}
+
+template <typename T>
+bool Remap
+(
+  const Image<T> & src,
+  const Remap_Map & map,
+  Image<T> & out,
+  const Sampler2d<SamplerLinear> &,
+  const T fill = T(0)
+)
+{
+  return Remap(src, map, out, ERemap_Interpolation::BILINEAR, fill);
+}
+
+template <typename T>
+bool Remap
+(
+  const Image<T> & src,
+  const Remap_Map & map,
+  Image<T> & out,
+  const Sampler2d<SamplerNearest> &,
+  const T fill = T(0)
+)
+{
+  return Remap(src, map, out, ERemap_Interpolation::NEAREST, fill);
+}
+
+} // namespace image
+} // namespace openMVG
+
+#endif // OPENMVG_IMAGE_IMAGE_REMAP_HPP
@@ -0,0 +1,147 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/image/image_remap.hpp"
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::image;
+
+// Random image & random map (positions on the fixed-point grid, some of them
+// near or outside the image border)
+template <typename T>
+void RandomImage(const int width, const int height, Image<T> & image)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_int_distribution<int> rand_value(0, 255);
+  image.resize(width, height);
+  for (int i = 0; i < image.Height(); ++i)
+    for (int j = 0; j < image.Width(); ++j)
+      image(i, j) = T(rand_value(random_generator));
+}
+
+Remap_Map RandomMap(const int width, const int height, const Image<unsigned char> & src)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_int_distribution<int>
+    rand_x(-2 * Remap_Map::fraction_one, (src.Width() + 1) * Remap_Map::fraction_one),
+    rand_y(-2 * Remap_Map::fraction_one, (src.Height() + 1) * Remap_Map::fraction_one);
+  Remap_Map map(width, height, src.Width(), src.Height());
+  for (int i = 0; i < height; ++i)
+    for (int j = 0; j < width; ++j)
+      map.Set(i, j,
+        rand_x(random_generator) / static_cast<double>(Remap_Map::fraction_one),
+        rand_y(random_generator) / static_cast<double>(Remap_Map::fraction_one));
+  return map;
+}
+
+// Maximal difference between the remap & the sampling of the map positions
+template <typename T, typename SamplerT>
+int MaxDifferenceToSampler
+(
+  const Image<T> & src,
+  const Remap_Map & map,
+  const Image<T> & remapped,
+  const SamplerT & sampler
+)
+{
+  int max_difference = 0;
+  for (int i = 0; i < map.Height(); ++i)
+    for (int j = 0; j < map.Width(); ++j)
+    {
+      T expected(0);
+      if (map.IsValid(i, j))
+        expected = sampler(src,
+          map.RowY(i)[j] / static_cast<float>(Remap_Map::fraction_one),
+          map.RowX(i)[j] / static_cast<float>(Remap_Map::fraction_one));
+      max_difference = std::max(max_difference,
+        std::abs(static_cast<int>(expected) - static_cast<int>(remapped(i, j))));
+    }
+  return max_difference;
+}
+
+TEST(Remap, Map) {
+  Remap_Map map(4, 2, 10, 5);
+  EXPECT_EQ(4, map.Width());
+  EXPECT_EQ(2, map.Height());
+  EXPECT_FALSE(map.IsValid(0, 0));
+  map.Set(0, 0, 1.5, 2.25);
+  EXPECT_TRUE(map.IsValid(0, 0));
+  EXPECT_EQ(384, map.RowX(0)[0]);
+  EXPECT_EQ(576, map.RowY(0)[0]);
+  // Same domain as Image::Contains
+  map.Set(0, 1, -0.5, 4.9);
+  EXPECT_TRUE(map.IsValid(0, 1));
+  map.Set(0, 2, -1.0, 2.0);
+  EXPECT_FALSE(map.IsValid(0, 2));
+  map.Set(0, 3, 2.0, 5.0);
+  EXPECT_FALSE(map.IsValid(0, 3));
+  map.Set(1, 0, std::nan(""), 2.0);
+  EXPECT_FALSE(map.IsValid(1, 0));
+  EXPECT_EQ(2 * 4 * 2 * sizeof(int32_t), map.MemoryUsage());
+}
+
+TEST(Remap, SizeMismatch) {
+  const Remap_Map map(4, 2, 10, 5);
+  const Image<unsigned char> src(5, 10);
+  Image<unsigned char> out;
+  EXPECT_FALSE(Remap(src, map, out));
+}
+
+TEST(Remap, SameAsSampler2d_Gray) {
+  Image<unsigned char> src;
+  RandomImage(64, 48, src);
+  const Remap_Map map = RandomMap(100, 80, src);
+
+  Image<unsigned char> out;
+  EXPECT_TRUE(Remap(src, map, out, ERemap_Interpolation::NEAREST));
+  EXPECT_EQ(0, MaxDifferenceToSampler(src, map, out, Sampler2d<SamplerNearest>()));
+  EXPECT_TRUE(Remap(src, map, out, ERemap_Interpolation::BILINEAR));
+  EXPECT_TRUE(MaxDifferenceToSampler(src, map, out, Sampler2d<SamplerLinear>()) <= 1);
+  EXPECT_TRUE(Remap(src, map, out, ERemap_Interpolation::BICUBIC));
+  EXPECT_TRUE(MaxDifferenceToSampler(src, map, out, Sampler2d<SamplerCubic>()) <= 1);
+  // Generic sampler path
+  EXPECT_TRUE(Remap(src, map, out, Sampler2d<SamplerSpline16>()));
+  EXPECT_EQ(0, MaxDifferenceToSampler(src, map, out, Sampler2d<SamplerSpline16>()));
+}
+
+TEST(Remap, SameAsSampler2d_RGB) {
+  Image<unsigned char> gray;
+  RandomImage(64, 48, gray);
+  const Remap_Map map = RandomMap(100, 80, gray);
+  Image<RGBColor> src(gray.Width(), gray.Height());
+  for (int i = 0; i < gray.Height(); ++i)
+    for (int j = 0; j < gray.Width(); ++j)
+      src(i, j) = RGBColor(gray(i, j), 255 - gray(i, j), gray(i, j) / 2);
+
+  const Sampler2d<SamplerLinear> sampler;
+  Image<RGBColor> out;
+  EXPECT_TRUE(Remap(src, map, out, ERemap_Interpolation::BILINEAR, BLACK));
+  int max_difference = 0;
+  for (int i = 0; i < map.Height(); ++i)
+    for (int j = 0; j < map.Width(); ++j)
+    {
+      RGBColor expected = BLACK;
+      if (map.IsValid(i, j))
+        expected = sampler(src,
+          map.RowY(i)[j] / static_cast<float>(Remap_Map::fraction_one),
+          map.RowX(i)[j] / static_cast<float>(Remap_Map::fraction_one));
+      for (int c = 0; c < 3; ++c)
+        max_difference = std::max(max_difference,
+          std::abs(static_cast<int>(expected(c)) - static_cast<int>(out(i, j)(c))));
+    }
+  EXPECT_TRUE(max_difference <= 1);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
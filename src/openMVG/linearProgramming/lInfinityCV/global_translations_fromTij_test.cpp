@@ -8,11 +8,15 @@
 
 #include "openMVG/linearProgramming/linearProgrammingInterface.hpp"
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
+#include "openMVG/linearProgramming/linearProgrammingPDLP.hpp"
 #include "openMVG/linearProgramming/lInfinityCV/global_translations_fromTij.hpp"
 
 #include "openMVG/multiview/translation_averaging_test.hpp"
 #include "testing/testing.h"
 
+#include <algorithm>
+#include <random>
+
 using namespace openMVG;
 using namespace openMVG::linearProgramming;
 using namespace lInfinityCV;
@@ -102,6 +106,69 @@ TEST(translation_averaging, globalTi_from_tijs) {
   }
 }
 
+// The global SfM pipeline uses the first order solver for the large scenes
+//  (see GlobalSfM_Translation_AveragingSolver::kMaxSimplexCameras)
+TEST(translation_averaging, globalTi_from_tijs_PDLP) {
+
+  const int focal = 1000;
+  const int principal_Point = 500;
+  const int iNviews = 64;
+  const int iNbPoints = 6;
+  const NViewDataSet d = NRealisticCamerasCardioid(
+    iNviews, iNbPoints,
+    nViewDatasetConfigurator(focal, focal, principal_Point, principal_Point, 5, 0));
+
+  //-- Triplets of relative translations: a camera is linked to the next one
+  //-   and to a random one (long range links of an unordered photo collection).
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_int_distribution<int> random_view(0, iNviews - 1);
+  std::vector<openMVG::RelativeInfo_Vec > vec_relative_estimates;
+  for (int i = 0; i < iNviews; ++i)
+  {
+    IndexT triplet[3] = {IndexT(i), IndexT((i + 1) % iNviews), 0};
+    do
+    {
+      triplet[2] = random_view(random_generator);
+    } while (triplet[2] == triplet[0] || triplet[2] == triplet[1]);
+    std::sort(&triplet[0], &triplet[3]);
+
+    openMVG::RelativeInfo_Vec relative_motion;
+    for (const Pair & pair : {Pair(triplet[0], triplet[1]),
+                              Pair(triplet[1], triplet[2]),
+                              Pair(triplet[0], triplet[2])})
+    {
+      Mat3 Rij;
+      Vec3 tij;
+      RelativeCameraMotion(d._R[pair.first], d._t[pair.first],
+                           d._R[pair.second], d._t[pair.second], &Rij, &tij);
+      relative_motion.emplace_back(pair, std::make_pair(Rij, tij));
+    }
+    vec_relative_estimates.push_back(relative_motion);
+  }
+
+  std::vector<double> vec_solution(iNviews*3 + vec_relative_estimates.size() + 1);
+  PDLP_SolverWrapper solverLP(vec_solution.size());
+
+  Tifromtij_ConstraintBuilder cstBuilder(vec_relative_estimates);
+  LP_Constraints_Sparse constraint;
+  cstBuilder.Build(constraint);
+  solverLP.setup(constraint);
+  EXPECT_TRUE(solverLP.solve());
+
+  solverLP.getSolution(vec_solution);
+  const double gamma = vec_solution[vec_solution.size()-1];
+  EXPECT_NEAR(0.0, gamma, 1e-4);
+
+  // Check the direction of the camera centers (the solution is found up to a scale)
+  for (size_t i = 1; i < iNviews; ++i)
+  {
+    const Vec3 t(vec_solution[i*3], vec_solution[i*3+1], vec_solution[i*3+2]);
+    const Vec3 C_computed = - d._R[i].transpose() * t;
+    const Vec3 C_GT = d._C[i] - d._C[0];
+    EXPECT_NEAR(0.0, DistanceLInfinity(C_computed.normalized(), C_GT.normalized()), 1e-3);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
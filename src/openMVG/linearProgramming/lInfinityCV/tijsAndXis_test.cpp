@@ -10,6 +10,7 @@
 #include "openMVG/linearProgramming/linearProgrammingInterface.hpp"
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
 #include "openMVG/linearProgramming/lInfinityCV/tijsAndXis_From_xi_Ri.hpp"
+#include "openMVG/linearProgramming/lInfinityCV/triplet_tijsAndXis_kernel.hpp"
 #include "openMVG/multiview/projection.hpp"
 #include "openMVG/multiview/test_data_sets.hpp"
 #include "openMVG/numeric/numeric.h"
@@ -198,6 +199,34 @@ TEST(Translation_Structure_L_Infinity, OSICLP_SOLVER_K) {
   d2.ExportToPLY("test_After_Infinity.ply");
 }
 
+TEST(Translation_Structure_L2, Triplet_Solver) {
+
+  const size_t nViews = 3;
+  const size_t nbPoints = 6;
+  const NViewDataSet d = NRealisticCamerasRing(nViews, nbPoints,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  std::vector<trifocal::kernel::TrifocalTensorModel> models;
+  translations_Triplet_L2_Solver::Solve(d._x[0], d._x[1], d._x[2], d._R, &models, 1.0);
+  EXPECT_EQ(1, models.size());
+
+  // The translations are found up to a scale (the first camera is the origin)
+  Vec6 t_GT;
+  t_GT << d._t[1] - d._R[1] * d._R[0].transpose() * d._t[0],
+          d._t[2] - d._R[2] * d._R[0].transpose() * d._t[0];
+  Vec6 t;
+  t << models[0].P2.col(3), models[0].P3.col(3);
+  EXPECT_MATRIX_NEAR(Vec3::Zero(), models[0].P1.col(3), 1e-8);
+  EXPECT_MATRIX_NEAR(t_GT.normalized(), t.normalized(), 1e-8);
+
+  // Check that the reprojection errors are null
+  for (size_t i = 0; i < nbPoints; ++i)
+  {
+    EXPECT_NEAR(0.0, translations_Triplet_L2_Solver::Error(models[0],
+      d._x[0].col(i), d._x[1].col(i), d._x[2].col(i)), 1e-8);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
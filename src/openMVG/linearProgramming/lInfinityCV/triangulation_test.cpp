@@ -9,6 +9,7 @@
 #include "openMVG/linearProgramming/bisectionLP.hpp"
 #include "openMVG/linearProgramming/linearProgrammingInterface.hpp"
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
+#include "openMVG/linearProgramming/linearProgrammingPDLP.hpp"
 #include "openMVG/linearProgramming/lInfinityCV/triangulation.hpp"
 
 #include "openMVG/multiview/projection.hpp"
@@ -17,6 +18,7 @@
 #include "testing/testing.h"
 
 #include <iostream>
+#include <random>
 #include <vector>
 
 using namespace openMVG;
@@ -82,6 +84,67 @@ TEST(lInfinityCV, Triangulation_OSICLPSOLVER) {
   d2.ExportToPLY("test_After_Infinity_Triangulation_OSICLP.ply");
 }
 
+// The bisection converges to the same gamma with the first order solver
+TEST(lInfinityCV, Triangulation_Bisection_PDLPSOLVER) {
+
+  const NViewDataSet d = NRealisticCamerasRing(6, 10,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  std::vector<Mat34> vec_Pi;
+  for (size_t i = 0; i < d._n; ++i)
+    vec_Pi.push_back(d.P(i));
+
+  // Noisy observations: the optimal gamma is not zero
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<double> noise(0.0, 1e-3);
+
+  for (Mat2X::Index k = 0; k < d._x[0].cols(); ++k)
+  {
+    Mat2X x_ij;
+    x_ij.resize(2,d._n);
+    for (size_t i = 0; i < d._n; ++i)
+      x_ij.col(i) = d._x[i].col(k) + Vec2(noise(random_generator), noise(random_generator));
+
+    Triangulation_L1_ConstraintBuilder cstBuilder(vec_Pi, x_ij);
+
+    std::vector<double> vec_solution_OSICLP(3);
+    double gamma_OSICLP = -1.0;
+    OSI_CLP_SolverWrapper wrapperOSICLPSolver(3);
+    EXPECT_TRUE(
+      (BisectionLP<Triangulation_L1_ConstraintBuilder,LP_Constraints>(
+      wrapperOSICLPSolver,
+      cstBuilder,
+      &vec_solution_OSICLP,
+      1.0,
+      0.0,
+      1e-8,
+      20,
+      &gamma_OSICLP))
+    );
+
+    // Feasibility queries: an iteration cap must not be reported as feasible
+    PDLP_SolverWrapper::Options options;
+    options.best_iterate_on_iteration_cap = false;
+    std::vector<double> vec_solution_PDLP(3);
+    double gamma_PDLP = -1.0;
+    PDLP_SolverWrapper wrapperPDLPSolver(3, options);
+    EXPECT_TRUE(
+      (BisectionLP<Triangulation_L1_ConstraintBuilder,LP_Constraints>(
+      wrapperPDLPSolver,
+      cstBuilder,
+      &vec_solution_PDLP,
+      1.0,
+      0.0,
+      1e-8,
+      20,
+      &gamma_PDLP))
+    );
+
+    EXPECT_TRUE(gamma_OSICLP > 0.0);
+    EXPECT_NEAR(gamma_OSICLP, gamma_PDLP, 1e-4);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -8,6 +8,9 @@
 
 #include "openMVG/linearProgramming/lInfinityCV/triplet_tijsAndXis_kernel.hpp"
 
+#include <array>
+#include <limits>
+
 #include "openMVG/multiview/projection.hpp"
 #include "openMVG/multiview/triangulation_nview.hpp"
 #include "openMVG/numeric/numeric.h"
@@ -130,4 +133,86 @@ double translations_Triplet_Solver::Error
   return TrifocalTensorModel::Error(Tensor, pt0, pt1, pt2);
 }
 
+/// Solve the computation of the "tensor" (linear L2 formulation).
+void translations_Triplet_L2_Solver::Solve
+(
+  const Mat &pt0,
+  const Mat & pt1,
+  const Mat & pt2,
+  const std::vector<Mat3> & vec_KR,
+  std::vector<TrifocalTensorModel> *P,
+  const double /*ThresholdUpperBound*/
+)
+{
+  const int n_obs = pt0.cols();
+  if (n_obs < MINIMUM_SAMPLES)
+    return;
+
+  // Epipolar constraint of the view pair (a,b) with known rotations:
+  //  (R_ab * x_a ^ x_b)' * (t_b - R_ab * t_a) = 0, R_ab = R_b * R_a'
+  // The unknowns are (t1, t2) since the first camera is fixed (t0 = 0).
+  const Mat * pts[3] = {&pt0, &pt1, &pt2};
+  const std::array<std::pair<int, int>, 3> view_pairs {{{0, 1}, {0, 2}, {1, 2}}};
+  Mat A = Mat::Zero(3 * n_obs, 6);
+  for (int p = 0; p < 3; ++p)
+  {
+    const int a = view_pairs[p].first, b = view_pairs[p].second;
+    const Mat3 Rab = vec_KR[b] * vec_KR[a].transpose();
+    for (int i = 0; i < n_obs; ++i)
+    {
+      const Vec3 xa = pts[a]->col(i).homogeneous(), xb = pts[b]->col(i).homogeneous();
+      const Vec3 normal = (Rab * xa).cross(xb);
+      if (normal.norm() < std::numeric_limits<double>::epsilon())
+        continue;
+      const Vec3 n = normal.normalized();
+      A.block<1, 3>(3 * i + p, 3 * (b - 1)) += n.transpose();
+      if (a > 0)
+        A.block<1, 3>(3 * i + p, 3 * (a - 1)) -= n.transpose() * Rab;
+    }
+  }
+  const Eigen::SelfAdjointEigenSolver<Mat> eigen_solver(A.transpose() * A);
+  if (eigen_solver.info() != Eigen::Success)
+    return;
+  const Vec6 t = eigen_solver.eigenvectors().col(0);
+
+  TrifocalTensorModel PTemp;
+  PTemp.P1 = HStack(vec_KR[0], Vec3::Zero());
+  PTemp.P2 = HStack(vec_KR[1], Vec3(t.head<3>()));
+  PTemp.P3 = HStack(vec_KR[2], Vec3(t.tail<3>()));
+
+  // Choose the solution sign that keeps most of the points in front of the cameras
+  int front_count = 0;
+  for (int i = 0; i < n_obs; ++i)
+  {
+    const std::vector<Mat34> poses {PTemp.P1, PTemp.P2, PTemp.P3};
+    const std::vector<Vec3> Xs {pt0.col(i).homogeneous(),
+                                pt1.col(i).homogeneous(),
+                                pt2.col(i).homogeneous()};
+    Eigen::Map<const Mat3> bearing_matrix(Xs[0].data());
+    Vec4 Xhomogeneous;
+    TriangulateNViewAlgebraic(bearing_matrix, poses, &Xhomogeneous);
+    const Vec3 X = Xhomogeneous.hnormalized();
+    for (const Mat34 & pose : poses)
+      front_count += ((pose * X.homogeneous())(2) > 0.0) ? 1 : -1;
+  }
+  if (front_count < 0)
+  {
+    PTemp.P2.col(3) *= -1.0;
+    PTemp.P3.col(3) *= -1.0;
+  }
+  P->push_back(PTemp);
+}
+
+// Compute the residual of reprojections
+double translations_Triplet_L2_Solver::Error
+(
+  const TrifocalTensorModel & Tensor,
+  const Vec2 & pt0,
+  const Vec2 & pt1,
+  const Vec2 & pt2
+)
+{
+  return TrifocalTensorModel::Error(Tensor, pt0, pt1, pt2);
+}
+
 } // namespace openMVG
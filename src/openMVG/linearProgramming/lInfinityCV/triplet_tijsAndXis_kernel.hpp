@@ -66,6 +66,35 @@ struct translations_Triplet_Solver {
   );
 };
 
+/// Solve the translations of a view-triplet that have known rotations with a
+/// linear (L2) formulation. Cheaper than the L-infinity LP solver: the three
+/// pairwise epipolar constraints are linear in the translations (t0 = 0) and
+/// the solution is the null vector of a 6 x 6 system.
+struct translations_Triplet_L2_Solver {
+  enum { MINIMUM_SAMPLES = 4 };
+  enum { MAX_MODELS = 1 };
+
+  /// Solve the computation of the "tensor".
+  static void Solve
+  (
+    const Mat &pt0,
+    const Mat & pt1,
+    const Mat & pt2,
+    const std::vector<Mat3> & vec_KR,
+    std::vector<trifocal::kernel::TrifocalTensorModel> *P,
+    const double ThresholdUpperBound
+  );
+
+  // Compute the residual of reprojections
+  static double Error
+  (
+    const trifocal::kernel::TrifocalTensorModel & Tensor,
+    const Vec2 & pt0,
+    const Vec2 & pt1,
+    const Vec2 & pt2
+  );
+};
+
 } // namespace openMVG
 
 #endif // OPENMVG_LINFINITY_COMPUTER_VISION_TRIPLET_TIJS_AND_KIS_KERNEL_HPP
@@ -13,6 +13,7 @@
 
 #include "openMVG/linearProgramming/linearProgrammingInterface.hpp"
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
+#include "openMVG/linearProgramming/linearProgrammingPDLP.hpp"
 
 // Multiple View Geometry solver that rely on Linear programming formulations
 #include "openMVG/linearProgramming/lInfinityCV/lInfinityCV.hpp"
@@ -0,0 +1,454 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/linearProgramming/linearProgrammingPDLP.hpp"
+#include "openMVG/system/logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace openMVG   {
+namespace linearProgramming  {
+
+namespace {
+
+const double kInfinity = std::numeric_limits<double>::infinity();
+
+// The LP bounds larger than this value are considered as infinite
+inline double ToInfinity(const double value)
+{
+  if (value <= -1e20) return -kInfinity;
+  if (value >= 1e20) return kInfinity;
+  return value;
+}
+
+// y = A * x (the rows are computed in parallel for large matrices)
+void Multiply(const sRMat & A, const Vec & x, Vec & y)
+{
+  y.resize(A.rows());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static) if (A.nonZeros() > 100000)
+#endif
+  for (int i = 0; i < static_cast<int>(A.rows()); ++i)
+  {
+    double sum = 0.0;
+    for (sRMat::InnerIterator it(A, i); it; ++it)
+      sum += it.value() * x[it.col()];
+    y[i] = sum;
+  }
+}
+
+// Scale the rows and the columns of A: A = diag(row) * A * diag(col)
+void Scale(const Vec & row, const Vec & col, sRMat & A)
+{
+  for (int i = 0; i < static_cast<int>(A.rows()); ++i)
+    for (sRMat::InnerIterator it(A, i); it; ++it)
+      it.valueRef() *= row[i] * col[it.col()];
+}
+
+} // namespace
+
+PDLP_SolverWrapper::PDLP_SolverWrapper(int nbParams)
+  : PDLP_SolverWrapper(nbParams, Options())
+{
+}
+
+PDLP_SolverWrapper::PDLP_SolverWrapper(int nbParams, const Options & options)
+  : LP_Solver(nbParams),
+    options_(options),
+    objective_sign_(1.0),
+    primal_weight_(-1.0),
+    iterations_(0)
+{
+}
+
+bool PDLP_SolverWrapper::setup(const LP_Constraints & cstraints)
+{
+  LP_Constraints_Sparse sparse_cstraints;
+  sparse_cstraints.nbParams_ = cstraints.nbParams_;
+  sparse_cstraints.vec_bounds_ = cstraints.vec_bounds_;
+  sparse_cstraints.constraint_mat_ = cstraints.constraint_mat_.sparseView();
+  sparse_cstraints.constraint_objective_ = cstraints.constraint_objective_;
+  sparse_cstraints.vec_sign_ = cstraints.vec_sign_;
+  sparse_cstraints.bminimize_ = cstraints.bminimize_;
+  sparse_cstraints.vec_cost_ = cstraints.vec_cost_;
+  return setup(sparse_cstraints);
+}
+
+bool PDLP_SolverWrapper::setup(const LP_Constraints_Sparse & cstraints)
+{
+  const int NUMVAR = cstraints.constraint_mat_.cols();
+  const int NUMROW = cstraints.constraint_mat_.rows();
+  if (static_cast<int>(cstraints.vec_sign_.size()) != NUMROW
+      || cstraints.constraint_objective_.size() != NUMROW)
+  {
+    OPENMVG_LOG_ERROR << "Invalid LP constraints";
+    return false;
+  }
+  this->nbParams_ = NUMVAR;
+  objective_sign_ = cstraints.bminimize_ ? 1.0 : -1.0;
+
+  //-- Objective function (always minimized)
+  c_ = Vec::Zero(NUMVAR);
+  for (int j = 0; j < NUMVAR && j < static_cast<int>(cstraints.vec_cost_.size()); ++j)
+    c_[j] = objective_sign_ * cstraints.vec_cost_[j];
+
+  //-- Setup bounds for all the parameters
+  col_lb_ = Vec::Constant(NUMVAR, -kInfinity);
+  col_ub_ = Vec::Constant(NUMVAR, kInfinity);
+  for (int j = 0; j < NUMVAR && !cstraints.vec_bounds_.empty(); ++j)
+  {
+    // Same bound for all the parameters or each parameter have its own bounds
+    const std::pair<double, double> & bounds =
+      cstraints.vec_bounds_[(cstraints.vec_bounds_.size() == 1) ? 0 : j];
+    col_lb_[j] = ToInfinity(bounds.first);
+    col_ub_[j] = ToInfinity(bounds.second);
+  }
+
+  //-- Row bounds
+  row_lb_ = Vec::Constant(NUMROW, -kInfinity);
+  row_ub_ = Vec::Constant(NUMROW, kInfinity);
+  for (int i = 0; i < NUMROW; ++i)
+  {
+    const double b = cstraints.constraint_objective_(i);
+    if (cstraints.vec_sign_[i] == LP_Constraints::LP_EQUAL ||
+        cstraints.vec_sign_[i] == LP_Constraints::LP_LESS_OR_EQUAL)
+      row_ub_[i] = b;
+    if (cstraints.vec_sign_[i] == LP_Constraints::LP_EQUAL ||
+        cstraints.vec_sign_[i] == LP_Constraints::LP_GREATER_OR_EQUAL)
+      row_lb_[i] = b;
+  }
+
+  //-- Rescale the constraint matrix:
+  // - Ruiz equilibration (infinity norm of the rows and columns),
+  // - Pock-Chambolle equilibration (l1 norm of the rows and columns).
+  K_ = cstraints.constraint_mat_;
+  row_scale_ = Vec::Ones(NUMROW);
+  col_scale_ = Vec::Ones(NUMVAR);
+  for (int iteration = 0; iteration < 11; ++iteration)
+  {
+    const bool bRuiz = iteration < 10;
+    Vec row_norm = Vec::Zero(NUMROW), col_norm = Vec::Zero(NUMVAR);
+    for (int i = 0; i < NUMROW; ++i)
+    {
+      for (sRMat::InnerIterator it(K_, i); it; ++it)
+      {
+        const double value = std::abs(it.value());
+        if (bRuiz)
+        {
+          row_norm[i] = std::max(row_norm[i], value);
+          col_norm[it.col()] = std::max(col_norm[it.col()], value);
+        }
+        else
+        {
+          row_norm[i] += value;
+          col_norm[it.col()] += value;
+        }
+      }
+    }
+    const Vec row = row_norm.unaryExpr([](double v) { return v > 0.0 ? 1.0 / std::sqrt(v) : 1.0; });
+    const Vec col = col_norm.unaryExpr([](double v) { return v > 0.0 ? 1.0 / std::sqrt(v) : 1.0; });
+    Scale(row, col, K_);
+    row_scale_.array() *= row.array();
+    col_scale_.array() *= col.array();
+  }
+  Kt_ = K_.transpose();
+  c_.array() *= col_scale_.array();
+  col_lb_.array() /= col_scale_.array();
+  col_ub_.array() /= col_scale_.array();
+  row_lb_.array() *= row_scale_.array();
+  row_ub_.array() *= row_scale_.array();
+
+  //-- Warm start from the last iterates if the problem size is the same
+  if (x_.size() != NUMVAR || y_.size() != NUMROW)
+  {
+    x_ = Vec::Zero(NUMVAR);
+    y_ = Vec::Zero(NUMROW);
+    primal_weight_ = -1.0;
+  }
+  return true;
+}
+
+bool PDLP_SolverWrapper::solve()
+{
+  const int n = K_.cols(), m = K_.rows();
+  iterations_ = 0;
+  if (n == 0 || c_.size() != n)
+  {
+    OPENMVG_LOG_ERROR << "Cannot solve if no problem is setup";
+    return false;
+  }
+
+  // Projection of the dual variables: y_i >= 0 for a finite lower bound,
+  // y_i <= 0 for a finite upper bound, y_i free for an equality.
+  const auto projectDual = [](const double lo, const double hi) -> double
+  {
+    return (lo > 0.0) ? lo : ((hi < 0.0) ? hi : 0.0);
+  };
+
+  //-- Relative KKT error of the iterates (computed for the original problem)
+  const Vec col_lb = col_lb_.cwiseProduct(col_scale_), col_ub = col_ub_.cwiseProduct(col_scale_);
+  const Vec row_lb = row_lb_.cwiseQuotient(row_scale_), row_ub = row_ub_.cwiseQuotient(row_scale_);
+  const Vec c = c_.cwiseQuotient(col_scale_);
+  double b_norm = 0.0;
+  for (int i = 0; i < m; ++i)
+  {
+    const double b = std::isfinite(row_lb[i]) ? row_lb[i] : (std::isfinite(row_ub[i]) ? row_ub[i] : 0.0);
+    b_norm += b * b;
+  }
+  b_norm = std::sqrt(b_norm);
+  const double c_norm = c.norm();
+
+  // Dual objective part of the reduced costs (lambda) and the norm of the
+  //  reduced costs that are not compatible with the parameter bounds.
+  const auto reducedCosts = [&](const Vec & lambda, double & objective, double & violation)
+  {
+    objective = violation = 0.0;
+    for (int j = 0; j < n; ++j)
+    {
+      if (lambda[j] > 0.0)
+      {
+        if (std::isfinite(col_lb[j])) objective += lambda[j] * col_lb[j];
+        else violation += lambda[j] * lambda[j];
+      }
+      else if (lambda[j] < 0.0)
+      {
+        if (std::isfinite(col_ub[j])) objective += lambda[j] * col_ub[j];
+        else violation += lambda[j] * lambda[j];
+      }
+    }
+    violation = std::sqrt(violation);
+  };
+  // Dual objective part of the constraints
+  const auto rowsObjective = [&](const Vec & y, double & objective, double & violation)
+  {
+    objective = violation = 0.0;
+    for (int i = 0; i < m; ++i)
+    {
+      if (y[i] > 0.0)
+      {
+        if (std::isfinite(row_lb[i])) objective += y[i] * row_lb[i];
+        else violation += y[i] * y[i];
+      }
+      else if (y[i] < 0.0)
+      {
+        if (std::isfinite(row_ub[i])) objective += y[i] * row_ub[i];
+        else violation += y[i] * y[i];
+      }
+    }
+    violation = std::sqrt(violation);
+  };
+
+  Vec Kx(m), Kty(n);
+  const auto kktError = [&](const Vec & x_scaled, const Vec & y_scaled, bool & bConverged) -> double
+  {
+    Multiply(K_, x_scaled, Kx);
+    Multiply(Kt_, y_scaled, Kty);
+    const Vec x = x_scaled.cwiseProduct(col_scale_);
+    const Vec y = y_scaled.cwiseProduct(row_scale_);
+    // Primal residual
+    const Vec Ax = Kx.cwiseQuotient(row_scale_);
+    const double primal_residual =
+      (Ax - Ax.cwiseMax(row_lb).cwiseMin(row_ub)).norm() / (1.0 + b_norm);
+    // Dual residual
+    const Vec lambda = (c_ - Kty).cwiseQuotient(col_scale_);
+    double dual_objective, dual_residual, rows_objective, rows_violation;
+    reducedCosts(lambda, dual_objective, dual_residual);
+    rowsObjective(y, rows_objective, rows_violation);
+    dual_objective += rows_objective;
+    dual_residual /= (1.0 + c_norm);
+    // Duality gap
+    const double primal_objective = c.dot(x);
+    const double gap = std::abs(primal_objective - dual_objective)
+      / (1.0 + std::abs(primal_objective) + std::abs(dual_objective));
+
+    bConverged = primal_residual <= options_.tolerance
+      && dual_residual <= options_.tolerance
+      && gap <= options_.tolerance;
+    return std::sqrt(primal_residual * primal_residual
+      + dual_residual * dual_residual + gap * gap);
+  };
+
+  // Primal infeasibility certificate: a dual ray (y) with a positive dual
+  //  objective and with reduced costs compatible with the parameter bounds.
+  const auto isPrimalInfeasible = [&](const Vec & ray_scaled) -> bool
+  {
+    Vec Kt_ray;
+    Multiply(Kt_, ray_scaled, Kt_ray);
+    const Vec ray = ray_scaled.cwiseProduct(row_scale_);
+    double objective, violation, rows_objective, rows_violation;
+    reducedCosts(-Kt_ray.cwiseQuotient(col_scale_), objective, violation);
+    rowsObjective(ray, rows_objective, rows_violation);
+    objective += rows_objective;
+    violation += rows_violation;
+    return objective > 0.0 && violation <= 1e-8 * objective;
+  };
+
+  //-- Step size: the constraint matrix norm is estimated by power iterations
+  double K_norm = 0.0;
+  {
+    Vec v = Vec::Ones(n).normalized(), Kv(m), KtKv(n);
+    for (int k = 0; k < 50; ++k)
+    {
+      Multiply(K_, v, Kv);
+      Multiply(Kt_, Kv, KtKv);
+      K_norm = std::sqrt(KtKv.norm());
+      if (KtKv.norm() == 0.0)
+        break;
+      v = KtKv.normalized();
+    }
+  }
+  const double step_size = (K_norm > 0.0) ? 0.95 / (1.01 * K_norm) : 1.0;
+
+  if (primal_weight_ <= 0.0)
+  {
+    double row_bounds_norm = 0.0;
+    for (int i = 0; i < m; ++i)
+    {
+      const double b = std::isfinite(row_lb_[i]) ? row_lb_[i] : (std::isfinite(row_ub_[i]) ? row_ub_[i] : 0.0);
+      row_bounds_norm += b * b;
+    }
+    row_bounds_norm = std::sqrt(row_bounds_norm);
+    primal_weight_ = (c_.norm() > 1e-10 && row_bounds_norm > 1e-10) ?
+      c_.norm() / row_bounds_norm : 1.0;
+  }
+
+  //-- Initial iterates (warm start)
+  Vec x = x_.cwiseQuotient(col_scale_).cwiseMax(col_lb_).cwiseMin(col_ub_);
+  Vec y = y_.cwiseQuotient(row_scale_);
+  for (int i = 0; i < m; ++i)
+    y[i] = projectDual(
+      std::isfinite(row_lb_[i]) ? y[i] : -kInfinity,
+      std::isfinite(row_ub_[i]) ? y[i] : kInfinity);
+
+  bool bConverged = false;
+  double kkt_restart = kktError(x, y, bConverged);
+  if (bConverged)
+    return true;
+  // Best iterate (returned if the tolerance is not reached)
+  double kkt_best = kkt_restart;
+  Vec x_best = x, y_best = y;
+  double kkt_last_candidate = kInfinity;
+  Vec x_restart = x, y_restart = y;
+  Vec x_sum = Vec::Zero(n), y_sum = Vec::Zero(m);
+  int nb_average = 0, iteration_restart = 0;
+
+  Vec x_new(n), Kx_bar(m);
+  Multiply(Kt_, y, Kty);
+  for (int k = 1; k <= options_.max_iterations; ++k)
+  {
+    const double tau = step_size / primal_weight_;
+    const double sigma = step_size * primal_weight_;
+
+    //-- Primal-Dual Hybrid Gradient iteration
+    x_new = (x - tau * (c_ - Kty)).cwiseMax(col_lb_).cwiseMin(col_ub_);
+    Multiply(K_, 2.0 * x_new - x, Kx_bar);
+    for (int i = 0; i < m; ++i)
+    {
+      const double w = y[i] - sigma * Kx_bar[i];
+      y[i] = projectDual(w + sigma * row_lb_[i], w + sigma * row_ub_[i]);
+    }
+    x.swap(x_new);
+    Multiply(Kt_, y, Kty);
+    x_sum += x;
+    y_sum += y;
+    ++nb_average;
+    iterations_ = k;
+
+    if (k % 64 != 0 && k != options_.max_iterations)
+      continue;
+
+    //-- Check the convergence of the current and the average iterates
+    bool bConverged_average = false;
+    const Vec x_average = x_sum / nb_average, y_average = y_sum / nb_average;
+    const double kkt_average = kktError(x_average, y_average, bConverged_average);
+    const double kkt_current = kktError(x, y, bConverged);
+    Multiply(Kt_, y, Kty); // Kty was modified by kktError
+    if (bConverged || bConverged_average)
+    {
+      x_ = (bConverged ? x : x_average).cwiseProduct(col_scale_);
+      y_ = (bConverged ? y : y_average).cwiseProduct(row_scale_);
+      return true;
+    }
+    if (isPrimalInfeasible(y - y_restart))
+    {
+      x_ = x.cwiseProduct(col_scale_);
+      y_ = Vec::Zero(m);
+      return false;
+    }
+
+    //-- Adaptive restart to the best candidate
+    const bool bAverage = kkt_average < kkt_current;
+    const double kkt_candidate = bAverage ? kkt_average : kkt_current;
+    if (kkt_candidate < kkt_best)
+    {
+      kkt_best = kkt_candidate;
+      x_best = bAverage ? x_average : x;
+      y_best = bAverage ? y_average : y;
+    }
+    if (kkt_candidate <= 0.2 * kkt_restart
+        || (kkt_candidate <= 0.8 * kkt_restart && kkt_candidate > kkt_last_candidate)
+        || (k - iteration_restart) >= 0.36 * k)
+    {
+      if (bAverage)
+      {
+        x = x_average;
+        y = y_average;
+        Multiply(Kt_, y, Kty);
+      }
+      // Primal weight update (balance the primal and dual distances)
+      const double delta_x = (x - x_restart).norm(), delta_y = (y - y_restart).norm();
+      if (delta_x > 1e-10 && delta_y > 1e-10)
+        primal_weight_ = std::exp(0.5 * std::log(delta_y / delta_x) + 0.5 * std::log(primal_weight_));
+      x_restart = x;
+      y_restart = y;
+      x_sum.setZero();
+      y_sum.setZero();
+      nb_average = 0;
+      iteration_restart = k;
+      kkt_restart = kkt_candidate;
+      kkt_last_candidate = kInfinity;
+    }
+    else
+    {
+      kkt_last_candidate = kkt_candidate;
+    }
+  }
+  // The tolerance is not reached: keep the best iterate (for a warm start)
+  x_ = x_best.cwiseProduct(col_scale_);
+  y_ = y_best.cwiseProduct(row_scale_);
+  if (!options_.best_iterate_on_iteration_cap)
+  {
+    // Feasibility query: the feasibility is not proven
+    OPENMVG_LOG_INFO << "PDLP: the tolerance (" << options_.tolerance
+      << ") is not reached after " << options_.max_iterations
+      << " iterations, the problem is considered infeasible.";
+    return false;
+  }
+  OPENMVG_LOG_WARNING << "PDLP: the tolerance (" << options_.tolerance
+    << ") is not reached after " << options_.max_iterations
+    << " iterations, the best iterate (relative KKT error: " << kkt_best << ") is used.";
+  return true;
+}
+
+bool PDLP_SolverWrapper::getSolution(std::vector<double> & estimatedParams)
+{
+  if (x_.size() == 0)
+  {
+    OPENMVG_LOG_ERROR << "Cannot get the solution if no problem is solved";
+    return false;
+  }
+  if (estimatedParams.size() < static_cast<size_t>(x_.size()))
+    estimatedParams.resize(x_.size());
+  std::copy(x_.data(), x_.data() + x_.size(), estimatedParams.begin());
+  return true;
+}
+
+} // namespace linearProgramming
+} // namespace openMVG
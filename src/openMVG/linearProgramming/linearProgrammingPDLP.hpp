@@ -0,0 +1,93 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_LINEAR_PROGRAMMING_LINEAR_PROGRAMMING_PDLP_HPP
+#define OPENMVG_LINEAR_PROGRAMMING_LINEAR_PROGRAMMING_PDLP_HPP
+
+#include <vector>
+
+#include "openMVG/linearProgramming/linearProgrammingInterface.hpp"
+
+//------------------
+//-- Bibliography --
+//------------------
+//- [1] "Practical Large-Scale Linear Programming using Primal-Dual Hybrid Gradient."
+//- Authors: David Applegate, Mateo Diaz, Oliver Hinder, Haihao Lu, Miles Lubin,
+//-  Brendan O'Donoghue and Warren Schudy.
+//- Date: 2021.
+//- Conference: NeurIPS.
+
+namespace openMVG   {
+namespace linearProgramming  {
+
+/// First order LP solver for the LP_Solver interface (PDLP [1]).
+/// The LP is solved by restarted Primal-Dual Hybrid Gradient iterations:
+///  - the constraint matrix is never factorized (only sparse matrix-vector
+///    products, computed in parallel),
+///  - the problem is rescaled (Ruiz and Pock-Chambolle equilibration),
+///  - the iterates are restarted adaptively and the primal weight is updated
+///    at each restart.
+/// The last iterates are kept across the setup() calls: if the next problem
+/// has the same size (i.e. the BisectionLP steps), it is warm-started.
+/// solve() returns false if the problem is proven infeasible. If the
+/// tolerance is not reached within the maximum number of iterations, the best
+/// iterate found (smallest KKT error) is kept and a warning is logged: solve()
+/// returns true for a single LP, false for a feasibility query (see Options).
+class PDLP_SolverWrapper : public LP_Solver
+{
+public:
+  struct Options
+  {
+    int max_iterations = 100000;
+    // Relative tolerance over the primal residual, dual residual and duality gap
+    // (a first order solver is not meant to reach the simplex accuracy)
+    double tolerance = 1e-6;
+    // If true, the best iterate is used as the solution if the maximum number
+    // of iterations is reached. Must be false for the feasibility queries
+    // (BisectionLP): an infeasibility that is not detected yet must not be
+    // reported as a feasible gamma.
+    bool best_iterate_on_iteration_cap = true;
+  };
+
+  explicit PDLP_SolverWrapper(int nbParams);
+  PDLP_SolverWrapper(int nbParams, const Options & options);
+
+  //--
+  // Inherited functions:
+  //--
+
+  bool setup(const LP_Constraints & constraints) override;
+  bool setup(const LP_Constraints_Sparse & constraints) override;
+
+  bool solve() override;
+
+  bool getSolution(std::vector<double> & estimatedParams) override;
+
+  /// Number of iterations of the last solve() call
+  int iterations() const { return iterations_; }
+
+private:
+  Options options_;
+
+  // Rescaled problem:
+  //  min c'x, s.t. row_lb <= K x <= row_ub, col_lb <= x <= col_ub
+  sRMat K_, Kt_;
+  Vec c_, row_lb_, row_ub_, col_lb_, col_ub_;
+  Vec row_scale_, col_scale_; // K_ = diag(row_scale_) * A * diag(col_scale_)
+  double objective_sign_;
+
+  // Last iterates (in the original problem space)
+  Vec x_, y_;
+  double primal_weight_;
+  int iterations_;
+};
+
+} // namespace linearProgramming
+} // namespace openMVG
+
+#endif // OPENMVG_LINEAR_PROGRAMMING_LINEAR_PROGRAMMING_PDLP_HPP
@@ -10,6 +10,7 @@
 #include "testing/testing.h"
 
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
+#include "openMVG/linearProgramming/linearProgrammingPDLP.hpp"
 
 #include <algorithm>
 #include <limits>
@@ -149,6 +150,92 @@ TEST(linearProgramming, osiclp_sparse_sample) {
   EXPECT_NEAR( 8.33, vec_solution[3], 1e-2);
 }
 
+TEST(linearProgramming, pdlp_dense_sample) {
+
+  LP_Constraints cstraint;
+  BuildLinearProblem(cstraint);
+
+  //Solve
+  std::vector<double> vec_solution(2);
+  PDLP_SolverWrapper solver(2);
+  solver.setup(cstraint);
+
+  EXPECT_TRUE(solver.solve());
+  solver.getSolution(vec_solution);
+
+  EXPECT_NEAR( 21.875000, vec_solution[0], 1e-4);
+  EXPECT_NEAR( 53.125000, vec_solution[1], 1e-4);
+}
+
+TEST(linearProgramming, pdlp_sparse_sample) {
+
+  LP_Constraints_Sparse cstraint;
+  BuildSparseLinearProblem(cstraint);
+
+  //Solve
+  std::vector<double> vec_solution(4);
+  PDLP_SolverWrapper solver(4);
+  solver.setup(cstraint);
+
+  EXPECT_TRUE(solver.solve());
+  solver.getSolution(vec_solution);
+
+  EXPECT_NEAR( 0.00, vec_solution[0], 1e-2);
+  EXPECT_NEAR( 0.00, vec_solution[1], 1e-2);
+  EXPECT_NEAR( 15, vec_solution[2], 1e-2);
+  EXPECT_NEAR( 8.33, vec_solution[3], 1e-2);
+
+  // Warm start: the same problem is solved again from the last iterates
+  const int iterations = solver.iterations();
+  solver.setup(cstraint);
+  EXPECT_TRUE(solver.solve());
+  EXPECT_TRUE(solver.iterations() <= iterations);
+}
+
+TEST(linearProgramming, pdlp_iteration_cap) {
+
+  LP_Constraints_Sparse cstraint;
+  BuildSparseLinearProblem(cstraint);
+
+  // The best iterate is returned if the tolerance is not reached
+  PDLP_SolverWrapper::Options options;
+  options.max_iterations = 64;
+  options.tolerance = 1e-12;
+  PDLP_SolverWrapper solver(4, options);
+  solver.setup(cstraint);
+
+  EXPECT_TRUE(solver.solve());
+  EXPECT_EQ(64, solver.iterations());
+  std::vector<double> vec_solution;
+  EXPECT_TRUE(solver.getSolution(vec_solution));
+  EXPECT_EQ(4, vec_solution.size());
+
+  // A feasibility query does not report a feasibility that is not proven
+  options.best_iterate_on_iteration_cap = false;
+  PDLP_SolverWrapper feasibility_solver(4, options);
+  feasibility_solver.setup(cstraint);
+  EXPECT_FALSE(feasibility_solver.solve());
+  EXPECT_EQ(64, feasibility_solver.iterations());
+}
+
+TEST(linearProgramming, pdlp_infeasible) {
+
+  // x >= 2 and x <= 1
+  LP_Constraints cstraint;
+  cstraint.nbParams_ = 1;
+  cstraint.bminimize_ = true;
+  cstraint.vec_cost_ = {1.0};
+  cstraint.constraint_mat_ = Mat(2,1);
+  cstraint.constraint_mat_ << 1, 1;
+  cstraint.constraint_objective_ = Vec2(2, 1);
+  cstraint.vec_sign_ = {LP_Constraints::LP_GREATER_OR_EQUAL, LP_Constraints::LP_LESS_OR_EQUAL};
+  cstraint.vec_bounds_ = {{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max()}};
+
+  PDLP_SolverWrapper solver(1);
+  solver.setup(cstraint);
+  EXPECT_FALSE(solver.solve());
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
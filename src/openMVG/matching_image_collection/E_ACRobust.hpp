@@ -21,7 +21,7 @@
 #include "openMVG/multiview/essential.hpp"
 #include "openMVG/robust_estimation/robust_estimator_ACRansac.hpp"
 #include "openMVG/robust_estimation/robust_estimator_ACRansacKernelAdaptator.hpp"
-#include "openMVG/robust_estimation/guided_matching.hpp"
+#include "openMVG/robust_estimation/guided_matching_grid.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/system/logger.hpp"
@@ -200,7 +200,7 @@ struct GeometricFilter_EMatrix_AC
         regionsI = regions_provider->get(iIndex),
         regionsJ = regions_provider->get(jIndex);
 
-      geometry_aware::GuidedMatching<
+      geometry_aware::GuidedMatching_Grid<
         Mat3,
         openMVG::fundamental::kernel::EpipolarDistanceError>(
           //openMVG::fundamental::kernel::SymmetricEpipolarDistanceError>(
@@ -17,7 +17,7 @@
 #include "openMVG/matching_image_collection/Geometric_Filter_utils.hpp"
 #include "openMVG/multiview/essential.hpp"
 #include "openMVG/multiview/solver_fundamental_kernel.hpp"
-#include "openMVG/robust_estimation/guided_matching.hpp"
+#include "openMVG/robust_estimation/guided_matching_grid.hpp"
 #include "openMVG/robust_estimation/robust_estimator_ACRansac.hpp"
 #include "openMVG/robust_estimation/robust_estimator_ACRansacKernelAdaptator.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
@@ -137,7 +137,7 @@ struct GeometricFilter_FMatrix_AC
         regionsJ = regions_provider->get(jIndex);
 
       // Check the features correspondences that agree in the geometric and photometric domain
-      geometry_aware::GuidedMatching<
+      geometry_aware::GuidedMatching_Grid<
         Mat3,
         openMVG::fundamental::kernel::EpipolarDistanceError>(
           //openMVG::fundamental::kernel::SymmetricEpipolarDistanceError>(
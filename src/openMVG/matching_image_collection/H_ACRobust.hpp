@@ -18,6 +18,7 @@
 #include "openMVG/matching_image_collection/Geometric_Filter_utils.hpp"
 #include "openMVG/multiview/solver_homography_kernel.hpp"
 #include "openMVG/robust_estimation/guided_matching.hpp"
+#include "openMVG/robust_estimation/guided_matching_grid.hpp"
 #include "openMVG/robust_estimation/robust_estimator_ACRansac.hpp"
 #include "openMVG/robust_estimation/robust_estimator_ACRansacKernelAdaptator.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
@@ -188,7 +189,7 @@ struct GeometricFilter_HMatrix_AC
       else
       {
         // Filtering based on region positions and regions descriptors
-        geometry_aware::GuidedMatching<
+        geometry_aware::GuidedMatching_Grid<
           Mat3,
           openMVG::homography::kernel::AsymmetricError>(
             m_H,
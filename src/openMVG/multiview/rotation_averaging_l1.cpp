@@ -185,7 +185,10 @@ unsigned int FilterRelativeRotations(
   assert(threshold >= 0);
   // compute errors for each relative rotation
   std::vector<float> errors(RelRs.size());
-  for (size_t r= 0; r<RelRs.size(); ++r) {
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < static_cast<int>(RelRs.size()); ++r) {
     const RelativeRotation& relR = RelRs[r];
     const Matrix3x3& Ri = Rs[relR.i];
     const Matrix3x3& Rj = Rs[relR.j];
@@ -243,7 +246,10 @@ double RelRotationAvgError
   return boost::accumulators::mean(acc);
 #else
   std::vector<double> vec_err(RelRs.size(), 0.0);
-  for (size_t i=0; i < RelRs.size(); ++i) {
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int i = 0; i < static_cast<int>(RelRs.size()); ++i) {
     const RelativeRotation& relR = RelRs[i];
     vec_err[i] = openMVG::FrobeniusNorm(relR.Rij  - (Rs[relR.j]*Rs[relR.i].transpose()));
   }
@@ -365,7 +371,10 @@ inline void FillErrorMatrix(
   const Matrix3x3Arr& Rs,
   Vec & b)
 {
-  for (size_t r = 0; r < RelRs.size(); ++r) {
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < static_cast<int>(RelRs.size()); ++r) {
     const RelativeRotation& relR = RelRs[r];
     const Matrix3x3& Ri = Rs[relR.i];
     const Matrix3x3& Rj = Rs[relR.j];
@@ -383,11 +392,14 @@ inline void CorrectMatrix(
   const uint32_t nMainViewID,
   Matrix3x3Arr& Rs)
 {
-  for (size_t r = 0; r < Rs.size(); ++r) {
-    if (r == nMainViewID)
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < static_cast<int>(Rs.size()); ++r) {
+    if (r == static_cast<int>(nMainViewID))
       continue;
     Matrix3x3& Ri = Rs[r];
-    const uint32_t i = (r<nMainViewID ? r : r-1);
+    const uint32_t i = (static_cast<uint32_t>(r)<nMainViewID ? r : r-1);
     const openMVG::Vec3 eRid = openMVG::Vec3(x.block<3,1>(3*i,0));
     const Mat3 eRi;
     ceres::AngleAxisToRotationMatrix((const double*)eRid.data(), (double*)eRi.data());
@@ -395,6 +407,38 @@ inline void CorrectMatrix(
   }
 }
 
+// build the weighted normal matrix At * diag(weights) * A of the mapping matrix
+//  directly from the relative rotations (A blocks are +/- identity matrices)
+inline void FillWeightedNormalMatrix(
+  const RelativeRotations& RelRs,
+  const uint32_t nMainViewID,
+  const Eigen::ArrayXd & weights,
+  sMat& AtWA)
+{
+  // 12 entries per relative rotation, the ones related to the main view are
+  //  replaced by explicit zeros on an existing diagonal entry
+  std::vector<Eigen::Triplet<double>> tripletList(RelRs.size() * 12);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < static_cast<int>(RelRs.size()); ++r) {
+    const RelativeRotation& relR = RelRs[r];
+    const bool bI = relR.i != nMainViewID, bJ = relR.j != nMainViewID;
+    const sMat::Index i = 3*(relR.i<nMainViewID ? relR.i : relR.i-1);
+    const sMat::Index j = 3*(relR.j<nMainViewID ? relR.j : relR.j-1);
+    const sMat::Index d = bI ? i : j; // an existing diagonal entry
+    Eigen::Triplet<double> * triplet = &tripletList[12 * r];
+    for (int k = 0; k < 3; ++k) {
+      const double w = weights(3*r+k);
+      *triplet++ = bI ? Eigen::Triplet<double>(i+k, i+k, w) : Eigen::Triplet<double>(d+k, d+k, 0.0);
+      *triplet++ = bJ ? Eigen::Triplet<double>(j+k, j+k, w) : Eigen::Triplet<double>(d+k, d+k, 0.0);
+      *triplet++ = (bI && bJ) ? Eigen::Triplet<double>(i+k, j+k, -w) : Eigen::Triplet<double>(d+k, d+k, 0.0);
+      *triplet++ = (bI && bJ) ? Eigen::Triplet<double>(j+k, i+k, -w) : Eigen::Triplet<double>(d+k, d+k, 0.0);
+    }
+  }
+  AtWA.setFromTriplets(tripletList.begin(), tripletList.end());
+}
+
 // L1RA -> L1 Rotation Averaging implementation
 bool SolveL1RA
 (
@@ -459,8 +503,11 @@ bool SolveIRLS
   //  compute it once to speed up the solution time.
   using Linear_Solver_T = Eigen::SimplicialLDLT<sMat>;
 
+  sMat AtWA(n, n);
+  FillWeightedNormalMatrix(RelRs, nMainViewID, Eigen::ArrayXd::Ones(m), AtWA);
+
   Linear_Solver_T linear_solver;
-  linear_solver.analyzePattern(A.transpose() * A);
+  linear_solver.analyzePattern(AtWA);
   if (linear_solver.info() != Eigen::Success) {
     OPENMVG_LOG_ERROR << "Cholesky decomposition failed.";
     return false;
@@ -486,15 +533,15 @@ bool SolveIRLS
     weights = sigmaSq / (errors.square() + sigmaSq).square();
 
     // Update the factorization for the weighted values
-    const sMat at_weight = A.transpose() * weights.matrix().asDiagonal();
-    linear_solver.factorize(at_weight * A);
+    FillWeightedNormalMatrix(RelRs, nMainViewID, weights, AtWA);
+    linear_solver.factorize(AtWA);
     if (linear_solver.info() != Eigen::Success) {
       OPENMVG_LOG_ERROR << "Failed to factorize the least squares system.";
       return false;
     }
 
     // Solve the least squares problem
-    x = linear_solver.solve(at_weight * b);
+    x = linear_solver.solve(A.transpose() * (weights * b.array()).matrix());
     if (linear_solver.info() != Eigen::Success) {
       OPENMVG_LOG_ERROR << "Failed to solve the least squares system.";
       return false;
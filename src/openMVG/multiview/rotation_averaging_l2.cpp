@@ -15,6 +15,10 @@
 #include <ceres/ceres.h>
 #include <ceres/rotation.h>
 
+#include <Eigen/SparseCholesky>
+
+#include <random>
+
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
 #endif
@@ -61,6 +65,89 @@ bool compare_first_abs(std::pair<double, Vec> const &x, std::pair<double, Vec> c
  return std::abs(x.first) < std::abs(y.first);
 }
 
+// Above this number of camera the eigen vectors are computed with the sparse
+//  iterative solver (the dense solver is O(n^3) in time and O(n^2) in memory).
+static const size_t kMaxDenseCamera = 1000;
+
+// Build the AtA matrix of the (3 * m) x (3 * n) linear system
+//  => wij * (R_j - R_{i,j} * R_i) = 0
+// directly from its 3x3 blocks:
+//  AtA(i,i) += wij^2 * R_{i,j}^T * R_{i,j}
+//  AtA(j,j) += wij^2 * Id
+//  AtA(i,j) -= wij^2 * R_{i,j}^T
+//  AtA(j,i) -= wij^2 * R_{i,j}
+static sMat BuildAtA
+(
+  size_t nCamera,
+  const RelativeRotations& vec_relativeRot
+)
+{
+  std::vector<Eigen::Triplet<double>> tripletList(vec_relativeRot.size() * 30);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int cpt = 0; cpt < static_cast<int>(vec_relativeRot.size()); ++cpt)
+  {
+    const RelativeRotation & rel = vec_relativeRot[cpt];
+    const int i = 3 * static_cast<int>(rel.i);
+    const int j = 3 * static_cast<int>(rel.j);
+    const double w2 = rel.weight * rel.weight;
+    const Mat3 RtR = rel.Rij.transpose() * rel.Rij * w2;
+    Eigen::Triplet<double> * triplet = &tripletList[30 * cpt];
+    for (int r = 0; r < 3; ++r)
+    {
+      *triplet++ = {j + r, j + r, w2};
+      for (int c = 0; c < 3; ++c)
+      {
+        *triplet++ = {i + r, i + c, RtR(r, c)};
+        *triplet++ = {i + r, j + c, - w2 * rel.Rij(c, r)};
+        *triplet++ = {j + r, i + c, - w2 * rel.Rij(r, c)};
+      }
+    }
+  }
+  sMat AtA(3 * nCamera, 3 * nCamera);
+  AtA.setFromTriplets(tripletList.begin(), tripletList.end());
+  return AtA;
+}
+
+// Compute the global rotations from the 3 eigen vectors spanning the
+//  approximated nullspace of AtA.
+static void NullspaceToRotations
+(
+  size_t nCamera,
+  const Vec & NullspaceVector0,
+  const Vec & NullspaceVector1,
+  const Vec & NullspaceVector2,
+  std::vector<Mat3> & global_rotations
+)
+{
+  //--
+  // Search the closest matrix :
+  //  - From solution of SVD get back column and reconstruct Rotation matrix
+  //  - Enforce the orthogonality constraint
+  //     (approximate rotation in the Frobenius norm using SVD).
+  //--
+  global_rotations.resize(nCamera);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int i = 0; i < static_cast<int>(nCamera); ++i)
+  {
+    Mat3 Rotation;
+    Rotation << NullspaceVector0.segment(3 * i, 3),
+                NullspaceVector1.segment(3 * i, 3),
+                NullspaceVector2.segment(3 * i, 3);
+
+    //-- Compute the closest SVD rotation matrix
+    global_rotations[i] = ClosestSVDRotationMatrix(Rotation);
+  }
+  // Force R0 to be Identity
+  const Mat3 R0T = global_rotations[0].transpose();
+  for (size_t i = 0; i < nCamera; ++i) {
+    global_rotations[i] *= R0T;
+  }
+}
+
 //-- Solve the Global Rotation matrix registration for each camera given a list
 //    of relative orientation using matrix parametrization
 //    [1] formula 6.62 page 100. Dense formulation.
@@ -90,6 +177,8 @@ bool compare_first_abs(std::pair<double, Vec> const &x, std::pair<double, Vec> c
 // => m = #R_{i,j} => the number of relative rotations.
 // => n => the number of view (camera)
 //
+// Large problems are forwarded to the sparse formulation.
+//
 bool L2RotationAveraging
 (
   size_t nCamera,
@@ -98,49 +187,13 @@ bool L2RotationAveraging
   std::vector<Mat3> & global_rotations
 )
 {
-  const size_t nRotationEstimation = vec_relativeRot.size();
-  //--
-  // Setup the Action Matrix
-  //--
-  std::vector<Eigen::Triplet<double>> tripletList;
-  tripletList.reserve(nRotationEstimation*12); // 3*3 + 3
-  //-- Encode constraint (6.62 Martinec Thesis page 100):
-  sMat::Index cpt = 0;
-  for (const auto & iter : vec_relativeRot)
+  if (nCamera > kMaxDenseCamera)
   {
-    //-- Encode weight * ( rj - Rij * ri ) = 0
-    const sMat::Index i = iter.i;
-    const sMat::Index j = iter.j;
-
-    // A.block<3,3>(3 * cpt, 3 * i) = - Rij * weight;
-    tripletList.emplace_back(3 * cpt, 3 * i, - iter.Rij(0,0) * iter.weight);
-    tripletList.emplace_back(3 * cpt, 3 * i + 1, - iter.Rij(0,1) * iter.weight);
-    tripletList.emplace_back(3 * cpt, 3 * i + 2, - iter.Rij(0,2) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * i, - iter.Rij(1,0) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * i + 1, - iter.Rij(1,1) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * i + 2, - iter.Rij(1,2) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * i, - iter.Rij(2,0) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * i + 1, - iter.Rij(2,1) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * i + 2, - iter.Rij(2,2) * iter.weight);
-
-    // A.block<3,3>(3 * cpt, 3 * j) = Id * weight;
-    tripletList.emplace_back(3 * cpt, 3 * j, iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * j + 1, iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * j + 2, iter.weight);
-    ++cpt;
+    return L2RotationAveraging_Sparse(nCamera, vec_relativeRot, global_rotations);
   }
 
   // nCamera * 3 because each columns have 3 elements.
-  Mat AtA(3*nCamera,3*nCamera);
-  {
-    sMat A(nRotationEstimation*3, 3*nCamera);
-    A.setFromTriplets(tripletList.begin(), tripletList.end());
-    tripletList.clear();
-    tripletList.shrink_to_fit();
-
-    const sMat AtAsparse = A.transpose() * A;
-    AtA = Mat(AtAsparse); // convert to dense
-  }
+  const Mat AtA = Mat(BuildAtA(nCamera, vec_relativeRot)); // convert to dense
 
   // Solve Ax=0 => eigen vectors
   Eigen::SelfAdjointEigenSolver<Mat> es(AtA, Eigen::ComputeEigenvectors);
@@ -159,34 +212,114 @@ bool L2RotationAveraging
     }
     std::stable_sort(eigs.begin(), eigs.end(), &compare_first_abs);
 
-    const Vec & NullspaceVector0 = eigs[0].second;
-    const Vec & NullspaceVector1 = eigs[1].second;
-    const Vec & NullspaceVector2 = eigs[2].second;
-
-    //--
-    // Search the closest matrix :
-    //  - From solution of SVD get back column and reconstruct Rotation matrix
-    //  - Enforce the orthogonality constraint
-    //     (approximate rotation in the Frobenius norm using SVD).
-    //--
-    global_rotations.clear();
-    global_rotations.reserve(nCamera);
-    for (size_t i=0; i < nCamera; ++i)
+    NullspaceToRotations(nCamera, eigs[0].second, eigs[1].second, eigs[2].second,
+      global_rotations);
+  }
+  return true;
+}
+
+//-- Sparse formulation of L2RotationAveraging.
+// The 3 eigen vectors of the smallest eigen values of AtA are computed by a
+//  shifted inverse subspace iteration:
+//  - AtA + shift * Id is factorized once with a sparse Cholesky (LDLT),
+//  - a small block of vectors is repeatedly solved against the factorization
+//     and orthonormalized,
+//  - a Rayleigh-Ritz projection extracts the eigen pairs of the block.
+// Since the nullspace eigen values are close to 0 and the shift is small,
+//  the block converges in a few iterations.
+bool L2RotationAveraging_Sparse
+(
+  size_t nCamera,
+  const RelativeRotations& vec_relativeRot,
+  // Output
+  std::vector<Mat3> & global_rotations
+)
+{
+  const sMat AtA = BuildAtA(nCamera, vec_relativeRot);
+  const Mat::Index n = AtA.cols();
+  // Some extra vectors speed up the convergence of the 3 smallest ones
+  const Mat::Index block_size = std::min<Mat::Index>(n, 8);
+  if (n < 3)
+  {
+    return false;
+  }
+
+  const double scale = Vec(AtA.diagonal()).cwiseAbs().maxCoeff();
+  if (scale <= 0.0)
+  {
+    return false;
+  }
+
+  // Factorize the shifted matrix (AtA is singular)
+  sMat shifted = AtA;
+  for (Mat::Index i = 0; i < n; ++i)
+  {
+    shifted.coeffRef(i, i) += scale * 1e-8;
+  }
+  Eigen::SimplicialLDLT<sMat> ldlt(shifted);
+  if (ldlt.info() != Eigen::Success)
+  {
+    OPENMVG_LOG_ERROR << "Cholesky decomposition failed.";
+    return false;
+  }
+
+  // Random orthonormal starting block
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<double> distribution;
+  Mat X(n, block_size);
+  for (Mat::Index k = 0; k < X.size(); ++k)
+  {
+    X.data()[k] = distribution(random_generator);
+  }
+  {
+    const Eigen::HouseholderQR<Mat> qr(X);
+    X = qr.householderQ() * Mat::Identity(n, block_size);
+  }
+
+  Mat Y(n, block_size);
+  Vec eigen_values;
+  bool b_converged = false;
+  for (int iter = 0; iter < 100 && !b_converged; ++iter)
+  {
+    // Inverse iteration: each column is solved independently
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int k = 0; k < static_cast<int>(block_size); ++k)
     {
-      Mat3 Rotation;
-      Rotation << NullspaceVector0.segment(3 * i, 3),
-                  NullspaceVector1.segment(3 * i, 3),
-                  NullspaceVector2.segment(3 * i, 3);
+      Y.col(k) = ldlt.solve(X.col(k));
+    }
+    {
+      const Eigen::HouseholderQR<Mat> qr(Y);
+      X = qr.householderQ() * Mat::Identity(n, block_size);
+    }
 
-      //-- Compute the closest SVD rotation matrix
-      global_rotations.emplace_back(ClosestSVDRotationMatrix(Rotation));
+    // Rayleigh-Ritz projection (eigen values are sorted in increasing order)
+    Y = AtA * X;
+    const Mat H = X.transpose() * Y;
+    const Eigen::SelfAdjointEigenSolver<Mat> es(0.5 * (H + H.transpose()));
+    if (es.info() != Eigen::Success)
+    {
+      return false;
     }
-    // Force R0 to be Identity
-    const Mat3 R0T = global_rotations[0].transpose();
-    for (size_t i = 0; i < nCamera; ++i) {
-      global_rotations[i] *= R0T;
+    X = X * es.eigenvectors();
+    Y = Y * es.eigenvectors();
+    eigen_values = es.eigenvalues();
+
+    // Check the residuals of the 3 smallest eigen pairs
+    b_converged = true;
+    for (int k = 0; k < 3; ++k)
+    {
+      const double residual = (Y.col(k) - eigen_values(k) * X.col(k)).norm();
+      b_converged &= residual <= scale * 1e-10;
     }
   }
+  if (!b_converged)
+  {
+    OPENMVG_LOG_WARNING << "The sparse eigen solver did not fully converge.";
+  }
+
+  NullspaceToRotations(nCamera, X.col(0), X.col(1), X.col(2), global_rotations);
   return true;
 }
 
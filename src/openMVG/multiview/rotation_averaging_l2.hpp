@@ -63,6 +63,15 @@ bool L2RotationAveraging( size_t nCamera,
   // Output
   std::vector<Mat3> & vec_ApprRotMatrix);
 
+// Sparse formulation of L2RotationAveraging, used for large view graphs.
+// The nullspace of the system is approximated by an inverse subspace iteration
+//  on the sparse normal matrix, so memory stays linear in the number of relative
+//  rotations. L2RotationAveraging forwards to it for large problems.
+bool L2RotationAveraging_Sparse( size_t nCamera,
+  const RelativeRotations& vec_relativeRot,
+  // Output
+  std::vector<Mat3> & vec_ApprRotMatrix);
+
 // None linear refinement of the rotation using an angle-axis representation
 bool L2RotationAveraging_Refine(
   const RelativeRotations & vec_relativeRot,
@@ -17,6 +17,7 @@
 #include <iostream>
 #include <iterator>
 #include <numeric>
+#include <random>
 #include <vector>
 
 using namespace openMVG;
@@ -377,6 +378,48 @@ TEST ( rotation_averaging, RefineRotationsAvgL1IRLS_CompleteGraph_outliers)
   }
 }
 
+// The sparse solver must give the dense solution on a noisy graph
+TEST ( rotation_averaging, RotationLeastSquare_Sparse_NoisyGraph)
+{
+  const int iNviews = 40;
+  const NViewDataSet d = NRealisticCamerasRing(iNviews, 5,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  // Link each camera to the three next ones with noisy relative rotations
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<double> noise(0.0, D2R(1.0));
+  RelativeRotations vec_relativeRotEstimate;
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    for (size_t k = 1; k <= 3; ++k)
+    {
+      const size_t index0 = i;
+      const size_t index1 = (i+k)%iNviews;
+      Mat3 Rrel;
+      Vec3 trel;
+      RelativeCameraMotion(d._R[index0], d._t[index0], d._R[index1], d._t[index1], &Rrel, &trel);
+      Rrel = RotationAroundX(noise(random_generator))
+        * RotationAroundY(noise(random_generator)) * Rrel;
+      vec_relativeRotEstimate.emplace_back(index0, index1, Rrel, 1.0 + 0.1 * k);
+    }
+  }
+
+  std::vector<Mat3> vec_globalR_dense, vec_globalR_sparse;
+  EXPECT_TRUE(L2RotationAveraging(iNviews, vec_relativeRotEstimate, vec_globalR_dense));
+  EXPECT_TRUE(L2RotationAveraging_Sparse(iNviews, vec_relativeRotEstimate, vec_globalR_sparse));
+  EXPECT_EQ(iNviews, vec_globalR_sparse.size());
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    EXPECT_NEAR(0.0, FrobeniusDistance(vec_globalR_dense[i], vec_globalR_sparse[i]), 1e-8);
+    // The solution is close to the ground truth
+    Mat3 Rrel_gt, Rrel;
+    Vec3 trel;
+    RelativeCameraMotion(d._R[0], Vec3::Zero(), d._R[i], Vec3::Zero(), &Rrel_gt, &trel);
+    RelativeCameraMotion(vec_globalR_sparse[0], Vec3::Zero(), vec_globalR_sparse[i], Vec3::Zero(), &Rrel, &trel);
+    EXPECT_NEAR(0.0, FrobeniusDistance(Rrel_gt, Rrel), 0.05);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
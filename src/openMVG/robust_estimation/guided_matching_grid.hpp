@@ -0,0 +1,418 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_ROBUST_ESTIMATION_GUIDED_MATCHING_GRID_HPP
+#define OPENMVG_ROBUST_ESTIMATION_GUIDED_MATCHING_GRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <typeinfo>
+#include <vector>
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/features/regions.hpp"
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/matching/metric.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/multiview/solver_homography_kernel.hpp"
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/robust_estimation/guided_matching.hpp"
+
+namespace openMVG{
+namespace geometry_aware{
+
+/// Spatial index of 2D feature positions.
+/// The positions are binned in a uniform grid of square cells; the features
+/// of a cell are stored contiguously (CSR layout) by increasing index.
+/// A grid can be built once per view and used by all the pairs of the view.
+class Feature_Grid
+{
+public:
+  Feature_Grid() = default;
+
+  /**
+  * @brief Build the grid
+  * @param positions Feature positions
+  * @param cell_size Size of a cell (pixels). If <= 0, a size that gives
+  *  about 4 features per cell is used.
+  */
+  explicit Feature_Grid
+  (
+    std::vector<Vec2> positions,
+    double cell_size = 0.0
+  ):
+    positions_(std::move(positions))
+  {
+    if (positions_.empty())
+      return;
+    Vec2 min_pt = positions_[0], max_pt = positions_[0];
+    for (const Vec2 & pt : positions_)
+    {
+      min_pt = min_pt.cwiseMin(pt);
+      max_pt = max_pt.cwiseMax(pt);
+    }
+    if (cell_size <= 0.0)
+    {
+      const Vec2 extent = (max_pt - min_pt).cwiseMax(Vec2(1., 1.));
+      cell_size = std::max(1.0, 2.0 * std::sqrt(extent.prod() / positions_.size()));
+    }
+    origin_ = min_pt;
+    cell_size_ = cell_size;
+    cols_ = static_cast<int>((max_pt.x() - min_pt.x()) / cell_size_) + 1;
+    rows_ = static_cast<int>((max_pt.y() - min_pt.y()) / cell_size_) + 1;
+
+    // Counting sort of the features by cell
+    std::vector<IndexT> cells(positions_.size());
+    cell_offsets_.assign(static_cast<size_t>(cols_) * rows_ + 1, 0);
+    for (size_t i = 0; i < positions_.size(); ++i)
+    {
+      cells[i] = Cell(Col(positions_[i].x()), Row(positions_[i].y()));
+      ++cell_offsets_[cells[i] + 1];
+    }
+    for (size_t c = 1; c < cell_offsets_.size(); ++c)
+      cell_offsets_[c] += cell_offsets_[c - 1];
+    indexes_.resize(positions_.size());
+    std::vector<IndexT> fill(cell_offsets_.cbegin(), cell_offsets_.cend() - 1);
+    for (size_t i = 0; i < positions_.size(); ++i)
+      indexes_[fill[cells[i]]++] = static_cast<IndexT>(i);
+  }
+
+  const std::vector<Vec2> & Positions() const { return positions_; }
+
+  double CellSize() const { return cell_size_; }
+
+  /**
+  * @brief Visit the features that can be at a distance <= distance of a line
+  *  (i.e. the features of the cells intersecting the band around the line)
+  * @param line Line (a, b, c) : ax + by + c = 0
+  * @param distance Half width of the band
+  * @param functor Called with the index of each visited feature
+  */
+  template <typename Functor>
+  void VisitLine
+  (
+    const Vec3 & line,
+    double distance,
+    Functor && functor
+  ) const
+  {
+    if (positions_.empty() || !line.allFinite() || std::isnan(distance))
+      return;
+    // Degenerate line (a = b = 0, or the line at infinity): nothing to visit
+    const double norm = line.head<2>().norm();
+    if (norm <= std::numeric_limits<double>::epsilon() * std::abs(line(2)))
+      return;
+    const double a = line(0) / norm, b = line(1) / norm, c = line(2) / norm;
+    // Slightly enlarge the band to keep the features lying on its border
+    distance = distance * (1.0 + 1e-9) + 1e-9;
+
+    // Walk along the main direction of the line
+    const bool b_horizontal = std::abs(b) >= std::abs(a);
+    const int nb_steps = b_horizontal ? cols_ : rows_;
+    const double origin_u = b_horizontal ? origin_.x() : origin_.y();
+    const double origin_v = b_horizontal ? origin_.y() : origin_.x();
+    const int max_v = (b_horizontal ? rows_ : cols_) - 1;
+    // v(u) = -(alpha * u + c) / beta
+    const double alpha = b_horizontal ? a : b, beta = b_horizontal ? b : a;
+    const double half_band = distance / std::abs(beta);
+    for (int step = 0; step < nb_steps; ++step)
+    {
+      const double u0 = origin_u + step * cell_size_, u1 = u0 + cell_size_;
+      const double v0 = -(alpha * u0 + c) / beta, v1 = -(alpha * u1 + c) / beta;
+      const double v_min = std::min(v0, v1) - half_band, v_max = std::max(v0, v1) + half_band;
+      const double first = std::floor((v_min - origin_v) / cell_size_);
+      const double last = std::floor((v_max - origin_v) / cell_size_);
+      if (last < 0 || first > max_v)
+        continue;
+      const int first_v = static_cast<int>(std::max(first, 0.0));
+      const int last_v = static_cast<int>(std::min(last, static_cast<double>(max_v)));
+      for (int v = first_v; v <= last_v; ++v)
+      {
+        VisitCell(b_horizontal ? Cell(step, v) : Cell(v, step), functor);
+      }
+    }
+  }
+
+  /**
+  * @brief Visit the features that can be at a distance <= radius of a point
+  * @param center Center of the disk
+  * @param radius Radius of the disk
+  * @param functor Called with the index of each visited feature
+  */
+  template <typename Functor>
+  void VisitDisk
+  (
+    const Vec2 & center,
+    double radius,
+    Functor && functor
+  ) const
+  {
+    if (positions_.empty() || !center.allFinite())
+      return;
+    radius = radius * (1.0 + 1e-9) + 1e-9;
+    const double first_col = std::floor((center.x() - radius - origin_.x()) / cell_size_);
+    const double last_col = std::floor((center.x() + radius - origin_.x()) / cell_size_);
+    const double first_row = std::floor((center.y() - radius - origin_.y()) / cell_size_);
+    const double last_row = std::floor((center.y() + radius - origin_.y()) / cell_size_);
+    if (last_col < 0 || first_col >= cols_ || last_row < 0 || first_row >= rows_)
+      return;
+    for (int row = static_cast<int>(std::max(first_row, 0.0));
+         row <= static_cast<int>(std::min(last_row, rows_ - 1.0)); ++row)
+    {
+      for (int col = static_cast<int>(std::max(first_col, 0.0));
+           col <= static_cast<int>(std::min(last_col, cols_ - 1.0)); ++col)
+      {
+        VisitCell(Cell(col, row), functor);
+      }
+    }
+  }
+
+private:
+  int Col(const double x) const
+  {
+    return std::min(static_cast<int>((x - origin_.x()) / cell_size_), cols_ - 1);
+  }
+  int Row(const double y) const
+  {
+    return std::min(static_cast<int>((y - origin_.y()) / cell_size_), rows_ - 1);
+  }
+  IndexT Cell(const int col, const int row) const
+  {
+    return static_cast<IndexT>(row) * cols_ + col;
+  }
+
+  template <typename Functor>
+  void VisitCell(const IndexT cell, Functor && functor) const
+  {
+    for (IndexT k = cell_offsets_[cell]; k < cell_offsets_[cell + 1]; ++k)
+      functor(indexes_[k]);
+  }
+
+  std::vector<Vec2> positions_;
+  Vec2 origin_ = Vec2::Zero();
+  double cell_size_ = 1.0;
+  int cols_ = 0, rows_ = 0;
+  std::vector<IndexT> cell_offsets_; // features of the cell c: indexes_[cell_offsets_[c], cell_offsets_[c+1])
+  std::vector<IndexT> indexes_;
+};
+
+/// Search area of the right features that can satisfy
+///  ErrorArg::Error(model, xL, xR) < errorTh for a given left feature xL.
+/// Specialized for the errors handled by GuidedMatching_Grid.
+template <typename ErrorArg>
+struct Guided_Search;
+
+/// Squared distance to the epipolar line: a band of half width sqrt(errorTh)
+template <>
+struct Guided_Search<fundamental::kernel::EpipolarDistanceError>
+{
+  template <typename Functor>
+  static void Visit(const Feature_Grid & grid, const Mat3 & F, const Vec2 & xL,
+    const double errorTh, Functor && functor)
+  {
+    grid.VisitLine(F * xL.homogeneous(), std::sqrt(errorTh), functor);
+  }
+};
+
+/// The symmetric error is at least a quarter of the squared distance to the
+///  epipolar line: a band of half width 2 sqrt(errorTh)
+template <>
+struct Guided_Search<fundamental::kernel::SymmetricEpipolarDistanceError>
+{
+  template <typename Functor>
+  static void Visit(const Feature_Grid & grid, const Mat3 & F, const Vec2 & xL,
+    const double errorTh, Functor && functor)
+  {
+    grid.VisitLine(F * xL.homogeneous(), 2.0 * std::sqrt(errorTh), functor);
+  }
+};
+
+/// Squared distance to the transferred point: a disk of radius sqrt(errorTh)
+template <>
+struct Guided_Search<homography::kernel::AsymmetricError>
+{
+  template <typename Functor>
+  static void Visit(const Feature_Grid & grid, const Mat3 & H, const Vec2 & xL,
+    const double errorTh, Functor && functor)
+  {
+    grid.VisitDisk(Vec3(H * xL.homogeneous()).hnormalized(), std::sqrt(errorTh), functor);
+  }
+};
+
+/// Squared descriptor distances between a left region and a batch of right regions.
+/// Same values as Regions::SquaredDescriptorDistance, but the descriptor arrays
+///  are read directly with the (SIMD) metrics of matching/metric.hpp instead of
+///  a virtual call and a dynamic_cast per distance.
+class Descriptor_Distances
+{
+public:
+  Descriptor_Distances
+  (
+    const features::Regions & lRegions,
+    const features::Regions & rRegions
+  ):
+    lRegions_(lRegions), rRegions_(rRegions),
+    length_(lRegions.DescriptorLength()),
+    distances_(&Descriptor_Distances::Generic)
+  {
+    if (lRegions.RegionCount() == 0 || rRegions.RegionCount() == 0 ||
+        lRegions.IsScalar() != rRegions.IsScalar() ||
+        lRegions.Type_id() != rRegions.Type_id() ||
+        lRegions.DescriptorLength() != rRegions.DescriptorLength())
+      return;
+    if (lRegions.IsScalar())
+    {
+      if (lRegions.Type_id() == typeid(unsigned char).name())
+        distances_ = &Descriptor_Distances::Metric<matching::L2<unsigned char>>;
+      else if (lRegions.Type_id() == typeid(float).name())
+        distances_ = &Descriptor_Distances::Metric<matching::L2<float>>;
+      else if (lRegions.Type_id() == typeid(double).name())
+        distances_ = &Descriptor_Distances::Metric<matching::L2<double>>;
+    }
+    else if (lRegions.IsBinary() && lRegions.Type_id() == typeid(unsigned char).name())
+    {
+      distances_ = &Descriptor_Distances::Metric<matching::Hamming<unsigned char>, true>;
+    }
+  }
+
+  /**
+  * @brief Compute the distances of a left descriptor to some right descriptors
+  * @param i Left region index
+  * @param js Right region indexes
+  * @param nb Number of right regions
+  * @param[out] distances Squared descriptor distances
+  */
+  void operator()(const IndexT i, const IndexT * js, const size_t nb, double * distances) const
+  {
+    (this->*distances_)(i, js, nb, distances);
+  }
+
+private:
+  void Generic(const IndexT i, const IndexT * js, const size_t nb, double * distances) const
+  {
+    for (size_t k = 0; k < nb; ++k)
+      distances[k] = lRegions_.SquaredDescriptorDistance(i, &rRegions_, js[k]);
+  }
+
+  template <typename MetricT, bool bSquare = false>
+  void Metric(const IndexT i, const IndexT * js, const size_t nb, double * distances) const
+  {
+    using T = typename MetricT::ElementType;
+    const MetricT metric;
+    const T * left = reinterpret_cast<const T *>(lRegions_.DescriptorRawData()) + i * length_;
+    const T * right = reinterpret_cast<const T *>(rRegions_.DescriptorRawData());
+    for (size_t k = 0; k < nb; ++k)
+    {
+      const double distance = metric(left, right + js[k] * length_, length_);
+      distances[k] = bSquare ? distance * distance : distance;
+    }
+  }
+
+  const features::Regions & lRegions_;
+  const features::Regions & rRegions_;
+  const size_t length_;
+  void (Descriptor_Distances::*distances_)(IndexT, const IndexT *, size_t, double *) const;
+};
+
+/// Guided Matching (features + descriptors with distance ratio) on a feature grid:
+///  Same correspondences as the exhaustive GuidedMatching, but each left feature
+///  only visits the right features of the grid cells near its search area
+///  (i.e. its epipolar line band), and the descriptor distances of the
+///  geometric candidates are computed by batch.
+template<
+  typename ModelArg,  // The used model type
+  typename ErrorArg   // The metric to compute distance to the model (see Guided_Search)
+  >
+void GuidedMatching_Grid(
+  const ModelArg & mod, // The model
+  const std::vector<Vec2> & lRegionsPos, // (undistorted) left feature positions
+  const features::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const Feature_Grid & rGrid,          // grid of the (undistorted) right feature positions
+  const features::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & vec_corresponding_index) // Ouput corresponding index
+{
+  const std::vector<Vec2> & rRegionsPos = rGrid.Positions();
+  const Descriptor_Distances descriptor_distances(lRegions, rRegions);
+
+  std::vector<IndexT> candidates;
+  std::vector<double> distances;
+  for (size_t i = 0; i < lRegionsPos.size(); ++i) {
+
+    // Geometric candidates (by increasing index, like the exhaustive search)
+    candidates.clear();
+    Guided_Search<ErrorArg>::Visit(rGrid, mod, lRegionsPos[i], errorTh,
+      [&](const IndexT j)
+      {
+        if (ErrorArg::Error(mod, lRegionsPos[i], rRegionsPos[j]) < errorTh)
+          candidates.push_back(j);
+      });
+    if (candidates.empty())
+      continue;
+    std::sort(candidates.begin(), candidates.end());
+
+    distances.resize(candidates.size());
+    descriptor_distances(i, candidates.data(), candidates.size(), distances.data());
+    distanceRatio<double> dR;
+    for (size_t k = 0; k < candidates.size(); ++k) {
+      // Update the corresponding points & distance (if required)
+      dR.update(candidates[k], distances[k]);
+    }
+    // Add correspondence only iff the distance ratio is valid
+    if (dR.isValid(distRatio))  {
+      // save the best corresponding index
+      vec_corresponding_index.push_back(matching::IndMatch(i,dR.idx));
+    }
+  }
+
+  // Remove duplicates (when multiple points at same position exist)
+  matching::IndMatch::getDeduplicated(vec_corresponding_index);
+}
+
+/// Guided Matching (features + descriptors with distance ratio) on a feature grid:
+///  see above, the feature positions are undistorted on the fly and
+///  the grid of the right features is built for this pair.
+template<
+  typename ModelArg,  // The used model type
+  typename ErrorArg   // The metric to compute distance to the model (see Guided_Search)
+  >
+void GuidedMatching_Grid(
+  const ModelArg & mod, // The model
+  const cameras::IntrinsicBase * camL, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const cameras::IntrinsicBase * camR, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & vec_corresponding_index) // Ouput corresponding index
+{
+  // Build region positions arrays (in order to un-distord on-demand point position once)
+  std::vector<Vec2>
+    lRegionsPos(lRegions.RegionCount()),
+    rRegionsPos(rRegions.RegionCount());
+  for (size_t i = 0; i < lRegions.RegionCount(); ++i) {
+    lRegionsPos[i] = camL ? camL->get_ud_pixel(lRegions.GetRegionPosition(i)) : lRegions.GetRegionPosition(i);
+  }
+  for (size_t i = 0; i < rRegions.RegionCount(); ++i) {
+    rRegionsPos[i] = camR ? camR->get_ud_pixel(rRegions.GetRegionPosition(i)) : rRegions.GetRegionPosition(i);
+  }
+  const Feature_Grid rGrid(std::move(rRegionsPos));
+  GuidedMatching_Grid<ModelArg, ErrorArg>(
+    mod,
+    lRegionsPos, lRegions,
+    rGrid, rRegions,
+    errorTh, distRatio,
+    vec_corresponding_index);
+}
+
+} // namespace geometry_aware
+} // namespace openMVG
+
+#endif // OPENMVG_ROBUST_ESTIMATION_GUIDED_MATCHING_GRID_HPP
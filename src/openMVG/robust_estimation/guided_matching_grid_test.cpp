@@ -0,0 +1,163 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/features/regions_factory.hpp"
+#include "openMVG/robust_estimation/guided_matching_grid.hpp"
+
+#include "testing/testing.h"
+
+#include <limits>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::features;
+using namespace openMVG::geometry_aware;
+
+TEST(Feature_Grid, VisitLineAndDisk)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> position(0.0, 640.0);
+  std::vector<Vec2> points(2000);
+  for (Vec2 & pt : points)
+    pt << position(random_generator), 0.75 * position(random_generator);
+  const Feature_Grid grid(points, 13.0);
+
+  // The visited features are a superset of the features inside the area
+  std::uniform_real_distribution<double> angle(0.0, 2 * M_PI);
+  for (int i = 0; i < 100; ++i)
+  {
+    const double theta = angle(random_generator);
+    const Vec2 pt(position(random_generator), position(random_generator));
+    const Vec3 line(std::cos(theta), std::sin(theta),
+      -std::cos(theta) * pt.x() - std::sin(theta) * pt.y());
+    const double distance = 4.0;
+    std::vector<bool> visited(points.size(), false);
+    grid.VisitLine(line, distance, [&](const IndexT j) { visited[j] = true; });
+    std::vector<bool> visited_disk(points.size(), false);
+    grid.VisitDisk(pt, 20.0, [&](const IndexT j) { visited_disk[j] = true; });
+    for (size_t j = 0; j < points.size(); ++j)
+    {
+      if (std::abs(line.dot(points[j].homogeneous())) <= distance)
+        EXPECT_TRUE(visited[j]);
+      if ((points[j] - pt).norm() <= 20.0)
+        EXPECT_TRUE(visited_disk[j]);
+    }
+  }
+
+  // Non finite or degenerate lines (e.g. a point on the epipole) visit nothing
+  size_t nb_visited = 0;
+  const auto count_visited = [&](const IndexT) { ++nb_visited; };
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  grid.VisitLine(Vec3(nan, 1.0, -100.0), 4.0, count_visited);
+  grid.VisitLine(Vec3(1.0, std::numeric_limits<double>::infinity(), -100.0), 4.0, count_visited);
+  grid.VisitLine(Vec3(1.0, 1.0, -100.0), nan, count_visited);
+  grid.VisitLine(Vec3(0.0, 0.0, 1.0), 4.0, count_visited);
+  grid.VisitLine(Vec3(1e-300, 0.0, 1.0), 4.0, count_visited);
+  grid.VisitLine(Vec3::Zero(), 4.0, count_visited);
+  EXPECT_EQ(0, nb_visited);
+}
+
+// Random features in two views and noisy copies of their descriptors
+void MakeRegions
+(
+  const Mat3 & F,
+  SIFT_Regions & lRegions,
+  SIFT_Regions & rRegions
+)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> position(0.0, 500.0);
+  std::uniform_int_distribution<int> value(0, 255), noise(-6, 6);
+  for (int i = 0; i < 800; ++i)
+  {
+    SIFT_Regions::DescriptorT desc;
+    for (int k = 0; k < 128; ++k)
+      desc[k] = value(random_generator);
+    const Vec2 xL(position(random_generator), position(random_generator));
+    lRegions.Features().emplace_back(xL.x(), xL.y());
+    lRegions.Descriptors().push_back(desc);
+
+    // Right feature near the epipolar line (or anywhere)
+    const Vec3 line = F * xL.homogeneous();
+    double x = position(random_generator);
+    double y = -(line(0) * x + line(2)) / line(1) + noise(random_generator) * 0.5;
+    if (i % 3 == 0)
+      y = position(random_generator);
+    for (int k = 0; k < 128; ++k)
+      desc[k] = std::min(255, std::max(0, desc[k] + noise(random_generator)));
+    rRegions.Features().emplace_back(x, y);
+    rRegions.Descriptors().push_back(desc);
+  }
+}
+
+TEST(GuidedMatching_Grid, SameAsExhaustive_Fundamental)
+{
+  // Translation along x: horizontal epipolar lines with a small slope
+  Mat3 F;
+  F << 0, -0.001, 0.1,
+       0.001, 0, -1,
+       -0.1, 1, 0.5;
+  SIFT_Regions lRegions, rRegions;
+  MakeRegions(F, lRegions, rRegions);
+
+  for (const double errorTh : {1.0, 4.0, 16.0})
+  {
+    matching::IndMatches exhaustive_matches, grid_matches;
+    GuidedMatching<Mat3, fundamental::kernel::EpipolarDistanceError>(
+      F, nullptr, lRegions, nullptr, rRegions, errorTh, Square(0.8), exhaustive_matches);
+    GuidedMatching_Grid<Mat3, fundamental::kernel::EpipolarDistanceError>(
+      F, nullptr, lRegions, nullptr, rRegions, errorTh, Square(0.8), grid_matches);
+    EXPECT_TRUE(!exhaustive_matches.empty());
+    EXPECT_TRUE(exhaustive_matches == grid_matches);
+
+    exhaustive_matches.clear();
+    grid_matches.clear();
+    GuidedMatching<Mat3, fundamental::kernel::SymmetricEpipolarDistanceError>(
+      F, nullptr, lRegions, nullptr, rRegions, errorTh, Square(0.8), exhaustive_matches);
+    GuidedMatching_Grid<Mat3, fundamental::kernel::SymmetricEpipolarDistanceError>(
+      F, nullptr, lRegions, nullptr, rRegions, errorTh, Square(0.8), grid_matches);
+    EXPECT_TRUE(exhaustive_matches == grid_matches);
+  }
+}
+
+TEST(GuidedMatching_Grid, SameAsExhaustive_Homography)
+{
+  Mat3 H;
+  H << 1.1, 0.05, 10,
+       -0.02, 0.95, -5,
+       0.0001, 0, 1;
+  SIFT_Regions lRegions, rRegions;
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> position(0.0, 500.0);
+  std::uniform_int_distribution<int> value(0, 255), noise(-4, 4);
+  for (int i = 0; i < 800; ++i)
+  {
+    SIFT_Regions::DescriptorT desc;
+    for (int k = 0; k < 128; ++k)
+      desc[k] = value(random_generator);
+    const Vec2 xL(position(random_generator), position(random_generator));
+    lRegions.Features().emplace_back(xL.x(), xL.y());
+    lRegions.Descriptors().push_back(desc);
+    const Vec2 xR = Vec3(H * xL.homogeneous()).hnormalized()
+      + Vec2(noise(random_generator), noise(random_generator));
+    rRegions.Features().emplace_back(xR.x(), xR.y());
+    rRegions.Descriptors().push_back(desc);
+  }
+
+  matching::IndMatches exhaustive_matches, grid_matches;
+  GuidedMatching<Mat3, homography::kernel::AsymmetricError>(
+    H, nullptr, lRegions, nullptr, rRegions, Square(4.0), Square(0.8), exhaustive_matches);
+  GuidedMatching_Grid<Mat3, homography::kernel::AsymmetricError>(
+    H, nullptr, lRegions, nullptr, rRegions, Square(4.0), Square(0.8), grid_matches);
+  EXPECT_TRUE(!exhaustive_matches.empty());
+  EXPECT_TRUE(exhaustive_matches == grid_matches);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
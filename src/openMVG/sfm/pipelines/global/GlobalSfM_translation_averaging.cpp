@@ -32,6 +32,12 @@
 #include "openMVG/system/loggerprogress.hpp"
 #include "openMVG/system/timer.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
 #include <vector>
 
 namespace openMVG{
@@ -41,6 +47,76 @@ using namespace openMVG::cameras;
 using namespace openMVG::geometry;
 using namespace openMVG::matching;
 
+// Minimal inlier count of a triplet translation model
+static const size_t kMinTripletInliers = 30;
+
+/// Per thread cache of the undistorted and normalized feature coordinates.
+/// The views of an edge are shared by all its candidate triplets: the
+///  coordinates are computed once per feature for the most recent views.
+struct GlobalSfM_Translation_AveragingSolver::Triplet_Features_Cache
+{
+  static const size_t kMaxViews = 32;
+
+  struct View_Features
+  {
+    IndexT view_id = UndefinedIndexT;
+    size_t last_use = 0;
+    std::vector<Vec2> coords; // NaN if not yet computed
+  };
+  std::vector<View_Features> views;
+  size_t use_count = 0;
+
+  const Vec2 & Get
+  (
+    const sfm::SfM_Data & sfm_data,
+    const sfm::Features_Provider * features_provider,
+    const IndexT view_id,
+    const IndexT feat_id
+  )
+  {
+    auto it = std::find_if(views.begin(), views.end(),
+      [view_id](const View_Features & cached) { return cached.view_id == view_id; });
+    if (it == views.end())
+    {
+      // Add the view or replace the least recently used one
+      if (views.size() < kMaxViews)
+      {
+        views.emplace_back();
+        it = std::prev(views.end());
+      }
+      else
+      {
+        it = std::min_element(views.begin(), views.end(),
+          [](const View_Features & a, const View_Features & b) { return a.last_use < b.last_use; });
+      }
+      it->view_id = view_id;
+      it->coords.assign(features_provider->getFeatures(view_id).size(),
+        Vec2::Constant(std::numeric_limits<double>::quiet_NaN()));
+    }
+    it->last_use = ++use_count;
+
+    Vec2 & coords = it->coords[feat_id];
+    if (std::isnan(coords(0)))
+    {
+      const View * view = sfm_data.views.at(view_id).get();
+      const IntrinsicBase * cam = sfm_data.intrinsics.at(view->id_intrinsic).get();
+      const features::PointFeature & pt = features_provider->getFeatures(view_id)[feat_id];
+      coords = ((*cam)(cam->get_ud_pixel(pt.coords().cast<double>()))).colwise().hnormalized();
+    }
+    return coords;
+  }
+};
+
+constexpr size_t GlobalSfM_Translation_AveragingSolver::kMaxSimplexCameras;
+
+GlobalSfM_Translation_AveragingSolver::GlobalSfM_Translation_AveragingSolver
+(
+  const size_t max_simplex_cameras
+)
+: max_simplex_cameras_(max_simplex_cameras)
+{
+}
+
 /// Use features in normalized camera frames
 bool GlobalSfM_Translation_AveragingSolver::Run
 (
@@ -138,20 +214,26 @@ bool GlobalSfM_Translation_AveragingSolver::Translation_averaging(
         {
           vec_solution.resize(iNview*3 + vec_relative_motion_cpy.size() + 1);
           using namespace openMVG::linearProgramming;
-          OSI_CLP_SolverWrapper solverLP(vec_solution.size());
+          // The simplex solver does not scale to large scenes: the first order
+          //  solver (sparse matrix-vector products only) is used instead.
+          std::unique_ptr<LP_Solver> solverLP;
+          if (iNview > max_simplex_cameras_)
+            solverLP.reset(new PDLP_SolverWrapper(vec_solution.size()));
+          else
+            solverLP.reset(new OSI_CLP_SolverWrapper(vec_solution.size()));
 
           lInfinityCV::Tifromtij_ConstraintBuilder cstBuilder(vec_relative_motion_cpy);
 
           LP_Constraints_Sparse constraint;
           //-- Setup constraint and solver
           cstBuilder.Build(constraint);
-          solverLP.setup(constraint);
+          solverLP->setup(constraint);
           //--
           // Solving
-          const bool bFeasible = solverLP.solve();
+          const bool bFeasible = solverLP->solve();
           //--
           if (bFeasible)  {
-            solverLP.getSolution(vec_solution);
+            solverLP->getSolution(vec_solution);
             gamma = vec_solution[vec_solution.size()-1];
           }
           else  {
@@ -340,6 +422,7 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
   //   - list all edges that have support in the rotation pose graph
   //
   Pair_Set rotation_pose_id_graph;
+  Pose_Matches_Index pose_matches_index;
   std::set<IndexT> set_pose_ids;
   std::transform(map_globalR.cbegin(), map_globalR.cend(),
     std::inserter(set_pose_ids, set_pose_ids.begin()), stl::RetrieveKey());
@@ -356,6 +439,8 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
         && set_pose_ids.count(v2->id_pose))
     {
       rotation_pose_id_graph.insert({v1->id_pose, v2->id_pose});
+      pose_matches_index[{std::min(v1->id_pose, v2->id_pose),
+                          std::max(v1->id_pose, v2->id_pose)}].push_back(pair);
     }
   }
   // List putative triplets (from global rotations Ids)
@@ -363,6 +448,7 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
     graph::TripletListing(rotation_pose_id_graph);
   OPENMVG_LOG_INFO << "#Triplets: " << vec_triplets.size();
 
+  uint32_t estimated_triplet_count = 0;
   {
     // Compute triplets of translations
     // Avoid to cover each edge of the graph by using an edge coverage algorithm
@@ -411,14 +497,20 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
                    stl::RetrieveKey());
 
     openMVG::sfm::MutexSet<myEdge> m_mutexSet;
+    // Triplets that cannot be estimated (the estimation is deterministic, so
+    //  they are not tried again from their other edges)
+    openMVG::sfm::MutexSet<uint32_t> m_rejectedTriplets;
+    std::atomic<uint32_t> triplet_estimation_count(0);
 
     system::LoggerProgress my_progress_bar(vec_edges.size(),
       "Relative translations computation (edge coverage algorithm)");
 
 #  ifdef OPENMVG_USE_OPENMP
     std::vector<std::vector<RelativeInfo_Vec>> initial_estimates(omp_get_max_threads());
+    std::vector<Triplet_Features_Cache> features_caches(omp_get_max_threads());
 #  else
     std::vector<std::vector<RelativeInfo_Vec>> initial_estimates(1);
+    std::vector<Triplet_Features_Cache> features_caches(1);
 #  endif
 
     #ifdef OPENMVG_USE_OPENMP
@@ -455,14 +547,22 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
         {
           const graph::Triplet & triplet = vec_triplets[triplet_index];
 
-          // If the triplet is already estimated by another thread; try the next one
-          if (m_mutexSet.count({triplet.i, triplet.j}) &&
-              m_mutexSet.count({triplet.i, triplet.k}) &&
-              m_mutexSet.count({triplet.j, triplet.k}))
+          // If the triplet is already estimated by another thread
+          //  or was rejected from another edge; try the next one
+          if ((m_mutexSet.count({triplet.i, triplet.j}) &&
+               m_mutexSet.count({triplet.i, triplet.k}) &&
+               m_mutexSet.count({triplet.j, triplet.k}))
+              || m_rejectedTriplets.count(triplet_index))
           {
             continue;
           }
 
+          #ifdef OPENMVG_USE_OPENMP
+            const int thread_id = omp_get_thread_num();
+          #else
+            const int thread_id = 0;
+          #endif
+
           //--
           // Try to estimate this triplet of translations
           //--
@@ -479,14 +579,21 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
               map_globalR,
               features_provider,
               matches_provider,
+              pose_matches_index,
+              features_caches[thread_id],
               triplet,
               vec_tis,
               dPrecision,
               vec_inliers,
               pose_triplet_tracks,
               sOutDirectory);
+          ++triplet_estimation_count;
 
-          if (bTriplet_estimation)
+          if (!bTriplet_estimation)
+          {
+            m_rejectedTriplets.insert(triplet_index);
+          }
+          else
           {
             // Since new translation edges have been computed, mark their corresponding edges as estimated
             #ifdef OPENMVG_USE_OPENMP
@@ -521,12 +628,6 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
               Vec3 tik;
               RelativeCameraMotion(RI, ti, RK, tk, &Rik, &tik);
 
-              #ifdef OPENMVG_USE_OPENMP
-                const int thread_id = omp_get_thread_num();
-              #else
-                const int thread_id = 0;
-              #endif
-
               RelativeInfo_Vec triplet_relative_motion;
               triplet_relative_motion.push_back(
                 {{triplet.i, triplet.j}, {Rij, tij}});
@@ -575,6 +676,7 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
       vec_triplet_relative_motion.insert( vec_triplet_relative_motion.end(),
         std::make_move_iterator(vec.begin()), std::make_move_iterator(vec.end()));
     }
+    estimated_triplet_count = triplet_estimation_count;
   }
 
   const double timeLP_triplet = timerLP_triplet.elapsed();
@@ -583,6 +685,8 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
     << "-- #Relative triplet of translations estimates: " << vec_triplet_relative_motion.size()
     << " computed from " << vec_triplets.size() << " triplets.\n"
     << "-- resulting in " << vec_triplet_relative_motion.size()*3 << " translations estimation.\n"
+    << "-- #Triplet estimations: " << estimated_triplet_count
+    << " (" << estimated_triplet_count / std::max(timeLP_triplet, 1e-6) << " triplets/s).\n"
     << "-- time to compute triplets of relative translations: " << timeLP_triplet << " seconds.\n"
     << "-------------------------------";
 }
@@ -594,6 +698,8 @@ bool GlobalSfM_Translation_AveragingSolver::Estimate_T_triplet
   const Hash_Map<IndexT, Mat3> & map_globalR,
   const sfm::Features_Provider * features_provider,
   const sfm::Matches_Provider * matches_provider,
+  const Pose_Matches_Index & pose_matches_index,
+  Triplet_Features_Cache & features_cache,
   const graph::Triplet & poses_id,
   std::vector<Vec3> & vec_tis,
   double & dPrecision, // UpperBound of the precision found by the AContrario estimator
@@ -603,20 +709,20 @@ bool GlobalSfM_Translation_AveragingSolver::Estimate_T_triplet
 ) const
 {
   // List matches that belong to the triplet of poses
+  //  (shared correspondences (pairs) between the 3 pairs of poses)
   PairWiseMatches map_triplet_matches;
-  const std::set<IndexT> set_pose_ids {poses_id.i, poses_id.j, poses_id.k};
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : matches_provider->pairWise_matches_)
+  const std::array<Pair, 3> pose_pairs {{
+    {std::min(poses_id.i, poses_id.j), std::max(poses_id.i, poses_id.j)},
+    {std::min(poses_id.i, poses_id.k), std::max(poses_id.i, poses_id.k)},
+    {std::min(poses_id.j, poses_id.k), std::max(poses_id.j, poses_id.k)}}};
+  for (const Pair & pose_pair : pose_pairs)
   {
-    const Pair & pair = match_iterator.first;
-    const View * v1 = sfm_data.GetViews().at(pair.first).get();
-    const View * v2 = sfm_data.GetViews().at(pair.second).get();
-    if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-        (v1->id_pose != v2->id_pose)
-        && set_pose_ids.count(v1->id_pose)
-        && set_pose_ids.count(v2->id_pose))
+    const auto pose_matches_it = pose_matches_index.find(pose_pair);
+    if (pose_matches_it == pose_matches_index.end())
+      continue;
+    for (const Pair & view_pair : pose_matches_it->second)
     {
-      map_triplet_matches.insert( match_iterator );
+      map_triplet_matches.insert(*matches_provider->pairWise_matches_.find(view_pair));
     }
   }
 
@@ -645,11 +751,9 @@ bool GlobalSfM_Translation_AveragingSolver::Estimate_T_triplet
     for (const auto & track_it : track)
     {
       const uint32_t idx_view = track_it.first;
-      const View * view = sfm_data.views.at(idx_view).get();
-      const IntrinsicBase * cam = sfm_data.intrinsics.at(view->id_intrinsic).get();
-      intrinsic_ids.insert(view->id_intrinsic);
-      const features::PointFeature pt = features_provider->getFeatures(idx_view)[track_it.second];
-      xxx[index++]->col(cpt) = ((*cam)(cam->get_ud_pixel(pt.coords().cast<double>()))).colwise().hnormalized();
+      intrinsic_ids.insert(sfm_data.views.at(idx_view)->id_intrinsic);
+      xxx[index++]->col(cpt) =
+        features_cache.Get(sfm_data, features_provider, idx_view, track_it.second);
     }
     ++cpt;
   }
@@ -676,16 +780,33 @@ bool GlobalSfM_Translation_AveragingSolver::Estimate_T_triplet
   using namespace openMVG::trifocal;
   using namespace openMVG::trifocal::kernel;
 
+  const double ThresholdUpperBound = 1.0e-2; // upper bound of the pixel residual (normalized coordinates)
+  const size_t ORSA_ITER = 320;  // max number of iterations of AC-RANSAC
+
+  // Linear (L2) pre-solver: an AC-RANSAC with a cheap minimal solver rejects
+  //  the triplets that do not have enough support before running the LPs.
+  {
+    using L2KernelType =
+      TranslationTripletKernel_ACRansac<
+        translations_Triplet_L2_Solver,
+        translations_Triplet_L2_Solver,
+        TrifocalTensorModel>;
+    const L2KernelType l2_kernel(x1, x2, x3, vec_global_R_Triplet, Mat3::Identity(), ThresholdUpperBound);
+    std::vector<uint32_t> vec_l2_inliers;
+    robust::ACRANSAC(l2_kernel, vec_l2_inliers, ORSA_ITER, nullptr, dPrecision/min_focal, false);
+    // The L2 models are noisier than the L-infinity ones: use half the
+    //  minimal inlier count required for the final model.
+    if (vec_l2_inliers.size() < kMinTripletInliers / 2)
+      return false;
+  }
+
   using KernelType =
     TranslationTripletKernel_ACRansac<
       translations_Triplet_Solver,
       translations_Triplet_Solver,
       TrifocalTensorModel>;
-  const double ThresholdUpperBound = 1.0e-2; // upper bound of the pixel residual (normalized coordinates)
   KernelType kernel(x1, x2, x3, vec_global_R_Triplet, Mat3::Identity(), ThresholdUpperBound);
 
-  const size_t ORSA_ITER = 320;  // max number of iterations of AC-RANSAC
-
   TrifocalTensorModel T;
   const std::pair<double,double> acStat =
     robust::ACRANSAC(kernel, vec_inliers, ORSA_ITER, &T, dPrecision/min_focal, false);
@@ -784,7 +905,7 @@ bool GlobalSfM_Translation_AveragingSolver::Estimate_T_triplet
 #endif
 
   // Keep the model iff it has a sufficient inlier count
-  const bool bTest = ( vec_inliers.size() > 30 && 0.33 * tracks.size() );
+  const bool bTest = ( vec_inliers.size() > kMinTripletInliers && 0.33 * tracks.size() );
 
 #ifdef DEBUG_TRIPLET
   {
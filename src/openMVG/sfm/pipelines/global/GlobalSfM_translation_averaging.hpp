@@ -9,6 +9,7 @@
 #ifndef OPENMVG_SFM_GLOBAL_ENGINE_PIPELINES_GLOBAL_TRANSLATION_AVERAGING_HPP
 #define OPENMVG_SFM_GLOBAL_ENGINE_PIPELINES_GLOBAL_TRANSLATION_AVERAGING_HPP
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -38,9 +39,19 @@ struct Features_Provider;
 class GlobalSfM_Translation_AveragingSolver
 {
   std::vector<RelativeInfo_Vec> vec_relative_motion_;
+  size_t max_simplex_cameras_;
 
 public:
 
+  /// Above this number of cameras the L1 translation averaging LP is solved
+  ///  with the first order solver (PDLP) instead of the simplex solver.
+  static constexpr size_t kMaxSimplexCameras = 1000;
+
+  explicit GlobalSfM_Translation_AveragingSolver
+  (
+    const size_t max_simplex_cameras = kMaxSimplexCameras
+  );
+
   bool Run(
     ETranslationAveragingMethod eTranslationAveragingMethod,
     openMVG::sfm::SfM_Data & sfm_data,
@@ -51,6 +62,11 @@ public:
   );
 
 private:
+  // View pairs (that have matches) between two poses, indexed by pose pair
+  using Pose_Matches_Index = Hash_Map<Pair, std::vector<Pair>>;
+  // Per thread cache of the normalized feature coordinates
+  struct Triplet_Features_Cache;
+
   bool Translation_averaging(
     ETranslationAveragingMethod eTranslationAveragingMethod,
     sfm::SfM_Data & sfm_data,
@@ -76,11 +92,15 @@ private:
     matching::PairWiseMatches & newpairMatches);
 
   // Robust estimation and refinement of triplet of translations
+  // A linear (L2) pre-solver rejects the triplets without support before
+  //  running the L-infinity AContrario estimation.
   bool Estimate_T_triplet(
     const sfm::SfM_Data & sfm_data,
     const Hash_Map<IndexT, Mat3> & map_globalR,
     const sfm::Features_Provider * features_provider,
     const sfm::Matches_Provider * matches_provider,
+    const Pose_Matches_Index & pose_matches_index,
+    Triplet_Features_Cache & features_cache,
     const graph::Triplet & poses_id,
     std::vector<Vec3> & vec_tis,
     double & dPrecision, // UpperBound of the precision found by the AContrario estimator
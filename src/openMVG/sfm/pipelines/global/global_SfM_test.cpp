@@ -25,6 +25,7 @@
 
 #include <cmath>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
 
 using namespace openMVG;
@@ -85,6 +86,61 @@ TEST(GLOBAL_SFM, RotationAveragingL2_TranslationAveragingL1) {
   EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
 }
 
+// The L1 translation averaging of a large scene uses the first order LP solver:
+//  force it on a small scene
+TEST(GLOBAL_SFM, RotationAveragingL2_TranslationAveragingL1_PDLP) {
+
+  const int nviews = 6;
+  const int npoints = 64;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfM_Data sfm_data_2 = sfm_data;
+  sfm_data_2.poses.clear();
+  sfm_data_2.structure.clear();
+
+  GlobalSfMReconstructionEngine_RelativeMotions sfmEngine(
+    sfm_data_2,
+    "./",
+    stlplus::create_filespec("./", "Reconstruction_Report.html"));
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.SetFeaturesProvider(feats_provider.get());
+  sfmEngine.SetMatchesProvider(matches_provider.get());
+
+  // Configure reconstruction parameters (intrinsic parameters are held constant)
+  sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+
+  // Configure motion averaging methods
+  sfmEngine.SetRotationAveragingMethod(ROTATION_AVERAGING_L2);
+  sfmEngine.SetTranslationAveragingMethod(TRANSLATION_AVERAGING_L1);
+  sfmEngine.SetMaxSimplexCameras(0);
+
+  EXPECT_TRUE (sfmEngine.Process());
+
+  const double dResidual = RMSE(sfmEngine.Get_SfM_Data());
+  std::cout << "RMSE residual: " << dResidual << std::endl;
+  EXPECT_TRUE( dResidual < 0.5);
+  EXPECT_EQ( nviews, sfmEngine.Get_SfM_Data().GetPoses().size());
+  EXPECT_EQ( npoints, sfmEngine.Get_SfM_Data().GetLandmarks().size());
+  EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
+}
+
 TEST(GLOBAL_SFM, RotationAveragingL1_TranslationAveragingL1) {
 
   const int nviews = 6;
@@ -242,6 +298,96 @@ TEST(GLOBAL_SFM, RotationAveragingL2_TranslationAveragingSoftL1) {
   EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
 }
 
+TEST(GLOBAL_SFM, Resume_From_Checkpoint) {
+
+  const int nviews = 6;
+  const int npoints = 64;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene (without poses and structure)
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  sfm_data.poses.clear();
+  sfm_data.structure.clear();
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  Synthetic_Features_Provider feats_provider;
+  std::normal_distribution<double> distribution(0.0,0.5);
+  feats_provider.load(d,distribution);
+  Synthetic_Matches_Provider matches_provider;
+  matches_provider.load(d);
+
+  const std::string checkpoint_directory = stlplus::create_filespec("./", "global_checkpoint_test");
+  const std::string relative_poses_file =
+    stlplus::create_filespec(checkpoint_directory, "relative_poses", "bin");
+  stlplus::folder_delete(checkpoint_directory, true);
+
+  const auto process = [&](const bool b_resume) -> SfM_Data
+  {
+    GlobalSfMReconstructionEngine_RelativeMotions sfmEngine(sfm_data, "./");
+    sfmEngine.SetFeaturesProvider(&feats_provider);
+    sfmEngine.SetMatchesProvider(&matches_provider);
+    sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+    sfmEngine.SetRotationAveragingMethod(ROTATION_AVERAGING_L2);
+    sfmEngine.SetTranslationAveragingMethod(TRANSLATION_AVERAGING_L1);
+    sfmEngine.SetCheckpoint(checkpoint_directory, 0.0, b_resume);
+    if (!sfmEngine.Process())
+      return SfM_Data();
+    return sfmEngine.Get_SfM_Data();
+  };
+
+  // Mark all the relative poses of the results file as failed (a run that
+  //  loads this file cannot compute the global rotations)
+  const auto fail_relative_poses = [&]()
+  {
+    std::fstream stream(relative_poses_file, std::ios::in | std::ios::out | std::ios::binary);
+    const std::streamoff header_size = 8 + sizeof(uint64_t);
+    const std::streamoff record_size = 2 * sizeof(uint32_t) + 1 + 12 * sizeof(double);
+    stream.seekg(0, std::ios::end);
+    const std::streamoff record_count = (static_cast<std::streamoff>(stream.tellg()) - header_size) / record_size;
+    for (std::streamoff k = 0; k < record_count; ++k)
+    {
+      stream.seekp(header_size + k * record_size + 2 * sizeof(uint32_t));
+      stream.put(0);
+    }
+    return record_count > 0 && stream.good();
+  };
+
+  // A run with checkpoints saves the relative poses and the initial structure
+  EXPECT_EQ(nviews, process(false).GetPoses().size());
+  EXPECT_TRUE(stlplus::file_exists(relative_poses_file));
+  EXPECT_TRUE(stlplus::file_exists(stlplus::create_filespec(checkpoint_directory, "checkpoint", "state")));
+
+  // A new run does not load the relative poses of a previous run
+  EXPECT_TRUE(fail_relative_poses());
+  EXPECT_EQ(nviews, process(false).GetPoses().size());
+
+  // Remove a pose from the checkpoint initial structure
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    SfM_Data checkpoint_scene;
+    SfM_Checkpoint_State checkpoint_state;
+    EXPECT_TRUE(checkpoint.Load(checkpoint_scene, checkpoint_state));
+    EXPECT_EQ(nviews, checkpoint_scene.GetPoses().size());
+    const IndexT removed_pose_id = nviews - 1;
+    checkpoint_scene.poses.erase(removed_pose_id);
+    for (auto & landmark_it : checkpoint_scene.structure)
+      landmark_it.second.obs.erase(removed_pose_id);
+    EXPECT_TRUE(checkpoint.Save(checkpoint_scene, checkpoint_state, true));
+    EXPECT_TRUE(checkpoint.Wait());
+  }
+
+  // Resume: the scene is refined from the checkpoint initial structure
+  //  (the motion averaging and the relative poses are not recomputed)
+  EXPECT_TRUE(fail_relative_poses());
+  const SfM_Data resumed_sfm_data = process(true);
+  EXPECT_EQ(nviews - 1, resumed_sfm_data.GetPoses().size());
+  EXPECT_EQ(npoints, resumed_sfm_data.GetLandmarks().size());
+  EXPECT_TRUE( RMSE(resumed_sfm_data) < 0.5);
+
+  stlplus::folder_delete(checkpoint_directory, true);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -48,6 +48,9 @@ using namespace openMVG::cameras;
 using namespace openMVG::geometry;
 using namespace openMVG::features;
 
+// Checkpoint stage of the global engine: the motion averaging is done
+static const uint32_t kInitialStructureStage = 1;
+
 GlobalSfMReconstructionEngine_RelativeMotions::GlobalSfMReconstructionEngine_RelativeMotions(
   const SfM_Data & sfm_data,
   const std::string & soutDirectory,
@@ -71,6 +74,7 @@ GlobalSfMReconstructionEngine_RelativeMotions::GlobalSfMReconstructionEngine_Rel
   // Set default motion Averaging methods
   eRotation_averaging_method_ = ROTATION_AVERAGING_L2;
   eTranslation_averaging_method_ = TRANSLATION_AVERAGING_L1;
+  max_simplex_cameras_ = GlobalSfM_Translation_AveragingSolver::kMaxSimplexCameras;
 }
 
 GlobalSfMReconstructionEngine_RelativeMotions::~GlobalSfMReconstructionEngine_RelativeMotions()
@@ -109,6 +113,14 @@ void GlobalSfMReconstructionEngine_RelativeMotions::SetTranslationAveragingMetho
   eTranslation_averaging_method_ = eTranslationAveragingMethod;
 }
 
+void GlobalSfMReconstructionEngine_RelativeMotions::SetMaxSimplexCameras
+(
+  size_t max_simplex_cameras
+)
+{
+  max_simplex_cameras_ = max_simplex_cameras;
+}
+
 bool GlobalSfMReconstructionEngine_RelativeMotions::Process() {
 
   //-------------------
@@ -125,27 +137,59 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Process() {
     KeepOnlyReferencedElement(set_remainingIds, matches_provider_->pairWise_matches_);
   }
 
-  openMVG::rotation_averaging::RelativeRotations relatives_R;
-  Compute_Relative_Rotations(relatives_R);
-
-  Hash_Map<IndexT, Mat3> global_rotations;
-  if (!Compute_Global_Rotations(relatives_R, global_rotations))
-  {
-    OPENMVG_LOG_ERROR << "GlobalSfM:: Rotation Averaging failure!";
-    return false;
-  }
-
-  matching::PairWiseMatches  tripletWise_matches;
-  if (!Compute_Global_Translations(global_rotations, tripletWise_matches))
+  // Resume from the initial structure of a previous run (the motion averaging is skipped)
+  const uint64_t inputs_fingerprint =
+    SfM_Checkpoint_Fingerprint(sfm_data_, matches_provider_->pairWise_matches_);
+  SfM_Checkpoint_State checkpoint_state;
+  SfM_Data checkpoint_scene;
+  const bool b_resumed = b_resume_from_checkpoint_
+    && checkpoint_->Load(checkpoint_scene, checkpoint_state)
+    && checkpoint_state.stage == kInitialStructureStage
+    && checkpoint_state.fingerprint == inputs_fingerprint;
+  if (b_resumed)
   {
-    OPENMVG_LOG_ERROR << "GlobalSfM:: Translation Averaging failure!";
-    return false;
+    sfm_data_ = std::move(checkpoint_scene);
+    intrinsic_refinement_options_ = checkpoint_state.intrinsic_refinement_options;
+    extrinsic_refinement_options_ = checkpoint_state.extrinsic_refinement_options;
+    OPENMVG_LOG_INFO << "Resume from the checkpoint: " << sfm_data_.GetPoses().size() << " poses, "
+      << sfm_data_.GetLandmarks().size() << " landmarks";
   }
-  if (!Compute_Initial_Structure(tripletWise_matches))
+  else
   {
-    OPENMVG_LOG_ERROR << "GlobalSfM:: Cannot initialize an initial structure!";
-    return false;
+    openMVG::rotation_averaging::RelativeRotations relatives_R;
+    Compute_Relative_Rotations(relatives_R);
+
+    Hash_Map<IndexT, Mat3> global_rotations;
+    if (!Compute_Global_Rotations(relatives_R, global_rotations))
+    {
+      OPENMVG_LOG_ERROR << "GlobalSfM:: Rotation Averaging failure!";
+      return false;
+    }
+
+    matching::PairWiseMatches  tripletWise_matches;
+    if (!Compute_Global_Translations(global_rotations, tripletWise_matches))
+    {
+      OPENMVG_LOG_ERROR << "GlobalSfM:: Translation Averaging failure!";
+      return false;
+    }
+    if (!Compute_Initial_Structure(tripletWise_matches))
+    {
+      OPENMVG_LOG_ERROR << "GlobalSfM:: Cannot initialize an initial structure!";
+      return false;
+    }
+
+    // Checkpoint the initial structure (written while the scene is refined)
+    if (checkpoint_)
+    {
+      checkpoint_state = SfM_Checkpoint_State();
+      checkpoint_state.stage = kInitialStructureStage;
+      checkpoint_state.fingerprint = inputs_fingerprint;
+      checkpoint_state.intrinsic_refinement_options = intrinsic_refinement_options_;
+      checkpoint_state.extrinsic_refinement_options = extrinsic_refinement_options_;
+      checkpoint_->Save(sfm_data_, checkpoint_state, true);
+    }
   }
+
   if (!Adjust())
   {
     OPENMVG_LOG_ERROR << "GlobalSfM:: Non-linear adjustment failure!";
@@ -295,7 +339,7 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Compute_Global_Translations
 )
 {
   // Translation averaging (compute translations & update them to a global common coordinates system)
-  GlobalSfM_Translation_AveragingSolver translation_averaging_solver;
+  GlobalSfM_Translation_AveragingSolver translation_averaging_solver(max_simplex_cameras_);
   const bool bTranslationAveraging = translation_averaging_solver.Run(
     eTranslation_averaging_method_,
     sfm_data_,
@@ -540,6 +584,12 @@ void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
   const Relative_Pose_Engine::Relative_Pair_Poses relative_poses = [&]
   {
     Relative_Pose_Engine relative_pose_engine;
+    // Keep the relative poses along the checkpoints (a resumed run computes
+    //  only the missing ones, a new run overwrites them)
+    if (checkpoint_)
+      relative_pose_engine.SetResultsFile(
+        stlplus::create_filespec(checkpoint_->Directory(), "relative_poses", "bin"),
+        b_resume_from_checkpoint_);
     if (!relative_pose_engine.Process(sfm_data_,
         matches_provider_,
         features_provider_))
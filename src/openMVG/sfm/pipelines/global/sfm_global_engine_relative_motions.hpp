@@ -43,6 +43,9 @@ public:
 
   void SetRotationAveragingMethod(ERotationAveragingMethod eRotationAveragingMethod);
   void SetTranslationAveragingMethod(ETranslationAveragingMethod eTranslation_averaging_method_);
+  /// Above this number of cameras the L1 translation averaging uses the first
+  ///  order LP solver (PDLP) instead of the simplex solver
+  void SetMaxSimplexCameras(size_t max_simplex_cameras);
 
   bool Process() override;
 
@@ -88,6 +91,7 @@ private:
   // Parameter
   ERotationAveragingMethod eRotation_averaging_method_;
   ETranslationAveragingMethod eTranslation_averaging_method_;
+  size_t max_simplex_cameras_;
 
   //-- Data provider
   Features_Provider  * features_provider_;
@@ -0,0 +1,623 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/pipelines/localization/SfM_Localizer_Landmark_Index.hpp"
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/clustering/kmeans.hpp"
+#include "openMVG/features/regions.hpp"
+#include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/system/logger.hpp"
+#include "openMVG/system/mapped_file.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <typeinfo>
+
+namespace openMVG {
+namespace sfm {
+
+struct SfM_Localization_Landmark_Index::Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t descriptor_type; // see DescriptorType
+  uint32_t descriptor_length;
+  uint32_t cluster_count;
+  uint64_t landmark_count;
+  uint64_t descriptor_count;
+  // Section offsets (from the beginning of the file)
+  uint64_t landmark_positions_offset;
+  uint64_t landmark_ids_offset;
+  uint64_t cluster_centers_offset;
+  uint64_t cluster_ranges_offset;
+  uint64_t descriptor_landmarks_offset;
+  uint64_t descriptors_offset;
+  uint64_t file_size;
+};
+
+namespace {
+
+const char kLandmarkIndexMagic[8] = {'O', 'M', 'V', 'G', 'L', 'M', 'I', '1'};
+const uint32_t kLandmarkIndexVersion = 1;
+const uint64_t kSectionAlignment = 64;
+// Largest supported descriptor length (it bounds the descriptor and the cluster center sizes)
+const uint32_t kMaxDescriptorLength = 1 << 16;
+
+enum DescriptorType : uint32_t
+{
+  DESCRIPTOR_UINT8 = 1,
+  DESCRIPTOR_FLOAT = 2
+};
+
+uint32_t GetDescriptorType(const features::Regions & regions)
+{
+  if (!regions.IsScalar())
+    return 0;
+  if (regions.Type_id() == typeid(unsigned char).name())
+    return DESCRIPTOR_UINT8;
+  if (regions.Type_id() == typeid(float).name())
+    return DESCRIPTOR_FLOAT;
+  return 0;
+}
+
+size_t DescriptorTypeSize(const uint32_t descriptor_type)
+{
+  return descriptor_type == DESCRIPTOR_UINT8 ? sizeof(unsigned char) : sizeof(float);
+}
+
+uint64_t AlignOffset(const uint64_t offset)
+{
+  return (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+inline float SquaredDistance(const float * a, const float * b, const size_t size)
+{
+  float sum = 0.f;
+  for (size_t i = 0; i < size; ++i)
+  {
+    const float d = a[i] - b[i];
+    sum += d * d;
+  }
+  return sum;
+}
+
+inline float SquaredDistance
+(
+  const unsigned char * a,
+  const unsigned char * b,
+  const size_t size
+)
+{
+  // Integer accumulation (exact and vectorized by the compiler)
+  int32_t sum = 0;
+  for (size_t i = 0; i < size; ++i)
+  {
+    const int32_t d = static_cast<int32_t>(a[i]) - static_cast<int32_t>(b[i]);
+    sum += d * d;
+  }
+  return static_cast<float>(sum);
+}
+
+template <typename T>
+Vecf ToVecf(const T * descriptor, const size_t size)
+{
+  Vecf vec(size);
+  for (size_t i = 0; i < size; ++i)
+    vec[i] = static_cast<float>(descriptor[i]);
+  return vec;
+}
+
+/// Inverted file search of the query descriptors (see Match())
+template <typename T>
+void MatchInvertedFile
+(
+  const T * query_descriptors,
+  const size_t query_count,
+  const T * descriptors,
+  const uint32_t * descriptor_landmarks,
+  const float * cluster_centers,
+  const uint64_t * cluster_ranges,
+  const uint32_t cluster_count,
+  const size_t descriptor_length,
+  const uint32_t probe_count,
+  const float distance_ratio,
+  matching::IndMatches & matches
+)
+{
+  const float squared_ratio = distance_ratio * distance_ratio;
+  std::vector<std::pair<float, uint32_t>> cluster_distances(cluster_count);
+  std::vector<float> query_float(descriptor_length);
+  for (size_t j = 0; j < query_count; ++j)
+  {
+    const T * query = query_descriptors + j * descriptor_length;
+    std::copy(query, query + descriptor_length, query_float.begin());
+
+    // Nearest clusters of the query descriptor
+    for (uint32_t k = 0; k < cluster_count; ++k)
+    {
+      cluster_distances[k] = {SquaredDistance(query_float.data(),
+        cluster_centers + k * descriptor_length, descriptor_length), k};
+    }
+    std::partial_sort(cluster_distances.begin(),
+      cluster_distances.begin() + probe_count, cluster_distances.end());
+
+    // The two nearest landmarks (not the two nearest descriptors: the
+    // observations of a same landmark must not reject each other)
+    float best_distance = std::numeric_limits<float>::max();
+    float second_distance = std::numeric_limits<float>::max();
+    uint32_t best_landmark = std::numeric_limits<uint32_t>::max();
+    for (uint32_t p = 0; p < probe_count; ++p)
+    {
+      const uint32_t cluster = cluster_distances[p].second;
+      for (uint64_t i = cluster_ranges[cluster]; i < cluster_ranges[cluster + 1]; ++i)
+      {
+        const float distance =
+          SquaredDistance(query, descriptors + i * descriptor_length, descriptor_length);
+        if (distance < best_distance)
+        {
+          if (descriptor_landmarks[i] != best_landmark)
+          {
+            second_distance = best_distance;
+            best_landmark = descriptor_landmarks[i];
+          }
+          best_distance = distance;
+        }
+        else if (distance < second_distance && descriptor_landmarks[i] != best_landmark)
+        {
+          second_distance = distance;
+        }
+      }
+    }
+    if (best_landmark != std::numeric_limits<uint32_t>::max()
+        && best_distance < squared_ratio * second_distance)
+    {
+      matches.emplace_back(best_landmark, static_cast<IndexT>(j));
+    }
+  }
+}
+
+} // namespace
+
+SfM_Localization_Landmark_Index::SfM_Localization_Landmark_Index()
+: SfM_Localization_Landmark_Index(Options())
+{}
+
+SfM_Localization_Landmark_Index::SfM_Localization_Landmark_Index
+(
+  const Options & options
+)
+: SfM_Localizer(),
+  options_(options),
+  header_(nullptr),
+  landmark_positions_(nullptr),
+  landmark_ids_(nullptr),
+  cluster_centers_(nullptr),
+  cluster_ranges_(nullptr),
+  descriptor_landmarks_(nullptr),
+  descriptors_(nullptr)
+{}
+
+SfM_Localization_Landmark_Index::~SfM_Localization_Landmark_Index() = default;
+
+bool SfM_Localization_Landmark_Index::Init
+(
+  const SfM_Data & sfm_data,
+  const Regions_Provider & regions_provider
+)
+{
+  if (sfm_data.GetPoses().empty() || sfm_data.GetLandmarks().empty())
+  {
+    OPENMVG_LOG_ERROR << "The input SfM_Data file have no 3D content to match with.";
+    return false;
+  }
+  const features::Regions * regions_type = regions_provider.getRegionsType();
+  const uint32_t descriptor_type = regions_type ? GetDescriptorType(*regions_type) : 0;
+  if (descriptor_type == 0)
+  {
+    OPENMVG_LOG_ERROR << "The landmark index supports only unsigned char or float descriptors.";
+    return false;
+  }
+  const size_t descriptor_length = regions_type->DescriptorLength();
+  const size_t descriptor_size = descriptor_length * DescriptorTypeSize(descriptor_type);
+
+  // Landmarks are listed by id (the Landmarks container is not ordered),
+  // so a scene always gives the same database
+  std::vector<IndexT> landmark_ids;
+  landmark_ids.reserve(sfm_data.GetLandmarks().size());
+  for (const auto & landmark : sfm_data.GetLandmarks())
+    landmark_ids.push_back(landmark.first);
+  std::sort(landmark_ids.begin(), landmark_ids.end());
+
+  // Collect the observation descriptors
+  std::vector<unsigned char> raw_descriptors;
+  std::vector<uint32_t> raw_landmarks;
+  for (size_t l = 0; l < landmark_ids.size(); ++l)
+  {
+    const Landmark & landmark = sfm_data.GetLandmarks().at(landmark_ids[l]);
+    for (const auto & observation : landmark.obs)
+    {
+      if (observation.second.id_feat == UndefinedIndexT)
+        continue;
+      const std::shared_ptr<features::Regions> view_regions =
+        regions_provider.get(observation.first);
+      if (!view_regions || observation.second.id_feat >= view_regions->RegionCount())
+        continue;
+      const unsigned char * descriptor =
+        static_cast<const unsigned char*>(view_regions->DescriptorRawData())
+        + observation.second.id_feat * descriptor_size;
+      raw_descriptors.insert(raw_descriptors.end(), descriptor, descriptor + descriptor_size);
+      raw_landmarks.push_back(static_cast<uint32_t>(l));
+    }
+  }
+  const size_t descriptor_count = raw_landmarks.size();
+  if (descriptor_count == 0)
+  {
+    OPENMVG_LOG_ERROR << "The landmarks have no observation descriptors.";
+    return false;
+  }
+
+  const auto descriptor_as_vecf = [&](const size_t i)
+  {
+    const unsigned char * descriptor = raw_descriptors.data() + i * descriptor_size;
+    return descriptor_type == DESCRIPTOR_UINT8
+      ? ToVecf(descriptor, descriptor_length)
+      : ToVecf(reinterpret_cast<const float*>(descriptor), descriptor_length);
+  };
+
+  // Cluster a regular sample of the descriptors
+  uint32_t cluster_count = options_.cluster_count;
+  if (cluster_count == 0)
+  {
+    cluster_count = static_cast<uint32_t>(
+      std::max(16.0, std::min(4096.0, std::sqrt(static_cast<double>(descriptor_count)))));
+  }
+  cluster_count = static_cast<uint32_t>(std::min<size_t>(cluster_count, descriptor_count));
+
+  const size_t sample_step =
+    std::max<size_t>(1, descriptor_count / (static_cast<size_t>(cluster_count) * 32));
+  std::vector<Vecf> sample;
+  for (size_t i = 0; i < descriptor_count; i += sample_step)
+    sample.push_back(descriptor_as_vecf(i));
+
+  OPENMVG_LOG_INFO << "Clustering the landmark descriptors (" << cluster_count << " clusters)";
+  std::vector<uint32_t> sample_assignment;
+  std::vector<Vecf> kmeans_centers;
+  // Random initialization: the k-means++ one is quadratic in the cluster count
+  clustering::KMeans(sample, sample_assignment, kmeans_centers, cluster_count, 10,
+    clustering::KMeansInitType::KMEANS_INIT_RANDOM);
+  // Empty clusters have no center of mass
+  kmeans_centers.erase(
+    std::remove_if(kmeans_centers.begin(), kmeans_centers.end(),
+      [](const Vecf & center) { return !center.allFinite(); }),
+    kmeans_centers.end());
+  cluster_count = static_cast<uint32_t>(kmeans_centers.size());
+  if (cluster_count == 0)
+    return false;
+
+  // Assign every descriptor to its nearest cluster
+  std::vector<uint32_t> assignment(descriptor_count);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256)
+#endif
+  for (int i = 0; i < static_cast<int>(descriptor_count); ++i)
+  {
+    const Vecf descriptor = descriptor_as_vecf(i);
+    float best_distance = std::numeric_limits<float>::max();
+    for (uint32_t k = 0; k < cluster_count; ++k)
+    {
+      const float distance = (kmeans_centers[k] - descriptor).squaredNorm();
+      if (distance < best_distance)
+      {
+        best_distance = distance;
+        assignment[i] = k;
+      }
+    }
+  }
+
+  // Order the descriptors by cluster (counting sort, stable)
+  std::vector<uint64_t> cluster_ranges(cluster_count + 1, 0);
+  for (const uint32_t cluster : assignment)
+    ++cluster_ranges[cluster + 1];
+  for (uint32_t k = 0; k < cluster_count; ++k)
+    cluster_ranges[k + 1] += cluster_ranges[k];
+  std::vector<uint64_t> order(descriptor_count);
+  {
+    std::vector<uint64_t> next(cluster_ranges.begin(), cluster_ranges.end() - 1);
+    for (size_t i = 0; i < descriptor_count; ++i)
+      order[next[assignment[i]]++] = i;
+  }
+
+  // Layout of the database image
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::copy(kLandmarkIndexMagic, kLandmarkIndexMagic + sizeof(kLandmarkIndexMagic), header.magic);
+  header.version = kLandmarkIndexVersion;
+  header.descriptor_type = descriptor_type;
+  header.descriptor_length = static_cast<uint32_t>(descriptor_length);
+  header.cluster_count = cluster_count;
+  header.landmark_count = landmark_ids.size();
+  header.descriptor_count = descriptor_count;
+  header.landmark_positions_offset = AlignOffset(sizeof(Header));
+  header.landmark_ids_offset = AlignOffset(
+    header.landmark_positions_offset + header.landmark_count * 3 * sizeof(double));
+  header.cluster_centers_offset = AlignOffset(
+    header.landmark_ids_offset + header.landmark_count * sizeof(uint32_t));
+  header.cluster_ranges_offset = AlignOffset(
+    header.cluster_centers_offset + uint64_t(cluster_count) * descriptor_length * sizeof(float));
+  header.descriptor_landmarks_offset = AlignOffset(
+    header.cluster_ranges_offset + (uint64_t(cluster_count) + 1) * sizeof(uint64_t));
+  header.descriptors_offset = AlignOffset(
+    header.descriptor_landmarks_offset + descriptor_count * sizeof(uint32_t));
+  header.file_size = header.descriptors_offset + descriptor_count * descriptor_size;
+
+  // Fill the database image
+  mapped_file_.reset();
+  memory_.assign(header.file_size, 0);
+  unsigned char * data = memory_.data();
+  std::memcpy(data, &header, sizeof(Header));
+  double * landmark_positions =
+    reinterpret_cast<double*>(data + header.landmark_positions_offset);
+  uint32_t * landmark_index_ids =
+    reinterpret_cast<uint32_t*>(data + header.landmark_ids_offset);
+  for (size_t l = 0; l < landmark_ids.size(); ++l)
+  {
+    const Vec3 & X = sfm_data.GetLandmarks().at(landmark_ids[l]).X;
+    std::copy(X.data(), X.data() + 3, landmark_positions + 3 * l);
+    landmark_index_ids[l] = landmark_ids[l];
+  }
+  float * centers = reinterpret_cast<float*>(data + header.cluster_centers_offset);
+  for (uint32_t k = 0; k < cluster_count; ++k)
+    std::copy(kmeans_centers[k].data(), kmeans_centers[k].data() + descriptor_length,
+      centers + k * descriptor_length);
+  std::memcpy(data + header.cluster_ranges_offset, cluster_ranges.data(),
+    cluster_ranges.size() * sizeof(uint64_t));
+  uint32_t * descriptor_landmarks =
+    reinterpret_cast<uint32_t*>(data + header.descriptor_landmarks_offset);
+  unsigned char * descriptors = data + header.descriptors_offset;
+  for (size_t i = 0; i < descriptor_count; ++i)
+  {
+    descriptor_landmarks[i] = raw_landmarks[order[i]];
+    std::memcpy(descriptors + i * descriptor_size,
+      raw_descriptors.data() + order[i] * descriptor_size, descriptor_size);
+  }
+
+  if (!SetupSections(memory_.data(), memory_.size()))
+    return false;
+
+  OPENMVG_LOG_INFO << "Landmark index initialized with:\n"
+    << "#landmarks: " << LandmarkCount() << "\n"
+    << "#descriptors: " << DescriptorCount() << "\n"
+    << "#clusters: " << cluster_count;
+  return true;
+}
+
+bool SfM_Localization_Landmark_Index::Save(const std::string & filename) const
+{
+  if (!header_)
+    return false;
+  std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!stream)
+    return false;
+  stream.write(reinterpret_cast<const char*>(header_),
+    static_cast<std::streamsize>(header_->file_size));
+  return stream.good();
+}
+
+bool SfM_Localization_Landmark_Index::Load(const std::string & filename)
+{
+  header_ = nullptr;
+  memory_.clear();
+  memory_.shrink_to_fit();
+  mapped_file_.reset(new system::Mapped_File);
+  if (!mapped_file_->Open(filename))
+  {
+    OPENMVG_LOG_ERROR << "Cannot map the landmark index: " << filename;
+    mapped_file_.reset();
+    return false;
+  }
+  if (!SetupSections(mapped_file_->data(), mapped_file_->size()))
+  {
+    OPENMVG_LOG_ERROR << "Invalid landmark index: " << filename;
+    mapped_file_.reset();
+    return false;
+  }
+  return true;
+}
+
+bool SfM_Localization_Landmark_Index::SetupSections
+(
+  const unsigned char * data,
+  const size_t size
+)
+{
+  header_ = nullptr;
+  if (!data || size < sizeof(Header))
+    return false;
+  const Header * header = reinterpret_cast<const Header*>(data);
+  if (!std::equal(header->magic, header->magic + sizeof(header->magic), kLandmarkIndexMagic)
+      || header->version != kLandmarkIndexVersion
+      || (header->descriptor_type != DESCRIPTOR_UINT8
+          && header->descriptor_type != DESCRIPTOR_FLOAT)
+      || header->descriptor_length == 0
+      || header->descriptor_length > kMaxDescriptorLength
+      || header->cluster_count == 0
+      || header->file_size != size)
+    return false;
+
+  // Every section must lie in the file and be aligned.
+  // The element counts are checked without computing the section sizes
+  //  (a corrupted count must not make the size wrap around).
+  const uint64_t descriptor_size =
+    uint64_t(header->descriptor_length) * DescriptorTypeSize(header->descriptor_type);
+  struct Section { uint64_t offset, count, element_size; };
+  const Section sections[] = {
+    {header->landmark_positions_offset, header->landmark_count, 3 * sizeof(double)},
+    {header->landmark_ids_offset, header->landmark_count, sizeof(uint32_t)},
+    {header->cluster_centers_offset, header->cluster_count,
+      uint64_t(header->descriptor_length) * sizeof(float)},
+    {header->cluster_ranges_offset, uint64_t(header->cluster_count) + 1, sizeof(uint64_t)},
+    {header->descriptor_landmarks_offset, header->descriptor_count, sizeof(uint32_t)},
+    {header->descriptors_offset, header->descriptor_count, descriptor_size}
+  };
+  for (const Section & section : sections)
+  {
+    if (section.offset % kSectionAlignment != 0
+        || section.offset > size
+        || section.count > (size - section.offset) / section.element_size)
+      return false;
+  }
+
+  const uint64_t * cluster_ranges =
+    reinterpret_cast<const uint64_t*>(data + header->cluster_ranges_offset);
+  if (cluster_ranges[0] != 0 || cluster_ranges[header->cluster_count] != header->descriptor_count)
+    return false;
+  for (uint32_t k = 0; k < header->cluster_count; ++k)
+  {
+    if (cluster_ranges[k] > cluster_ranges[k + 1])
+      return false;
+  }
+
+  // The matches index the landmark sections through the descriptor landmarks
+  const uint32_t * descriptor_landmarks =
+    reinterpret_cast<const uint32_t*>(data + header->descriptor_landmarks_offset);
+  for (uint64_t i = 0; i < header->descriptor_count; ++i)
+  {
+    if (descriptor_landmarks[i] >= header->landmark_count)
+      return false;
+  }
+
+  header_ = header;
+  landmark_positions_ = reinterpret_cast<const double*>(data + header->landmark_positions_offset);
+  landmark_ids_ = reinterpret_cast<const uint32_t*>(data + header->landmark_ids_offset);
+  cluster_centers_ = reinterpret_cast<const float*>(data + header->cluster_centers_offset);
+  cluster_ranges_ = cluster_ranges;
+  descriptor_landmarks_ = descriptor_landmarks;
+  descriptors_ = data + header->descriptors_offset;
+  return true;
+}
+
+bool SfM_Localization_Landmark_Index::Match
+(
+  const features::Regions & query_regions,
+  matching::IndMatches & matches
+) const
+{
+  matches.clear();
+  if (!header_)
+  {
+    OPENMVG_LOG_ERROR << "The landmark index is not initialized.";
+    return false;
+  }
+  if (GetDescriptorType(query_regions) != header_->descriptor_type
+      || query_regions.DescriptorLength() != header_->descriptor_length)
+  {
+    OPENMVG_LOG_ERROR << "The query regions type does not match the landmark index.";
+    return false;
+  }
+  const uint32_t probe_count =
+    std::max<uint32_t>(1, std::min(options_.probe_count, header_->cluster_count));
+  if (header_->descriptor_type == DESCRIPTOR_UINT8)
+  {
+    MatchInvertedFile(
+      static_cast<const unsigned char*>(query_regions.DescriptorRawData()),
+      query_regions.RegionCount(),
+      static_cast<const unsigned char*>(descriptors_),
+      descriptor_landmarks_, cluster_centers_, cluster_ranges_,
+      header_->cluster_count, header_->descriptor_length,
+      probe_count, options_.distance_ratio, matches);
+  }
+  else
+  {
+    MatchInvertedFile(
+      static_cast<const float*>(query_regions.DescriptorRawData()),
+      query_regions.RegionCount(),
+      static_cast<const float*>(descriptors_),
+      descriptor_landmarks_, cluster_centers_, cluster_ranges_,
+      header_->cluster_count, header_->descriptor_length,
+      probe_count, options_.distance_ratio, matches);
+  }
+  return true;
+}
+
+bool SfM_Localization_Landmark_Index::Localize
+(
+  const resection::SolverType & solver_type,
+  const Pair & image_size,
+  const cameras::IntrinsicBase * optional_intrinsics,
+  const features::Regions & query_regions,
+  geometry::Pose3 & pose,
+  Image_Localizer_Match_Data * resection_data_ptr
+) const
+{
+  matching::IndMatches vec_putative_matches;
+  if (!Match(query_regions, vec_putative_matches))
+  {
+    return false;
+  }
+
+  OPENMVG_LOG_INFO << "#3D2d putative correspondences: " << vec_putative_matches.size();
+  // Init the 3D-2d correspondences array
+  Image_Localizer_Match_Data resection_data;
+  if (resection_data_ptr)
+  {
+    resection_data.error_max = resection_data_ptr->error_max;
+  }
+  resection_data.pt3D.resize(3, vec_putative_matches.size());
+  resection_data.pt2D.resize(2, vec_putative_matches.size());
+  for (size_t i = 0; i < vec_putative_matches.size(); ++i)
+  {
+    resection_data.pt3D.col(i) = LandmarkPosition(vec_putative_matches[i].i_);
+    resection_data.pt2D.col(i) = query_regions.GetRegionPosition(vec_putative_matches[i].j_);
+  }
+  Mat2X pt2D_original = resection_data.pt2D;
+  // Handle image distortion if intrinsic is known (to ease the resection)
+  if (optional_intrinsics && optional_intrinsics->have_disto())
+  {
+    resection_data.pt2D = ud_lut_cache_.Get(*optional_intrinsics)->get_ud_pixels(pt2D_original);
+  }
+
+  const bool bResection = SfM_Localizer::Localize(
+    solver_type, image_size, optional_intrinsics, resection_data, pose);
+
+  resection_data.pt2D = std::move(pt2D_original); // restore original image domain points
+
+  if (resection_data_ptr)
+    (*resection_data_ptr) = std::move(resection_data);
+
+  return bResection;
+}
+
+size_t SfM_Localization_Landmark_Index::LandmarkCount() const
+{
+  return header_ ? header_->landmark_count : 0;
+}
+
+size_t SfM_Localization_Landmark_Index::DescriptorCount() const
+{
+  return header_ ? header_->descriptor_count : 0;
+}
+
+Vec3 SfM_Localization_Landmark_Index::LandmarkPosition(const size_t i) const
+{
+  return Vec3(landmark_positions_[3 * i],
+              landmark_positions_[3 * i + 1],
+              landmark_positions_[3 * i + 2]);
+}
+
+IndexT SfM_Localization_Landmark_Index::LandmarkId(const size_t i) const
+{
+  return landmark_ids_[i];
+}
+
+} // namespace sfm
+} // namespace openMVG
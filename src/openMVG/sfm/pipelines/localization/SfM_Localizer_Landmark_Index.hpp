@@ -0,0 +1,155 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_PIPELINES_LOCALIZATION_SFM_LOCALIZER_LANDMARK_INDEX_HPP
+#define OPENMVG_SFM_PIPELINES_LOCALIZATION_SFM_LOCALIZER_LANDMARK_INDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "openMVG/cameras/Camera_undistortion_lut.hpp"
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/sfm/pipelines/localization/SfM_Localizer.hpp"
+#include "openMVG/types.hpp"
+
+namespace openMVG { namespace system { class Mapped_File; } }
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* @brief Persistent landmark descriptor database for the localization.
+*
+* The landmark observation descriptors are clustered (k-means) and stored
+* by cluster (an inverted file). A query descriptor is compared only to the
+* descriptors of its nearest clusters.
+*
+* The database is a single flat file (".lmi") whose sections are used in
+* place: Load() memory maps it, so opening a large database is immediate
+* and the database is shared by the processes that use it.
+* Init() builds the same layout in memory (and Save() writes it).
+*
+* Localize() and Match() only read the database: they can be called
+* concurrently from several threads.
+*
+* File layout (native endianness, 64 bytes aligned sections):
+*  - header (magic, descriptor type & length, counts, section offsets),
+*  - landmark positions (3 doubles) and landmark ids,
+*  - cluster centers (floats), cluster descriptor ranges,
+*  - for each descriptor (ordered by cluster): its landmark index,
+*  - the descriptors (ordered by cluster).
+*/
+class SfM_Localization_Landmark_Index : public SfM_Localizer
+{
+public:
+
+  struct Options
+  {
+    // Number of clusters (0: automatic, ~ square root of the descriptor count)
+    uint32_t cluster_count = 0;
+    // Number of clusters visited by a query descriptor
+    uint32_t probe_count = 8;
+    // Nearest neighbor distance ratio (between the two nearest landmarks)
+    float distance_ratio = 0.8f;
+  };
+
+  SfM_Localization_Landmark_Index();
+  explicit SfM_Localization_Landmark_Index(const Options & options);
+  ~SfM_Localization_Landmark_Index() override;
+
+  /**
+  * @brief Build the database (3D points descriptors) in memory
+  *
+  * @param[in] sfm_data the SfM scene that have to be described
+  * @param[in] region_provider regions provider (scalar descriptors only)
+  * @return True if the database has been correctly setup
+  */
+  bool Init
+  (
+    const SfM_Data & sfm_data,
+    const Regions_Provider & regions_provider
+  ) override;
+
+  /// Save the database to a file
+  bool Save(const std::string & filename) const;
+
+  /// Map a database file (built by Init() & Save())
+  bool Load(const std::string & filename);
+
+  /**
+  * @brief Try to localize an image in the database
+  *
+  * @param[in] solver_type the type of absolute pose solver to use
+  * @param[in] image_size the w,h image size
+  * @param[in] optional_intrinsics camera intrinsic if known (else nullptr)
+  * @param[in] query_regions the image regions (type must be the same as the database)
+  * @param[out] pose found pose
+  * @param[out] resection_data matching data (2D-3D and inliers; optional)
+  * @return True if a putative pose has been estimated
+  */
+  bool Localize
+  (
+    const resection::SolverType & solver_type,
+    const Pair & image_size,
+    const cameras::IntrinsicBase * optional_intrinsics,
+    const features::Regions & query_regions,
+    geometry::Pose3 & pose,
+    Image_Localizer_Match_Data * resection_data_ptr = nullptr
+  ) const override;
+
+  /**
+  * @brief Find the putative 2D-3D matches of some query regions
+  *
+  * @param[in] query_regions the image regions (type must be the same as the database)
+  * @param[out] matches putative matches (i_: landmark index, j_: query region index)
+  * @return True if the query regions can be matched to the database
+  */
+  bool Match
+  (
+    const features::Regions & query_regions,
+    matching::IndMatches & matches
+  ) const;
+
+  size_t LandmarkCount() const;
+  size_t DescriptorCount() const;
+
+  /// Position and id of the i-th landmark of the database
+  Vec3 LandmarkPosition(const size_t i) const;
+  IndexT LandmarkId(const size_t i) const;
+
+private:
+  struct Header;
+
+  /// Setup the section pointers from a database image (memory or mapped file)
+  bool SetupSections(const unsigned char * data, const size_t size);
+
+  Options options_;
+
+  // Database image: built in memory or mapped from a file
+  std::vector<unsigned char> memory_;
+  std::unique_ptr<system::Mapped_File> mapped_file_;
+
+  // Sections of the database image
+  const Header * header_;
+  const double * landmark_positions_;
+  const uint32_t * landmark_ids_;
+  const float * cluster_centers_;
+  const uint64_t * cluster_ranges_;
+  const uint32_t * descriptor_landmarks_;
+  const void * descriptors_;
+
+  // Inverse distortion tables of the query cameras (shared by the queries)
+  mutable cameras::Inverse_Distortion_LUT_Cache ud_lut_cache_;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_PIPELINES_LOCALIZATION_SFM_LOCALIZER_LANDMARK_INDEX_HPP
@@ -0,0 +1,198 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Init a SfM_Data scene from a synthetic dataset
+// - Give each landmark a random descriptor (its observations are noisy copies)
+// - Build the landmark index, save it and map it back
+// - Assert that:
+//   - the query descriptors are matched to their landmark,
+//   - the pose of a view is found from its regions.
+//-----------------
+
+#include "openMVG/features/regions_factory.hpp"
+#include "openMVG/sfm/pipelines/localization/SfM_Localizer_Landmark_Index.hpp"
+#include "openMVG/sfm/pipelines/pipelines_test.hpp"
+#include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+
+#include "testing/testing.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::features;
+using namespace openMVG::sfm;
+
+namespace {
+
+// Regions of the synthetic scene views
+struct Synthetic_Regions_Provider : public Regions_Provider
+{
+  Synthetic_Regions_Provider
+  (
+    const SfM_Data & sfm_data,
+    const std::vector<SIFT_Regions::DescriptorT> & landmark_descriptors,
+    std::mt19937 & random_generator
+  )
+  {
+    region_type_.reset(new SIFT_Regions);
+    for (const auto & view : sfm_data.GetViews())
+    {
+      cache_[view.first] = std::make_shared<SIFT_Regions>();
+    }
+    // The feature id of an observation is its landmark id
+    for (const auto & landmark : sfm_data.GetLandmarks())
+    {
+      for (const auto & observation : landmark.second.obs)
+      {
+        SIFT_Regions * regions = static_cast<SIFT_Regions*>(cache_[observation.first].get());
+        regions->Features().emplace_back(
+          observation.second.x.x(), observation.second.x.y(), 1.f, 0.f);
+        regions->Descriptors().push_back(
+          Noisy(landmark_descriptors[landmark.first], random_generator));
+      }
+    }
+  }
+
+  static SIFT_Regions::DescriptorT Noisy
+  (
+    const SIFT_Regions::DescriptorT & descriptor,
+    std::mt19937 & random_generator
+  )
+  {
+    std::uniform_int_distribution<int> noise(-3, 3);
+    SIFT_Regions::DescriptorT noisy;
+    for (uint32_t i = 0; i < SIFT_Regions::DescriptorT::static_size; ++i)
+      noisy[i] = static_cast<unsigned char>(
+        std::min(255, std::max(0, descriptor[i] + noise(random_generator))));
+    return noisy;
+  }
+};
+
+} // namespace
+
+TEST(LANDMARK_INDEX, Match_And_Localize)
+{
+  const int nviews = 6;
+  const int npoints = 512;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_int_distribution<int> value(0, 255);
+  std::vector<SIFT_Regions::DescriptorT> landmark_descriptors(npoints);
+  for (auto & descriptor : landmark_descriptors)
+  {
+    for (uint32_t i = 0; i < SIFT_Regions::DescriptorT::static_size; ++i)
+      descriptor[i] = static_cast<unsigned char>(value(random_generator));
+  }
+  const Synthetic_Regions_Provider regions_provider(
+    sfm_data, landmark_descriptors, random_generator);
+
+  SfM_Localization_Landmark_Index::Options options;
+  options.cluster_count = 16;
+  SfM_Localization_Landmark_Index built_index(options);
+  EXPECT_TRUE(built_index.Init(sfm_data, regions_provider));
+  EXPECT_EQ(npoints, built_index.LandmarkCount());
+  EXPECT_EQ(nviews * npoints, built_index.DescriptorCount());
+
+  const std::string filename = "landmark_index_test.lmi";
+  EXPECT_TRUE(built_index.Save(filename));
+  SfM_Localization_Landmark_Index index(options);
+  EXPECT_TRUE(index.Load(filename));
+  EXPECT_EQ(built_index.LandmarkCount(), index.LandmarkCount());
+  EXPECT_EQ(built_index.DescriptorCount(), index.DescriptorCount());
+
+  // Query: new noisy observations of the landmarks seen by the first view
+  SIFT_Regions query_regions;
+  for (int i = 0; i < npoints; ++i)
+  {
+    query_regions.Features().emplace_back(d._x[0](0, i), d._x[0](1, i), 1.f, 0.f);
+    query_regions.Descriptors().push_back(
+      Synthetic_Regions_Provider::Noisy(landmark_descriptors[i], random_generator));
+  }
+
+  matching::IndMatches matches;
+  EXPECT_TRUE(index.Match(query_regions, matches));
+  EXPECT_TRUE(matches.size() > npoints * 0.9);
+  for (const auto & match : matches)
+  {
+    EXPECT_EQ(match.j_, index.LandmarkId(match.i_));
+    EXPECT_MATRIX_NEAR(d._X.col(match.j_), index.LandmarkPosition(match.i_), 1e-12);
+  }
+
+  geometry::Pose3 pose;
+  Image_Localizer_Match_Data resection_data;
+  resection_data.error_max = 4.0;
+  EXPECT_TRUE(index.Localize(
+    resection::SolverType::DEFAULT,
+    {config._cx * 2, config._cy * 2},
+    sfm_data.GetIntrinsics().at(0).get(),
+    query_regions,
+    pose,
+    &resection_data));
+  EXPECT_TRUE(resection_data.vec_inliers.size() > npoints * 0.9);
+  EXPECT_MATRIX_NEAR(d._C[0], pose.center(), 1e-6);
+  EXPECT_MATRIX_NEAR(d._R[0], pose.rotation(), 1e-6);
+
+  // A descriptor that refers to a landmark out of range is a corrupted index
+  {
+    std::fstream stream(filename, std::ios::in | std::ios::out | std::ios::binary);
+    // Offset of the descriptor landmarks section in the header
+    stream.seekg(72);
+    uint64_t descriptor_landmarks_offset = 0;
+    stream.read(reinterpret_cast<char*>(&descriptor_landmarks_offset), sizeof(uint64_t));
+    stream.seekp(descriptor_landmarks_offset);
+    const uint32_t corrupted_landmark = npoints;
+    stream.write(reinterpret_cast<const char*>(&corrupted_landmark), sizeof(uint32_t));
+    EXPECT_TRUE(stream.good());
+  }
+  SfM_Localization_Landmark_Index corrupted_index(options);
+  EXPECT_FALSE(corrupted_index.Load(filename));
+
+  // A landmark count whose section sizes wrap around (2^62 * 24 and 2^62 * 4
+  //  are 0 modulo 2^64) is a corrupted index
+  EXPECT_TRUE(built_index.Save(filename));
+  {
+    std::fstream stream(filename, std::ios::in | std::ios::out | std::ios::binary);
+    // Offset of the landmark count in the header
+    stream.seekp(24);
+    const uint64_t corrupted_count = uint64_t(1) << 62;
+    stream.write(reinterpret_cast<const char*>(&corrupted_count), sizeof(uint64_t));
+    EXPECT_TRUE(stream.good());
+  }
+  EXPECT_FALSE(corrupted_index.Load(filename));
+
+  // A truncated index
+  EXPECT_TRUE(built_index.Save(filename));
+  {
+    std::string buffer;
+    {
+      std::ifstream stream(filename, std::ios::binary);
+      buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+    stream.write(buffer.data(), buffer.size() / 2);
+    EXPECT_TRUE(stream.good());
+  }
+  EXPECT_FALSE(corrupted_index.Load(filename));
+
+  std::remove(filename.c_str());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
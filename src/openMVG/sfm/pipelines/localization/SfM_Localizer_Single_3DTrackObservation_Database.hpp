@@ -11,6 +11,7 @@
 
 #include <vector>
 
+#include "openMVG/cameras/Camera_undistortion_lut.hpp"
 #include "openMVG/matching/regions_matcher.hpp"
 #include "openMVG/sfm/pipelines/localization/SfM_Localizer.hpp"
 #include "openMVG/types.hpp"
@@ -80,6 +81,8 @@ private:
   /// A matching interface to find matches between 2D descriptor matches
   ///  and 3D points observation descriptors
   std::unique_ptr<matching::RegionsMatcher> matching_interface_;
+  /// Inverse distortion tables of the query cameras (shared by the queries)
+  mutable cameras::Inverse_Distortion_LUT_Cache ud_lut_cache_;
 };
 
 } // namespace sfm
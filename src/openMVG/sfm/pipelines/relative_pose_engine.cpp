@@ -17,11 +17,19 @@
 #include "openMVG/sfm/sfm_data_BA_ceres.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
+#include "openMVG/stl/hash.hpp"
 #include "openMVG/system/logger.hpp"
 #include "openMVG/system/timer.hpp"
 
 #include "ceres/ceres.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
 namespace openMVG {
 namespace sfm {
 
@@ -53,6 +61,261 @@ bool Relative_Pose_Engine::Process(
       features_provider_);
 }
 
+namespace {
+
+// Binary relative pose results file:
+// - header: magic number, fingerprint of the computation inputs,
+// - records: pose pair ids, status, rotation, camera center.
+const char kResultsMagic[8] = {'O', 'M', 'V', 'G', 'R', 'P', 'E', '1'};
+
+void WriteResult
+(
+  std::ostream & stream,
+  const Pair & relative_pose_pair,
+  const bool valid,
+  const Pose3 & relative_pose
+)
+{
+  const uint32_t ids[2] = {static_cast<uint32_t>(relative_pose_pair.first),
+                           static_cast<uint32_t>(relative_pose_pair.second)};
+  const uint8_t status = valid ? 1 : 0;
+  const Mat3 R = relative_pose.rotation();
+  const Vec3 C = relative_pose.center();
+  stream.write(reinterpret_cast<const char*>(ids), sizeof(ids));
+  stream.write(reinterpret_cast<const char*>(&status), sizeof(status));
+  stream.write(reinterpret_cast<const char*>(R.data()), 9 * sizeof(double));
+  stream.write(reinterpret_cast<const char*>(C.data()), 3 * sizeof(double));
+}
+
+// Load the results of a previous run (a truncated last record is ignored).
+// Return false if the file does not exist or was written for other pose pairs.
+bool LoadResults
+(
+  const std::string & filename,
+  const uint64_t fingerprint,
+  std::map<Pair, std::pair<bool, Pose3>> & results
+)
+{
+  std::ifstream stream(filename, std::ios::in | std::ios::binary);
+  if (!stream)
+    return false;
+  char magic[8];
+  uint64_t file_fingerprint = 0;
+  if (!stream.read(magic, sizeof(magic))
+      || !std::equal(magic, magic + sizeof(magic), kResultsMagic)
+      || !stream.read(reinterpret_cast<char*>(&file_fingerprint), sizeof(file_fingerprint))
+      || file_fingerprint != fingerprint)
+    return false;
+
+  uint32_t ids[2];
+  uint8_t status;
+  Mat3 R;
+  Vec3 C;
+  while (stream.read(reinterpret_cast<char*>(ids), sizeof(ids))
+         && stream.read(reinterpret_cast<char*>(&status), sizeof(status))
+         && stream.read(reinterpret_cast<char*>(R.data()), 9 * sizeof(double))
+         && stream.read(reinterpret_cast<char*>(C.data()), 3 * sizeof(double)))
+  {
+    results[{ids[0], ids[1]}] = {status == 1, Pose3(R, C)};
+  }
+  return true;
+}
+
+// Compute the un-distorted coordinates of the features matched by a batch of
+//  relative pose tasks (the other features of the views are left to zero)
+void UndistortMatchedFeatures
+(
+  const SfM_Data & sfm_data_,
+  const Matches_Provider * matches_provider_,
+  const Features_Provider * features_provider_,
+  const std::vector<std::pair<Pair, Pair_Set>> & relative_pose_tasks,
+  const std::vector<int> & batch_tasks,
+  Hash_Map<IndexT, std::vector<Vec2>> & ud_features
+)
+{
+  Hash_Map<IndexT, std::vector<bool>> matched_features;
+  for (const int i : batch_tasks)
+  {
+    for (const Pair & pair : relative_pose_tasks[i].second)
+    {
+      std::vector<bool>
+        & matched_I = matched_features[pair.first],
+        & matched_J = matched_features[pair.second];
+      matched_I.resize(features_provider_->feats_per_view.at(pair.first).size(), false);
+      matched_J.resize(features_provider_->feats_per_view.at(pair.second).size(), false);
+      for (const auto & match : matches_provider_->pairWise_matches_.at(pair))
+      {
+        matched_I[match.i_] = true;
+        matched_J[match.j_] = true;
+      }
+    }
+  }
+  std::vector<IndexT> matched_views;
+  for (const auto & matched_it : matched_features)
+  {
+    matched_views.push_back(matched_it.first);
+    ud_features[matched_it.first].resize(matched_it.second.size(), Vec2::Zero());
+  }
+  #ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+  #endif
+  for (int i = 0; i < static_cast<int>(matched_views.size()); ++i)
+  {
+    const IndexT view_id = matched_views[i];
+    const View * view = sfm_data_.views.at(view_id).get();
+    if (sfm_data_.GetIntrinsics().count(view->id_intrinsic) == 0)
+      continue;
+    const IntrinsicBase * cam = sfm_data_.GetIntrinsics().at(view->id_intrinsic).get();
+    const features::PointFeatures & features = features_provider_->feats_per_view.at(view_id);
+    const std::vector<bool> & matched = matched_features.at(view_id);
+    std::vector<Vec2> & ud_coords = ud_features.at(view_id);
+    for (size_t k = 0; k < features.size(); ++k)
+    {
+      if (matched[k])
+        ud_coords[k] = cam->get_ud_pixel(features[k].coords().cast<double>());
+    }
+  }
+}
+
+// Compute the relative pose of a pose pair from its view pair matches
+bool ComputeRelativePose
+(
+  const SfM_Data & sfm_data_,
+  const Matches_Provider * matches_provider_,
+  const Features_Provider * features_provider_,
+  const Hash_Map<IndexT, std::vector<Vec2>> & ud_features,
+  const ETriangulationMethod triangulation_method_,
+  const Pair & relative_pose_pair,
+  const Pair_Set & match_pairs,
+  Pose3 & relative_pose
+)
+{
+  // If a pair has the same ID, discard it
+  if (relative_pose_pair.first == relative_pose_pair.second)
+  {
+    return false;
+  }
+
+  // Select common bearing vectors
+  if (match_pairs.size() > 1)
+  {
+    OPENMVG_LOG_ERROR << "Compute relative pose between more than two view (rigid camera rigs) is not supported ";
+    return false;
+  }
+
+  const Pair current_pair(*std::begin(match_pairs));
+
+  const IndexT
+    I = current_pair.first,
+    J = current_pair.second;
+
+  const View
+    * view_I = sfm_data_.views.at(I).get(),
+    * view_J = sfm_data_.views.at(J).get();
+
+  // Check that valid cameras exist for the view pair
+  if (sfm_data_.GetIntrinsics().count(view_I->id_intrinsic) == 0 ||
+      sfm_data_.GetIntrinsics().count(view_J->id_intrinsic) == 0)
+    return false;
+
+  const IntrinsicBase
+    * cam_I = sfm_data_.GetIntrinsics().at(view_I->id_intrinsic).get(),
+    * cam_J = sfm_data_.GetIntrinsics().at(view_J->id_intrinsic).get();
+
+  // Retrieve for each feature the un-distorted camera coordinates
+  //  (computed once per view of the batch)
+  const std::vector<Vec2>
+    & ud_features_I = ud_features.at(I),
+    & ud_features_J = ud_features.at(J);
+  const matching::IndMatches & matches = matches_provider_->pairWise_matches_.at(current_pair);
+  size_t number_matches = matches.size();
+  Mat2X x1(2, number_matches), x2(2, number_matches);
+  number_matches = 0;
+  for (const auto & match : matches)
+  {
+    x1.col(number_matches) = ud_features_I[match.i_];
+    x2.col(number_matches++) = ud_features_J[match.j_];
+  }
+
+  RelativePose_Info relativePose_info;
+  relativePose_info.initial_residual_tolerance = Square(2.5);
+  if (!robustRelativePose(cam_I, cam_J,
+                          x1, x2, relativePose_info,
+                          {cam_I->w(), cam_I->h()},
+                          {cam_J->w(), cam_J->h()},
+                          256))
+  {
+    return false;
+  }
+  const bool bRefine_using_BA = true;
+  if (bRefine_using_BA)
+  {
+    // Refine the defined scene
+    SfM_Data tiny_scene;
+    tiny_scene.views.insert(*sfm_data_.GetViews().find(view_I->id_view));
+    tiny_scene.views.insert(*sfm_data_.GetViews().find(view_J->id_view));
+    tiny_scene.intrinsics.insert(*sfm_data_.GetIntrinsics().find(view_I->id_intrinsic));
+    tiny_scene.intrinsics.insert(*sfm_data_.GetIntrinsics().find(view_J->id_intrinsic));
+
+    // Init poses
+    const Pose3 & pose_I = tiny_scene.poses[view_I->id_pose] = {Mat3::Identity(), Vec3::Zero()};
+    const Pose3 & pose_J = tiny_scene.poses[view_J->id_pose] = relativePose_info.relativePose;
+
+    // Init structure
+    Landmarks & landmarks = tiny_scene.structure;
+    for (Mat::Index k = 0; k < x1.cols(); ++k)
+    {
+      Vec3 X;
+      if (Triangulate2View
+      (
+        pose_I.rotation(), pose_I.translation(), (*cam_I)(x1.col(k)),
+        pose_J.rotation(), pose_J.translation(), (*cam_J)(x2.col(k)),
+        X,
+        triangulation_method_
+      ))
+      {
+        Observations obs;
+        const Vec2 obs_I = features_provider_->feats_per_view.at(I)[matches[k].i_].coords().cast<double>();
+        const Vec2 obs_J = features_provider_->feats_per_view.at(J)[matches[k].j_].coords().cast<double>();
+        obs[view_I->id_view] = {obs_I, matches[k].i_};
+        obs[view_J->id_view] = {obs_J, matches[k].j_};
+        landmarks[k].obs = obs;
+        landmarks[k].X = X;
+      }
+    }
+    // - refine only Structure and Rotations & translations (keep intrinsic constant)
+    Bundle_Adjustment_Ceres::BA_Ceres_options options(false, false);
+    options.linear_solver_type_ = ceres::DENSE_SCHUR;
+    Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
+    const Optimize_Options ba_refine_options
+      (Intrinsic_Parameter_Type::NONE, // -> Keep intrinsic constant
+      Extrinsic_Parameter_Type::ADJUST_ALL, // adjust camera motion
+      Structure_Parameter_Type::ADJUST_ALL);// adjust scene structure
+    if (bundle_adjustment_obj.Adjust(tiny_scene, ba_refine_options))
+    {
+      // --> to debug: save relative pair geometry on disk
+      // std::ostringstream os;
+      // os << relative_pose_pair.first << "_" << relative_pose_pair.second << ".ply";
+      // Save(tiny_scene, os.str(), ESfM_Data(STRUCTURE | EXTRINSICS));
+      //
+      const Mat3 R1 = tiny_scene.poses[view_I->id_pose].rotation(),
+                 R2 = tiny_scene.poses[view_J->id_pose].rotation();
+      const Vec3 t1 = tiny_scene.poses[view_I->id_pose].translation(),
+                 t2 = tiny_scene.poses[view_J->id_pose].translation();
+      // Compute relative motion and save it
+      Mat3 Rrel;
+      Vec3 trel;
+      RelativeCameraMotion(R1, t1, R2, t2, &Rrel, &trel);
+      // Update found relative pose
+      relativePose_info.relativePose = Pose3(Rrel, -Rrel.transpose() * trel);
+    }
+  }
+  relative_pose = relativePose_info.relativePose;
+  return true;
+}
+
+} // namespace
+
 // Try to compute the relative pose for the provided pose pairs
 bool Relative_Pose_Engine::Relative_Pose_Engine::Process(
   const Pair_Set & relative_pose_pairs,
@@ -63,8 +326,9 @@ bool Relative_Pose_Engine::Relative_Pose_Engine::Process(
 {
   //
   // List the pairwise matches related to each pose edge ids.
+  // (sorted by pose pair, so that the results do not depend on the threads scheduling)
   //
-  using PoseWiseMatches = Hash_Map<Pair, Pair_Set>;
+  using PoseWiseMatches = std::map<Pair, Pair_Set>;
   PoseWiseMatches posewise_matches;
   for (const auto & iterMatches : matches_provider_->pairWise_matches_)
   {
@@ -75,152 +339,157 @@ bool Relative_Pose_Engine::Relative_Pose_Engine::Process(
         && relative_pose_pairs.count({v1->id_pose, v2->id_pose}) == 1)
       posewise_matches[{v1->id_pose, v2->id_pose}].insert(pair);
   }
+  const std::vector<std::pair<Pair, Pair_Set>> relative_pose_tasks(
+    posewise_matches.cbegin(), posewise_matches.cend());
 
-  system::Timer t;
-
-  system::LoggerProgress my_progress_bar(posewise_matches.size(),"- Relative pose computation -" );
+  // Result of each relative pose task
+  struct Relative_Pose_Result
+  {
+    bool computed = false;
+    bool valid = false;
+    Pose3 pose;
+  };
+  std::vector<Relative_Pose_Result> results(relative_pose_tasks.size());
 
-  #ifdef OPENMVG_USE_OPENMP
-    #pragma omp parallel for schedule(dynamic)
-  #endif
-  // Compute the relative pose from pairwise point matches:
-  for (int i = 0; i < static_cast<int>(posewise_matches.size()); ++i)
+  //
+  // Resume from the results of a previous run and stream the new results
+  //
+  std::ofstream results_stream;
+  std::mutex results_mutex;
+  if (!results_file_.empty())
   {
-    ++my_progress_bar;
+    // Fingerprint of the computation inputs: the triangulation method, the
+    //  pose pairs, their matches and the camera intrinsics of their views
+    std::size_t fingerprint = 0;
+    stl::hash_combine(fingerprint, static_cast<int>(triangulation_method_));
+    for (const auto & task : relative_pose_tasks)
     {
-      PoseWiseMatches::const_iterator iter (posewise_matches.begin());
-      std::advance(iter, i);
-      const auto & relative_pose_iterator(*iter);
-      const Pair relative_pose_pair = relative_pose_iterator.first;
-      const Pair_Set & match_pairs = relative_pose_iterator.second;
-
-      // If a pair has the same ID, discard it
-      if (relative_pose_pair.first == relative_pose_pair.second)
+      stl::hash_combine(fingerprint, task.first.first);
+      stl::hash_combine(fingerprint, task.first.second);
+      for (const Pair & pair : task.second)
       {
-        continue;
+        stl::hash_combine(fingerprint, pair.first);
+        stl::hash_combine(fingerprint, pair.second);
+        for (const IndexT view_id : {pair.first, pair.second})
+        {
+          const View * view = sfm_data_.GetViews().at(view_id).get();
+          const auto intrinsic_it = sfm_data_.GetIntrinsics().find(view->id_intrinsic);
+          if (intrinsic_it != sfm_data_.GetIntrinsics().end())
+            stl::hash_combine(fingerprint, intrinsic_it->second->hashValue());
+        }
+        const matching::IndMatches & matches = matches_provider_->pairWise_matches_.at(pair);
+        stl::hash_combine(fingerprint, matches.size());
+        for (const auto & match : matches)
+        {
+          stl::hash_combine(fingerprint, match.i_);
+          stl::hash_combine(fingerprint, match.j_);
+        }
       }
+    }
 
-      // Select common bearing vectors
-      if (match_pairs.size() > 1)
+    std::map<Pair, std::pair<bool, Pose3>> previous_results;
+    if (b_resume_results_ && LoadResults(results_file_, fingerprint, previous_results))
+    {
+      for (size_t i = 0; i < relative_pose_tasks.size(); ++i)
       {
-        OPENMVG_LOG_ERROR << "Compute relative pose between more than two view (rigid camera rigs) is not supported ";        continue;
-        continue;
+        const auto previous_it = previous_results.find(relative_pose_tasks[i].first);
+        if (previous_it != previous_results.end())
+        {
+          results[i].computed = true;
+          results[i].valid = previous_it->second.first;
+          results[i].pose = previous_it->second.second;
+        }
       }
+      OPENMVG_LOG_INFO << "Resume the relative pose computation: "
+        << previous_results.size() << " results loaded from " << results_file_;
+    }
 
-      const Pair current_pair(*std::begin(match_pairs));
+    // Rewrite the file (header and previous results): a truncated record is dropped
+    results_stream.open(results_file_, std::ios::out | std::ios::binary | std::ios::trunc);
+    const uint64_t file_fingerprint = fingerprint;
+    results_stream.write(kResultsMagic, sizeof(kResultsMagic));
+    results_stream.write(reinterpret_cast<const char*>(&file_fingerprint), sizeof(file_fingerprint));
+    for (size_t i = 0; i < relative_pose_tasks.size(); ++i)
+    {
+      if (results[i].computed)
+        WriteResult(results_stream, relative_pose_tasks[i].first, results[i].valid, results[i].pose);
+    }
+    results_stream.flush();
+    if (!results_stream)
+    {
+      OPENMVG_LOG_ERROR << "Cannot write the relative pose results to: " << results_file_;
+      results_stream.close();
+    }
+  }
 
-      const IndexT
-        I = current_pair.first,
-        J = current_pair.second;
+  std::vector<int> pending_tasks;
+  for (size_t i = 0; i < relative_pose_tasks.size(); ++i)
+  {
+    if (!results[i].computed)
+      pending_tasks.push_back(static_cast<int>(i));
+  }
 
-      const View
-        * view_I = sfm_data_.views.at(I).get(),
-        * view_J = sfm_data_.views.at(J).get();
+  system::Timer t;
 
-      // Check that valid cameras exist for the view pair
-      if (sfm_data_.GetIntrinsics().count(view_I->id_intrinsic) == 0 ||
-          sfm_data_.GetIntrinsics().count(view_J->id_intrinsic) == 0)
-        continue;
+  system::LoggerProgress my_progress_bar(pending_tasks.size(),"- Relative pose computation -" );
 
-      const IntrinsicBase
-        * cam_I = sfm_data_.GetIntrinsics().at(view_I->id_intrinsic).get(),
-        * cam_J = sfm_data_.GetIntrinsics().at(view_J->id_intrinsic).get();
+  // The pending pairs are processed by batches of consecutive pose pairs: the
+  //  un-distorted features of the batch views are computed once (a view is
+  //  shared by many pairs) and released after the batch (bounded memory).
+  const size_t kBatchSize = 512;
+  for (size_t batch_begin = 0; batch_begin < pending_tasks.size(); batch_begin += kBatchSize)
+  {
+    const std::vector<int> batch_tasks(
+      pending_tasks.cbegin() + batch_begin,
+      pending_tasks.cbegin() + std::min(batch_begin + kBatchSize, pending_tasks.size()));
 
-      // Compute for each feature the un-distorted camera coordinates
-      const matching::IndMatches & matches = matches_provider_->pairWise_matches_.at(current_pair);
-      size_t number_matches = matches.size();
-      Mat2X x1(2, number_matches), x2(2, number_matches);
-      number_matches = 0;
-      for (const auto & match : matches)
-      {
-        x1.col(number_matches) = cam_I->get_ud_pixel(
-          features_provider_->feats_per_view.at(I)[match.i_].coords().cast<double>());
-        x2.col(number_matches++) = cam_J->get_ud_pixel(
-          features_provider_->feats_per_view.at(J)[match.j_].coords().cast<double>());
-      }
+    Hash_Map<IndexT, std::vector<Vec2>> ud_features;
+    UndistortMatchedFeatures(
+      sfm_data_,
+      matches_provider_,
+      features_provider_,
+      relative_pose_tasks,
+      batch_tasks,
+      ud_features);
 
-      RelativePose_Info relativePose_info;
-      relativePose_info.initial_residual_tolerance = Square(2.5);
-      if (!robustRelativePose(cam_I, cam_J,
-                              x1, x2, relativePose_info,
-                              {cam_I->w(), cam_I->h()},
-                              {cam_J->w(), cam_J->h()},
-                              256))
-      {
-        continue;
-      }
-      const bool bRefine_using_BA = true;
-      if (bRefine_using_BA)
-      {
-        // Refine the defined scene
-        SfM_Data tiny_scene;
-        tiny_scene.views.insert(*sfm_data_.GetViews().find(view_I->id_view));
-        tiny_scene.views.insert(*sfm_data_.GetViews().find(view_J->id_view));
-        tiny_scene.intrinsics.insert(*sfm_data_.GetIntrinsics().find(view_I->id_intrinsic));
-        tiny_scene.intrinsics.insert(*sfm_data_.GetIntrinsics().find(view_J->id_intrinsic));
-
-        // Init poses
-        const Pose3 & pose_I = tiny_scene.poses[view_I->id_pose] = {Mat3::Identity(), Vec3::Zero()};
-        const Pose3 & pose_J = tiny_scene.poses[view_J->id_pose] = relativePose_info.relativePose;
-
-        // Init structure
-        Landmarks & landmarks = tiny_scene.structure;
-        for (Mat::Index k = 0; k < x1.cols(); ++k)
-        {
-          Vec3 X;
-          if (Triangulate2View
-          (
-            pose_I.rotation(), pose_I.translation(), (*cam_I)(x1.col(k)),
-            pose_J.rotation(), pose_J.translation(), (*cam_J)(x2.col(k)),
-            X,
-            triangulation_method_
-          ))
-          {
-            Observations obs;
-            const Vec2 obs_I = features_provider_->feats_per_view.at(I)[matches[k].i_].coords().cast<double>();
-            const Vec2 obs_J = features_provider_->feats_per_view.at(J)[matches[k].j_].coords().cast<double>();
-            obs[view_I->id_view] = {obs_I, matches[k].i_};
-            obs[view_J->id_view] = {obs_J, matches[k].j_};
-            landmarks[k].obs = obs;
-            landmarks[k].X = X;
-          }
-        }
-        // - refine only Structure and Rotations & translations (keep intrinsic constant)
-        Bundle_Adjustment_Ceres::BA_Ceres_options options(false, false);
-        options.linear_solver_type_ = ceres::DENSE_SCHUR;
-        Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
-        const Optimize_Options ba_refine_options
-          (Intrinsic_Parameter_Type::NONE, // -> Keep intrinsic constant
-          Extrinsic_Parameter_Type::ADJUST_ALL, // adjust camera motion
-          Structure_Parameter_Type::ADJUST_ALL);// adjust scene structure
-        if (bundle_adjustment_obj.Adjust(tiny_scene, ba_refine_options))
-        {
-          // --> to debug: save relative pair geometry on disk
-          // std::ostringstream os;
-          // os << relative_pose_pair.first << "_" << relative_pose_pair.second << ".ply";
-          // Save(tiny_scene, os.str(), ESfM_Data(STRUCTURE | EXTRINSICS));
-          //
-          const Mat3 R1 = tiny_scene.poses[view_I->id_pose].rotation(),
-                     R2 = tiny_scene.poses[view_J->id_pose].rotation();
-          const Vec3 t1 = tiny_scene.poses[view_I->id_pose].translation(),
-                     t2 = tiny_scene.poses[view_J->id_pose].translation();
-          // Compute relative motion and save it
-          Mat3 Rrel;
-          Vec3 trel;
-          RelativeCameraMotion(R1, t1, R2, t2, &Rrel, &trel);
-          // Update found relative pose
-          relativePose_info.relativePose = Pose3(Rrel, -Rrel.transpose() * trel);
-        }
-      }
-#ifdef OPENMVG_USE_OPENMP
-      #pragma omp critical
-#endif
+    // Compute the relative pose from pairwise point matches:
+    //  the pairs are distributed dynamically to the threads and each result
+    //  is stored in its own slot (merged afterward in the pose pair order)
+    #ifdef OPENMVG_USE_OPENMP
+      #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int k = 0; k < static_cast<int>(batch_tasks.size()); ++k)
+    {
+      ++my_progress_bar;
+      const int i = batch_tasks[k];
+      Relative_Pose_Result & result = results[i];
+
+      result.valid = ComputeRelativePose(
+        sfm_data_,
+        matches_provider_,
+        features_provider_,
+        ud_features,
+        triangulation_method_,
+        relative_pose_tasks[i].first,
+        relative_pose_tasks[i].second,
+        result.pose);
+      result.computed = true;
+
+      if (results_stream.is_open())
       {
-        // Add the relative pose to the relative 'rotation' pose graph
-        relative_poses_[relative_pose_pair] = relativePose_info.relativePose;
+        std::lock_guard<std::mutex> lock(results_mutex);
+        WriteResult(results_stream, relative_pose_tasks[i].first, result.valid, result.pose);
+        results_stream.flush();
       }
     }
   }
+
+  // Add the relative poses to the relative 'rotation' pose graph
+  for (size_t i = 0; i < relative_pose_tasks.size(); ++i)
+  {
+    if (results[i].valid)
+      relative_poses_[relative_pose_tasks[i].first] = results[i].pose;
+  }
   OPENMVG_LOG_INFO << "Relative motion computation took: " << t.elapsedMs() << "(ms)";
   return !relative_poses_.empty();
 }
@@ -9,6 +9,8 @@
 #ifndef OPENMVG_SFM_RELATIVE_POSE_ENGINE_HPP
 #define OPENMVG_SFM_RELATIVE_POSE_ENGINE_HPP
 
+#include <string>
+
 #include "openMVG/types.hpp"
 #include "openMVG/geometry/pose3.hpp"
 #include "openMVG/multiview/triangulation_method.hpp"
@@ -52,10 +54,24 @@ public:
     triangulation_method_ = method;
   }
 
+  /// Stream the relative pose results to a binary file while they are computed.
+  /// If b_resume is true and the file already exists and was written for the
+  ///  same pose pairs, matches, camera intrinsics and triangulation method,
+  ///  its results are loaded and only the missing pairs are computed (resume
+  ///  of an interrupted computation). Else the file is overwritten.
+  void SetResultsFile(const std::string & filename, const bool b_resume = true)
+  {
+    results_file_ = filename;
+    b_resume_results_ = b_resume;
+  }
+
 private:
   Relative_Pair_Poses relative_poses_;
 
   ETriangulationMethod triangulation_method_ = ETriangulationMethod::DEFAULT;
+
+  std::string results_file_;
+  bool b_resume_results_ = true;
 };
 
 } // namespace sfm
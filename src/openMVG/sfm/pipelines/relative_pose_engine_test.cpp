@@ -0,0 +1,167 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Compute the relative poses of a synthetic scene (noisy observations)
+// - Interrupt a computation streamed to a results file (truncated file)
+// - Assert that:
+//   - the resumed computation gives the same relative poses as an
+//     uninterrupted run,
+//   - the results file is not reused if the inputs changed.
+//-----------------
+
+#include "openMVG/sfm/pipelines/pipelines_test.hpp"
+#include "openMVG/sfm/pipelines/relative_pose_engine.hpp"
+
+#include "testing/testing.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+namespace {
+
+// Size of the results file header and of one result record
+const std::streamoff kHeaderSize = 8 + sizeof(uint64_t);
+const std::streamoff kRecordSize = 2 * sizeof(uint32_t) + 1 + 12 * sizeof(double);
+
+std::string ReadFile(const std::string & filename)
+{
+  std::ifstream stream(filename, std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), {});
+}
+
+void WriteFile(const std::string & filename, const std::string & content)
+{
+  std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  stream.write(content.data(), content.size());
+}
+
+bool SamePoses
+(
+  const Relative_Pose_Engine::Relative_Pair_Poses & expected,
+  const Relative_Pose_Engine::Relative_Pair_Poses & poses
+)
+{
+  if (expected.size() != poses.size())
+    return false;
+  for (const auto & pose_it : expected)
+  {
+    const auto it = poses.find(pose_it.first);
+    if (it == poses.end()
+        || (pose_it.second.rotation() - it->second.rotation()).norm() > 1e-12
+        || (pose_it.second.center() - it->second.center()).norm() > 1e-12)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(RELATIVE_POSE_ENGINE, Resume_From_Results_File)
+{
+  const int nviews = 8;
+  const int npoints = 128;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  std::normal_distribution<double> distribution(0, 0.1);
+  Synthetic_Features_Provider feats_provider;
+  feats_provider.load(d, distribution);
+  Synthetic_Matches_Provider matches_provider;
+  matches_provider.load(d);
+
+  // Uninterrupted run
+  Relative_Pose_Engine reference_engine;
+  EXPECT_TRUE(reference_engine.Process(sfm_data, &matches_provider, &feats_provider));
+  const Relative_Pose_Engine::Relative_Pair_Poses & reference_poses =
+    reference_engine.Get_Relative_Poses();
+  EXPECT_EQ(2 * nviews, reference_poses.size());
+
+  // Streamed run
+  const std::string filename = "relative_pose_engine_test.bin";
+  std::remove(filename.c_str());
+  {
+    Relative_Pose_Engine engine;
+    engine.SetResultsFile(filename);
+    EXPECT_TRUE(engine.Process(sfm_data, &matches_provider, &feats_provider));
+    EXPECT_TRUE(SamePoses(reference_poses, engine.Get_Relative_Poses()));
+  }
+  const std::string results = ReadFile(filename);
+  EXPECT_EQ(kHeaderSize + 2 * nviews * kRecordSize, results.size());
+
+  // Interrupted run: the file keeps a few records and a truncated one
+  WriteFile(filename, results.substr(0, kHeaderSize + 5 * kRecordSize + kRecordSize / 2));
+  {
+    Relative_Pose_Engine engine;
+    engine.SetResultsFile(filename);
+    EXPECT_TRUE(engine.Process(sfm_data, &matches_provider, &feats_provider));
+    EXPECT_TRUE(SamePoses(reference_poses, engine.Get_Relative_Poses()));
+  }
+  EXPECT_EQ(results.size(), ReadFile(filename).size());
+
+  // The loaded results are used as they are: a file where every pair is
+  //  marked as failed gives no relative pose.
+  std::string failed_results = results;
+  for (size_t k = 0; k < 2 * nviews; ++k)
+    failed_results[kHeaderSize + k * kRecordSize + 2 * sizeof(uint32_t)] = 0;
+  WriteFile(filename, failed_results);
+  {
+    Relative_Pose_Engine engine;
+    engine.SetResultsFile(filename);
+    EXPECT_FALSE(engine.Process(sfm_data, &matches_provider, &feats_provider));
+  }
+
+  // The file is not reused if the triangulation method changed
+  WriteFile(filename, failed_results);
+  {
+    Relative_Pose_Engine engine;
+    engine.SetTriangulationMethod(ETriangulationMethod::DIRECT_LINEAR_TRANSFORM);
+    engine.SetResultsFile(filename);
+    EXPECT_TRUE(engine.Process(sfm_data, &matches_provider, &feats_provider));
+    EXPECT_EQ(2 * nviews, engine.Get_Relative_Poses().size());
+  }
+
+  // The file is not reused if the matches changed (same match count)
+  WriteFile(filename, failed_results);
+  {
+    Synthetic_Matches_Provider shuffled_matches_provider = matches_provider;
+    matching::IndMatches & matches = shuffled_matches_provider.pairWise_matches_.begin()->second;
+    std::swap(matches[0], matches[1]);
+    Relative_Pose_Engine engine;
+    engine.SetResultsFile(filename);
+    EXPECT_TRUE(engine.Process(sfm_data, &shuffled_matches_provider, &feats_provider));
+    EXPECT_EQ(2 * nviews, engine.Get_Relative_Poses().size());
+  }
+
+  // The file is not reused if the camera intrinsics changed
+  WriteFile(filename, failed_results);
+  {
+    SfM_Data modified_sfm_data = sfm_data;
+    modified_sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic>(
+      config._cx * 2, config._cy * 2, config._fx * 1.01, config._cx, config._cy);
+    Relative_Pose_Engine engine;
+    engine.SetResultsFile(filename);
+    EXPECT_TRUE(engine.Process(modified_sfm_data, &matches_provider, &feats_provider));
+  }
+
+  std::remove(filename.c_str());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -17,11 +17,15 @@
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_BA.hpp"
 #include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_partitioned.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_session.hpp"
+#include "openMVG/sfm/sfm_data_BA_local.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/stl/stl.hpp"
 #include "openMVG/system/logger.hpp"
 #include "openMVG/system/loggerprogress.hpp"
+#include "openMVG/system/timer.hpp"
 
 #include "third_party/histogram/histogram.hpp"
 #include "third_party/htmlDoc/htmlDoc.hpp"
@@ -149,74 +153,149 @@ bool SequentialSfMReconstructionEngine::Process() {
   if (!InitLandmarkTracks())
     return false;
 
-  // Initial pair choice
-  if (initial_pair_ == Pair(0,0))
+  // Progress of the resection (restored from the last checkpoint if any)
+  size_t resectionGroupIndex = 0;
+  size_t nb_resected_views = 0;
+  bool b_last_ba_is_local = false;
+  const bool b_resumed = b_resume_from_checkpoint_ &&
+    ResumeFromCheckpoint(resectionGroupIndex, nb_resected_views, b_last_ba_is_local);
+  if (!b_resumed)
   {
-    if (!AutomaticInitialPairChoice(initial_pair_))
+    // Initial pair choice
+    if (initial_pair_ == Pair(0,0))
     {
-      // Cannot find a valid initial pair with the defined settings:
-      // - try to initialize a pair with less strict constraint
-      //    testing only X pairs with most matches.
-      const auto sorted_pairwise_matches_iterators =
-        GetPairWithMostMatches(sfm_data_, matches_provider_->pairWise_matches_, 20);
-
-      for (const auto & it : sorted_pairwise_matches_iterators)
+      if (!AutomaticInitialPairChoice(initial_pair_))
       {
-        if (MakeInitialPair3D({it->first.first, it->first.second}))
+        // Cannot find a valid initial pair with the defined settings:
+        // - try to initialize a pair with less strict constraint
+        //    testing only X pairs with most matches.
+        const auto sorted_pairwise_matches_iterators =
+          GetPairWithMostMatches(sfm_data_, matches_provider_->pairWise_matches_, 20);
+
+        for (const auto & it : sorted_pairwise_matches_iterators)
         {
-          initial_pair_ = {it->first.first, it->first.second};
-          break;
+          if (MakeInitialPair3D({it->first.first, it->first.second}))
+          {
+            initial_pair_ = {it->first.first, it->first.second};
+            break;
+          }
+        }
+        if (sorted_pairwise_matches_iterators.empty() || initial_pair_ == Pair(0,0))
+        {
+          OPENMVG_LOG_INFO << "Cannot find a valid initial pair - stop reconstruction.";
+          return false;
         }
-      }
-      if (sorted_pairwise_matches_iterators.empty() || initial_pair_ == Pair(0,0))
-      {
-        OPENMVG_LOG_INFO << "Cannot find a valid initial pair - stop reconstruction.";
-        return false;
       }
     }
-  }
-  // Else a starting pair was already initialized before
+    // Else a starting pair was already initialized before
 
-  // Initial pair Essential Matrix and [R|t] estimation.
-  if (!MakeInitialPair3D(initial_pair_))
-    return false;
+    // Initial pair Essential Matrix and [R|t] estimation.
+    if (!MakeInitialPair3D(initial_pair_))
+      return false;
+    SaveCheckpoint(resectionGroupIndex, nb_resected_views, b_last_ba_is_local);
+  }
 
   // Compute robust Resection of remaining images
   // - group of images will be selected and resection + scene completion will be tried
-  size_t resectionGroupIndex = 0;
   std::vector<uint32_t> vec_possible_resection_indexes;
+  system::Timer resection_timer;
   while (FindImagesWithPossibleResection(vec_possible_resection_indexes))
   {
-    bool bImageAdded = false;
+    system::Timer group_timer;
+    // Estimate the pose of the candidate images concurrently against the current scene
+    const int nb_candidates = static_cast<int>(vec_possible_resection_indexes.size());
+    std::vector<ResectionResult> resections(nb_candidates);
+    std::vector<char> resection_status(nb_candidates, 0);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < nb_candidates; ++i)
+    {
+      resection_status[i] = ComputeResection(vec_possible_resection_indexes[i], resections[i]);
+    }
+
     // Add images to the 3D reconstruction
-    for (const auto & iter : vec_possible_resection_indexes)
+    // - the results are committed in the candidate order, so the new tracks and
+    //   the tracks triangulated by several images are resolved deterministically.
+    std::set<IndexT> new_pose_ids;
+    for (int i = 0; i < nb_candidates; ++i)
     {
-      bImageAdded |= Resection(iter);
-      set_remaining_view_id_.erase(iter);
+      if (!sLogging_file_.empty() && !resections[i].html_log.empty())
+      {
+        using namespace htmlDocument;
+        std::ostringstream os;
+        os << "Resection of Image index: <" << resections[i].view_id << "> image: "
+          << sfm_data_.GetViews().at(resections[i].view_id)->s_Img_path << "<br> \n";
+        html_doc_stream_->pushInfo(htmlMarkup("h1",os.str()));
+        html_doc_stream_->pushInfo(resections[i].html_log);
+      }
+      if (resection_status[i])
+      {
+        CommitResection(resections[i]);
+        new_pose_ids.insert(sfm_data_.GetViews().at(resections[i].view_id)->id_pose);
+        ++nb_resected_views;
+      }
+      set_remaining_view_id_.erase(vec_possible_resection_indexes[i]);
     }
 
-    if (bImageAdded)
+    if (!new_pose_ids.empty())
     {
       // Scene logging as ply for visual debug
       std::ostringstream os;
       os << std::setw(8) << std::setfill('0') << resectionGroupIndex << "_Resection";
       Save(sfm_data_, stlplus::create_filespec(sOut_directory_, os.str(), ".ply"), ESfM_Data(ALL));
 
+      // Refine the whole scene at growth milestones, else only the neighborhood of the new poses
+      const bool b_global_ba = local_ba_options_.RequiresGlobalAdjustment
+        (sfm_data_.GetPoses().size(), nb_poses_at_last_global_ba_);
+
       // Perform BA until all point are under the given precision
       do
       {
-        BundleAdjustment();
+        if (b_global_ba)
+          BundleAdjustment();
+        else
+          LocalBundleAdjustment(new_pose_ids);
       }
       while (badTrackRejector(4.0, 50));
       eraseUnstablePosesAndObservations(sfm_data_);
+
+      if (b_global_ba)
+        nb_poses_at_last_global_ba_ = sfm_data_.GetPoses().size();
+      b_last_ba_is_local = !b_global_ba;
+
+      OPENMVG_LOG_INFO
+        << "Resection group " << resectionGroupIndex << ": "
+        << new_pose_ids.size() << " pose(s) added, "
+        << (b_global_ba ? "global" : "local") << " BA, "
+        << group_timer.elapsedMs() / new_pose_ids.size() << " ms per added view";
     }
     ++resectionGroupIndex;
+    SaveCheckpoint(resectionGroupIndex, nb_resected_views, b_last_ba_is_local);
+  }
+  // The end of the resection is always saved (the final adjustment can be long)
+  SaveCheckpoint(resectionGroupIndex, nb_resected_views, b_last_ba_is_local, true);
+  // Ensure that the scene is globally consistent after the last local adjustments
+  if (b_last_ba_is_local)
+  {
+    do
+    {
+      BundleAdjustment();
+    }
+    while (badTrackRejector(4.0, 50));
+    eraseUnstablePosesAndObservations(sfm_data_);
   }
   // Ensure there is no remaining outliers
   if (badTrackRejector(4.0, 0))
   {
     eraseUnstablePosesAndObservations(sfm_data_);
   }
+  if (nb_resected_views > 0)
+  {
+    OPENMVG_LOG_INFO
+      << "Resection & bundle adjustment: " << resection_timer.elapsedMs() << " ms, "
+      << resection_timer.elapsedMs() / nb_resected_views << " ms per added view";
+  }
 
   //-- Reconstruction done.
   //-- Display some statistics
@@ -743,17 +822,6 @@ double SequentialSfMReconstructionEngine::ComputeResidualsHistogram(Histogram<do
   return -1.0;
 }
 
-/// Functor to sort a vector of pair given the pair's second value
-template<class T1, class T2, class Pred = std::less<T2>>
-struct sort_pair_second {
-  bool operator()(const std::pair<T1,T2>&left,
-                    const std::pair<T1,T2>&right)
-  {
-    Pred p;
-    return p(left.second, right.second);
-  }
-};
-
 /**
  * @brief Estimate images on which we can compute the resectioning safely.
  *
@@ -822,7 +890,13 @@ bool SequentialSfMReconstructionEngine::FindImagesWithPossibleResection(
   }
 
   // Sort by the number of matches to the 3D scene.
-  std::sort(vec_putative.begin(), vec_putative.end(), sort_pair_second<uint32_t, uint32_t, std::greater<uint32_t>>());
+  // Ties are broken by view index, so the candidate order does not depend on the thread scheduling.
+  std::sort(vec_putative.begin(), vec_putative.end(),
+    [](const Pair & left, const Pair & right)
+    {
+      return left.second > right.second ||
+        (left.second == right.second && left.first < right.first);
+    });
 
   // If the list is empty or if the list contains images with no correspdences
   // -> (no resection will be possible)
@@ -848,22 +922,27 @@ bool SequentialSfMReconstructionEngine::FindImagesWithPossibleResection(
 }
 
 /**
- * @brief Add one image to the 3D reconstruction. To the resectioning of
- * the camera and triangulate all the new possible tracks.
+ * @brief Estimate the pose of one image against the 3D reconstruction.
  * @param[in] viewIndex: image index to add to the reconstruction.
+ * @param[out] resection: the estimated pose (and intrinsic if the view had none).
  *
  * A. Compute 2D/3D matches
  * B. Look if intrinsic data is known or not
  * C. Do the resectioning: compute the camera pose.
  * D. Refine the pose of the found camera
- * E. Update the global scene with the new camera
- * F. Update the observations into the global scene structure
- * G. Triangulate new possible 2D tracks
+ *
+ * The scene is only read, several images can be resected concurrently.
  */
-bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
+bool SequentialSfMReconstructionEngine::ComputeResection
+(
+  const uint32_t viewIndex,
+  ResectionResult & resection
+) const
 {
   using namespace tracks;
 
+  resection.view_id = viewIndex;
+
   // A. Compute 2D/3D matches
   // A1. list tracks ids used by the view
   openMVG::tracks::STLMAPTracks map_tracksCommon;
@@ -944,13 +1023,7 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
 
   if (!sLogging_file_.empty())
   {
-    using namespace htmlDocument;
     std::ostringstream os;
-    os << "Resection of Image index: <" << viewIndex << "> image: "
-      << view_I->s_Img_path <<"<br> \n";
-    html_doc_stream_->pushInfo(htmlMarkup("h1",os.str()));
-
-    os.str("");
     os
       << "-------------------------------" << "<br>"
       << "-- Robust Resection of camera index: <" << viewIndex << "> image: "
@@ -962,7 +1035,7 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
       << "-- % points validated: "
       << resection_data.vec_inliers.size()/static_cast<float>(vec_featIdForResection.size()) << "<br>"
       << "-------------------------------" << "<br>";
-    html_doc_stream_->pushInfo(os.str());
+    resection.html_log = os.str();
   }
 
   if (!bResection)
@@ -1029,13 +1102,41 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
       return false;
     }
 
-    // E. Update the global scene with:
+    resection.pose = pose;
+    resection.intrinsic = optional_intrinsic;
+    resection.b_new_intrinsic = b_new_intrinsic;
+    resection.error_max = resection_data.error_max;
+    resection.map_tracksCommon = std::move(map_tracksCommon);
+  }
+  return true;
+}
+
+/**
+ * @brief Add one resected image to the 3D reconstruction and triangulate all
+ * the new possible tracks.
+ * @param[in] resection: the pose estimation of the image (see ComputeResection).
+ *
+ * E. Update the global scene with the new camera
+ * F. Update the observations into the global scene structure
+ * G. Triangulate new possible 2D tracks
+ */
+void SequentialSfMReconstructionEngine::CommitResection
+(
+  const ResectionResult & resection
+)
+{
+  const uint32_t viewIndex = resection.view_id;
+  const openMVG::tracks::STLMAPTracks & map_tracksCommon = resection.map_tracksCommon;
+
+  // E. Update the global scene with:
+  {
+    const View * view_I = sfm_data_.GetViews().at(viewIndex).get();
     // - the new found camera pose
-    sfm_data_.poses[view_I->id_pose] = pose;
+    sfm_data_.poses[view_I->id_pose] = resection.pose;
     // - track the view's AContrario robust estimation found threshold
-    map_ACThreshold_.insert({viewIndex, resection_data.error_max});
+    map_ACThreshold_.insert({viewIndex, resection.error_max});
     // - intrinsic parameters (if the view has no intrinsic group add a new one)
-    if (b_new_intrinsic)
+    if (resection.b_new_intrinsic)
     {
       // Since the view have not yet an intrinsic group before, create a new one
       IndexT new_intrinsic_id = 0;
@@ -1050,7 +1151,7 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
         new_intrinsic_id = (*existing_intrinsicId.rbegin())+1;
       }
       sfm_data_.views.at(viewIndex)->id_intrinsic = new_intrinsic_id;
-      sfm_data_.intrinsics[new_intrinsic_id] = optional_intrinsic;
+      sfm_data_.intrinsics[new_intrinsic_id] = resection.intrinsic;
     }
   }
 
@@ -1183,28 +1284,13 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
       }
     }// All the tracks in the view
   }
-  return true;
 }
 
 /// Bundle adjustment to refine Structure; Motion and Intrinsics
 bool SequentialSfMReconstructionEngine::BundleAdjustment()
 {
-  Bundle_Adjustment_Ceres::BA_Ceres_options options;
-  if ( sfm_data_.GetPoses().size() > 100 &&
-      (ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::SUITE_SPARSE) ||
-       ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::CX_SPARSE) ||
-       ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::EIGEN_SPARSE))
-      )
-  // Enable sparse BA only if a sparse lib is available and if there more than 100 poses
-  {
-    options.preconditioner_type_ = ceres::JACOBI;
-    options.linear_solver_type_ = ceres::SPARSE_SCHUR;
-  }
-  else
-  {
-    options.linear_solver_type_ = ceres::DENSE_SCHUR;
-  }
-  Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
+  const Bundle_Adjustment_Ceres::BA_Ceres_options options =
+    BA_Ceres_options_for_pose_count(sfm_data_.GetPoses().size());
   const Optimize_Options ba_refine_options
     ( ReconstructionEngine::intrinsic_refinement_options_,
       Extrinsic_Parameter_Type::ADJUST_ALL, // Adjust camera motion
@@ -1212,7 +1298,44 @@ bool SequentialSfMReconstructionEngine::BundleAdjustment()
       Control_Point_Parameter(),
       this->b_use_motion_prior_
     );
-  return bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options);
+  if (ba_max_poses_per_submap_ > 0 &&
+      sfm_data_.GetPoses().size() > ba_max_poses_per_submap_)
+  {
+    // Large scene: refine submaps in parallel and couple them through their separators
+    Bundle_Adjustment_Ceres_Partitioned::BA_Partition_options partition_options
+      (options.bVerbose_, ba_max_poses_per_submap_);
+    partition_options.ceres_options_ = options;
+    Bundle_Adjustment_Ceres_Partitioned bundle_adjustment_obj(partition_options);
+    return bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options);
+  }
+  // Reuse the problem of the previous calls: only the scene changes are synchronized
+  if (!ba_session_)
+    ba_session_.reset(new Bundle_Adjustment_Ceres_Session(options));
+  else
+    ba_session_->ceres_options() = options;
+  return ba_session_->Adjust(sfm_data_, ba_refine_options);
+}
+
+/// Bundle adjustment restricted to the covisible neighborhood of the new poses
+bool SequentialSfMReconstructionEngine::LocalBundleAdjustment
+(
+  const std::set<IndexT> & new_pose_ids
+)
+{
+  const std::set<IndexT> window_poses =
+    CovisibilityNeighborhood(sfm_data_, new_pose_ids, local_ba_options_.covisibility_hops_);
+
+  const Bundle_Adjustment_Ceres::BA_Ceres_options options =
+    BA_Ceres_options_for_pose_count(window_poses.size());
+  // The intrinsics are shared by the whole scene:
+  //  they are only refined by the global bundle adjustment.
+  const Optimize_Options ba_refine_options
+    ( Intrinsic_Parameter_Type::NONE,
+      Extrinsic_Parameter_Type::ADJUST_ALL, // Adjust camera motion
+      Structure_Parameter_Type::ADJUST_ALL  // Adjust scene structure
+    );
+  Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
+  return sfm::LocalBundleAdjustment(bundle_adjustment_obj, sfm_data_, window_poses, ba_refine_options);
 }
 
 /**
@@ -1232,5 +1355,81 @@ bool SequentialSfMReconstructionEngine::badTrackRejector(double dPrecision, size
   return (nbOutliers_residualErr + nbOutliers_angleErr) > count;
 }
 
+void SequentialSfMReconstructionEngine::SaveCheckpoint
+(
+  const size_t resection_group_index,
+  const size_t nb_resected_views,
+  const bool b_last_ba_is_local,
+  const bool b_force
+)
+{
+  if (!checkpoint_)
+    return;
+  SfM_Checkpoint_State state;
+  state.fingerprint = SfM_Checkpoint_Fingerprint(sfm_data_, matches_provider_->pairWise_matches_);
+  state.remaining_view_ids = set_remaining_view_id_;
+  state.view_thresholds = map_ACThreshold_;
+  state.counters =
+  {
+    resection_group_index,
+    nb_resected_views,
+    b_last_ba_is_local ? 1u : 0u,
+    nb_poses_at_last_global_ba_,
+    initial_pair_.first,
+    initial_pair_.second
+  };
+  state.intrinsic_refinement_options = intrinsic_refinement_options_;
+  state.extrinsic_refinement_options = extrinsic_refinement_options_;
+  state.local_ba_options = local_ba_options_;
+  state.ba_max_poses_per_submap = ba_max_poses_per_submap_;
+  if (checkpoint_->Save(sfm_data_, state, b_force))
+  {
+    OPENMVG_LOG_INFO << "Checkpoint: " << sfm_data_.GetPoses().size() << " poses, "
+      << set_remaining_view_id_.size() << " remaining views";
+  }
+}
+
+bool SequentialSfMReconstructionEngine::ResumeFromCheckpoint
+(
+  size_t & resection_group_index,
+  size_t & nb_resected_views,
+  bool & b_last_ba_is_local
+)
+{
+  if (!checkpoint_)
+    return false;
+  SfM_Data sfm_data;
+  SfM_Checkpoint_State state;
+  if (!checkpoint_->Load(sfm_data, state))
+  {
+    OPENMVG_LOG_INFO << "No checkpoint to resume from in: " << checkpoint_->Directory();
+    return false;
+  }
+  if (state.fingerprint != SfM_Checkpoint_Fingerprint(sfm_data_, matches_provider_->pairWise_matches_)
+      || state.counters.size() != 6)
+  {
+    OPENMVG_LOG_WARNING << "The checkpoint does not match the input views and matches: it is ignored.";
+    return false;
+  }
+
+  sfm_data_ = std::move(sfm_data);
+  set_remaining_view_id_ = state.remaining_view_ids;
+  map_ACThreshold_ = state.view_thresholds;
+  resection_group_index = state.counters[0];
+  nb_resected_views = state.counters[1];
+  b_last_ba_is_local = (state.counters[2] != 0);
+  nb_poses_at_last_global_ba_ = state.counters[3];
+  initial_pair_ = {static_cast<IndexT>(state.counters[4]), static_cast<IndexT>(state.counters[5])};
+  intrinsic_refinement_options_ = state.intrinsic_refinement_options;
+  extrinsic_refinement_options_ = state.extrinsic_refinement_options;
+  local_ba_options_ = state.local_ba_options;
+  ba_max_poses_per_submap_ = state.ba_max_poses_per_submap;
+
+  OPENMVG_LOG_INFO << "Resume from the checkpoint: " << sfm_data_.GetPoses().size() << " poses, "
+    << sfm_data_.GetLandmarks().size() << " landmarks, "
+    << set_remaining_view_id_.size() << " remaining views";
+  return true;
+}
+
 } // namespace sfm
 } // namespace openMVG
@@ -17,6 +17,8 @@
 #include "openMVG/cameras/cameras.hpp"
 #include "openMVG/multiview/solver_resection.hpp"
 #include "openMVG/multiview/triangulation_method.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_session.hpp"
+#include "openMVG/sfm/sfm_data_BA_local.hpp"
 #include "openMVG/tracks/tracks.hpp"
 
 namespace htmlDocument { class htmlDocumentStream; }
@@ -82,6 +84,20 @@ public:
     resection_method_ = method;
   }
 
+  /// Use a partitioned (global-local) bundle adjustment for scenes that have
+  /// more poses than the given submap size (0: always use a monolithic bundle adjustment)
+  void SetPartitionedBundleAdjustment(const unsigned int max_poses_per_submap)
+  {
+    ba_max_poses_per_submap_ = max_poses_per_submap;
+  }
+
+  /// Configure when a local bundle adjustment (restricted to the covisible
+  /// neighborhood of the new poses) is used instead of a global one
+  void SetLocalBundleAdjustmentOptions(const Local_Bundle_Adjustment_Options & options)
+  {
+    local_ba_options_ = options;
+  }
+
 protected:
 
 
@@ -93,15 +109,52 @@ private:
   /// List the images that the greatest number of matches to the current 3D reconstruction.
   bool FindImagesWithPossibleResection(std::vector<uint32_t> & vec_possible_indexes);
 
-  /// Add a single Image to the scene and triangulate new possible tracks.
-  bool Resection(const uint32_t imageIndex);
+  /// Pose estimation of a view against the current (read-only) scene.
+  struct ResectionResult
+  {
+    uint32_t view_id;
+    geometry::Pose3 pose;
+    std::shared_ptr<cameras::IntrinsicBase> intrinsic;
+    bool b_new_intrinsic = false;
+    double error_max = 0.0; // A contrario threshold found by the robust estimation
+    openMVG::tracks::STLMAPTracks map_tracksCommon; // Tracks observed by the view
+    std::string html_log; // Report pushed to the HTML logger when the result is committed
+  };
+
+  /// Estimate the pose of a single image (the scene is not modified, so it
+  /// can be run concurrently for several images).
+  bool ComputeResection(const uint32_t imageIndex, ResectionResult & resection) const;
+
+  /// Add a resected image to the scene and triangulate new possible tracks.
+  void CommitResection(const ResectionResult & resection);
 
   /// Bundle adjustment to refine Structure; Motion and Intrinsics
   bool BundleAdjustment();
 
+  /// Bundle adjustment restricted to the covisible neighborhood of the new poses
+  bool LocalBundleAdjustment(const std::set<IndexT> & new_pose_ids);
+
   /// Discard track with too large residual error
   bool badTrackRejector(double dPrecision, size_t count = 0);
 
+  /// Save a checkpoint of the engine state (if the checkpoint interval is elapsed
+  ///  or if b_force is true)
+  void SaveCheckpoint
+  (
+    const size_t resection_group_index,
+    const size_t nb_resected_views,
+    const bool b_last_ba_is_local,
+    const bool b_force = false
+  );
+
+  /// Restore the engine state from the last checkpoint
+  bool ResumeFromCheckpoint
+  (
+    size_t & resection_group_index,
+    size_t & nb_resected_views,
+    bool & b_last_ba_is_local
+  );
+
   //----
   //-- Data
   //----
@@ -131,6 +184,14 @@ private:
   ETriangulationMethod triangulation_method_ = ETriangulationMethod::DEFAULT;
 
   resection::SolverType resection_method_ = resection::SolverType::DEFAULT;
+
+  unsigned int ba_max_poses_per_submap_ = 0; // Partitioned BA submap size (0: disabled)
+
+  Local_Bundle_Adjustment_Options local_ba_options_;
+  size_t nb_poses_at_last_global_ba_ = 0; // Scene size when the last global BA was run
+
+  // Global BA problem kept alive across the BundleAdjustment calls
+  std::unique_ptr<Bundle_Adjustment_Ceres_Session> ba_session_;
 };
 
 } // namespace sfm
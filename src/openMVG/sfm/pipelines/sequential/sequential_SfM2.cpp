@@ -14,15 +14,19 @@
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_BA.hpp"
 #include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_session.hpp"
+#include "openMVG/sfm/sfm_data_BA_local.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
 #include "openMVG/stl/stl.hpp"
 #include "openMVG/system/logger.hpp"
+#include "openMVG/system/timer.hpp"
 
 #include "third_party/histogram/histogram.hpp"
 #include "third_party/htmlDoc/htmlDoc.hpp"
 
+#include <algorithm>
 #include <array>
 #include <ceres/types.h>
 #include <functional>
@@ -156,12 +160,33 @@ bool SequentialSfMReconstructionEngine2::Process() {
     track_inlier_ratio < track_inlier_ratios.cend(); ++track_inlier_ratio)
   {
     IndexT pose_before = sfm_data_.GetPoses().size();
+    std::set<IndexT> previous_pose_ids;
+    std::transform(sfm_data_.GetPoses().cbegin(), sfm_data_.GetPoses().cend(),
+      std::inserter(previous_pose_ids, previous_pose_ids.begin()),
+      stl::RetrieveKey());
+    system::Timer round_timer;
     while (AddingMissingView(*track_inlier_ratio))
     {
+      std::set<IndexT> new_pose_ids;
+      for (const auto & pose_it : sfm_data_.GetPoses())
+      {
+        if (!previous_pose_ids.count(pose_it.first))
+          new_pose_ids.insert(pose_it.first);
+      }
       // Create new 3D points
       Triangulation();
-      // Adjust the scene
-      BundleAdjustment();
+      // Adjust the scene: globally at growth milestones, else the neighborhood of the new poses
+      const bool b_global_ba = local_ba_options_.RequiresGlobalAdjustment
+        (sfm_data_.GetPoses().size(), nb_poses_at_last_global_ba_);
+      if (b_global_ba)
+      {
+        BundleAdjustment();
+        nb_poses_at_last_global_ba_ = sfm_data_.GetPoses().size();
+      }
+      else
+      {
+        LocalBundleAdjustment(new_pose_ids);
+      }
       // Remove unstable triangulations and camera poses
       RemoveOutliers_AngleError(sfm_data_, 2.0);
       RemoveOutliers_PixelResidualError(sfm_data_, 4.0);
@@ -172,12 +197,23 @@ bool SequentialSfMReconstructionEngine2::Process() {
       Save(sfm_data_, stlplus::create_filespec(sOut_directory_, os.str(), ".ply"), ESfM_Data(ALL));
       ++resection_round;
 
+      OPENMVG_LOG_INFO
+        << "Resection round " << resection_round << ": "
+        << new_pose_ids.size() << " pose(s) added, "
+        << (b_global_ba ? "global" : "local") << " BA, "
+        << round_timer.elapsedMs() / std::max<size_t>(1, new_pose_ids.size()) << " ms per added view";
+
       // Stop if no cameras have been added
       // Note: some cameras could have been removed due to instable camera positions.
       const IndexT pose_after = sfm_data_.GetPoses().size();
       if (pose_before >= pose_after)
         break;
       pose_before = sfm_data_.GetPoses().size();
+      previous_pose_ids.clear();
+      std::transform(sfm_data_.GetPoses().cbegin(), sfm_data_.GetPoses().cend(),
+        std::inserter(previous_pose_ids, previous_pose_ids.begin()),
+        stl::RetrieveKey());
+      round_timer.reset();
       // Since we have augmented our set of poses we can reset our track inlier ratio iterator
       track_inlier_ratio = track_inlier_ratios.cbegin();
     }
@@ -506,22 +542,8 @@ bool SequentialSfMReconstructionEngine2::AddingMissingView
 
 bool SequentialSfMReconstructionEngine2::BundleAdjustment()
 {
-  Bundle_Adjustment_Ceres::BA_Ceres_options options;
-  if ( sfm_data_.GetPoses().size() > 100 &&
-      (ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::SUITE_SPARSE) ||
-       ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::CX_SPARSE) ||
-       ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::EIGEN_SPARSE))
-      )
-  // Enable sparse BA only if a sparse lib is available and if there more than 100 poses
-  {
-    options.preconditioner_type_ = ceres::JACOBI;
-    options.linear_solver_type_ = ceres::SPARSE_SCHUR;
-  }
-  else
-  {
-    options.linear_solver_type_ = ceres::DENSE_SCHUR;
-  }
-  Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
+  const Bundle_Adjustment_Ceres::BA_Ceres_options options =
+    BA_Ceres_options_for_pose_count(sfm_data_.GetPoses().size());
   const Optimize_Options ba_refine_options
     ( ReconstructionEngine::intrinsic_refinement_options_,
       ReconstructionEngine::extrinsic_refinement_options_,
@@ -529,7 +551,33 @@ bool SequentialSfMReconstructionEngine2::BundleAdjustment()
       Control_Point_Parameter(),
       this->b_use_motion_prior_
     );
-  return bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options);
+  // Reuse the problem of the previous calls: only the scene changes are synchronized
+  if (!ba_session_)
+    ba_session_.reset(new Bundle_Adjustment_Ceres_Session(options));
+  else
+    ba_session_->ceres_options() = options;
+  return ba_session_->Adjust(sfm_data_, ba_refine_options);
+}
+
+bool SequentialSfMReconstructionEngine2::LocalBundleAdjustment
+(
+  const std::set<IndexT> & new_pose_ids
+)
+{
+  const std::set<IndexT> window_poses =
+    CovisibilityNeighborhood(sfm_data_, new_pose_ids, local_ba_options_.covisibility_hops_);
+
+  const Bundle_Adjustment_Ceres::BA_Ceres_options options =
+    BA_Ceres_options_for_pose_count(window_poses.size());
+  Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
+  // The intrinsics are shared by the whole scene:
+  //  they are only refined by the global bundle adjustment.
+  const Optimize_Options ba_refine_options
+    ( Intrinsic_Parameter_Type::NONE,
+      ReconstructionEngine::extrinsic_refinement_options_,
+      Structure_Parameter_Type::ADJUST_ALL // Adjust scene structure
+    );
+  return sfm::LocalBundleAdjustment(bundle_adjustment_obj, sfm_data_, window_poses, ba_refine_options);
 }
 
 } // namespace sfm
@@ -17,6 +17,8 @@
 #include "openMVG/cameras/cameras.hpp"
 #include "openMVG/multiview/solver_resection.hpp"
 #include "openMVG/multiview/triangulation_method.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_session.hpp"
+#include "openMVG/sfm/sfm_data_BA_local.hpp"
 #include "openMVG/tracks/tracks.hpp"
 
 namespace htmlDocument { class htmlDocumentStream; }
@@ -59,6 +61,9 @@ public:
   /// Adjust intrinsics, landmark and extrinsics according the user config.
   bool BundleAdjustment();
 
+  /// Adjust the covisible neighborhood of the new poses (intrinsics are held constant).
+  bool LocalBundleAdjustment(const std::set<IndexT> & new_pose_ids);
+
   /**
    * Set the default lens distortion type to use if it is declared unknown
    * in the intrinsics camera parameters by the previous steps.
@@ -82,6 +87,13 @@ public:
     resection_method_ = method;
   }
 
+  /// Configure when a local bundle adjustment (restricted to the covisible
+  /// neighborhood of the new poses) is used instead of a global one
+  void SetLocalBundleAdjustmentOptions(const Local_Bundle_Adjustment_Options & options)
+  {
+    local_ba_options_ = options;
+  }
+
 private:
 
   //----
@@ -113,6 +125,12 @@ private:
   ETriangulationMethod triangulation_method_ = ETriangulationMethod::DEFAULT;
 
   resection::SolverType resection_method_ = resection::SolverType::DEFAULT;
+
+  Local_Bundle_Adjustment_Options local_ba_options_;
+  size_t nb_poses_at_last_global_ba_ = 0; // Scene size when the last global BA was run
+
+  // Global BA problem kept alive across the BundleAdjustment calls
+  std::unique_ptr<Bundle_Adjustment_Ceres_Session> ba_session_;
 };
 
 } // namespace sfm
@@ -25,7 +25,9 @@
 
 #include <cmath>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <limits>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -148,6 +150,201 @@ TEST(SEQUENTIAL_SFM, Partially_Known_Intrinsics) {
   EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
 }
 
+// Test that a reconstruction resumed from a checkpoint is completed
+TEST(SEQUENTIAL_SFM, Resume_From_Checkpoint) {
+
+  const int nviews = 6;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  sfm_data.poses.clear();
+  sfm_data.structure.clear();
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  Synthetic_Features_Provider feats_provider;
+  std::normal_distribution<double> distribution(0.0,0.5);
+  feats_provider.load(d,distribution);
+  Synthetic_Matches_Provider matches_provider;
+  matches_provider.load(d);
+
+  const std::string checkpoint_directory = stlplus::create_filespec("./", "checkpoint_test");
+  stlplus::folder_delete(checkpoint_directory, true);
+
+  // Interrupt the reconstruction after the initial pair: the checkpoint of a
+  //  run restricted to the initial pair matches is relabeled with the complete
+  //  inputs and all the other views remaining.
+  {
+    Synthetic_Matches_Provider initial_pair_matches_provider;
+    initial_pair_matches_provider.pairWise_matches_[{0, 1}] =
+      matches_provider.pairWise_matches_.at({0, 1});
+    SequentialSfMReconstructionEngine sfmEngine(sfm_data, "./");
+    sfmEngine.SetFeaturesProvider(&feats_provider);
+    sfmEngine.SetMatchesProvider(&initial_pair_matches_provider);
+    sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+    sfmEngine.setInitialPair({0, 1});
+    sfmEngine.SetCheckpoint(checkpoint_directory, 0.0, false);
+    sfmEngine.Process();
+  }
+  size_t checkpoint_pose_count = 0;
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    SfM_Data checkpoint_scene;
+    SfM_Checkpoint_State checkpoint_state;
+    EXPECT_TRUE(checkpoint.Load(checkpoint_scene, checkpoint_state));
+    checkpoint_pose_count = checkpoint_scene.GetPoses().size();
+    EXPECT_EQ(2, checkpoint_pose_count);
+    checkpoint_state.fingerprint =
+      SfM_Checkpoint_Fingerprint(sfm_data, matches_provider.pairWise_matches_);
+    checkpoint_state.remaining_view_ids.clear();
+    for (const auto & view_it : sfm_data.GetViews())
+    {
+      if (!checkpoint_scene.IsPoseAndIntrinsicDefined(view_it.second.get()))
+        checkpoint_state.remaining_view_ids.insert(view_it.first);
+    }
+    EXPECT_EQ(nviews - 2, checkpoint_state.remaining_view_ids.size());
+    EXPECT_TRUE(checkpoint.Save(checkpoint_scene, checkpoint_state, true));
+    EXPECT_TRUE(checkpoint.Wait());
+  }
+
+  // The view nviews does not exist: a new run cannot start from this pair
+  const Pair invalid_initial_pair(0, nviews);
+  {
+    SequentialSfMReconstructionEngine sfmEngine(sfm_data, "./");
+    sfmEngine.SetFeaturesProvider(&feats_provider);
+    sfmEngine.SetMatchesProvider(&matches_provider);
+    sfmEngine.setInitialPair(invalid_initial_pair);
+    EXPECT_FALSE(sfmEngine.Process());
+  }
+
+  // Resume (the initial pair and the options of the checkpoint are restored)
+  {
+    SequentialSfMReconstructionEngine sfmEngine(sfm_data, "./");
+    sfmEngine.SetFeaturesProvider(&feats_provider);
+    sfmEngine.SetMatchesProvider(&matches_provider);
+    sfmEngine.setInitialPair(invalid_initial_pair);
+    sfmEngine.SetCheckpoint(checkpoint_directory, 0.0, true);
+    EXPECT_TRUE (sfmEngine.Process());
+
+    const double dResidual = RMSE(sfmEngine.Get_SfM_Data());
+    EXPECT_TRUE( dResidual < 0.5);
+    EXPECT_EQ( nviews, sfmEngine.Get_SfM_Data().GetPoses().size());
+    EXPECT_EQ( npoints, sfmEngine.Get_SfM_Data().GetLandmarks().size());
+  }
+
+  // The resumed run started from the checkpoint poses: only the remaining
+  //  views were resected
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    SfM_Data checkpoint_scene;
+    SfM_Checkpoint_State checkpoint_state;
+    EXPECT_TRUE(checkpoint.Load(checkpoint_scene, checkpoint_state));
+    EXPECT_TRUE(checkpoint_state.remaining_view_ids.empty());
+    EXPECT_EQ(nviews - checkpoint_pose_count, checkpoint_state.counters[1]);
+  }
+  stlplus::folder_delete(checkpoint_directory, true);
+}
+
+// Test that a corrupted checkpoint state is rejected
+TEST(SEQUENTIAL_SFM, Corrupted_Checkpoint) {
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(3, 8, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  const std::string checkpoint_directory = stlplus::create_filespec("./", "corrupted_checkpoint_test");
+  const std::string state_file = stlplus::create_filespec(checkpoint_directory, "checkpoint", "state");
+  stlplus::folder_delete(checkpoint_directory, true);
+
+  SfM_Checkpoint_State checkpoint_state;
+  checkpoint_state.remaining_view_ids = {0, 1, 2};
+  checkpoint_state.counters = {1, 2, 3};
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    EXPECT_TRUE(checkpoint.Save(sfm_data, checkpoint_state, true));
+    EXPECT_TRUE(checkpoint.Wait());
+    SfM_Data checkpoint_scene;
+    EXPECT_TRUE(checkpoint.Load(checkpoint_scene, checkpoint_state));
+  }
+
+  // Replace the count of the remaining views (after the magic, version,
+  //  scene slot, stage and fingerprint fields) by a huge value
+  {
+    std::fstream stream(state_file, std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekp(8 + 3 * sizeof(uint32_t) + sizeof(uint64_t));
+    const uint64_t corrupted_count = std::numeric_limits<uint64_t>::max();
+    stream.write(reinterpret_cast<const char*>(&corrupted_count), sizeof(corrupted_count));
+    EXPECT_TRUE(stream.good());
+  }
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    SfM_Data checkpoint_scene;
+    EXPECT_FALSE(checkpoint.Load(checkpoint_scene, checkpoint_state));
+  }
+  stlplus::folder_delete(checkpoint_directory, true);
+}
+
+// Test that the first checkpoint of a new run does not overwrite the scene file
+//  of the checkpoint left by a previous run
+TEST(SEQUENTIAL_SFM, Checkpoint_New_Run) {
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(3, 8, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  const std::string checkpoint_directory = stlplus::create_filespec("./", "new_run_checkpoint_test");
+  stlplus::folder_delete(checkpoint_directory, true);
+
+  SfM_Checkpoint_State checkpoint_state;
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    EXPECT_TRUE(checkpoint.Save(sfm_data, checkpoint_state, true));
+    EXPECT_TRUE(checkpoint.Wait());
+  }
+  const std::string previous_scene_file =
+    stlplus::create_filespec(checkpoint_directory, "checkpoint_0", "sfmc");
+  EXPECT_TRUE(stlplus::file_exists(previous_scene_file));
+
+  // New run (the state of the previous run points to checkpoint_0)
+  SfM_Data empty_scene;
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    EXPECT_TRUE(checkpoint.Save(empty_scene, checkpoint_state, true));
+    EXPECT_TRUE(checkpoint.Wait());
+  }
+  SfM_Data previous_scene;
+  EXPECT_TRUE(Load_Chunked(previous_scene, previous_scene_file, ESfM_Data(ALL)));
+  EXPECT_EQ(sfm_data.GetPoses().size(), previous_scene.GetPoses().size());
+  {
+    SfM_Checkpoint checkpoint(checkpoint_directory);
+    SfM_Data checkpoint_scene;
+    EXPECT_TRUE(checkpoint.Load(checkpoint_scene, checkpoint_state));
+    EXPECT_TRUE(checkpoint_scene.GetPoses().empty());
+  }
+  stlplus::folder_delete(checkpoint_directory, true);
+}
+
+// Test that the checkpoint fingerprint depends on the content of the matches
+TEST(SEQUENTIAL_SFM, Checkpoint_Fingerprint) {
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(3, 8, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  Synthetic_Matches_Provider matches_provider;
+  matches_provider.load(d);
+  matching::PairWiseMatches pairwise_matches = matches_provider.pairWise_matches_;
+  const uint64_t fingerprint = SfM_Checkpoint_Fingerprint(sfm_data, pairwise_matches);
+  EXPECT_EQ(fingerprint, SfM_Checkpoint_Fingerprint(sfm_data, pairwise_matches));
+
+  // Same match counts, different matches
+  matching::IndMatches & matches = pairwise_matches.begin()->second;
+  std::swap(matches[0].j_, matches[1].j_);
+  EXPECT_TRUE(fingerprint != SfM_Checkpoint_Fingerprint(sfm_data, pairwise_matches));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -9,9 +9,11 @@
 #ifndef OPENMVG_SFM_SFM_ENGINE_HPP
 #define OPENMVG_SFM_SFM_ENGINE_HPP
 
+#include <memory>
 #include <string>
 
 #include "openMVG/cameras/Camera_Common.hpp"
+#include "openMVG/sfm/pipelines/sfm_engine_checkpoint.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_BA.hpp"
 
@@ -75,6 +77,20 @@ public:
     b_use_motion_prior_ = rhs;
   }
 
+  /// Save periodic checkpoints of the engine state in the given directory.
+  /// If b_resume is true, Process() restarts from the last checkpoint
+  /// (if it was saved for the same views and matches).
+  void SetCheckpoint
+  (
+    const std::string & directory,
+    const double interval_seconds,
+    const bool b_resume
+  )
+  {
+    checkpoint_.reset(new SfM_Checkpoint(directory, interval_seconds));
+    b_resume_from_checkpoint_ = b_resume;
+  }
+
   const SfM_Data & Get_SfM_Data() const {return sfm_data_;}
 
 protected:
@@ -91,6 +107,12 @@ protected:
   cameras::Intrinsic_Parameter_Type intrinsic_refinement_options_;
   sfm::Extrinsic_Parameter_Type extrinsic_refinement_options_;
   bool b_use_motion_prior_;
+
+  //-----
+  //-- Checkpoints (optional)
+  //-----
+  std::unique_ptr<SfM_Checkpoint> checkpoint_;
+  bool b_resume_from_checkpoint_ = false;
 };
 
 } // namespace sfm
@@ -0,0 +1,361 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/pipelines/sfm_engine_checkpoint.hpp"
+
+#include "openMVG/sfm/sfm_data_io_chunked.hpp"
+#include "openMVG/sfm/sfm_view_priors.hpp"
+#include "openMVG/stl/hash.hpp"
+#include "openMVG/system/logger.hpp"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+namespace openMVG {
+namespace sfm {
+
+namespace {
+
+const char kCheckpointMagic[8] = {'O', 'M', 'V', 'G', 'C', 'K', 'P', 'T'};
+const uint32_t kCheckpointVersion = 1;
+
+std::string SceneFilename(const std::string & directory, const uint32_t slot)
+{
+  return stlplus::create_filespec(directory,
+    "checkpoint_" + std::to_string(slot), "sfmc");
+}
+
+std::string StateFilename(const std::string & directory)
+{
+  return stlplus::create_filespec(directory, "checkpoint", "state");
+}
+
+template <typename T>
+void Write(std::ostream & stream, const T & value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool Read(std::istream & stream, T & value)
+{
+  return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+/// Check that a count of elements read in the stream fits in its remaining bytes
+/// (a corrupted count must not trigger a huge allocation or loop)
+bool IsValidCount
+(
+  std::istream & stream,
+  const std::streamoff stream_size,
+  const uint64_t count,
+  const uint64_t element_size
+)
+{
+  const std::streamoff position = stream.tellg();
+  if (position < 0 || position > stream_size)
+    return false;
+  return count <= static_cast<uint64_t>(stream_size - position) / element_size;
+}
+
+bool WriteState
+(
+  const std::string & filename,
+  const SfM_Checkpoint_State & state,
+  const uint32_t scene_slot
+)
+{
+  std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!stream)
+    return false;
+  stream.write(kCheckpointMagic, sizeof(kCheckpointMagic));
+  Write(stream, kCheckpointVersion);
+  Write(stream, scene_slot);
+  Write(stream, state.stage);
+  Write(stream, state.fingerprint);
+
+  Write(stream, static_cast<uint64_t>(state.remaining_view_ids.size()));
+  for (const uint32_t view_id : state.remaining_view_ids)
+    Write(stream, view_id);
+  // Sorted by view id, so the same state always gives the same file
+  std::vector<std::pair<IndexT, double>> view_thresholds(
+    state.view_thresholds.cbegin(), state.view_thresholds.cend());
+  std::sort(view_thresholds.begin(), view_thresholds.end());
+  Write(stream, static_cast<uint64_t>(view_thresholds.size()));
+  for (const auto & view_threshold : view_thresholds)
+  {
+    Write(stream, static_cast<uint32_t>(view_threshold.first));
+    Write(stream, view_threshold.second);
+  }
+  Write(stream, static_cast<uint64_t>(state.counters.size()));
+  for (const uint64_t counter : state.counters)
+    Write(stream, counter);
+
+  Write(stream, static_cast<int32_t>(state.intrinsic_refinement_options));
+  Write(stream, static_cast<int32_t>(state.extrinsic_refinement_options));
+  Write(stream, static_cast<uint8_t>(state.local_ba_options.bUse_local_ba_ ? 1 : 0));
+  Write(stream, static_cast<uint32_t>(state.local_ba_options.covisibility_hops_));
+  Write(stream, state.local_ba_options.global_ba_growth_ratio_);
+  Write(stream, static_cast<uint32_t>(state.local_ba_options.min_poses_for_local_ba_));
+  Write(stream, state.ba_max_poses_per_submap);
+  stream.flush();
+  return stream.good();
+}
+
+bool ReadState
+(
+  const std::string & filename,
+  SfM_Checkpoint_State & state,
+  uint32_t & scene_slot
+)
+{
+  std::ifstream stream(filename, std::ios::in | std::ios::binary);
+  if (!stream)
+    return false;
+  stream.seekg(0, std::ios::end);
+  const std::streamoff stream_size = stream.tellg();
+  stream.seekg(0);
+  char magic[8];
+  uint32_t version = 0;
+  if (!stream.read(magic, sizeof(magic))
+      || !std::equal(magic, magic + sizeof(magic), kCheckpointMagic)
+      || !Read(stream, version) || version != kCheckpointVersion
+      || !Read(stream, scene_slot)
+      || !Read(stream, state.stage)
+      || !Read(stream, state.fingerprint))
+    return false;
+
+  uint64_t count = 0;
+  if (!Read(stream, count) || !IsValidCount(stream, stream_size, count, sizeof(uint32_t)))
+    return false;
+  state.remaining_view_ids.clear();
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    uint32_t view_id;
+    if (!Read(stream, view_id))
+      return false;
+    state.remaining_view_ids.insert(view_id);
+  }
+  if (!Read(stream, count)
+      || !IsValidCount(stream, stream_size, count, sizeof(uint32_t) + sizeof(double)))
+    return false;
+  state.view_thresholds.clear();
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    uint32_t view_id;
+    double threshold;
+    if (!Read(stream, view_id) || !Read(stream, threshold))
+      return false;
+    state.view_thresholds[view_id] = threshold;
+  }
+  if (!Read(stream, count) || !IsValidCount(stream, stream_size, count, sizeof(uint64_t)))
+    return false;
+  state.counters.resize(count);
+  for (uint64_t & counter : state.counters)
+  {
+    if (!Read(stream, counter))
+      return false;
+  }
+
+  int32_t intrinsic_refinement_options, extrinsic_refinement_options;
+  uint8_t bUse_local_ba;
+  uint32_t covisibility_hops, min_poses_for_local_ba;
+  if (!Read(stream, intrinsic_refinement_options)
+      || !Read(stream, extrinsic_refinement_options)
+      || !Read(stream, bUse_local_ba)
+      || !Read(stream, covisibility_hops)
+      || !Read(stream, state.local_ba_options.global_ba_growth_ratio_)
+      || !Read(stream, min_poses_for_local_ba)
+      || !Read(stream, state.ba_max_poses_per_submap))
+    return false;
+  state.intrinsic_refinement_options =
+    static_cast<cameras::Intrinsic_Parameter_Type>(intrinsic_refinement_options);
+  state.extrinsic_refinement_options =
+    static_cast<Extrinsic_Parameter_Type>(extrinsic_refinement_options);
+  state.local_ba_options.bUse_local_ba_ = (bUse_local_ba == 1);
+  state.local_ba_options.covisibility_hops_ = covisibility_hops;
+  state.local_ba_options.min_poses_for_local_ba_ = min_poses_for_local_ba;
+  return true;
+}
+
+/// Replace a file by another one (atomically where the platform allows it)
+bool ReplaceFile(const std::string & from, const std::string & to)
+{
+  if (std::rename(from.c_str(), to.c_str()) == 0)
+    return true;
+  // Some platforms do not replace an existing file
+  std::remove(to.c_str());
+  return std::rename(from.c_str(), to.c_str()) == 0;
+}
+
+/// Copy of the scene that does not share the data that the engine modifies
+/// (views and intrinsics are shared pointers)
+SfM_Data DeepCopy(const SfM_Data & sfm_data)
+{
+  SfM_Data copy;
+  copy.s_root_path = sfm_data.s_root_path;
+  for (const auto & view_it : sfm_data.views)
+  {
+    const ViewPriors * view_priors = dynamic_cast<const ViewPriors*>(view_it.second.get());
+    if (view_priors)
+      copy.views[view_it.first] = std::make_shared<ViewPriors>(*view_priors);
+    else
+      copy.views[view_it.first] = std::make_shared<View>(*view_it.second);
+  }
+  for (const auto & intrinsic_it : sfm_data.intrinsics)
+  {
+    copy.intrinsics[intrinsic_it.first] =
+      std::shared_ptr<cameras::IntrinsicBase>(intrinsic_it.second->clone());
+  }
+  copy.poses = sfm_data.poses;
+  copy.structure = sfm_data.structure;
+  copy.control_points = sfm_data.control_points;
+  return copy;
+}
+
+} // namespace
+
+uint64_t SfM_Checkpoint_Fingerprint
+(
+  const SfM_Data & sfm_data,
+  const matching::PairWiseMatches & pairwise_matches
+)
+{
+  // The views are listed by id (the Views container is not ordered)
+  std::vector<std::pair<IndexT, IndexT>> view_poses;
+  view_poses.reserve(sfm_data.GetViews().size());
+  for (const auto & view_it : sfm_data.GetViews())
+    view_poses.emplace_back(view_it.first, view_it.second->id_pose);
+  std::sort(view_poses.begin(), view_poses.end());
+
+  std::size_t fingerprint = 0;
+  for (const auto & view_pose : view_poses)
+  {
+    stl::hash_combine(fingerprint, view_pose.first);
+    stl::hash_combine(fingerprint, view_pose.second);
+  }
+  // PairWiseMatches is an ordered map
+  for (const auto & matches_it : pairwise_matches)
+  {
+    stl::hash_combine(fingerprint, matches_it.first.first);
+    stl::hash_combine(fingerprint, matches_it.first.second);
+    stl::hash_combine(fingerprint, matches_it.second.size());
+    for (const matching::IndMatch & match : matches_it.second)
+    {
+      stl::hash_combine(fingerprint, match.i_);
+      stl::hash_combine(fingerprint, match.j_);
+    }
+  }
+  return fingerprint;
+}
+
+SfM_Checkpoint::SfM_Checkpoint
+(
+  const std::string & directory,
+  const double interval_seconds
+)
+: directory_(directory),
+  interval_seconds_(interval_seconds)
+{
+  if (!stlplus::folder_exists(directory_))
+    stlplus::folder_create(directory_);
+  // A checkpoint of a previous run may be in the directory: its scene file must
+  // not be overwritten by the first checkpoint (its state would point to it
+  // until the new state is written)
+  SfM_Checkpoint_State state;
+  uint32_t scene_slot = 0;
+  if (stlplus::file_exists(StateFilename(directory_))
+      && ReadState(StateFilename(directory_), state, scene_slot) && scene_slot <= 1)
+    committed_slot_ = scene_slot;
+}
+
+SfM_Checkpoint::~SfM_Checkpoint()
+{
+  Wait();
+}
+
+bool SfM_Checkpoint::Save
+(
+  const SfM_Data & sfm_data,
+  const SfM_Checkpoint_State & state,
+  const bool b_force
+)
+{
+  if (!b_force && timer_.elapsed() < interval_seconds_)
+    return false;
+  // Do not stall the engine on a slow disk: skip this checkpoint
+  if (!b_force && pending_write_.valid()
+      && pending_write_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    return false;
+  if (!Wait())
+    OPENMVG_LOG_WARNING << "The previous checkpoint could not be written in: " << directory_;
+
+  // The engine keeps modifying its scene: the writer works on a copy
+  std::shared_ptr<SfM_Data> scene = std::make_shared<SfM_Data>(DeepCopy(sfm_data));
+  // Never overwrite the scene file of the last complete checkpoint
+  const uint32_t scene_slot = 1 - committed_slot_;
+  const std::string directory = directory_;
+  pending_write_ = std::async(std::launch::async, [scene, state, scene_slot, directory]
+  {
+    const std::string scene_filename = SceneFilename(directory, scene_slot);
+    const std::string state_filename = StateFilename(directory);
+    const std::string state_tmp_filename = state_filename + ".tmp";
+    return Save_Chunked(*scene, scene_filename, ESfM_Data(ALL))
+      && WriteState(state_tmp_filename, state, scene_slot)
+      && ReplaceFile(state_tmp_filename, state_filename);
+  });
+  pending_slot_ = scene_slot;
+  timer_.reset();
+  return true;
+}
+
+bool SfM_Checkpoint::Wait()
+{
+  if (!pending_write_.valid())
+    return true;
+  const bool bOk = pending_write_.get();
+  if (bOk)
+    committed_slot_ = pending_slot_;
+  return bOk;
+}
+
+bool SfM_Checkpoint::Load
+(
+  SfM_Data & sfm_data,
+  SfM_Checkpoint_State & state
+)
+{
+  Wait();
+  uint32_t scene_slot = 0;
+  if (!stlplus::file_exists(StateFilename(directory_)))
+    return false;
+  if (!ReadState(StateFilename(directory_), state, scene_slot) || scene_slot > 1)
+  {
+    OPENMVG_LOG_ERROR << "Invalid checkpoint state: " << StateFilename(directory_);
+    return false;
+  }
+  SfM_Data scene;
+  if (!Load_Chunked(scene, SceneFilename(directory_, scene_slot), ESfM_Data(ALL)))
+  {
+    OPENMVG_LOG_ERROR << "Cannot read the checkpoint scene: "
+      << SceneFilename(directory_, scene_slot);
+    return false;
+  }
+  sfm_data = std::move(scene);
+  // Keep the loaded scene file valid until the next checkpoint is complete
+  committed_slot_ = scene_slot;
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,116 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_PIPELINES_SFM_ENGINE_CHECKPOINT_HPP
+#define OPENMVG_SFM_PIPELINES_SFM_ENGINE_CHECKPOINT_HPP
+
+#include "openMVG/cameras/Camera_Common.hpp"
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA.hpp"
+#include "openMVG/sfm/sfm_data_BA_local.hpp"
+#include "openMVG/system/timer.hpp"
+#include "openMVG/types.hpp"
+
+#include <cstdint>
+#include <future>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+/// Reconstruction engine state saved along the scene by a checkpoint
+struct SfM_Checkpoint_State
+{
+  uint32_t stage = 0;       // Engine specific processing stage
+  uint64_t fingerprint = 0; // Fingerprint of the engine inputs (see SfM_Checkpoint_Fingerprint)
+
+  std::set<uint32_t> remaining_view_ids;   // Views that are not yet processed
+  Hash_Map<IndexT, double> view_thresholds; // Per view a contrario residual threshold
+  std::vector<uint64_t> counters;           // Engine specific counters
+
+  // Bundle adjustment options
+  cameras::Intrinsic_Parameter_Type intrinsic_refinement_options =
+    cameras::Intrinsic_Parameter_Type::ADJUST_ALL;
+  Extrinsic_Parameter_Type extrinsic_refinement_options =
+    Extrinsic_Parameter_Type::ADJUST_ALL;
+  Local_Bundle_Adjustment_Options local_ba_options;
+  uint32_t ba_max_poses_per_submap = 0;
+};
+
+/// Fingerprint of the engine inputs (views and pairwise matches content):
+/// a checkpoint is resumed only if the inputs did not change.
+uint64_t SfM_Checkpoint_Fingerprint
+(
+  const SfM_Data & sfm_data,
+  const matching::PairWiseMatches & pairwise_matches
+);
+
+/**
+* @brief Periodic and asynchronous checkpoints of a reconstruction engine.
+*
+* The engine calls Save() at the end of its processing steps: a checkpoint is
+* written only if the configured interval is elapsed since the last one, and
+* the writing is done by a background task (the engine only pays the copy of
+* the scene).
+*
+* Checkpoint directory content:
+*  - checkpoint_0.sfmc, checkpoint_1.sfmc: the scene of the last two
+*    checkpoints (chunked binary sfm_data, see sfm_data_io_chunked.hpp),
+*  - checkpoint.state: the engine state and the name of its scene file.
+*    It is written last (and renamed atomically), so an interrupted write
+*    never invalidates the previous checkpoint.
+*/
+class SfM_Checkpoint
+{
+public:
+  SfM_Checkpoint
+  (
+    const std::string & directory,
+    const double interval_seconds = 300.0
+  );
+
+  /// Wait for the pending checkpoint writing
+  ~SfM_Checkpoint();
+
+  /// Save a checkpoint if the interval is elapsed (or if b_force is true).
+  /// Return true if a checkpoint writing was started.
+  bool Save
+  (
+    const SfM_Data & sfm_data,
+    const SfM_Checkpoint_State & state,
+    const bool b_force = false
+  );
+
+  /// Wait for the pending checkpoint writing, return false if it failed
+  bool Wait();
+
+  /// Load the last complete checkpoint
+  bool Load
+  (
+    SfM_Data & sfm_data,
+    SfM_Checkpoint_State & state
+  );
+
+  const std::string & Directory() const { return directory_; }
+
+private:
+  std::string directory_;
+  double interval_seconds_;
+  system::Timer timer_; // Time since the last checkpoint
+  std::future<bool> pending_write_;
+  uint32_t committed_slot_ = 1; // Scene file of the last complete checkpoint
+  uint32_t pending_slot_ = 0;   // Scene file of the checkpoint being written
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_PIPELINES_SFM_ENGINE_CHECKPOINT_HPP
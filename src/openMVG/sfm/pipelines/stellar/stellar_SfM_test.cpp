@@ -14,19 +14,25 @@
 // - Compute some stellar reconstruction on the data
 // - Assert that:
 //   - The computed poses are correct
+// - Check that the local tracks of the 2-uplets are the TracksBuilder ones
 //-----------------
 
 #include "openMVG/multiview/essential.hpp"
 #include "openMVG/sfm/pipelines/pipelines_test.hpp"
 #include "openMVG/sfm/pipelines/relative_pose_engine.hpp"
 #include "openMVG/sfm/pipelines/stellar/stellar_solver.hpp"
+#include "openMVG/sfm/pipelines/stellar/stellar_tracks_builder.hpp"
 #include "openMVG/sfm/sfm.hpp"
 
 #include "testing/testing.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -133,6 +139,63 @@ TEST(STELLAR_SOLVER, Known_Intrinsics) {
   }
 }
 
+// The local tracks builder gives the same tracks as TracksBuilder::Filter(3)
+// (the builder is reused from one match set to the next)
+TEST(STELLAR_SOLVER, Local_Tracks_Builder) {
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  internal::Local_Tracks_Builder local_tracks_builder;
+  for (int trial = 0; trial < 20; ++trial)
+  {
+    // Matches of 100 tracks between 3 views (the feature ids are shuffled):
+    // some matches are missing and some are wrong (they merge some tracks,
+    // with view id collisions)
+    const int nb_features = 100;
+    std::vector<std::vector<uint32_t>> track_features(3, std::vector<uint32_t>(nb_features));
+    for (auto & view_features : track_features)
+    {
+      std::iota(view_features.begin(), view_features.end(), 0);
+      std::shuffle(view_features.begin(), view_features.end(), random_generator);
+    }
+    std::uniform_int_distribution<int> feature_distribution(0, nb_features - 1);
+    std::bernoulli_distribution missing_match(0.2), wrong_match(0.05);
+    matching::PairWiseMatches pairwise_matches;
+    for (const Pair & pair : {Pair(0, 1), Pair(1, 2), Pair(0, 2)})
+    {
+      for (int k = 0; k < nb_features; ++k)
+      {
+        if (missing_match(random_generator))
+          continue;
+        const int l = wrong_match(random_generator) ? feature_distribution(random_generator) : k;
+        pairwise_matches[pair].emplace_back(
+          track_features[pair.first][k], track_features[pair.second][l]);
+      }
+    }
+
+    tracks::TracksBuilder tracks_builder;
+    tracks_builder.Build(pairwise_matches);
+    tracks_builder.Filter(3);
+    tracks::STLMAPTracks tracks;
+    tracks_builder.ExportToSTL(tracks);
+
+    std::vector<const matching::PairWiseMatches::value_type *> matches;
+    for (const auto & pair_matches : pairwise_matches)
+      matches.push_back(&pair_matches);
+    local_tracks_builder.Build(matches);
+    tracks::STLMAPTracks local_tracks;
+    local_tracks_builder.ExportToSTL(local_tracks, 3);
+
+    // The track ids differ: compare the tracks content
+    std::set<tracks::submapTrack> expected_tracks, computed_tracks;
+    for (const auto & track : tracks)
+      expected_tracks.insert(track.second);
+    for (const auto & track : local_tracks)
+      computed_tracks.insert(track.second);
+    EXPECT_EQ(tracks.size(), local_tracks.size());
+    EXPECT_TRUE(expected_tracks == computed_tracks);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -16,6 +16,7 @@
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_matches_provider.hpp"
 #include "openMVG/sfm/pipelines/stellar/stellar_definitions.hpp"
+#include "openMVG/sfm/pipelines/stellar/stellar_tracks_builder.hpp"
 #include "openMVG/sfm/sfm_data_BA_ceres.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
@@ -26,6 +27,7 @@
 #include "openMVG/types.hpp"
 
 #include <algorithm>
+#include <cstdint>
 
 #include "ceres/ceres.h"
 
@@ -40,8 +42,9 @@ bool EstimateTripletRelativeScale
   const Pair_Set & pairs,  // 2 pair of Pose Ids
   const SfM_Data & sfm_data,
   const Features_Provider * features_provider,
-  const Matches_Provider * matches_provider,
+  const Stellar_Solver::Pose_Pair_Matches & pose_pair_matches,
   const Hash_Map<Pair, geometry::Pose3> & relative_poses,
+  internal::Local_Tracks_Builder & tracks_builder,
   Relative_Scale & relative_scale
 )
 {
@@ -87,37 +90,28 @@ bool EstimateTripletRelativeScale
   //
   openMVG::tracks::STLMAPTracks map_tracksCommon;
   {
-    matching::PairWiseMatches matches;
-    //-- List all view that shared some content with the used poses
-    for (const auto & matches_it : matches_provider->pairWise_matches_)
+    //-- List all view pairs that shared some content with the used poses
+    std::vector<const matching::PairWiseMatches::value_type *> matches;
+    for (auto it_i = set_pose.cbegin(); it_i != set_pose.cend(); ++it_i)
     {
-      const Pair & pair = matches_it.first;
-
-      const View
-        * view_I = sfm_data.GetViews().find(pair.first)->second.get(),
-        * view_J = sfm_data.GetViews().find(pair.second)->second.get();
-
-      if (set_pose.count(view_I->id_pose)
-          && set_pose.count(view_J->id_pose))
+      for (auto it_j = it_i; it_j != set_pose.cend(); ++it_j)
       {
-        const matching::IndMatches & pair_matches = matches_it.second;
-        matches[pair] = pair_matches;
+        const auto it_matches = pose_pair_matches.find({*it_i, *it_j});
+        if (it_matches != pose_pair_matches.cend())
+          matches.insert(matches.end(), it_matches->second.cbegin(), it_matches->second.cend());
       }
     }
 
     // Computing tracks
-    openMVG::tracks::TracksBuilder tracksBuilder;
-    tracksBuilder.Build(matches);
-    tracksBuilder.Filter(3);
+    tracks_builder.Build(matches);
+    tracks_builder.ExportToSTL(map_tracksCommon, 3);
 
     // If there is insufficient 3-view track count,
     // We reject this triplet, since the relative scale factor cannot be reliably computed.
-    if (tracksBuilder.NbTracks() < 15)
+    if (map_tracksCommon.size() < 15)
     {
       return false;
     }
-
-    tracksBuilder.ExportToSTL(map_tracksCommon);
   }
 
   //
@@ -322,6 +316,28 @@ Stellar_Solver::Stellar_Solver
   use_all_matches_(use_all_matches),
   use_threading_(use_threading)
 {
+  // Index once the matches linked to the stellar pod poses
+  std::set<IndexT> set_pose;
+  for (const Pair & it : stellar_pod_)
+  {
+    set_pose.insert(it.first);
+    set_pose.insert(it.second);
+  }
+  for (const auto & matches_it : matches_provider_->pairWise_matches_)
+  {
+    const Pair & pair = matches_it.first;
+    const View
+      * view_I = sfm_data_.GetViews().find(pair.first)->second.get(),
+      * view_J = sfm_data_.GetViews().find(pair.second)->second.get();
+
+    if (set_pose.count(view_I->id_pose)
+        && set_pose.count(view_J->id_pose))
+    {
+      const Pair pose_pair(std::min(view_I->id_pose, view_J->id_pose),
+                           std::max(view_I->id_pose, view_J->id_pose));
+      pose_pair_matches_[pose_pair].push_back(&matches_it);
+    }
+  }
 }
 
 bool Stellar_Solver::Solve(Poses & poses)
@@ -408,20 +424,34 @@ bool Stellar_Solver::Solve2UpletsRelativeScales
 {
   // List possible 2-uplet and solve their relative scales
   // some 2-uplet cannot lead to a relative scale if they don't share a sufficient track amount
-  for (const auto edge_two_uplet : edge_two_uplets)
+  std::vector<Relative_Scale> two_uplets_scales(edge_two_uplets.size());
+  std::vector<uint8_t> two_uplets_valid(edge_two_uplets.size(), 0);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel if (use_threading_)
+#endif
   {
-    Relative_Scale relative_scale;
-    if (EstimateTripletRelativeScale(
-          edge_two_uplet,  // Pair of pose Ids that define a triplet of pose
-          sfm_data_,
-          features_provider_,
-          matches_provider_,
-          relative_poses_,
-          relative_scale))
+    // Per thread track builder (its memory is reused by each 2-uplet)
+    internal::Local_Tracks_Builder tracks_builder;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(edge_two_uplets.size()); ++i)
     {
-      relative_scales.emplace_back(relative_scale);
+      two_uplets_valid[i] = EstimateTripletRelativeScale(
+        edge_two_uplets[i],  // Pair of pose Ids that define a triplet of pose
+        sfm_data_,
+        features_provider_,
+        pose_pair_matches_,
+        relative_poses_,
+        tracks_builder,
+        two_uplets_scales[i]);
     }
   }
+  for (size_t i = 0; i < edge_two_uplets.size(); ++i)
+  {
+    if (two_uplets_valid[i])
+      relative_scales.emplace_back(two_uplets_scales[i]);
+  }
   return !relative_scales.empty();
 }
 
@@ -481,31 +511,23 @@ bool Stellar_Solver::Optimize
   openMVG::tracks::STLMAPTracks tracks;
   {
     matching::PairWiseMatches matches;
-    for (const auto & matches_it : matches_provider_->pairWise_matches_)
+    for (const auto & pose_pair_it : pose_pair_matches_)
     {
-      const Pair & pair = matches_it.first;
-
-      const View * view_I = sfm_data_.GetViews().find(pair.first)->second.get();
-      const View * view_J = sfm_data_.GetViews().find(pair.second)->second.get();
-
-      if (triplet_poses.count(view_I->id_pose)
-          && triplet_poses.count(view_J->id_pose))
+      const Pair & pose_pair = pose_pair_it.first;
+      if (triplet_poses.count(pose_pair.first) == 0
+          || triplet_poses.count(pose_pair.second) == 0)
+        continue;
+      if (!use_all_matches_ && used_pairs.count(pose_pair) == 0)
+        continue; // This pair is ignored
+
+      for (const auto * matches_it : pose_pair_it.second)
       {
         // Collect matches
-        const Pair pose_pair(std::min(view_I->id_pose,view_J->id_pose),
-                             std::max(view_I->id_pose,view_J->id_pose));
-        const matching::IndMatches & pair_matches = matches_it.second;
-        if (!use_all_matches_)
-        {
-          if (used_pairs.count(pose_pair))
-            matches[pair] = pair_matches;
-          else
-            continue; // This pair is ignored
-        }
-        else
-        {
-          matches[pair] = pair_matches;
-        }
+        const Pair & pair = matches_it->first;
+        matches[pair] = matches_it->second;
+
+        const View * view_I = sfm_data_.GetViews().find(pair.first)->second.get();
+        const View * view_J = sfm_data_.GetViews().find(pair.second)->second.get();
 
         // Add view information and related intrinsic data
         const std::array<const View*, 2> view_ids = {view_I, view_J};
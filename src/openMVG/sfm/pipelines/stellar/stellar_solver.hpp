@@ -9,9 +9,12 @@
 #ifndef OPENMVG_SFM_STELLAR_STELLAR_SOLVER_HPP
 #define OPENMVG_SFM_STELLAR_STELLAR_SOLVER_HPP
 
+#include "openMVG/matching/indMatch.hpp"
 #include "openMVG/sfm/pipelines/stellar/relative_scale.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 
+#include <vector>
+
 namespace openMVG {
 namespace sfm {
 
@@ -35,6 +38,10 @@ struct Stellar_Solver
 
   bool Solve(Poses & poses);
 
+  /// View pair matches indexed by their pose pair {min pose id, max pose id}
+  using Pose_Pair_Matches =
+    Hash_Map<Pair, std::vector<const matching::PairWiseMatches::value_type *>>;
+
 private:
 
   std::vector<Pair_Set> ListEdge2Uplets();
@@ -79,6 +86,8 @@ private:
   const Features_Provider * features_provider_;
   // Relative motion cache:
   const Hash_Map<Pair, Pose3> & relative_poses_;
+  // Matches linked to the stellar pod poses (listed once for all the 2-uplets)
+  Pose_Pair_Matches pose_pair_matches_;
 };
 
 } // namespace sfm
@@ -0,0 +1,109 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_STELLAR_TRACKS_BUILDER_HPP
+#define OPENMVG_SFM_STELLAR_TRACKS_BUILDER_HPP
+
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/tracks/tracks.hpp"
+#include "openMVG/tracks/union_find.hpp"
+#include "openMVG/types.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+// Implementation detail of the stellar solver (stellar_solver.cpp and its unit test)
+namespace internal
+{
+
+/// Build the tracks of a small set of view pair matches (i.e. a triplet of poses).
+/// It gives the same tracks as the TracksBuilder, Filter, ExportToSTL sequence
+/// but the object is meant to be reused: the memory is kept from one call to the next.
+class Local_Tracks_Builder
+{
+public:
+  void Build(const std::vector<const matching::PairWiseMatches::value_type *> & matches)
+  {
+    // List the (view, feature) nodes
+    nodes_.clear();
+    for (const auto * pair_matches : matches)
+    {
+      const Pair & pair = pair_matches->first;
+      for (const matching::IndMatch & match : pair_matches->second)
+      {
+        nodes_.push_back(Key(pair.first, match.i_));
+        nodes_.push_back(Key(pair.second, match.j_));
+      }
+    }
+    std::sort(nodes_.begin(), nodes_.end());
+    nodes_.erase(std::unique(nodes_.begin(), nodes_.end()), nodes_.end());
+
+    // Union of the matched features
+    uf_tree_.m_cc_parent.clear();
+    uf_tree_.m_cc_rank.clear();
+    uf_tree_.m_cc_size.clear();
+    uf_tree_.InitSets(nodes_.size());
+    for (const auto * pair_matches : matches)
+    {
+      const Pair & pair = pair_matches->first;
+      for (const matching::IndMatch & match : pair_matches->second)
+      {
+        uf_tree_.Union(Index(Key(pair.first, match.i_)), Index(Key(pair.second, match.j_)));
+      }
+    }
+  }
+
+  /// Export the tracks that have at least nLengthSupTo observations and
+  /// that list only once each view
+  void ExportToSTL(tracks::STLMAPTracks & map_tracks, uint32_t nLengthSupTo)
+  {
+    map_tracks.clear();
+    for (uint32_t k = 0; k < nodes_.size(); ++k)
+    {
+      const uint32_t track_id = uf_tree_.Find(k);
+      if (uf_tree_.m_cc_size[track_id] >= nLengthSupTo)
+      {
+        map_tracks[track_id][static_cast<uint32_t>(nodes_[k] >> 32)] =
+          static_cast<uint32_t>(nodes_[k]);
+      }
+    }
+    // Remove the tracks with view id collision (some features are merged)
+    for (auto it = map_tracks.begin(); it != map_tracks.end();)
+    {
+      if (it->second.size() != uf_tree_.m_cc_size[it->first])
+        it = map_tracks.erase(it);
+      else
+        ++it;
+    }
+  }
+
+private:
+  static uint64_t Key(uint32_t view_id, uint32_t feat_id)
+  {
+    return (static_cast<uint64_t>(view_id) << 32) | feat_id;
+  }
+
+  uint32_t Index(uint64_t key) const
+  {
+    return static_cast<uint32_t>(
+      std::lower_bound(nodes_.cbegin(), nodes_.cend(), key) - nodes_.cbegin());
+  }
+
+  std::vector<uint64_t> nodes_;
+  UnionFind uf_tree_;
+};
+
+} // namespace internal
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_STELLAR_TRACKS_BUILDER_HPP
@@ -19,9 +19,19 @@
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
+#include "openMVG/system/logger.hpp"
 #include "openMVG/system/loggerprogress.hpp"
+#include "openMVG/system/timer.hpp"
 #include "openMVG/tracks/tracks.hpp"
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
+
 namespace openMVG {
 namespace sfm {
 
@@ -30,12 +40,6 @@ using namespace openMVG::features;
 using namespace openMVG::geometry;
 using namespace openMVG::matching;
 
-/// Camera pair epipole (Projection of camera center 2 in the image plane 1)
-inline Vec3 epipole_from_P(const Mat34& P1, const Pose3& P2)
-{
-  return P1 * P2.center().homogeneous();
-}
-
 /// Export point feature based vector to a matrix [(x,y)'T, (x,y)'T]
 /// Use the camera intrinsics in order to get undistorted pixel coordinates
 template<typename MatT >
@@ -75,9 +79,67 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::run(
 {
   sfm_data.structure.clear();
 
+  system::Timer timer;
+  compute_feature_grids(sfm_data, pairs, regions_provider);
+  const double grid_time = timer.elapsed();
+  timer.reset();
   match(sfm_data, pairs, regions_provider);
+  const double match_time = timer.elapsed();
+  timer.reset();
   filter(sfm_data, pairs, regions_provider);
+  const double filter_time = timer.elapsed();
+  timer.reset();
   triangulate(sfm_data, regions_provider, triangulation_method);
+  const double triangulate_time = timer.elapsed();
+
+  OPENMVG_LOG_INFO
+    << "Structure estimation timing (s):\n"
+    << "- feature grids: " << grid_time << "\n"
+    << "- guided matching: " << match_time << "\n"
+    << "- triplet validation: " << filter_time << "\n"
+    << "- triangulation: " << triangulate_time;
+}
+
+/// Compute once the grid of the undistorted features of the views used by the pairs
+void SfM_Data_Structure_Estimation_From_Known_Poses::compute_feature_grids(
+  const SfM_Data & sfm_data,
+  const Pair_Set & pairs,
+  const std::shared_ptr<Regions_Provider> & regions_provider)
+{
+  std::set<IndexT> set_view_ids;
+  for (const Pair & pair : pairs)
+  {
+    set_view_ids.insert(pair.first);
+    set_view_ids.insert(pair.second);
+  }
+  const std::vector<IndexT> view_ids(set_view_ids.cbegin(), set_view_ids.cend());
+
+  std::vector<geometry_aware::Feature_Grid> grids(view_ids.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif // OPENMVG_USE_OPENMP
+  for (int i = 0; i < static_cast<int>(view_ids.size()); ++i)
+  {
+    const View * view = sfm_data.GetViews().at(view_ids[i]).get();
+    const Intrinsics::const_iterator iterIntrinsic =
+      sfm_data.GetIntrinsics().find(view->id_intrinsic);
+    if (iterIntrinsic == sfm_data.GetIntrinsics().end())
+      continue;
+    const IntrinsicBase * cam = iterIntrinsic->second.get();
+    const std::shared_ptr<features::Regions> regions = regions_provider->get(view_ids[i]);
+    std::vector<Vec2> features(regions->RegionCount());
+    for (size_t j = 0; j < features.size(); ++j)
+    {
+      features[j] = cam->get_ud_pixel(regions->GetRegionPosition(j));
+    }
+    grids[i] = geometry_aware::Feature_Grid(std::move(features));
+  }
+
+  feature_grids.clear();
+  for (size_t i = 0; i < view_ids.size(); ++i)
+  {
+    feature_grids[view_ids[i]] = std::move(grids[i]);
+  }
 }
 
 /// Use guided matching to find corresponding 2-view correspondences
@@ -86,23 +148,25 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::match(
   const Pair_Set & pairs,
   const std::shared_ptr<Regions_Provider> & regions_provider)
 {
-  system::LoggerProgress my_progress_bar( pairs.size(),
+  const std::vector<Pair> vec_pairs(pairs.cbegin(), pairs.cend());
+  // Each pair has its own result slot (no synchronization is required)
+  std::vector<IndMatches> pair_matches(vec_pairs.size());
+  std::vector<unsigned char> pair_matched(vec_pairs.size(), 0);
+
+  system::LoggerProgress my_progress_bar( vec_pairs.size(),
     "Pairwise fundamental guided matching" );
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel
+  #pragma omp parallel for schedule(dynamic)
 #endif // OPENMVG_USE_OPENMP
-  for (const Pair & pair : pairs)
+  for (int pair_index = 0; pair_index < static_cast<int>(vec_pairs.size()); ++pair_index)
   {
-#ifdef OPENMVG_USE_OPENMP
-    #pragma omp single nowait
-#endif // OPENMVG_USE_OPENMP
-    {
+    const Pair & pair = vec_pairs[pair_index];
     // --
     // Perform GUIDED MATCHING
     // --
     // Use the computed model to check valid correspondences
     // - by considering geometric error and descriptor distance ratio.
-    std::vector<IndMatch> vec_corresponding_indexes;
+    std::vector<IndMatch> & vec_corresponding_indexes = pair_matches[pair_index];
 
     const View
       * viewL = sfm_data.GetViews().at(pair.first).get(),
@@ -112,7 +176,7 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::match(
       poseL = sfm_data.GetPoseOrDie(viewL),
       poseR = sfm_data.GetPoseOrDie(viewR);
 
-    if (sfm_data.GetIntrinsics().count(viewL->id_intrinsic) != 0 ||
+    if (sfm_data.GetIntrinsics().count(viewL->id_intrinsic) != 0 &&
         sfm_data.GetIntrinsics().count(viewR->id_intrinsic) != 0)
     {
       const Intrinsics::const_iterator
@@ -143,33 +207,30 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::match(
           vec_corresponding_indexes
         );
     #else
-      const Vec3 epipole2  = epipole_from_P(P_R, poseL);
-
-      geometry_aware::GuidedMatching_Fundamental_Fast
-        <openMVG::fundamental::kernel::EpipolarDistanceError>
+      // Only the right features near the epipolar lines are visited
+      geometry_aware::GuidedMatching_Grid
+        <Mat3, openMVG::fundamental::kernel::EpipolarDistanceError>
         (
           F_lr,
-          epipole2,
-          iterIntrinsicL->second.get(),
+          feature_grids.at(pair.first).Positions(),
           *regionsL.get(),
-          iterIntrinsicR->second.get(),
+          feature_grids.at(pair.second),
           *regionsR.get(),
-          iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
           Square(thresholdF), Square(0.8),
           vec_corresponding_indexes
         );
   #endif
-
-  #ifdef OPENMVG_USE_OPENMP
-      #pragma omp critical
-  #endif // OPENMVG_USE_OPENMP
-        {
-          putative_matches[pair].insert(putative_matches[pair].end(),
-            vec_corresponding_indexes.begin(), vec_corresponding_indexes.end());
-        }
-        ++my_progress_bar;
-      }
+      pair_matched[pair_index] = 1;
     }
+    ++my_progress_bar;
+  }
+
+  // Collect the pair results (the pairs are sorted)
+  for (size_t i = 0; i < vec_pairs.size(); ++i)
+  {
+    if (pair_matched[i])
+      putative_matches.emplace_hint(putative_matches.end(),
+        vec_pairs[i], std::move(pair_matches[i]));
   }
 }
 
@@ -186,113 +247,153 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::filter(
   using Triplets = std::vector<graph::Triplet>;
   const Triplets triplets = graph::TripletListing(pairs);
 
+  // Each thread stores its validated correspondences in its own buffer
+#ifdef OPENMVG_USE_OPENMP
+  const int nb_threads = omp_get_max_threads();
+#else
+  const int nb_threads = 1;
+#endif // OPENMVG_USE_OPENMP
+  std::vector<PairWiseMatches> thread_matches(nb_threads);
+
   system::LoggerProgress my_progress_bar( triplets.size(),
     "Per triplet tracks validation (discard spurious correspondences)" );
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel
+  #pragma omp parallel for schedule(dynamic) num_threads(nb_threads)
 #endif // OPENMVG_USE_OPENMP
-  for (Triplets::const_iterator it = triplets.begin(); it != triplets.end(); ++it)
+  for (int triplet_index = 0; triplet_index < static_cast<int>(triplets.size()); ++triplet_index)
   {
 #ifdef OPENMVG_USE_OPENMP
-    #pragma omp single nowait
+    PairWiseMatches & local_matches = thread_matches[omp_get_thread_num()];
+#else
+    PairWiseMatches & local_matches = thread_matches[0];
 #endif // OPENMVG_USE_OPENMP
+    ++my_progress_bar;
+
+    const graph::Triplet & triplet = triplets[triplet_index];
+    const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+
+    openMVG::tracks::STLMAPTracks map_tracksCommon;
+    openMVG::tracks::TracksBuilder tracksBuilder;
     {
-      ++my_progress_bar;
+      PairWiseMatches map_matchesIJK;
+      if (putative_matches.count({I,J}))
+        map_matchesIJK.insert(*putative_matches.find({I,J}));
 
-      const graph::Triplet & triplet = *it;
-      const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+      if (putative_matches.count({I,K}))
+        map_matchesIJK.insert(*putative_matches.find({I,K}));
 
-      openMVG::tracks::STLMAPTracks map_tracksCommon;
-      openMVG::tracks::TracksBuilder tracksBuilder;
-      {
-        PairWiseMatches map_matchesIJK;
-        if (putative_matches.count({I,J}))
-          map_matchesIJK.insert(*putative_matches.find({I,J}));
+      if (putative_matches.count({J,K}))
+        map_matchesIJK.insert(*putative_matches.find({J,K}));
+
+      if (map_matchesIJK.size() >= 2) {
+        tracksBuilder.Build(map_matchesIJK);
+        tracksBuilder.Filter(3);
+        tracksBuilder.ExportToSTL(map_tracksCommon);
+      }
 
-        if (putative_matches.count({I,K}))
-          map_matchesIJK.insert(*putative_matches.find({I,K}));
+      if (map_tracksCommon.empty())
+        continue;
 
-        if (putative_matches.count({J,K}))
-          map_matchesIJK.insert(*putative_matches.find({J,K}));
+      const std::map<IndexT, std::shared_ptr<openMVG::features::Regions>> regions =
+      {{I, regions_provider->get(I)},
+       {J, regions_provider->get(J)},
+       {K, regions_provider->get(K)},
+      };
 
-        if (map_matchesIJK.size() >= 2) {
-          tracksBuilder.Build(map_matchesIJK);
-          tracksBuilder.Filter(3);
-          tracksBuilder.ExportToSTL(map_tracksCommon);
+      // Triangulate the tracks
+      for (const auto & track_it : map_tracksCommon)
+      {
+        const tracks::submapTrack & subTrack = track_it.second;
+        std::vector<Vec3> bearing;
+        std::vector<Mat34> poses;
+        bearing.reserve(subTrack.size());
+        poses.reserve(subTrack.size());
+        for (const auto & observation_it : subTrack) {
+          const size_t imaIndex = observation_it.first;
+          const size_t featIndex = observation_it.second;
+          const View * view = sfm_data.GetViews().at(imaIndex).get();
+          const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
+          const Pose3 pose = sfm_data.GetPoseOrDie(view);
+          bearing.emplace_back((*cam)(feature_grids.at(imaIndex).Positions()[featIndex]));
+          poses.emplace_back(pose.asMatrix());
         }
+        const Eigen::Map<const Mat3X> bearing_matrix(bearing[0].data(), 3, bearing.size());
+        Vec4 Xhomogeneous;
+        TriangulateNViewAlgebraic(bearing_matrix, poses, &Xhomogeneous);
+        const Vec3 X = Xhomogeneous.hnormalized();
+
+        // Test validity of the hypothesis:
+        // - residual error
+        // - cheirality
+        bool bCheirality = true;
+        bool bReprojection_error = true;
+        int i(0);
+        for (tracks::submapTrack::const_iterator obs_it = subTrack.begin();
+          obs_it != subTrack.end() && bCheirality && bReprojection_error; ++obs_it, ++i)
+        {
+          const View * view = sfm_data.views.at(obs_it->first).get();
 
-        const std::map<IndexT, std::shared_ptr<openMVG::features::Regions>> regions =
-        {{I, regions_provider->get(I)},
-         {J, regions_provider->get(J)},
-         {K, regions_provider->get(K)},
-        };
+          const Pose3 pose = sfm_data.GetPoseOrDie(view);
+          bCheirality &= CheiralityTest(bearing[i], pose, X);
 
-        // Triangulate the tracks
-        for (const auto & track_it : map_tracksCommon)
+          const size_t imaIndex = obs_it->first;
+          const size_t featIndex = obs_it->second;
+          const Vec2 pt = regions.at(imaIndex)->GetRegionPosition(featIndex);
+          const IntrinsicBase * cam = sfm_data.intrinsics.at(view->id_intrinsic).get();
+          const Vec2 residual = cam->residual(pose(X), pt);
+          bReprojection_error &= residual.squaredNorm() < max_reprojection_error_;
+        }
+        if (bCheirality && bReprojection_error)
+        // TODO: Add an angular check ?
         {
-          const tracks::submapTrack & subTrack = track_it.second;
-          std::vector<Vec3> bearing;
-          std::vector<Mat34> poses;
-          bearing.reserve(subTrack.size());
-          poses.reserve(subTrack.size());
-          for (const auto & observation_it : subTrack) {
-            const size_t imaIndex = observation_it.first;
-            const size_t featIndex = observation_it.second;
-            const View * view = sfm_data.GetViews().at(imaIndex).get();
-            const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-            const Pose3 pose = sfm_data.GetPoseOrDie(view);
-            const Vec2 pt = regions.at(imaIndex)->GetRegionPosition(featIndex);
-            bearing.emplace_back((*cam)(cam->get_ud_pixel(pt)));
-            poses.emplace_back(pose.asMatrix());
-          }
-          const Eigen::Map<const Mat3X> bearing_matrix(bearing[0].data(), 3, bearing.size());
-          Vec4 Xhomogeneous;
-          TriangulateNViewAlgebraic(bearing_matrix, poses, &Xhomogeneous);
-          const Vec3 X = Xhomogeneous.hnormalized();
-
-          // Test validity of the hypothesis:
-          // - residual error
-          // - cheirality
-          bool bCheirality = true;
-          bool bReprojection_error = true;
-          int i(0);
-          for (tracks::submapTrack::const_iterator obs_it = subTrack.begin();
-            obs_it != subTrack.end() && bCheirality && bReprojection_error; ++obs_it, ++i)
-          {
-            const View * view = sfm_data.views.at(obs_it->first).get();
-
-            const Pose3 pose = sfm_data.GetPoseOrDie(view);
-            bCheirality &= CheiralityTest(bearing[i], pose, X);
-
-            const size_t imaIndex = obs_it->first;
-            const size_t featIndex = obs_it->second;
-            const Vec2 pt = regions.at(imaIndex)->GetRegionPosition(featIndex);
-            const IntrinsicBase * cam = sfm_data.intrinsics.at(view->id_intrinsic).get();
-            const Vec2 residual = cam->residual(pose(X), pt);
-            bReprojection_error &= residual.squaredNorm() < max_reprojection_error_;
-          }
-          if (bCheirality && bReprojection_error)
-          // TODO: Add an angular check ?
-          {
-            #ifdef OPENMVG_USE_OPENMP
-            #pragma omp critical
-            #endif // OPENMVG_USE_OPENMP
-            {
-              openMVG::tracks::submapTrack::const_iterator iterI, iterJ, iterK;
-              iterI = iterJ = iterK = subTrack.begin();
-              std::advance(iterJ,1);
-              std::advance(iterK,2);
-
-              triplets_matches[{I,J}].emplace_back(iterI->second, iterJ->second);
-              triplets_matches[{J,K}].emplace_back(iterJ->second, iterK->second);
-            }
-          }
+          openMVG::tracks::submapTrack::const_iterator iterI, iterJ, iterK;
+          iterI = iterJ = iterK = subTrack.begin();
+          std::advance(iterJ,1);
+          std::advance(iterK,2);
+
+          local_matches[{I,J}].emplace_back(iterI->second, iterJ->second);
+          local_matches[{J,K}].emplace_back(iterJ->second, iterK->second);
         }
       }
     }
   }
   // Clear putatives matches since they are no longer required
   matching::PairWiseMatches().swap(putative_matches);
+  Hash_Map<IndexT, geometry_aware::Feature_Grid>().swap(feature_grids);
+
+  //--
+  // Merge the thread buffers: the correspondences of the pairs are merged
+  //  concurrently, sorted and deduplicated (a pair is validated by many triplets).
+  //--
+  std::set<Pair> set_validated_pairs;
+  for (const PairWiseMatches & matches : thread_matches)
+    for (const auto & pair_it : matches)
+      set_validated_pairs.insert(pair_it.first);
+  const std::vector<Pair> validated_pairs(set_validated_pairs.cbegin(), set_validated_pairs.cend());
+
+  std::vector<IndMatches> merged_matches(validated_pairs.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif // OPENMVG_USE_OPENMP
+  for (int i = 0; i < static_cast<int>(validated_pairs.size()); ++i)
+  {
+    IndMatches & matches = merged_matches[i];
+    for (const PairWiseMatches & local_matches : thread_matches)
+    {
+      const auto pair_it = local_matches.find(validated_pairs[i]);
+      if (pair_it != local_matches.end())
+        matches.insert(matches.end(), pair_it->second.cbegin(), pair_it->second.cend());
+    }
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+  }
+  std::vector<PairWiseMatches>().swap(thread_matches);
+
+  for (size_t i = 0; i < validated_pairs.size(); ++i)
+  {
+    triplets_matches.emplace_hint(triplets_matches.end(),
+      validated_pairs[i], std::move(merged_matches[i]));
+  }
 }
 
 /// Init & triangulate landmark observations from the fused validated 3-view correspondences
@@ -311,48 +412,44 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::triangulate(
   // Generate new Structure tracks
   sfm_data.structure.clear();
 
-  const IndexT min_required_inliers = 3;
-  const IndexT min_sample_index = 2;
-
-  SfM_Data_Structure_Computation_Robust structure_estimator(
-    max_reprojection_error_,
-    min_required_inliers,
-    min_sample_index,
-    triangulation_method);
-  system::LoggerProgress my_progress_bar( map_tracksCommon.size(),
-    "Tracks to structure conversion:" );
   // Fill sfm_data with the computed tracks (no 3D yet)
+  std::vector<tracks::STLMAPTracks::const_iterator> vec_tracks;
+  vec_tracks.reserve(map_tracksCommon.size());
+  for (auto itTracks = map_tracksCommon.cbegin(); itTracks != map_tracksCommon.cend(); ++itTracks)
+    vec_tracks.push_back(itTracks);
+
+  std::vector<Observations> tracks_obs(vec_tracks.size());
 #ifdef OPENMVG_USE_OPENMP
   #pragma omp parallel for schedule(dynamic)
 #endif // OPENMVG_USE_OPENMP
-  for (int i = 0; i < map_tracksCommon.size(); ++i)
+  for (int i = 0; i < static_cast<int>(vec_tracks.size()); ++i)
   {
-    ++my_progress_bar;
-
-    tracks::STLMAPTracks::const_iterator itTracks = map_tracksCommon.begin();
-    std::advance(itTracks, i);
+    Observations & obs = tracks_obs[i];
+    for (const auto & track_obs : vec_tracks[i]->second)
     {
-      const tracks::submapTrack & track = itTracks->second;
-
-      Observations obs;
-      for (const auto & track_obs : track)
-      {
-        const IndexT imaIndex = track_obs.first;
-        const IndexT featIndex = track_obs.second;
-        const std::shared_ptr<features::Regions> regions = regions_provider->get(imaIndex);
-        const Vec2 pt = regions->GetRegionPosition(featIndex);
-        obs[imaIndex] = Observation(pt, featIndex);
-      }
-      Landmark landmark;
-      if (structure_estimator.robust_triangulation(sfm_data, obs, landmark))
-      #ifdef OPENMVG_USE_OPENMP
-      #pragma omp critical
-      #endif // OPENMVG_USE_OPENMP
-      {
-        sfm_data.structure[itTracks->first] = landmark;
-      }
+      const IndexT imaIndex = track_obs.first;
+      const IndexT featIndex = track_obs.second;
+      const std::shared_ptr<features::Regions> regions = regions_provider->get(imaIndex);
+      const Vec2 pt = regions->GetRegionPosition(featIndex);
+      obs[imaIndex] = Observation(pt, featIndex);
     }
   }
+  for (size_t i = 0; i < vec_tracks.size(); ++i)
+  {
+    sfm_data.structure[vec_tracks[i]->first].obs = std::move(tracks_obs[i]);
+  }
+
+  // Robust triangulation of the tracks (invalid tracks are removed)
+  const IndexT min_required_inliers = 3;
+  const IndexT min_sample_index = 2;
+
+  SfM_Data_Structure_Computation_Robust structure_estimator(
+    max_reprojection_error_,
+    min_required_inliers,
+    min_sample_index,
+    triangulation_method,
+    true);
+  structure_estimator.triangulate(sfm_data);
 }
 
 } // namespace sfm
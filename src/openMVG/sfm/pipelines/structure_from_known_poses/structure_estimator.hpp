@@ -13,6 +13,7 @@
 
 #include "openMVG/matching/indMatch.hpp"
 #include "openMVG/multiview/triangulation_method.hpp"
+#include "openMVG/robust_estimation/guided_matching_grid.hpp"
 
 namespace openMVG { namespace sfm { struct Regions_Provider; } }
 namespace openMVG { namespace sfm { struct SfM_Data; } }
@@ -39,6 +40,12 @@ public:
 
 private:
 
+  /// Compute once the grid of the undistorted features of the views used by the pairs
+  void compute_feature_grids(
+    const SfM_Data & sfm_data,
+    const Pair_Set & pairs,
+    const std::shared_ptr<Regions_Provider> & regions_provider);
+
   /// Use guided matching to find corresponding 2-view correspondences
   void match(
     const SfM_Data & sfm_data,
@@ -63,6 +70,7 @@ private:
   //--
   matching::PairWiseMatches putative_matches;
   matching::PairWiseMatches triplets_matches;
+  Hash_Map<IndexT, geometry_aware::Feature_Grid> feature_grids; // per view
   double max_reprojection_error_;
 };
 
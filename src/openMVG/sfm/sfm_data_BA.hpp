@@ -10,6 +10,9 @@
 #define OPENMVG_SFM_SFM_DATA_BA_HPP
 
 #include "openMVG/cameras/Camera_Common.hpp"
+#include "openMVG/types.hpp"
+
+#include <set>
 
 namespace openMVG {
 namespace sfm {
@@ -70,6 +73,12 @@ struct Optimize_Options
   Structure_Parameter_Type structure_opt;
   Control_Point_Parameter control_point_opt;
   bool use_motion_priors_opt;
+  /// Landmark ids that must be held as constant even if the structure is refined
+  /// (i.e separator landmarks of a partitioned bundle adjustment)
+  std::set<IndexT> constant_landmarks;
+  /// Pose ids that must be held as constant even if the extrinsics are refined
+  /// (i.e poses outside of a local bundle adjustment window)
+  std::set<IndexT> constant_poses;
 
   Optimize_Options
   (
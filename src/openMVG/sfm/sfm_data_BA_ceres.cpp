@@ -20,6 +20,7 @@
 #include "openMVG/geometry/Similarity3_Kernel.hpp"
 //- Robust estimation - LMeds (since no threshold can be defined)
 #include "openMVG/robust_estimation/robust_estimator_LMeds.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_camera_analytic_functor.hpp"
 #include "openMVG/sfm/sfm_data_BA_ceres_camera_functor.hpp"
 #include "openMVG/sfm/sfm_data_transform.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
@@ -83,9 +84,31 @@ ceres::CostFunction * IntrinsicsToCostFunction
 (
   IntrinsicBase * intrinsic,
   const Vec2 & observation,
-  const double weight
+  const double weight,
+  const bool b_analytic_derivatives
 )
 {
+  if (b_analytic_derivatives)
+  {
+    switch (intrinsic->getType())
+    {
+      case PINHOLE_CAMERA:
+        return ResidualErrorAnalytic_Pinhole_Intrinsic::Create(observation, weight);
+      case PINHOLE_CAMERA_RADIAL1:
+        return ResidualErrorAnalytic_Pinhole_Intrinsic_Radial_K1::Create(observation, weight);
+      case PINHOLE_CAMERA_RADIAL3:
+        return ResidualErrorAnalytic_Pinhole_Intrinsic_Radial_K3::Create(observation, weight);
+      case PINHOLE_CAMERA_BROWN:
+        return ResidualErrorAnalytic_Pinhole_Intrinsic_Brown_T2::Create(observation, weight);
+      case PINHOLE_CAMERA_FISHEYE:
+        return ResidualErrorAnalytic_Pinhole_Intrinsic_Fisheye::Create(observation, weight);
+      case CAMERA_SPHERICAL:
+        return ResidualErrorAnalytic_Intrinsic_Spherical::Create(intrinsic, observation, weight);
+      default:
+        return {};
+    }
+  }
+
   switch (intrinsic->getType())
   {
     case PINHOLE_CAMERA:
@@ -114,7 +137,8 @@ Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
   nb_threads_(1),
   parameter_tolerance_(1e-8), //~= numeric_limits<float>::epsilon()
   bUse_loss_function_(true),
-  max_num_iterations_(500)
+  max_num_iterations_(500),
+  bUse_analytic_derivatives_(false)
 {
   #ifdef OPENMVG_USE_OPENMP
     nb_threads_ = omp_get_max_threads();
@@ -150,6 +174,28 @@ Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
   }
 }
 
+Bundle_Adjustment_Ceres::BA_Ceres_options BA_Ceres_options_for_pose_count
+(
+  const size_t nb_poses
+)
+{
+  Bundle_Adjustment_Ceres::BA_Ceres_options options;
+  if ( nb_poses > 100 &&
+      (ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::SUITE_SPARSE) ||
+       ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::CX_SPARSE) ||
+       ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::EIGEN_SPARSE))
+      )
+  // Enable sparse BA only if a sparse lib is available and if there more than 100 poses
+  {
+    options.preconditioner_type_ = ceres::JACOBI;
+    options.linear_solver_type_ = ceres::SPARSE_SCHUR;
+  }
+  else
+  {
+    options.linear_solver_type_ = ceres::DENSE_SCHUR;
+  }
+  return options;
+}
 
 Bundle_Adjustment_Ceres::Bundle_Adjustment_Ceres
 (
@@ -263,7 +309,8 @@ bool Bundle_Adjustment_Ceres::Adjust
 
     double * parameter_block = &map_poses.at(indexPose)[0];
     problem.AddParameterBlock(parameter_block, 6);
-    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE)
+    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE ||
+        options.constant_poses.count(indexPose))
     {
       // set the whole parameter block as constant for best performance
       problem.SetParameterBlockConstant(parameter_block);
@@ -351,7 +398,9 @@ bool Bundle_Adjustment_Ceres::Adjust
       // image location and compares the reprojection against the observation.
       ceres::CostFunction* cost_function =
         IntrinsicsToCostFunction(sfm_data.intrinsics.at(view->id_intrinsic).get(),
-                                 obs_it.second.x);
+                                 obs_it.second.x,
+                                 0.0,
+                                 ceres_options_.bUse_analytic_derivatives_);
 
       if (cost_function)
       {
@@ -377,7 +426,8 @@ bool Bundle_Adjustment_Ceres::Adjust
         return false;
       }
     }
-    if (options.structure_opt == Structure_Parameter_Type::NONE)
+    if (options.structure_opt == Structure_Parameter_Type::NONE ||
+        options.constant_landmarks.count(structure_landmark_it.first))
       problem.SetParameterBlockConstant(structure_landmark_it.second.X.data());
   }
 
@@ -401,7 +451,8 @@ bool Bundle_Adjustment_Ceres::Adjust
           IntrinsicsToCostFunction(
             sfm_data.intrinsics.at(view->id_intrinsic).get(),
             obs_it.second.x,
-            options.control_point_opt.weight);
+            options.control_point_opt.weight,
+            ceres_options_.bUse_analytic_derivatives_);
 
         if (cost_function)
         {
@@ -513,6 +564,8 @@ bool Bundle_Adjustment_Ceres::Adjust
       for (auto & pose_it : sfm_data.poses)
       {
         const IndexT indexPose = pose_it.first;
+        if (options.constant_poses.count(indexPose))
+          continue;
 
         Mat3 R_refined;
         ceres::AngleAxisToRotationMatrix(&map_poses.at(indexPose)[0], R_refined.data());
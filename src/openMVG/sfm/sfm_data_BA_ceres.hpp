@@ -21,11 +21,14 @@ namespace sfm {
 
 /// Create the appropriate cost functor according the provided input camera intrinsic model
 /// Can be residual cost functor can be weighetd if desired (default 0.0 means no weight).
+/// The Jacobians are computed by automatic differentiation or by the hand-written
+/// analytic derivatives (b_analytic_derivatives).
 ceres::CostFunction * IntrinsicsToCostFunction
 (
   cameras::IntrinsicBase * intrinsic,
   const Vec2 & observation,
-  const double weight = 0.0
+  const double weight = 0.0,
+  const bool b_analytic_derivatives = false
 );
 
 class Bundle_Adjustment_Ceres : public Bundle_Adjustment
@@ -42,6 +45,7 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
     double parameter_tolerance_;
     bool bUse_loss_function_;
     int max_num_iterations_;
+    bool bUse_analytic_derivatives_; // Use the analytic Jacobians instead of the AutoDiff ones
 
     BA_Ceres_options(const bool bVerbose = true, bool bmultithreaded = true);
   };
@@ -66,6 +70,14 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
   ) override;
 };
 
+/// Ceres options of a bundle adjustment that refines nb_poses poses:
+/// the sparse Schur solver is used only if a sparse library is available and
+/// if there is more than 100 poses (the dense Schur solver is used otherwise).
+Bundle_Adjustment_Ceres::BA_Ceres_options BA_Ceres_options_for_pose_count
+(
+  const size_t nb_poses
+);
+
 } // namespace sfm
 } // namespace openMVG
 
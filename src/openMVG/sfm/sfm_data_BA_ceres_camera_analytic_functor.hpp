@@ -0,0 +1,505 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_BA_CERES_CAMERA_ANALYTIC_FUNCTOR_HPP
+#define OPENMVG_SFM_SFM_DATA_BA_CERES_CAMERA_ANALYTIC_FUNCTOR_HPP
+
+#include <algorithm>
+#include <cmath>
+
+#include <ceres/rotation.h>
+#include <ceres/sized_cost_function.h>
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/numeric/numeric.h"
+
+//--
+//- Define ceres cost functions with hand-written (analytic) Jacobians for each
+//-  OpenMVG camera model.
+//- They compute the same residuals than the AutoDiff functors of
+//-  sfm_data_BA_ceres_camera_functor.hpp, without the Jet arithmetic overhead.
+//--
+
+namespace openMVG {
+namespace sfm {
+
+using Mat23 = Eigen::Matrix<double, 2, 3>;
+
+/**
+ * @brief Transform a 3D point in the camera frame (X_cam = R(angle_axis) * X + t)
+ *  and compute the Jacobians of X_cam.
+ *
+ * @param[in] cam_extrinsics: [angle axis (3), translation (3)] parameter block
+ * @param[in] pos_3dpoint: 3D point parameter block
+ * @param[out] transformed_point: the point in the camera frame
+ * @param[out] jacobian_rotation: d(X_cam) / d(angle_axis) (the translation one is the identity)
+ * @param[out] rotation: d(X_cam) / d(X)
+ */
+inline void TransformPointWithJacobians
+(
+  const double * const cam_extrinsics,
+  const double * const pos_3dpoint,
+  Vec3 & transformed_point,
+  Mat3 & jacobian_rotation,
+  Mat3 & rotation
+)
+{
+  const Eigen::Map<const Vec3> angle_axis(cam_extrinsics);
+  const Eigen::Map<const Vec3> X(pos_3dpoint);
+
+  ceres::AngleAxisToRotationMatrix(cam_extrinsics, rotation.data());
+  transformed_point = rotation * X + Eigen::Map<const Vec3>(&cam_extrinsics[3]);
+
+  // d(R X)/d(angle_axis) = - R [X]_x J_r, J_r being the right Jacobian of SO(3):
+  //  J_r = I - (1 - cos(theta)) / theta^2 [w]_x + (theta - sin(theta)) / theta^3 [w]_x^2
+  const Mat3 w_x = CrossProductMatrix(angle_axis);
+  const double theta2 = angle_axis.squaredNorm();
+  double a, b;
+  if (theta2 > 1e-6)
+  {
+    const double theta = std::sqrt(theta2);
+    a = (1.0 - std::cos(theta)) / theta2;
+    b = (theta - std::sin(theta)) / (theta2 * theta);
+  }
+  else
+  {
+    // Taylor expansion (avoid the catastrophic cancellation near the identity)
+    a = 0.5 - theta2 / 24.0;
+    b = 1.0 / 6.0 - theta2 / 120.0;
+  }
+  const Mat3 right_jacobian = Mat3::Identity() - a * w_x + b * w_x * w_x;
+  jacobian_rotation = - rotation * CrossProductMatrix(X) * right_jacobian;
+}
+
+/**
+ * @brief Ceres cost function with analytic Jacobians for the models that use
+ *  an intrinsic parameter block.
+ *
+ *  Data parameter blocks are the following <2,N,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - N => the intrinsic data block (ProjectionModel::intrinsic_size),
+ *  - 6 => the camera extrinsic data block (camera orientation and position) [R;t],
+ *         - rotation(angle axis), and translation [rX,rY,rZ,tx,ty,tz].
+ *  - 3 => a 3D point data block.
+ *
+ * The ProjectionModel maps a point of the camera frame to the image plane:
+ *  static void Project(cam_intrinsics, X_cam, projection,
+ *                      jacobian_point (2x3 or nullptr), jacobian_intrinsics (2xN row major or nullptr))
+ */
+template <typename ProjectionModel>
+class ResidualErrorAnalytic_Intrinsic :
+  public ceres::SizedCostFunction<2, ProjectionModel::intrinsic_size, 6, 3>
+{
+public:
+  ResidualErrorAnalytic_Intrinsic
+  (
+    const Vec2 & observation,
+    const double weight
+  ):
+    m_pos_2dpoint(observation),
+    m_weight(weight == 0.0 ? 1.0 : weight)
+  {
+  }
+
+  bool Evaluate
+  (
+    double const * const * parameters,
+    double * out_residuals,
+    double ** jacobians
+  ) const override
+  {
+    const double * cam_intrinsics = parameters[0];
+    const double * cam_extrinsics = parameters[1];
+    const double * pos_3dpoint = parameters[2];
+
+    Vec3 transformed_point;
+    Mat3 jacobian_rotation, rotation;
+    TransformPointWithJacobians(cam_extrinsics, pos_3dpoint,
+      transformed_point, jacobian_rotation, rotation);
+
+    const bool b_jacobian_intrinsics = jacobians && jacobians[0];
+    const bool b_jacobian_point = jacobians && (jacobians[1] || jacobians[2]);
+
+    Vec2 projection;
+    Mat23 jacobian_point;
+    ProjectionModel::Project(cam_intrinsics, transformed_point, projection,
+      b_jacobian_point ? &jacobian_point : nullptr,
+      b_jacobian_intrinsics ? jacobians[0] : nullptr);
+
+    Eigen::Map<Vec2> residuals(out_residuals);
+    residuals = m_weight * (projection - m_pos_2dpoint);
+
+    if (!jacobians)
+      return true;
+
+    if (b_jacobian_intrinsics)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, ProjectionModel::intrinsic_size, Eigen::RowMajor>>
+        jacobian(jacobians[0]);
+      jacobian *= m_weight;
+    }
+    if (jacobians[1])
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> jacobian(jacobians[1]);
+      jacobian.leftCols<3>() = m_weight * jacobian_point * jacobian_rotation;
+      jacobian.rightCols<3>() = m_weight * jacobian_point;
+    }
+    if (jacobians[2])
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> jacobian(jacobians[2]);
+      jacobian = m_weight * jacobian_point * rotation;
+    }
+    return true;
+  }
+
+  // Factory to hide the construction of the CostFunction object from
+  // the client code.
+  static ceres::CostFunction* Create
+  (
+    const Vec2 & observation,
+    const double weight = 0.0
+  )
+  {
+    return new ResidualErrorAnalytic_Intrinsic(observation, weight);
+  }
+
+private:
+  const Vec2 m_pos_2dpoint; // The 2D observation
+  const double m_weight;
+};
+
+/// Jacobian of the perspective division (x/z, y/z)
+inline Mat23 PerspectiveDivisionJacobian(const Vec3 & X)
+{
+  const double inv_z = 1.0 / X(2);
+  Mat23 jacobian;
+  jacobian << inv_z, 0.0, - X(0) * inv_z * inv_z,
+              0.0, inv_z, - X(1) * inv_z * inv_z;
+  return jacobian;
+}
+
+/// Pinhole camera: [focal, principal point x, principal point y]
+struct Pinhole_Projection
+{
+  static constexpr int intrinsic_size = 3;
+
+  static void Project
+  (
+    const double * const cam_intrinsics,
+    const Vec3 & transformed_point,
+    Vec2 & projection,
+    Mat23 * jacobian_point,
+    double * jacobian_intrinsics
+  )
+  {
+    const double focal = cam_intrinsics[0];
+    const Vec2 projected_point = transformed_point.hnormalized();
+    projection = focal * projected_point + Vec2(cam_intrinsics[1], cam_intrinsics[2]);
+
+    if (jacobian_point)
+      *jacobian_point = focal * PerspectiveDivisionJacobian(transformed_point);
+    if (jacobian_intrinsics)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, intrinsic_size, Eigen::RowMajor>> jacobian(jacobian_intrinsics);
+      jacobian << projected_point(0), 1.0, 0.0,
+                  projected_point(1), 0.0, 1.0;
+    }
+  }
+};
+
+/**
+ * @brief Radial distortion models:
+ *  [focal, principal point x, principal point y, K1, ..., K_NbCoeffs]
+ *  distorted point = x_u * (1 + K1 r^2 + K2 r^4 + ...)
+ */
+template <int NbCoeffs>
+struct Pinhole_Radial_Projection
+{
+  static constexpr int intrinsic_size = 3 + NbCoeffs;
+
+  static void Project
+  (
+    const double * const cam_intrinsics,
+    const Vec3 & transformed_point,
+    Vec2 & projection,
+    Mat23 * jacobian_point,
+    double * jacobian_intrinsics
+  )
+  {
+    const double focal = cam_intrinsics[0];
+    const double * k = &cam_intrinsics[3];
+    const Vec2 projected_point = transformed_point.hnormalized();
+    const double r2 = projected_point.squaredNorm();
+
+    // r_coeff = 1 + sum(k_i r2^i), d_r_coeff = d(r_coeff)/d(r2)
+    double r_coeff = 1.0, d_r_coeff = 0.0, r2_pow = 1.0;
+    for (int i = 0; i < NbCoeffs; ++i)
+    {
+      d_r_coeff += (i + 1) * k[i] * r2_pow;
+      r2_pow *= r2;
+      r_coeff += k[i] * r2_pow;
+    }
+    projection = focal * r_coeff * projected_point + Vec2(cam_intrinsics[1], cam_intrinsics[2]);
+
+    if (jacobian_point)
+    {
+      const Eigen::Matrix2d jacobian_distortion = r_coeff * Eigen::Matrix2d::Identity() +
+        (2.0 * d_r_coeff) * projected_point * projected_point.transpose();
+      *jacobian_point = focal * jacobian_distortion * PerspectiveDivisionJacobian(transformed_point);
+    }
+    if (jacobian_intrinsics)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, intrinsic_size, Eigen::RowMajor>> jacobian(jacobian_intrinsics);
+      jacobian.col(0) = r_coeff * projected_point;
+      jacobian.col(1) = Vec2(1.0, 0.0);
+      jacobian.col(2) = Vec2(0.0, 1.0);
+      r2_pow = 1.0;
+      for (int i = 0; i < NbCoeffs; ++i)
+      {
+        r2_pow *= r2;
+        jacobian.col(3 + i) = focal * r2_pow * projected_point;
+      }
+    }
+  }
+};
+
+/// Brown camera: [focal, principal point x, principal point y, K1, K2, K3, T1, T2]
+struct Pinhole_Brown_Projection
+{
+  static constexpr int intrinsic_size = 8;
+
+  static void Project
+  (
+    const double * const cam_intrinsics,
+    const Vec3 & transformed_point,
+    Vec2 & projection,
+    Mat23 * jacobian_point,
+    double * jacobian_intrinsics
+  )
+  {
+    const double focal = cam_intrinsics[0];
+    const double k1 = cam_intrinsics[3], k2 = cam_intrinsics[4], k3 = cam_intrinsics[5];
+    const double t1 = cam_intrinsics[6], t2 = cam_intrinsics[7];
+
+    const Vec2 projected_point = transformed_point.hnormalized();
+    const double x_u = projected_point(0);
+    const double y_u = projected_point(1);
+    const double r2 = projected_point.squaredNorm();
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const double t_x = t2 * (r2 + 2.0 * x_u * x_u) + 2.0 * t1 * x_u * y_u;
+    const double t_y = t1 * (r2 + 2.0 * y_u * y_u) + 2.0 * t2 * x_u * y_u;
+    const Vec2 distorted_point(x_u * r_coeff + t_x, y_u * r_coeff + t_y);
+
+    projection = focal * distorted_point + Vec2(cam_intrinsics[1], cam_intrinsics[2]);
+
+    if (jacobian_point)
+    {
+      const double d_r_coeff = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+      Eigen::Matrix2d jacobian_distortion = r_coeff * Eigen::Matrix2d::Identity() +
+        (2.0 * d_r_coeff) * projected_point * projected_point.transpose();
+      jacobian_distortion(0, 0) += 6.0 * t2 * x_u + 2.0 * t1 * y_u;
+      jacobian_distortion(0, 1) += 2.0 * t2 * y_u + 2.0 * t1 * x_u;
+      jacobian_distortion(1, 0) += 2.0 * t1 * x_u + 2.0 * t2 * y_u;
+      jacobian_distortion(1, 1) += 6.0 * t1 * y_u + 2.0 * t2 * x_u;
+      *jacobian_point = focal * jacobian_distortion * PerspectiveDivisionJacobian(transformed_point);
+    }
+    if (jacobian_intrinsics)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, intrinsic_size, Eigen::RowMajor>> jacobian(jacobian_intrinsics);
+      jacobian.col(0) = distorted_point;
+      jacobian.col(1) = Vec2(1.0, 0.0);
+      jacobian.col(2) = Vec2(0.0, 1.0);
+      jacobian.col(3) = focal * r2 * projected_point;
+      jacobian.col(4) = focal * r4 * projected_point;
+      jacobian.col(5) = focal * r6 * projected_point;
+      jacobian.col(6) = focal * Vec2(2.0 * x_u * y_u, r2 + 2.0 * y_u * y_u);
+      jacobian.col(7) = focal * Vec2(r2 + 2.0 * x_u * x_u, 2.0 * x_u * y_u);
+    }
+  }
+};
+
+/// Fisheye camera: [focal, principal point x, principal point y, K1, K2, K3, K4]
+struct Pinhole_Fisheye_Projection
+{
+  static constexpr int intrinsic_size = 7;
+
+  static void Project
+  (
+    const double * const cam_intrinsics,
+    const Vec3 & transformed_point,
+    Vec2 & projection,
+    Mat23 * jacobian_point,
+    double * jacobian_intrinsics
+  )
+  {
+    const double focal = cam_intrinsics[0];
+    const double * k = &cam_intrinsics[3];
+
+    const Vec2 projected_point = transformed_point.hnormalized();
+    const double r = projected_point.norm();
+    const double theta = std::atan(r);
+    const double theta2 = theta * theta;
+
+    // theta_dist = theta * (1 + k1 theta^2 + ... + k4 theta^8)
+    // d_theta_dist = d(theta_dist)/d(theta)
+    double theta_dist = theta, d_theta_dist = 1.0, theta2_pow = 1.0;
+    double theta_pows[4]; // theta^3, theta^5, theta^7, theta^9
+    for (int i = 0; i < 4; ++i)
+    {
+      theta2_pow *= theta2;
+      theta_pows[i] = theta * theta2_pow;
+      theta_dist += k[i] * theta_pows[i];
+      d_theta_dist += (2 * i + 3) * k[i] * theta2_pow;
+    }
+
+    // Near the principal point the model is the identity
+    const bool b_distorted = r > 1e-8;
+    const double cdist = b_distorted ? theta_dist / r : 1.0;
+    projection = focal * cdist * projected_point + Vec2(cam_intrinsics[1], cam_intrinsics[2]);
+
+    if (jacobian_point)
+    {
+      Eigen::Matrix2d jacobian_distortion = cdist * Eigen::Matrix2d::Identity();
+      if (b_distorted)
+      {
+        // d(cdist)/d(r), with d(theta)/d(r) = 1 / (1 + r^2)
+        const double d_cdist = (d_theta_dist / (1.0 + r * r) - cdist) / r;
+        jacobian_distortion += (d_cdist / r) * projected_point * projected_point.transpose();
+      }
+      *jacobian_point = focal * jacobian_distortion * PerspectiveDivisionJacobian(transformed_point);
+    }
+    if (jacobian_intrinsics)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, intrinsic_size, Eigen::RowMajor>> jacobian(jacobian_intrinsics);
+      jacobian.col(0) = cdist * projected_point;
+      jacobian.col(1) = Vec2(1.0, 0.0);
+      jacobian.col(2) = Vec2(0.0, 1.0);
+      for (int i = 0; i < 4; ++i)
+      {
+        jacobian.col(3 + i) = b_distorted ?
+          Vec2(focal * theta_pows[i] / r * projected_point) : Vec2::Zero();
+      }
+    }
+  }
+};
+
+using ResidualErrorAnalytic_Pinhole_Intrinsic =
+  ResidualErrorAnalytic_Intrinsic<Pinhole_Projection>;
+using ResidualErrorAnalytic_Pinhole_Intrinsic_Radial_K1 =
+  ResidualErrorAnalytic_Intrinsic<Pinhole_Radial_Projection<1>>;
+using ResidualErrorAnalytic_Pinhole_Intrinsic_Radial_K3 =
+  ResidualErrorAnalytic_Intrinsic<Pinhole_Radial_Projection<3>>;
+using ResidualErrorAnalytic_Pinhole_Intrinsic_Brown_T2 =
+  ResidualErrorAnalytic_Intrinsic<Pinhole_Brown_Projection>;
+using ResidualErrorAnalytic_Pinhole_Intrinsic_Fisheye =
+  ResidualErrorAnalytic_Intrinsic<Pinhole_Fisheye_Projection>;
+
+/**
+ * @brief Ceres cost function with analytic Jacobians for the spherical camera
+ *  (the model has no intrinsic parameter block).
+ *
+ *  Data parameter blocks are the following <2,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - 6 => the camera extrinsic data block (camera orientation and position) [R;t],
+ *         - rotation(angle axis), and translation [rX,rY,rZ,tx,ty,tz].
+ *  - 3 => a 3D point data block.
+ */
+class ResidualErrorAnalytic_Intrinsic_Spherical :
+  public ceres::SizedCostFunction<2, 6, 3>
+{
+public:
+  ResidualErrorAnalytic_Intrinsic_Spherical
+  (
+    const Vec2 & observation,
+    const uint32_t imageSize_w,
+    const uint32_t imageSize_h,
+    const double weight
+  ):
+    m_pos_2dpoint(observation),
+    m_imageSize{imageSize_w, imageSize_h},
+    m_weight(weight == 0.0 ? 1.0 : weight)
+  {
+  }
+
+  bool Evaluate
+  (
+    double const * const * parameters,
+    double * out_residuals,
+    double ** jacobians
+  ) const override
+  {
+    Vec3 transformed_point;
+    Mat3 jacobian_rotation, rotation;
+    TransformPointWithJacobians(parameters[0], parameters[1],
+      transformed_point, jacobian_rotation, rotation);
+
+    const double x = transformed_point(0);
+    const double y = transformed_point(1);
+    const double z = transformed_point(2);
+
+    // Transform the coord in is Image space
+    const double lon = std::atan2(x, z);
+    const double xz_norm = std::hypot(x, z);
+    const double lat = std::atan2(-y, xz_norm);
+
+    const double size = std::max(m_imageSize[0], m_imageSize[1]);
+    const double scale = size / (2 * M_PI);
+    out_residuals[0] = m_weight * (lon * scale - 0.5 + m_imageSize[0] / 2.0 - m_pos_2dpoint(0));
+    out_residuals[1] = m_weight * (- lat * scale - 0.5 + m_imageSize[1] / 2.0 - m_pos_2dpoint(1));
+
+    if (!jacobians || (!jacobians[0] && !jacobians[1]))
+      return true;
+
+    const double xz_norm2 = xz_norm * xz_norm;
+    const double norm2 = xz_norm2 + y * y;
+    Mat23 jacobian_point;
+    // d(lon) and - d(lat)
+    jacobian_point << z / xz_norm2, 0.0, - x / xz_norm2,
+                      - x * y / (xz_norm * norm2), xz_norm / norm2, - z * y / (xz_norm * norm2);
+    jacobian_point *= m_weight * scale;
+
+    if (jacobians[0])
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> jacobian(jacobians[0]);
+      jacobian.leftCols<3>() = jacobian_point * jacobian_rotation;
+      jacobian.rightCols<3>() = jacobian_point;
+    }
+    if (jacobians[1])
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> jacobian(jacobians[1]);
+      jacobian = jacobian_point * rotation;
+    }
+    return true;
+  }
+
+  // Factory to hide the construction of the CostFunction object from
+  // the client code.
+  static ceres::CostFunction* Create
+  (
+    const cameras::IntrinsicBase * cameraInterface,
+    const Vec2 & observation,
+    const double weight = 0.0
+  )
+  {
+    return new ResidualErrorAnalytic_Intrinsic_Spherical(
+      observation, cameraInterface->w(), cameraInterface->h(), weight);
+  }
+
+private:
+  const Vec2 m_pos_2dpoint;  // The 2D observation
+  const size_t m_imageSize[2]; // The image width and height
+  const double m_weight;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_BA_CERES_CAMERA_ANALYTIC_FUNCTOR_HPP
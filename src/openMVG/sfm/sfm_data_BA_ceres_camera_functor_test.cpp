@@ -0,0 +1,281 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - For each camera model, check that the analytic cost functions compute the
+//   same residuals & Jacobians than the AutoDiff ones (random cameras & points).
+// - Check that a BA converges to the same solution for both derivative modes.
+// (see openMVG_sample_sfm_bundle_adjustment_analytic for a timing benchmark)
+//-----------------
+
+#include "openMVG/cameras/cameras.hpp"
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_test.hpp"
+
+#include "testing/testing.h"
+
+// The cost functions are created by IntrinsicsToCostFunction: only the
+// (glog free) ceres::CostFunction interface is required to evaluate them.
+#include <ceres/cost_function.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// The parameter blocks of a residual
+struct Parameter_Blocks
+{
+  std::vector<double> intrinsic; // empty for the spherical camera
+  double extrinsics[6];
+  double X[3];
+  Vec2 observation;
+
+  std::vector<const double*> Pointers() const
+  {
+    std::vector<const double*> pointers;
+    if (!intrinsic.empty())
+      pointers.push_back(intrinsic.data());
+    pointers.push_back(extrinsics);
+    pointers.push_back(X);
+    return pointers;
+  }
+};
+
+// Random camera & point (the point is in front of the camera).
+// The intrinsic block is the camera parameters with some added noise.
+Parameter_Blocks RandomParameterBlocks
+(
+  const IntrinsicBase & intrinsic,
+  std::mt19937 & random_generator,
+  const double max_angle
+)
+{
+  std::uniform_real_distribution<double> unit_distribution(-1.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 0.01);
+
+  Parameter_Blocks blocks;
+  blocks.intrinsic = intrinsic.getParams();
+  for (double & param : blocks.intrinsic)
+    param *= 1.0 + noise(random_generator);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    blocks.extrinsics[i] = max_angle * unit_distribution(random_generator);
+    blocks.extrinsics[3 + i] = unit_distribution(random_generator);
+  }
+  // A point in the camera field of view
+  const Vec3 X_cam(unit_distribution(random_generator),
+    unit_distribution(random_generator), 3.0 + unit_distribution(random_generator));
+  const Vec3 angle_axis = Eigen::Map<const Vec3>(blocks.extrinsics);
+  const Mat3 R = Eigen::AngleAxisd(angle_axis.norm(), angle_axis.normalized()).toRotationMatrix();
+  Eigen::Map<Vec3>(blocks.X) =
+    R.transpose() * (X_cam - Eigen::Map<const Vec3>(&blocks.extrinsics[3]));
+
+  blocks.observation = intrinsic.project(X_cam) +
+    Vec2(unit_distribution(random_generator), unit_distribution(random_generator));
+  return blocks;
+}
+
+// Evaluate the cost functions and return the largest difference between the
+// residuals and the Jacobians (relative to the largest Jacobian coefficient)
+double CompareCostFunctions
+(
+  const ceres::CostFunction & autodiff_cost,
+  const ceres::CostFunction & analytic_cost,
+  const Parameter_Blocks & blocks
+)
+{
+  const std::vector<int32_t> & block_sizes = autodiff_cost.parameter_block_sizes();
+  std::vector<std::vector<double>> autodiff_jacobians, analytic_jacobians;
+  std::vector<double*> autodiff_pointers, analytic_pointers;
+  for (const int32_t block_size : block_sizes)
+  {
+    autodiff_jacobians.emplace_back(2 * block_size, 0.0);
+    analytic_jacobians.emplace_back(2 * block_size, 0.0);
+  }
+  for (size_t i = 0; i < block_sizes.size(); ++i)
+  {
+    autodiff_pointers.push_back(autodiff_jacobians[i].data());
+    analytic_pointers.push_back(analytic_jacobians[i].data());
+  }
+
+  double autodiff_residuals[2], analytic_residuals[2];
+  const std::vector<const double*> parameters = blocks.Pointers();
+  if (!autodiff_cost.Evaluate(parameters.data(), autodiff_residuals, autodiff_pointers.data()) ||
+      !analytic_cost.Evaluate(parameters.data(), analytic_residuals, analytic_pointers.data()))
+    return std::numeric_limits<double>::max();
+
+  double max_difference =
+    (Vec2(autodiff_residuals[0], autodiff_residuals[1]) -
+     Vec2(analytic_residuals[0], analytic_residuals[1])).lpNorm<Eigen::Infinity>();
+  double max_jacobian = 1.0;
+  for (size_t i = 0; i < block_sizes.size(); ++i)
+  {
+    for (size_t j = 0; j < autodiff_jacobians[i].size(); ++j)
+    {
+      max_jacobian = std::max(max_jacobian, std::abs(autodiff_jacobians[i][j]));
+      max_difference = std::max(max_difference,
+        std::abs(autodiff_jacobians[i][j] - analytic_jacobians[i][j]));
+    }
+  }
+  // The residuals only have to be evaluated (no Jacobian requested)
+  if (!analytic_cost.Evaluate(parameters.data(), analytic_residuals, nullptr))
+    return std::numeric_limits<double>::max();
+  max_difference = std::max(max_difference,
+    (Vec2(autodiff_residuals[0], autodiff_residuals[1]) -
+     Vec2(analytic_residuals[0], analytic_residuals[1])).lpNorm<Eigen::Infinity>());
+  return max_difference / max_jacobian;
+}
+
+// The camera models that use an intrinsic block
+std::vector<std::shared_ptr<IntrinsicBase>> PinholeCameras()
+{
+  const unsigned int w = 1000, h = 800;
+  return {
+    std::make_shared<Pinhole_Intrinsic>(w, h, 1000.0, 510.0, 390.0),
+    std::make_shared<Pinhole_Intrinsic_Radial_K1>(w, h, 1000.0, 510.0, 390.0, -0.1),
+    std::make_shared<Pinhole_Intrinsic_Radial_K3>(w, h, 1000.0, 510.0, 390.0, -0.1, 0.05, -0.01),
+    std::make_shared<Pinhole_Intrinsic_Brown_T2>(w, h, 1000.0, 510.0, 390.0, -0.1, 0.05, -0.01, 0.001, -0.002),
+    std::make_shared<Pinhole_Intrinsic_Fisheye>(w, h, 1000.0, 510.0, 390.0, -0.01, 0.02, -0.003, 0.001)
+  };
+}
+
+TEST(BA_CERES_CAMERA_FUNCTOR, AnalyticVsAutoDiff_Pinhole_Models) {
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  for (const auto & intrinsic : PinholeCameras())
+  {
+    for (const double weight : {0.0, 2.5})
+    {
+      double max_difference = 0.0;
+      for (int i = 0; i < 200; ++i)
+      {
+        // Include some (almost) identity rotations
+        const double max_angle = (i % 10 == 0) ? 1e-5 : 3.0;
+        const Parameter_Blocks blocks = RandomParameterBlocks(*intrinsic, random_generator, max_angle);
+
+        const std::unique_ptr<ceres::CostFunction> autodiff_cost(
+          IntrinsicsToCostFunction(intrinsic.get(), blocks.observation, weight, false));
+        const std::unique_ptr<ceres::CostFunction> analytic_cost(
+          IntrinsicsToCostFunction(intrinsic.get(), blocks.observation, weight, true));
+        EXPECT_EQ(autodiff_cost->parameter_block_sizes().size(),
+                  analytic_cost->parameter_block_sizes().size());
+        max_difference = std::max(max_difference,
+          CompareCostFunctions(*autodiff_cost, *analytic_cost, blocks));
+      }
+      std::cout << "Camera type: " << intrinsic->getType() << " weight: " << weight
+        << " max difference: " << max_difference << std::endl;
+      EXPECT_NEAR(0.0, max_difference, 1e-9);
+    }
+  }
+}
+
+TEST(BA_CERES_CAMERA_FUNCTOR, AnalyticVsAutoDiff_Fisheye_Center) {
+
+  // A point on the optical axis (the fisheye model is the identity at the center)
+  Pinhole_Intrinsic_Fisheye intrinsic(1000, 800, 1000.0, 510.0, 390.0, -0.01, 0.02, -0.003, 0.001);
+  Parameter_Blocks blocks;
+  blocks.intrinsic = intrinsic.getParams();
+  std::fill(blocks.extrinsics, blocks.extrinsics + 6, 0.0);
+  blocks.X[0] = 1e-10; blocks.X[1] = 0.0; blocks.X[2] = 2.0;
+  blocks.observation = Vec2(512.0, 388.0);
+
+  const std::unique_ptr<ceres::CostFunction> autodiff_cost(
+    IntrinsicsToCostFunction(&intrinsic, blocks.observation, 0.0, false));
+  const std::unique_ptr<ceres::CostFunction> analytic_cost(
+    IntrinsicsToCostFunction(&intrinsic, blocks.observation, 0.0, true));
+  EXPECT_NEAR(0.0, CompareCostFunctions(*autodiff_cost, *analytic_cost, blocks), 1e-9);
+}
+
+TEST(BA_CERES_CAMERA_FUNCTOR, AnalyticVsAutoDiff_Spherical) {
+
+  Intrinsic_Spherical intrinsic(2000, 1000);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> unit_distribution(-1.0, 1.0);
+  for (const double weight : {0.0, 2.5})
+  {
+    double max_difference = 0.0;
+    for (int i = 0; i < 200; ++i)
+    {
+      Parameter_Blocks blocks;
+      for (int j = 0; j < 6; ++j)
+        blocks.extrinsics[j] = 3.0 * unit_distribution(random_generator);
+      // Any direction can be observed by a spherical camera
+      for (int j = 0; j < 3; ++j)
+        blocks.X[j] = 10.0 * unit_distribution(random_generator);
+      blocks.observation = Vec2(1000.0, 500.0) +
+        500.0 * Vec2(unit_distribution(random_generator), unit_distribution(random_generator));
+
+      const std::unique_ptr<ceres::CostFunction> autodiff_cost(
+        IntrinsicsToCostFunction(&intrinsic, blocks.observation, weight, false));
+      const std::unique_ptr<ceres::CostFunction> analytic_cost(
+        IntrinsicsToCostFunction(&intrinsic, blocks.observation, weight, true));
+      max_difference = std::max(max_difference,
+        CompareCostFunctions(*autodiff_cost, *analytic_cost, blocks));
+    }
+    std::cout << "Spherical camera weight: " << weight
+      << " max difference: " << max_difference << std::endl;
+    EXPECT_NEAR(0.0, max_difference, 1e-9);
+  }
+}
+
+TEST(BA_CERES_CAMERA_FUNCTOR, AnalyticVsAutoDiff_BundleAdjustment) {
+
+  const Optimize_Options ba_refine_options(
+    Intrinsic_Parameter_Type::NONE,
+    Extrinsic_Parameter_Type::ADJUST_ALL,
+    Structure_Parameter_Type::ADJUST_ALL);
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(8, 100, config);
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+  // Distort the observations: the scene uses a non null radial distortion
+  const Pinhole_Intrinsic_Radial_K3 distorted_intrinsic
+    (config._cx * 2, config._cy * 2, config._fx, config._cx, config._cy, -0.1, 0.05, -0.01);
+  for (auto & landmark_it : sfm_data.structure)
+  {
+    for (auto & obs_it : landmark_it.second.obs)
+    {
+      const Vec3 X_cam = Pose3(d._R[obs_it.first], d._C[obs_it.first])(d._X.col(landmark_it.first));
+      obs_it.second.x += distorted_intrinsic.project(X_cam) - sfm_data.intrinsics.at(0)->project(X_cam);
+    }
+  }
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic_Radial_K3>(distorted_intrinsic);
+
+  double rmse[2];
+  for (const bool b_analytic : {false, true})
+  {
+    SfM_Data scene = sfm_data;
+    Bundle_Adjustment_Ceres::BA_Ceres_options options(false, false);
+    options.bUse_analytic_derivatives_ = b_analytic;
+    Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
+    EXPECT_TRUE( bundle_adjustment_obj.Adjust(scene, ba_refine_options) );
+    rmse[b_analytic] = RMSE(scene);
+  }
+  std::cout << "BA RMSE before: " << RMSE(sfm_data)
+    << " AutoDiff: " << rmse[0] << " Analytic: " << rmse[1] << std::endl;
+  EXPECT_TRUE(rmse[1] < RMSE(sfm_data));
+  EXPECT_NEAR(rmse[0], rmse[1], 1e-6);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,363 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_data_BA_ceres_partitioned.hpp"
+
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/system/logger.hpp"
+#include "openMVG/system/timer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace openMVG {
+namespace sfm {
+
+namespace {
+
+/// Recursive median split of the camera centers (along the axis of largest extent)
+void SplitPoses
+(
+  std::vector<std::pair<IndexT, Vec3>>::iterator begin,
+  std::vector<std::pair<IndexT, Vec3>>::iterator end,
+  const unsigned int max_poses_per_submap,
+  std::vector<std::set<IndexT>> & submaps
+)
+{
+  const auto count = std::distance(begin, end);
+  if (count <= static_cast<std::ptrdiff_t>(max_poses_per_submap))
+  {
+    std::set<IndexT> submap;
+    for (auto it = begin; it != end; ++it)
+      submap.insert(it->first);
+    submaps.emplace_back(std::move(submap));
+    return;
+  }
+
+  // Find the axis of largest extent
+  Vec3 min_bound = begin->second, max_bound = begin->second;
+  for (auto it = begin; it != end; ++it)
+  {
+    min_bound = min_bound.cwiseMin(it->second);
+    max_bound = max_bound.cwiseMax(it->second);
+  }
+  int axis = 0;
+  (max_bound - min_bound).maxCoeff(&axis);
+
+  // Split at the median (ties are broken by pose id to keep the split deterministic)
+  const auto middle = begin + count / 2;
+  std::nth_element(begin, middle, end,
+    [axis](const std::pair<IndexT, Vec3> & a, const std::pair<IndexT, Vec3> & b)
+    {
+      return (a.second(axis) < b.second(axis)) ||
+        (a.second(axis) == b.second(axis) && a.first < b.first);
+    });
+  SplitPoses(begin, middle, max_poses_per_submap, submaps);
+  SplitPoses(middle, end, max_poses_per_submap, submaps);
+}
+
+/// Copy the landmark with only the observations made by the given views
+Landmark RestrictObservations
+(
+  const Landmark & landmark,
+  const Views & views
+)
+{
+  Landmark sub_landmark;
+  sub_landmark.X = landmark.X;
+  for (const auto & obs_it : landmark.obs)
+  {
+    if (views.count(obs_it.first))
+      sub_landmark.obs.insert(obs_it);
+  }
+  return sub_landmark;
+}
+
+} // namespace
+
+std::vector<std::set<IndexT>> PartitionPoses
+(
+  const SfM_Data & sfm_data,
+  const unsigned int max_poses_per_submap
+)
+{
+  std::vector<std::pair<IndexT, Vec3>> centers;
+  centers.reserve(sfm_data.GetPoses().size());
+  for (const auto & pose_it : sfm_data.GetPoses())
+  {
+    centers.emplace_back(pose_it.first, pose_it.second.center());
+  }
+
+  std::vector<std::set<IndexT>> submaps;
+  if (!centers.empty())
+  {
+    SplitPoses(centers.begin(), centers.end(),
+      std::max(1u, max_poses_per_submap), submaps);
+  }
+  return submaps;
+}
+
+Bundle_Adjustment_Ceres_Partitioned::BA_Partition_options::BA_Partition_options
+(
+  const bool bVerbose,
+  const unsigned int max_poses_per_submap,
+  const unsigned int nb_global_local_iterations
+)
+: bVerbose_(bVerbose),
+  max_poses_per_submap_(max_poses_per_submap),
+  nb_global_local_iterations_(nb_global_local_iterations),
+  ceres_options_(false)
+{
+}
+
+Bundle_Adjustment_Ceres_Partitioned::Bundle_Adjustment_Ceres_Partitioned
+(
+  const BA_Partition_options & options
+)
+: partition_options_(options)
+{}
+
+Bundle_Adjustment_Ceres_Partitioned::BA_Partition_options &
+Bundle_Adjustment_Ceres_Partitioned::partition_options()
+{
+  return partition_options_;
+}
+
+bool Bundle_Adjustment_Ceres_Partitioned::Adjust
+(
+  SfM_Data & sfm_data,     // the SfM scene to refine
+  const Optimize_Options & options
+)
+{
+  if (sfm_data.GetPoses().size() <= partition_options_.max_poses_per_submap_ ||
+      options.control_point_opt.bUse_control_points ||
+      options.use_motion_priors_opt)
+  {
+    // The whole scene must be considered at once
+    Bundle_Adjustment_Ceres::BA_Ceres_options ceres_options = partition_options_.ceres_options_;
+    ceres_options.bVerbose_ = partition_options_.bVerbose_;
+    Bundle_Adjustment_Ceres bundle_adjustment_obj(ceres_options);
+    return bundle_adjustment_obj.Adjust(sfm_data, options);
+  }
+
+  system::Timer timer;
+
+  //--
+  // Cluster the poses and classify the landmarks
+  //--
+  const std::vector<std::set<IndexT>> submaps =
+    PartitionPoses(sfm_data, partition_options_.max_poses_per_submap_);
+
+  Hash_Map<IndexT, IndexT> submap_per_pose;
+  for (IndexT submap_id = 0; submap_id < submaps.size(); ++submap_id)
+  {
+    for (const IndexT pose_id : submaps[submap_id])
+      submap_per_pose[pose_id] = submap_id;
+  }
+
+  // List the views of each submap
+  std::vector<Views> views_per_submap(submaps.size());
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    const auto submap_it = submap_per_pose.find(view_it.second->id_pose);
+    if (submap_it != submap_per_pose.end() &&
+        sfm_data.IsPoseAndIntrinsicDefined(view_it.second.get()))
+    {
+      views_per_submap[submap_it->second].insert(view_it);
+    }
+  }
+
+  // Landmarks are interior to a single submap or separators between submaps
+  std::vector<std::vector<IndexT>> interior_landmarks(submaps.size());
+  std::set<IndexT> separator_landmarks;
+  std::set<IndexT> boundary_poses; // poses that observe at least one separator
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    std::set<IndexT> observing_submaps;
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      const View * view = sfm_data.GetViews().at(obs_it.first).get();
+      const auto submap_it = submap_per_pose.find(view->id_pose);
+      if (submap_it != submap_per_pose.end())
+        observing_submaps.insert(submap_it->second);
+    }
+    if (observing_submaps.size() == 1)
+    {
+      interior_landmarks[*observing_submaps.begin()].push_back(landmark_it.first);
+    }
+    else if (observing_submaps.size() > 1)
+    {
+      separator_landmarks.insert(landmark_it.first);
+      for (const auto & obs_it : landmark_it.second.obs)
+      {
+        const IndexT pose_id = sfm_data.GetViews().at(obs_it.first)->id_pose;
+        if (submap_per_pose.count(pose_id))
+          boundary_poses.insert(pose_id);
+      }
+    }
+  }
+
+  if (partition_options_.bVerbose_)
+  {
+    OPENMVG_LOG_INFO
+      << "\nPartitioned Bundle Adjustment:\n"
+      << " #poses: " << sfm_data.GetPoses().size() << "\n"
+      << " #submaps: " << submaps.size() << "\n"
+      << " #boundary poses: " << boundary_poses.size() << "\n"
+      << " #landmarks: " << sfm_data.GetLandmarks().size() << "\n"
+      << " #separator landmarks: " << separator_landmarks.size();
+  }
+
+  // Sub-problems are solved on a single thread since the parallelism is
+  // exploited at the submap level.
+  Bundle_Adjustment_Ceres::BA_Ceres_options local_ceres_options = partition_options_.ceres_options_;
+  local_ceres_options.bVerbose_ = false;
+  local_ceres_options.nb_threads_ = 1;
+
+  Bundle_Adjustment_Ceres::BA_Ceres_options global_ceres_options = partition_options_.ceres_options_;
+  global_ceres_options.bVerbose_ = false;
+
+  for (unsigned int iteration = 0;
+       iteration < partition_options_.nb_global_local_iterations_; ++iteration)
+  {
+    //--
+    // Local stage: refine every submap independently
+    //--
+    // Intrinsics are shared between the submaps, so they are held constant
+    Optimize_Options local_options(options);
+    local_options.intrinsics_opt = cameras::Intrinsic_Parameter_Type::NONE;
+
+    std::atomic<bool> b_local_stage_ok(true);
+    const double local_stage_start = timer.elapsedMs();
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(partition_options_.ceres_options_.nb_threads_)
+#endif
+    for (int submap_id = 0; submap_id < static_cast<int>(submaps.size()); ++submap_id)
+    {
+      const Views & submap_views = views_per_submap[submap_id];
+      SfM_Data submap_data;
+      submap_data.views = submap_views;
+      for (const IndexT pose_id : submaps[submap_id])
+        submap_data.poses[pose_id] = sfm_data.poses.at(pose_id);
+      for (const auto & view_it : submap_views)
+      {
+        const IndexT intrinsic_id = view_it.second->id_intrinsic;
+        submap_data.intrinsics[intrinsic_id] = sfm_data.intrinsics.at(intrinsic_id);
+      }
+
+      Optimize_Options submap_options(local_options);
+      for (const IndexT landmark_id : interior_landmarks[submap_id])
+      {
+        submap_data.structure[landmark_id] =
+          RestrictObservations(sfm_data.structure.at(landmark_id), submap_views);
+      }
+      for (const IndexT landmark_id : separator_landmarks)
+      {
+        Landmark landmark = RestrictObservations(sfm_data.structure.at(landmark_id), submap_views);
+        if (!landmark.obs.empty())
+        {
+          submap_data.structure[landmark_id] = std::move(landmark);
+          submap_options.constant_landmarks.insert(landmark_id);
+        }
+      }
+
+      Bundle_Adjustment_Ceres bundle_adjustment_obj(local_ceres_options);
+      if (!bundle_adjustment_obj.Adjust(submap_data, submap_options))
+      {
+        b_local_stage_ok = false;
+        continue;
+      }
+
+      // Poses and interior landmarks are owned by this submap only:
+      //  they can be updated without synchronization.
+      for (const auto & pose_it : submap_data.poses)
+        sfm_data.poses.at(pose_it.first) = pose_it.second;
+      for (const IndexT landmark_id : interior_landmarks[submap_id])
+        sfm_data.structure.at(landmark_id).X = submap_data.structure.at(landmark_id).X;
+    }
+    if (!b_local_stage_ok)
+    {
+      OPENMVG_LOG_ERROR << "Partitioned Bundle Adjustment: a submap refinement failed.";
+      return false;
+    }
+    const double local_stage_time = timer.elapsedMs() - local_stage_start;
+
+    //--
+    // Global stage: refine the separators and the boundary poses
+    //--
+    const double global_stage_start = timer.elapsedMs();
+    if (!separator_landmarks.empty())
+    {
+      SfM_Data separator_data;
+      for (const IndexT pose_id : boundary_poses)
+        separator_data.poses[pose_id] = sfm_data.poses.at(pose_id);
+      for (const auto & view_it : sfm_data.GetViews())
+      {
+        if (boundary_poses.count(view_it.second->id_pose) &&
+            sfm_data.IsPoseAndIntrinsicDefined(view_it.second.get()))
+        {
+          separator_data.views.insert(view_it);
+          const IndexT intrinsic_id = view_it.second->id_intrinsic;
+          // Intrinsics are shared with the input scene: they are updated in place
+          separator_data.intrinsics[intrinsic_id] = sfm_data.intrinsics.at(intrinsic_id);
+        }
+      }
+
+      Optimize_Options global_options(options);
+      for (const IndexT landmark_id : separator_landmarks)
+      {
+        separator_data.structure[landmark_id] =
+          RestrictObservations(sfm_data.structure.at(landmark_id), separator_data.views);
+      }
+      // The interior landmarks seen by the boundary poses anchor them to their submap
+      for (const auto & interior_ids : interior_landmarks)
+      {
+        for (const IndexT landmark_id : interior_ids)
+        {
+          Landmark landmark = RestrictObservations(sfm_data.structure.at(landmark_id), separator_data.views);
+          if (!landmark.obs.empty())
+          {
+            separator_data.structure[landmark_id] = std::move(landmark);
+            global_options.constant_landmarks.insert(landmark_id);
+          }
+        }
+      }
+
+      Bundle_Adjustment_Ceres bundle_adjustment_obj(global_ceres_options);
+      if (!bundle_adjustment_obj.Adjust(separator_data, global_options))
+      {
+        OPENMVG_LOG_ERROR << "Partitioned Bundle Adjustment: the separator refinement failed.";
+        return false;
+      }
+
+      for (const auto & pose_it : separator_data.poses)
+        sfm_data.poses.at(pose_it.first) = pose_it.second;
+      for (const IndexT landmark_id : separator_landmarks)
+        sfm_data.structure.at(landmark_id).X = separator_data.structure.at(landmark_id).X;
+    }
+    const double global_stage_time = timer.elapsedMs() - global_stage_start;
+
+    if (partition_options_.bVerbose_)
+    {
+      OPENMVG_LOG_INFO
+        << "Global-local iteration " << iteration << ":"
+        << " local stage (ms): " << local_stage_time
+        << ", global stage (ms): " << global_stage_time;
+    }
+  }
+
+  if (partition_options_.bVerbose_)
+  {
+    OPENMVG_LOG_INFO << "Partitioned Bundle Adjustment took (ms): " << timer.elapsedMs();
+  }
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
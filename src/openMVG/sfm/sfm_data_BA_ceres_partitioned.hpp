@@ -0,0 +1,102 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_BA_CERES_PARTITIONED_HPP
+#define OPENMVG_SFM_SFM_DATA_BA_CERES_PARTITIONED_HPP
+
+#include "openMVG/sfm/sfm_data_BA.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/types.hpp"
+
+#include <set>
+#include <vector>
+
+namespace openMVG { namespace sfm { struct SfM_Data; } }
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* @brief Cluster the scene poses into spatially compact submaps.
+* The camera centers are recursively split at the median of their axis of
+* largest extent until every submap contains at most max_poses_per_submap poses.
+* @param sfm_data The scene to partition
+* @param max_poses_per_submap Maximal number of poses per submap
+* @return The list of submaps (a set of pose ids per submap)
+*/
+std::vector<std::set<IndexT>> PartitionPoses
+(
+  const SfM_Data & sfm_data,
+  const unsigned int max_poses_per_submap
+);
+
+/**
+* @brief Hierarchical (global-local) bundle adjustment for large scenes.
+*
+* The pose graph is clustered into submaps (see PartitionPoses).
+* A landmark observed by a single submap is an interior landmark,
+* a landmark observed by several submaps is a separator landmark.
+* Each global-local round runs:
+*  - a local stage: the submaps (poses + interior landmarks) are refined in
+*    parallel, the separator landmarks and the intrinsics being held constant,
+*  - a global stage: the separator landmarks, the boundary poses that observe
+*    them and the intrinsics are refined jointly, the interior landmarks being
+*    held constant.
+* Since the landmarks are eliminated by the Schur complement in every
+* sub-problem, the reduced camera system is bounded by the submap size
+* (local stage) or by the number of boundary poses (global stage) instead of
+* the number of poses of the whole scene.
+*/
+class Bundle_Adjustment_Ceres_Partitioned : public Bundle_Adjustment
+{
+  public:
+  struct BA_Partition_options
+  {
+    bool bVerbose_;
+    unsigned int max_poses_per_submap_;
+    unsigned int nb_global_local_iterations_;
+    // Solver configuration used for the sub-problems
+    Bundle_Adjustment_Ceres::BA_Ceres_options ceres_options_;
+
+    BA_Partition_options
+    (
+      const bool bVerbose = true,
+      const unsigned int max_poses_per_submap = 100,
+      const unsigned int nb_global_local_iterations = 2
+    );
+  };
+  private:
+    BA_Partition_options partition_options_;
+
+  public:
+  explicit Bundle_Adjustment_Ceres_Partitioned
+  (
+    const BA_Partition_options & options = BA_Partition_options()
+  );
+
+  BA_Partition_options & partition_options();
+
+  /**
+  * @brief Refine the scene with the global-local scheme.
+  * Falls back to the monolithic Bundle_Adjustment_Ceres if the scene fits in
+  * a single submap or if control points or motion priors are used (since they
+  * constrain the whole scene at once).
+  */
+  bool Adjust
+  (
+    // the SfM scene to refine
+    sfm::SfM_Data & sfm_data,
+    // tell which parameter needs to be adjusted
+    const Optimize_Options & options
+  ) override;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_BA_CERES_PARTITIONED_HPP
@@ -0,0 +1,143 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a SfM_Data scene from a synthetic dataset (a ring of cameras,
+//   noisy 2D observations & perturbed rotations).
+// - Check that the pose clustering covers all the poses with bounded submaps.
+// - Check that the partitioned BA converges like the global BA on a scene
+//   where each point is seen only by nearby cameras (so the scene has both
+//   interior and separator landmarks).
+// (see openMVG_sample_sfm_bundle_adjustment_partitioned for a scaling benchmark)
+//-----------------
+
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_partitioned.hpp"
+#include "openMVG/sfm/sfm_data_BA_test.hpp"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+TEST(BUNDLE_ADJUSTMENT_PARTITIONED, PartitionPoses_Ring) {
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(64, 8, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  const unsigned int max_poses_per_submap = 10;
+  const std::vector<std::set<IndexT>> submaps = PartitionPoses(sfm_data, max_poses_per_submap);
+
+  std::set<IndexT> covered_poses;
+  size_t pose_count = 0;
+  for (const auto & submap : submaps)
+  {
+    EXPECT_TRUE(!submap.empty());
+    EXPECT_TRUE(submap.size() <= max_poses_per_submap);
+    covered_poses.insert(submap.cbegin(), submap.cend());
+    pose_count += submap.size();
+  }
+  // Each pose belongs to exactly one submap
+  EXPECT_EQ(sfm_data.GetPoses().size(), pose_count);
+  EXPECT_EQ(sfm_data.GetPoses().size(), covered_poses.size());
+
+  // A single submap is returned when the scene fits in one submap
+  EXPECT_EQ(1, PartitionPoses(sfm_data, 64).size());
+}
+
+// Keep only the observations of the cameras near the "home" camera of each
+// landmark (landmark id modulo the number of views): a point is seen by
+// 2 * half_window + 1 consecutive cameras of the ring.
+void KeepNearbyObservations(SfM_Data & sfm_data, const int half_window)
+{
+  const int nviews = static_cast<int>(sfm_data.GetViews().size());
+  for (auto & landmark_it : sfm_data.structure)
+  {
+    const int home_view = static_cast<int>(landmark_it.first % nviews);
+    Observations & obs = landmark_it.second.obs;
+    for (auto obs_it = obs.begin(); obs_it != obs.end();)
+    {
+      const int delta = std::abs(static_cast<int>(obs_it->first) - home_view);
+      if (std::min(delta, nviews - delta) > half_window)
+        obs_it = obs.erase(obs_it);
+      else
+        ++obs_it;
+    }
+  }
+}
+
+TEST(BUNDLE_ADJUSTMENT_PARTITIONED, EffectiveMinimization_Ring) {
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(24, 192, config);
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  KeepNearbyObservations(sfm_data, 2);
+  const double dResidual_before = RMSE(sfm_data);
+
+  // The scene has interior landmarks (seen by a single submap) and separator
+  // landmarks (seen by several submaps)
+  const unsigned int max_poses_per_submap = 9;
+  const std::vector<std::set<IndexT>> submaps = PartitionPoses(sfm_data, max_poses_per_submap);
+  EXPECT_TRUE(submaps.size() > 1);
+  std::map<IndexT, size_t> submap_of_pose;
+  for (size_t i = 0; i < submaps.size(); ++i)
+    for (const IndexT pose_id : submaps[i])
+      submap_of_pose[pose_id] = i;
+  size_t nb_interior_landmarks = 0;
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    std::set<size_t> landmark_submaps;
+    for (const auto & obs_it : landmark_it.second.obs)
+      landmark_submaps.insert(submap_of_pose.at(obs_it.first));
+    if (landmark_submaps.size() == 1)
+      ++nb_interior_landmarks;
+  }
+  std::cout << "#landmarks: " << sfm_data.GetLandmarks().size()
+    << " #interior landmarks: " << nb_interior_landmarks << std::endl;
+  EXPECT_TRUE(nb_interior_landmarks > 0);
+  EXPECT_TRUE(nb_interior_landmarks < sfm_data.GetLandmarks().size());
+
+  const Optimize_Options options(
+    Intrinsic_Parameter_Type::NONE,
+    Extrinsic_Parameter_Type::ADJUST_ALL,
+    Structure_Parameter_Type::ADJUST_ALL);
+
+  SfM_Data global_data = sfm_data;
+  Bundle_Adjustment_Ceres global_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+  EXPECT_TRUE( global_ba.Adjust(global_data, options) );
+
+  Bundle_Adjustment_Ceres_Partitioned::BA_Partition_options partition_options
+    (false, max_poses_per_submap, 4);
+  Bundle_Adjustment_Ceres_Partitioned ba_object(partition_options);
+  EXPECT_TRUE( ba_object.Adjust(sfm_data, options) );
+
+  const double dResidual_after = RMSE(sfm_data);
+  const double dResidual_global = RMSE(global_data);
+  std::cout << "RMSE before: " << dResidual_before
+    << " partitioned: " << dResidual_after
+    << " global: " << dResidual_global << std::endl;
+  EXPECT_TRUE( dResidual_before > dResidual_after );
+  EXPECT_TRUE( dResidual_after < 1.0 );
+  EXPECT_NEAR( dResidual_global, dResidual_after, 1e-2 );
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,588 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_data_BA_ceres_session.hpp"
+
+#include "ceres/local_parameterization.h"
+#include "ceres/loss_function.h"
+#include "ceres/ordered_groups.h"
+#include "ceres/problem.h"
+#include "ceres/solver.h"
+#include "openMVG/cameras/Camera_Common.hpp"
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/system/logger.hpp"
+#include "openMVG/types.hpp"
+
+#include <ceres/rotation.h>
+#include <ceres/types.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+
+// Elimination groups of the Schur complement based solvers
+static const int kLandmarkGroup = 0;
+static const int kCameraGroup = 1;
+
+struct Bundle_Adjustment_Ceres_Session::Problem_Cache
+{
+  // Parameter blocks (the blocks are owned by the cache, their address is stable)
+  struct Pose_Block
+  {
+    std::array<double, 6> params; // angleAxis + translation
+    unsigned int stamp;
+  };
+  struct Intrinsic_Block
+  {
+    std::vector<double> params;
+    const IntrinsicBase * intrinsic; // The intrinsic object the block was built from
+    unsigned int stamp;
+  };
+  // Residual block of a landmark observation
+  struct Residual
+  {
+    ceres::ResidualBlockId id;
+    IndexT id_view;
+    // The cost functors keep a pointer to the observation:
+    //  it is owned by the cache since the scene observations can be reallocated.
+    std::unique_ptr<Vec2> x;
+    IndexT id_pose;
+    IndexT id_intrinsic;
+    unsigned int stamp;
+  };
+  struct Landmark_Block
+  {
+    std::array<double, 3> X;
+    unsigned int stamp;
+    std::vector<Residual> residuals; // (a track has a few observations)
+  };
+
+  // Structural options the problem has been built with
+  const Extrinsic_Parameter_Type extrinsics_opt;
+  const Intrinsic_Parameter_Type intrinsics_opt;
+  const bool b_analytic_derivatives;
+
+  // Shared by all the residual blocks (must outlive the problem)
+  std::unique_ptr<ceres::LossFunction> loss_function;
+  ceres::Problem problem;
+  ceres::ParameterBlockOrdering ordering;
+
+  Hash_Map<IndexT, Pose_Block> poses;
+  Hash_Map<IndexT, Intrinsic_Block> intrinsics;
+  Hash_Map<IndexT, Landmark_Block> landmarks;
+  size_t nb_residuals = 0;
+
+  // Synchronization counter (used to detect the removed scene elements)
+  unsigned int stamp = 0;
+
+  static ceres::Problem::Options ProblemOptions()
+  {
+    ceres::Problem::Options problem_options;
+    problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+    // Residual blocks are removed at every outlier rejection step
+    problem_options.enable_fast_removal = true;
+    return problem_options;
+  }
+
+  Problem_Cache
+  (
+    const Optimize_Options & options,
+    const Bundle_Adjustment_Ceres::BA_Ceres_options & ceres_options
+  ):
+    extrinsics_opt(options.extrinsics_opt),
+    intrinsics_opt(options.intrinsics_opt),
+    b_analytic_derivatives(ceres_options.bUse_analytic_derivatives_),
+    // Set a LossFunction to be less penalized by false measurements
+    loss_function(ceres_options.bUse_loss_function_ ? new ceres::HuberLoss(Square(4.0)) : nullptr),
+    problem(ProblemOptions())
+  {
+  }
+
+  bool IsCompatible
+  (
+    const Optimize_Options & options,
+    const Bundle_Adjustment_Ceres::BA_Ceres_options & ceres_options
+  ) const
+  {
+    return extrinsics_opt == options.extrinsics_opt &&
+      intrinsics_opt == options.intrinsics_opt &&
+      b_analytic_derivatives == ceres_options.bUse_analytic_derivatives_ &&
+      (loss_function != nullptr) == ceres_options.bUse_loss_function_;
+  }
+};
+
+Bundle_Adjustment_Ceres_Session::Bundle_Adjustment_Ceres_Session
+(
+  const Bundle_Adjustment_Ceres::BA_Ceres_options & options
+)
+: ceres_options_(options)
+{}
+
+Bundle_Adjustment_Ceres_Session::~Bundle_Adjustment_Ceres_Session() = default;
+
+Bundle_Adjustment_Ceres::BA_Ceres_options &
+Bundle_Adjustment_Ceres_Session::ceres_options()
+{
+  return ceres_options_;
+}
+
+const Bundle_Adjustment_Ceres_Session::Session_Statistics &
+Bundle_Adjustment_Ceres_Session::statistics() const
+{
+  return statistics_;
+}
+
+void Bundle_Adjustment_Ceres_Session::Reset()
+{
+  cache_.reset();
+}
+
+bool Bundle_Adjustment_Ceres_Session::Adjust
+(
+  SfM_Data & sfm_data,
+  const Optimize_Options & options
+)
+{
+  statistics_ = Session_Statistics();
+
+  // Control points and motion priors are handled by the one-shot adjustment
+  if (options.control_point_opt.bUse_control_points || options.use_motion_priors_opt)
+  {
+    Bundle_Adjustment_Ceres bundle_adjustment_obj(ceres_options_);
+    return bundle_adjustment_obj.Adjust(sfm_data, options);
+  }
+
+  if (!cache_ || !cache_->IsCompatible(options, ceres_options_))
+  {
+    cache_.reset(new Problem_Cache(options, ceres_options_));
+  }
+  Problem_Cache & cache = *cache_;
+  ceres::Problem & problem = cache.problem;
+  const unsigned int stamp = ++cache.stamp;
+
+  //----------
+  // Synchronize the camera parameters
+  // - poses [R|t]
+  // - intrinsics
+  //----------
+  for (const auto & pose_it : sfm_data.poses)
+  {
+    const IndexT indexPose = pose_it.first;
+    auto cached_pose_it = cache.poses.find(indexPose);
+    const bool b_new_pose = (cached_pose_it == cache.poses.end());
+    if (b_new_pose)
+      cached_pose_it = cache.poses.insert({indexPose, Problem_Cache::Pose_Block()}).first;
+
+    Problem_Cache::Pose_Block & pose_block = cached_pose_it->second;
+    pose_block.stamp = stamp;
+    const Mat3 R = pose_it.second.rotation();
+    const Vec3 t = pose_it.second.translation();
+    ceres::RotationMatrixToAngleAxis((const double*)R.data(), &pose_block.params[0]);
+    pose_block.params[3] = t(0);
+    pose_block.params[4] = t(1);
+    pose_block.params[5] = t(2);
+
+    double * parameter_block = &pose_block.params[0];
+    if (b_new_pose)
+    {
+      problem.AddParameterBlock(parameter_block, 6);
+      cache.ordering.AddElementToGroup(parameter_block, kCameraGroup);
+      ++statistics_.added_parameter_blocks;
+
+      // Subset parametrization
+      std::vector<int> vec_constant_extrinsic;
+      // If we adjust only the translation, we must set ROTATION as constant
+      if (options.extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_TRANSLATION)
+      {
+        // Subset rotation parametrization
+        vec_constant_extrinsic.insert(vec_constant_extrinsic.end(), {0,1,2});
+      }
+      // If we adjust only the rotation, we must set TRANSLATION as constant
+      if (options.extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_ROTATION)
+      {
+        // Subset translation parametrization
+        vec_constant_extrinsic.insert(vec_constant_extrinsic.end(), {3,4,5});
+      }
+      if (!vec_constant_extrinsic.empty())
+      {
+        ceres::SubsetParameterization *subset_parameterization =
+          new ceres::SubsetParameterization(6, vec_constant_extrinsic);
+        problem.SetParameterization(parameter_block, subset_parameterization);
+      }
+    }
+    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE ||
+        options.constant_poses.count(indexPose))
+      problem.SetParameterBlockConstant(parameter_block);
+    else
+      problem.SetParameterBlockVariable(parameter_block);
+  }
+
+  for (const auto & intrinsic_it : sfm_data.intrinsics)
+  {
+    const IndexT indexCam = intrinsic_it.first;
+    if (!isValid(intrinsic_it.second->getType()))
+    {
+      OPENMVG_LOG_ERROR << "Unsupported camera type.";
+      continue;
+    }
+    const std::vector<double> params = intrinsic_it.second->getParams();
+
+    auto cached_intrinsic_it = cache.intrinsics.find(indexCam);
+    if (cached_intrinsic_it != cache.intrinsics.end() &&
+        (cached_intrinsic_it->second.intrinsic != intrinsic_it.second.get() ||
+         cached_intrinsic_it->second.params.size() != params.size()))
+    {
+      // The camera model has been replaced: its residuals must be rebuilt
+      for (auto & landmark_it : cache.landmarks)
+      {
+        std::vector<Problem_Cache::Residual> & residuals = landmark_it.second.residuals;
+        for (auto residual_it = residuals.begin(); residual_it != residuals.end();)
+        {
+          if (residual_it->id_intrinsic == indexCam)
+          {
+            problem.RemoveResidualBlock(residual_it->id);
+            residual_it = residuals.erase(residual_it);
+            --cache.nb_residuals;
+            ++statistics_.removed_residuals;
+          }
+          else
+            ++residual_it;
+        }
+      }
+      if (!cached_intrinsic_it->second.params.empty())
+      {
+        problem.RemoveParameterBlock(&cached_intrinsic_it->second.params[0]);
+        cache.ordering.Remove(&cached_intrinsic_it->second.params[0]);
+        ++statistics_.removed_parameter_blocks;
+      }
+      cache.intrinsics.erase(cached_intrinsic_it);
+      cached_intrinsic_it = cache.intrinsics.end();
+    }
+
+    const bool b_new_intrinsic = (cached_intrinsic_it == cache.intrinsics.end());
+    if (b_new_intrinsic)
+      cached_intrinsic_it = cache.intrinsics.insert({indexCam, Problem_Cache::Intrinsic_Block()}).first;
+
+    Problem_Cache::Intrinsic_Block & intrinsic_block = cached_intrinsic_it->second;
+    intrinsic_block.stamp = stamp;
+    intrinsic_block.intrinsic = intrinsic_it.second.get();
+    // Copy the values (the block address must not change)
+    intrinsic_block.params.resize(params.size());
+    std::copy(params.cbegin(), params.cend(), intrinsic_block.params.begin());
+    if (intrinsic_block.params.empty())
+      continue;
+
+    double * parameter_block = &intrinsic_block.params[0];
+    if (b_new_intrinsic)
+    {
+      problem.AddParameterBlock(parameter_block, intrinsic_block.params.size());
+      cache.ordering.AddElementToGroup(parameter_block, kCameraGroup);
+      ++statistics_.added_parameter_blocks;
+      if (options.intrinsics_opt != Intrinsic_Parameter_Type::NONE)
+      {
+        const std::vector<int> vec_constant_intrinsic =
+          intrinsic_it.second->subsetParameterization(options.intrinsics_opt);
+        if (!vec_constant_intrinsic.empty())
+        {
+          ceres::SubsetParameterization *subset_parameterization =
+            new ceres::SubsetParameterization(
+              intrinsic_block.params.size(), vec_constant_intrinsic);
+          problem.SetParameterization(parameter_block, subset_parameterization);
+        }
+      }
+    }
+    if (options.intrinsics_opt == Intrinsic_Parameter_Type::NONE)
+      problem.SetParameterBlockConstant(parameter_block);
+    else
+      problem.SetParameterBlockVariable(parameter_block);
+  }
+
+  //----------
+  // Synchronize the structure and the observations
+  //----------
+  for (const auto & structure_landmark_it : sfm_data.structure)
+  {
+    const IndexT indexLandmark = structure_landmark_it.first;
+    auto cached_landmark_it = cache.landmarks.find(indexLandmark);
+    const bool b_new_landmark = (cached_landmark_it == cache.landmarks.end());
+    if (b_new_landmark)
+      cached_landmark_it = cache.landmarks.insert({indexLandmark, Problem_Cache::Landmark_Block()}).first;
+
+    Problem_Cache::Landmark_Block & landmark_block = cached_landmark_it->second;
+    landmark_block.stamp = stamp;
+    const Vec3 & X = structure_landmark_it.second.X;
+    landmark_block.X = {X(0), X(1), X(2)};
+
+    double * parameter_block = &landmark_block.X[0];
+    if (b_new_landmark)
+    {
+      problem.AddParameterBlock(parameter_block, 3);
+      cache.ordering.AddElementToGroup(parameter_block, kLandmarkGroup);
+      ++statistics_.added_parameter_blocks;
+    }
+
+    for (const auto & obs_it : structure_landmark_it.second.obs)
+    {
+      const View * view = sfm_data.views.at(obs_it.first).get();
+      if (!sfm_data.IsPoseAndIntrinsicDefined(view) ||
+          !cache.intrinsics.count(view->id_intrinsic))
+        continue;
+
+      const Vec2 & x = obs_it.second.x;
+      auto residual_it = std::find_if(landmark_block.residuals.begin(), landmark_block.residuals.end(),
+        [&obs_it](const Problem_Cache::Residual & residual) { return residual.id_view == obs_it.first; });
+      if (residual_it != landmark_block.residuals.end())
+      {
+        if (*residual_it->x == x &&
+            residual_it->id_pose == view->id_pose && residual_it->id_intrinsic == view->id_intrinsic)
+        {
+          residual_it->stamp = stamp;
+          ++statistics_.reused_residuals;
+          continue;
+        }
+        // The observation has been modified
+        problem.RemoveResidualBlock(residual_it->id);
+        landmark_block.residuals.erase(residual_it);
+        --cache.nb_residuals;
+        ++statistics_.removed_residuals;
+      }
+
+      // Build the residual block corresponding to the track observation
+      Problem_Cache::Intrinsic_Block & intrinsic_block = cache.intrinsics.at(view->id_intrinsic);
+      Problem_Cache::Residual residual;
+      residual.x.reset(new Vec2(x));
+      ceres::CostFunction* cost_function =
+        IntrinsicsToCostFunction(sfm_data.intrinsics.at(view->id_intrinsic).get(), *residual.x,
+          0.0, cache.b_analytic_derivatives);
+      if (!cost_function)
+      {
+        OPENMVG_LOG_ERROR << "Cannot create a CostFunction for this camera model.";
+        return false;
+      }
+
+      if (!intrinsic_block.params.empty())
+      {
+        residual.id = problem.AddResidualBlock(cost_function,
+          cache.loss_function.get(),
+          &intrinsic_block.params[0],
+          &cache.poses.at(view->id_pose).params[0],
+          parameter_block);
+      }
+      else
+      {
+        residual.id = problem.AddResidualBlock(cost_function,
+          cache.loss_function.get(),
+          &cache.poses.at(view->id_pose).params[0],
+          parameter_block);
+      }
+      residual.id_view = obs_it.first;
+      residual.id_pose = view->id_pose;
+      residual.id_intrinsic = view->id_intrinsic;
+      residual.stamp = stamp;
+      landmark_block.residuals.push_back(std::move(residual));
+      ++cache.nb_residuals;
+      ++statistics_.added_residuals;
+    }
+
+    // Remove the residual blocks of the removed observations
+    for (auto residual_it = landmark_block.residuals.begin(); residual_it != landmark_block.residuals.end();)
+    {
+      if (residual_it->stamp != stamp)
+      {
+        problem.RemoveResidualBlock(residual_it->id);
+        residual_it = landmark_block.residuals.erase(residual_it);
+        --cache.nb_residuals;
+        ++statistics_.removed_residuals;
+      }
+      else
+        ++residual_it;
+    }
+
+    if (options.structure_opt == Structure_Parameter_Type::NONE ||
+        options.constant_landmarks.count(indexLandmark))
+      problem.SetParameterBlockConstant(parameter_block);
+    else
+      problem.SetParameterBlockVariable(parameter_block);
+  }
+
+  //----------
+  // Remove the blocks of the scene elements that no longer exist
+  // (the landmarks first, so the camera blocks are no longer used)
+  //----------
+  for (auto landmark_it = cache.landmarks.begin(); landmark_it != cache.landmarks.end();)
+  {
+    if (landmark_it->second.stamp != stamp)
+    {
+      // Its residual blocks are removed as well
+      cache.nb_residuals -= landmark_it->second.residuals.size();
+      statistics_.removed_residuals += landmark_it->second.residuals.size();
+      problem.RemoveParameterBlock(&landmark_it->second.X[0]);
+      cache.ordering.Remove(&landmark_it->second.X[0]);
+      landmark_it = cache.landmarks.erase(landmark_it);
+      ++statistics_.removed_parameter_blocks;
+    }
+    else
+      ++landmark_it;
+  }
+  for (auto pose_it = cache.poses.begin(); pose_it != cache.poses.end();)
+  {
+    if (pose_it->second.stamp != stamp)
+    {
+      problem.RemoveParameterBlock(&pose_it->second.params[0]);
+      cache.ordering.Remove(&pose_it->second.params[0]);
+      pose_it = cache.poses.erase(pose_it);
+      ++statistics_.removed_parameter_blocks;
+    }
+    else
+      ++pose_it;
+  }
+  for (auto intrinsic_it = cache.intrinsics.begin(); intrinsic_it != cache.intrinsics.end();)
+  {
+    if (intrinsic_it->second.stamp != stamp)
+    {
+      if (!intrinsic_it->second.params.empty())
+      {
+        problem.RemoveParameterBlock(&intrinsic_it->second.params[0]);
+        cache.ordering.Remove(&intrinsic_it->second.params[0]);
+        ++statistics_.removed_parameter_blocks;
+      }
+      intrinsic_it = cache.intrinsics.erase(intrinsic_it);
+    }
+    else
+      ++intrinsic_it;
+  }
+
+  if (cache.nb_residuals == 0)
+  {
+    OPENMVG_LOG_ERROR << "There is no observation to refine.";
+    return false;
+  }
+
+  // Configure a BA engine and run it
+  ceres::Solver::Options ceres_config_options;
+  ceres_config_options.max_num_iterations = ceres_options_.max_num_iterations_;
+  ceres_config_options.preconditioner_type =
+    static_cast<ceres::PreconditionerType>(ceres_options_.preconditioner_type_);
+  ceres_config_options.linear_solver_type =
+    static_cast<ceres::LinearSolverType>(ceres_options_.linear_solver_type_);
+  ceres_config_options.sparse_linear_algebra_library_type =
+    static_cast<ceres::SparseLinearAlgebraLibraryType>(ceres_options_.sparse_linear_algebra_library_type_);
+  ceres_config_options.minimizer_progress_to_stdout = ceres_options_.bVerbose_;
+  ceres_config_options.logging_type = ceres::SILENT;
+  ceres_config_options.num_threads = ceres_options_.nb_threads_;
+#if CERES_VERSION_MAJOR < 2
+  ceres_config_options.num_linear_solver_threads = ceres_options_.nb_threads_;
+#endif
+  ceres_config_options.parameter_tolerance = ceres_options_.parameter_tolerance_;
+  // Use the maintained elimination ordering (landmarks, then cameras) instead
+  // of letting Ceres detect the bundle structure at every call.
+  // Ceres edits the given ordering (it removes the constant blocks): use a copy.
+  if (cache.ordering.GroupSize(kLandmarkGroup) > 0 &&
+      cache.ordering.NumElements() == problem.NumParameterBlocks())
+  {
+    ceres_config_options.linear_solver_ordering =
+      std::make_shared<ceres::ParameterBlockOrdering>(cache.ordering);
+  }
+
+  // Solve BA
+  ceres::Solver::Summary summary;
+  ceres::Solve(ceres_config_options, &problem, &summary);
+  if (ceres_options_.bCeres_summary_)
+    OPENMVG_LOG_INFO << summary.FullReport();
+
+  // If no error, get back refined parameters
+  if (!summary.IsSolutionUsable())
+  {
+    OPENMVG_LOG_ERROR << "IsSolutionUsable is false. Bundle Adjustment failed.";
+    return false;
+  }
+
+  if (ceres_options_.bVerbose_)
+  {
+    // Display statistics about the minimization
+    OPENMVG_LOG_INFO
+      << "\nBundle Adjustment statistics (approximated RMSE):\n"
+      << " #views: " << sfm_data.views.size() << "\n"
+      << " #poses: " << sfm_data.poses.size() << "\n"
+      << " #intrinsics: " << sfm_data.intrinsics.size() << "\n"
+      << " #tracks: " << sfm_data.structure.size() << "\n"
+      << " #residuals: " << summary.num_residuals << "\n"
+      << " #residuals added/removed/reused: " << statistics_.added_residuals
+      << "/" << statistics_.removed_residuals << "/" << statistics_.reused_residuals << "\n"
+      << " Initial RMSE: " << std::sqrt( summary.initial_cost / summary.num_residuals) << "\n"
+      << " Final RMSE: " << std::sqrt( summary.final_cost / summary.num_residuals) << "\n"
+      << " Time (s): " << summary.total_time_in_seconds;
+  }
+
+  // Update camera poses with refined data
+  if (options.extrinsics_opt != Extrinsic_Parameter_Type::NONE)
+  {
+    for (auto & pose_it : sfm_data.poses)
+    {
+      const IndexT indexPose = pose_it.first;
+      if (options.constant_poses.count(indexPose))
+        continue;
+
+      const std::array<double, 6> & params = cache.poses.at(indexPose).params;
+      Mat3 R_refined;
+      ceres::AngleAxisToRotationMatrix(&params[0], R_refined.data());
+      const Vec3 t_refined(params[3], params[4], params[5]);
+      // Update the pose
+      Pose3 & pose = pose_it.second;
+      if (options.extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_ROTATION)
+      {
+        // Update only rotation
+        pose.rotation() = R_refined;
+      }
+      else if (options.extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_TRANSLATION)
+      {
+        // Update only translation
+        pose.center() = -R_refined.transpose() * t_refined;
+      }
+      else
+      {
+        // Update rotation + translation
+        pose = Pose3(R_refined, -R_refined.transpose() * t_refined);
+      }
+    }
+  }
+
+  // Update camera intrinsics with refined data
+  if (options.intrinsics_opt != Intrinsic_Parameter_Type::NONE)
+  {
+    for (auto & intrinsic_it : sfm_data.intrinsics)
+    {
+      const auto cached_intrinsic_it = cache.intrinsics.find(intrinsic_it.first);
+      if (cached_intrinsic_it != cache.intrinsics.end())
+        intrinsic_it.second->updateFromParams(cached_intrinsic_it->second.params);
+    }
+  }
+
+  // Update the structure
+  if (options.structure_opt != Structure_Parameter_Type::NONE)
+  {
+    for (auto & structure_landmark_it : sfm_data.structure)
+    {
+      const std::array<double, 3> & X = cache.landmarks.at(structure_landmark_it.first).X;
+      structure_landmark_it.second.X = Vec3(X[0], X[1], X[2]);
+    }
+  }
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
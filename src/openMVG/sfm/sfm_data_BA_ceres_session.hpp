@@ -0,0 +1,89 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_BA_CERES_SESSION_HPP
+#define OPENMVG_SFM_SFM_DATA_BA_CERES_SESSION_HPP
+
+#include "openMVG/sfm/sfm_data_BA.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+
+#include <memory>
+
+namespace openMVG { namespace sfm { struct SfM_Data; } }
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* @brief Bundle adjustment that keeps its ceres::Problem alive across the
+* Adjust calls.
+*
+* Every Adjust call synchronizes the persistent problem with the scene:
+*  - the parameter blocks (poses, intrinsics, landmarks) of the new scene
+*    elements are added, the ones of the removed elements are removed,
+*  - only the residual blocks of the new (or modified) observations are
+*    created, the ones of the removed observations are removed,
+*  - the parameter values are reloaded from the scene.
+* The Schur elimination ordering (landmarks first, then cameras) is
+* maintained incrementally as well, so Ceres does not have to recompute it.
+*
+* It is meant to be used on the same evolving scene, as done by the
+* sequential SfM engines (repeated BA and outlier rejection steps).
+* The scenes that use control points or motion priors are refined with a
+* one-shot Bundle_Adjustment_Ceres (they are registered/transformed at each
+* call).
+*/
+class Bundle_Adjustment_Ceres_Session : public Bundle_Adjustment
+{
+  public:
+  /// Number of blocks processed by the last synchronization of the problem
+  struct Session_Statistics
+  {
+    size_t added_residuals = 0;
+    size_t removed_residuals = 0;
+    size_t reused_residuals = 0;
+    size_t added_parameter_blocks = 0;
+    size_t removed_parameter_blocks = 0;
+  };
+
+  explicit Bundle_Adjustment_Ceres_Session
+  (
+    const Bundle_Adjustment_Ceres::BA_Ceres_options & options =
+      Bundle_Adjustment_Ceres::BA_Ceres_options()
+  );
+
+  ~Bundle_Adjustment_Ceres_Session() override;
+
+  Bundle_Adjustment_Ceres::BA_Ceres_options & ceres_options();
+
+  /// Statistics of the last Adjust call
+  const Session_Statistics & statistics() const;
+
+  /// Release the persistent problem (the next Adjust call will rebuild it)
+  void Reset();
+
+  bool Adjust
+  (
+    // the SfM scene to refine
+    sfm::SfM_Data & sfm_data,
+    // tell which parameter needs to be adjusted
+    const Optimize_Options & options
+  ) override;
+
+  private:
+    Bundle_Adjustment_Ceres::BA_Ceres_options ceres_options_;
+    Session_Statistics statistics_;
+
+    struct Problem_Cache;
+    std::unique_ptr<Problem_Cache> cache_;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_BA_CERES_SESSION_HPP
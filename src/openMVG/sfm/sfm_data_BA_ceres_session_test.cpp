@@ -0,0 +1,177 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a SfM_Data scene from a synthetic dataset (a ring of cameras,
+//   noisy 2D observations & perturbed rotations).
+// - Check that the session BA converges like the one-shot BA.
+// - Check that the residual blocks are reused and that the removed/added
+//   scene elements are handled between two calls.
+// - Check that repeated BA & outlier rejection steps converge like the
+//   one-shot BA.
+// (see openMVG_sample_sfm_bundle_adjustment_session for a timing benchmark)
+//-----------------
+
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_session.hpp"
+#include "openMVG/sfm/sfm_data_BA_test.hpp"
+#include "openMVG/sfm/sfm_data_filters.hpp"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+size_t CountObservations(const SfM_Data & sfm_data)
+{
+  size_t count = 0;
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+    count += landmark_it.second.obs.size();
+  return count;
+}
+
+const Optimize_Options ba_refine_options(
+  Intrinsic_Parameter_Type::ADJUST_ALL,
+  Extrinsic_Parameter_Type::ADJUST_ALL,
+  Structure_Parameter_Type::ADJUST_ALL);
+
+TEST(BUNDLE_ADJUSTMENT_SESSION, EffectiveMinimization) {
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(16, 300, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  // Keep the intrinsics fixed so both solvers converge to the same minimum.
+  const Optimize_Options options(
+    Intrinsic_Parameter_Type::NONE,
+    Extrinsic_Parameter_Type::ADJUST_ALL,
+    Structure_Parameter_Type::ADJUST_ALL);
+
+  SfM_Data one_shot_data = sfm_data;
+  Bundle_Adjustment_Ceres one_shot_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+  EXPECT_TRUE( one_shot_ba.Adjust(one_shot_data, options) );
+
+  SfM_Data session_data = sfm_data;
+  Bundle_Adjustment_Ceres_Session session_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+  EXPECT_TRUE( session_ba.Adjust(session_data, options) );
+
+  std::cout << "RMSE before: " << RMSE(sfm_data)
+    << " one-shot: " << RMSE(one_shot_data)
+    << " session: " << RMSE(session_data) << std::endl;
+  EXPECT_TRUE( RMSE(session_data) < RMSE(sfm_data) );
+  EXPECT_NEAR( RMSE(one_shot_data), RMSE(session_data), 1e-3 );
+  EXPECT_EQ( CountObservations(sfm_data), session_ba.statistics().added_residuals );
+}
+
+TEST(BUNDLE_ADJUSTMENT_SESSION, IncrementalUpdate) {
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(16, 300, config);
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  Bundle_Adjustment_Ceres_Session session_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+  EXPECT_TRUE( session_ba.Adjust(sfm_data, ba_refine_options) );
+
+  // Nothing changed: every residual block is reused
+  EXPECT_TRUE( session_ba.Adjust(sfm_data, ba_refine_options) );
+  EXPECT_EQ( 0, session_ba.statistics().added_residuals );
+  EXPECT_EQ( 0, session_ba.statistics().removed_residuals );
+  EXPECT_EQ( CountObservations(sfm_data), session_ba.statistics().reused_residuals );
+
+  // Remove a landmark and some observations, add a landmark
+  size_t nb_removed_obs = sfm_data.structure.begin()->second.obs.size();
+  sfm_data.structure.erase(sfm_data.structure.begin());
+  for (auto & landmark_it : sfm_data.structure)
+  {
+    if (landmark_it.first % 10 == 0 && landmark_it.second.obs.size() > 2)
+    {
+      landmark_it.second.obs.erase(landmark_it.second.obs.begin());
+      ++nb_removed_obs;
+    }
+  }
+  // (Landmarks is an unordered map in some builds: look for the largest id)
+  const auto last_landmark_it = std::max_element(
+    sfm_data.structure.cbegin(), sfm_data.structure.cend(),
+    [](const Landmarks::value_type & a, const Landmarks::value_type & b)
+    { return a.first < b.first; });
+  const Landmark new_landmark = last_landmark_it->second;
+  const size_t nb_added_obs = new_landmark.obs.size();
+  sfm_data.structure[last_landmark_it->first + 1] = new_landmark;
+
+  EXPECT_TRUE( session_ba.Adjust(sfm_data, ba_refine_options) );
+  EXPECT_EQ( nb_added_obs, session_ba.statistics().added_residuals );
+  EXPECT_EQ( nb_removed_obs, session_ba.statistics().removed_residuals );
+  EXPECT_EQ( CountObservations(sfm_data) - nb_added_obs, session_ba.statistics().reused_residuals );
+
+  // Remove a pose (and its observations) and hold some poses constant
+  const IndexT removed_pose = 5;
+  sfm_data.poses.erase(removed_pose);
+  for (auto & landmark_it : sfm_data.structure)
+    landmark_it.second.obs.erase(removed_pose);
+  eraseUnstablePosesAndObservations(sfm_data);
+
+  Optimize_Options options = ba_refine_options;
+  options.constant_poses = {0, 1};
+  const Pose3 constant_pose = sfm_data.poses.at(0);
+  EXPECT_TRUE( session_ba.Adjust(sfm_data, options) );
+  EXPECT_EQ( 0, session_ba.statistics().added_residuals );
+  EXPECT_NEAR( 0.0, (constant_pose.center() - sfm_data.poses.at(0).center()).norm(), 1e-12 );
+  EXPECT_TRUE( RMSE(sfm_data) < 1.0 );
+
+  // The problem is rebuilt if the refined parameters change
+  options = ba_refine_options;
+  options.intrinsics_opt = Intrinsic_Parameter_Type::NONE;
+  EXPECT_TRUE( session_ba.Adjust(sfm_data, options) );
+  EXPECT_EQ( CountObservations(sfm_data), session_ba.statistics().added_residuals );
+}
+
+// Repeated BA & outlier rejection steps (as done by the sequential SfM engine)
+bool RepeatedAdjustment
+(
+  Bundle_Adjustment & ba,
+  SfM_Data & sfm_data,
+  const int nb_rejection_steps
+)
+{
+  for (int i = 0; i < nb_rejection_steps; ++i)
+  {
+    if (!ba.Adjust(sfm_data, ba_refine_options))
+      return false;
+    RemoveOutliers_PixelResidualError(sfm_data, 1.0 - 0.1 * i, 2);
+  }
+  return true;
+}
+
+TEST(BUNDLE_ADJUSTMENT_SESSION, RepeatedAdjustment) {
+
+  const int nb_rejection_steps = 3;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(12, 200, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  SfM_Data one_shot_data = sfm_data;
+  Bundle_Adjustment_Ceres one_shot_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+  EXPECT_TRUE( RepeatedAdjustment(one_shot_ba, one_shot_data, nb_rejection_steps) );
+
+  SfM_Data session_data = sfm_data;
+  Bundle_Adjustment_Ceres_Session session_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+  EXPECT_TRUE( RepeatedAdjustment(session_ba, session_data, nb_rejection_steps) );
+
+  EXPECT_NEAR( RMSE(one_shot_data), RMSE(session_data), 1e-2 );
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
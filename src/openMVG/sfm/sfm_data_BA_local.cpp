@@ -0,0 +1,149 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_data_BA_local.hpp"
+
+#include "openMVG/sfm/sfm_data.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+std::set<IndexT> CovisibilityNeighborhood
+(
+  const SfM_Data & sfm_data,
+  const std::set<IndexT> & seed_poses,
+  const unsigned int hops
+)
+{
+  std::set<IndexT> neighborhood = seed_poses;
+  if (hops == 0)
+    return neighborhood;
+
+  // Pose ids of the views that observe every landmark
+  std::vector<std::vector<IndexT>> poses_per_landmark;
+  poses_per_landmark.reserve(sfm_data.GetLandmarks().size());
+  // Landmarks (index into poses_per_landmark) observed by every pose
+  Hash_Map<IndexT, std::vector<IndexT>> landmarks_per_pose;
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    std::vector<IndexT> observing_poses;
+    observing_poses.reserve(landmark_it.second.obs.size());
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      const IndexT pose_id = sfm_data.GetViews().at(obs_it.first)->id_pose;
+      if (sfm_data.GetPoses().count(pose_id))
+      {
+        observing_poses.push_back(pose_id);
+        landmarks_per_pose[pose_id].push_back(poses_per_landmark.size());
+      }
+    }
+    poses_per_landmark.emplace_back(std::move(observing_poses));
+  }
+
+  // Breadth first traversal of the covisibility graph
+  std::set<IndexT> frontier = seed_poses;
+  for (unsigned int hop = 0; hop < hops && !frontier.empty(); ++hop)
+  {
+    std::set<IndexT> next_frontier;
+    for (const IndexT pose_id : frontier)
+    {
+      const auto landmarks_it = landmarks_per_pose.find(pose_id);
+      if (landmarks_it == landmarks_per_pose.end())
+        continue;
+      for (const IndexT landmark_index : landmarks_it->second)
+      {
+        for (const IndexT neighbor_pose_id : poses_per_landmark[landmark_index])
+        {
+          if (neighborhood.insert(neighbor_pose_id).second)
+            next_frontier.insert(neighbor_pose_id);
+        }
+      }
+    }
+    frontier = std::move(next_frontier);
+  }
+  return neighborhood;
+}
+
+bool LocalBundleAdjustment
+(
+  Bundle_Adjustment & bundle_adjustment,
+  SfM_Data & sfm_data,
+  const std::set<IndexT> & window_poses,
+  const Optimize_Options & options
+)
+{
+  // Build a local scene with:
+  // - the landmarks observed by the window poses,
+  // - all the poses observing them (the ones outside the window are held constant).
+  SfM_Data local_scene;
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    bool b_in_window = false;
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      if (window_poses.count(sfm_data.GetViews().at(obs_it.first)->id_pose))
+      {
+        b_in_window = true;
+        break;
+      }
+    }
+    if (!b_in_window)
+      continue;
+
+    Landmark & landmark = local_scene.structure[landmark_it.first];
+    landmark.X = landmark_it.second.X;
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      const auto & view = sfm_data.GetViews().at(obs_it.first);
+      if (!sfm_data.IsPoseAndIntrinsicDefined(view.get()))
+        continue;
+      landmark.obs.insert(obs_it);
+      if (local_scene.views.insert({obs_it.first, view}).second)
+      {
+        local_scene.poses[view->id_pose] = sfm_data.GetPoses().at(view->id_pose);
+        // Intrinsics are shared with the input scene (updated in place if refined)
+        local_scene.intrinsics[view->id_intrinsic] = sfm_data.GetIntrinsics().at(view->id_intrinsic);
+      }
+    }
+  }
+
+  if (local_scene.structure.empty())
+    return false;
+
+  Optimize_Options local_options(options);
+  // Motion priors register the refined scene to their coordinate system:
+  //  they can only be used on the whole scene.
+  local_options.use_motion_priors_opt = false;
+  for (const auto & pose_it : local_scene.poses)
+  {
+    if (!window_poses.count(pose_it.first))
+      local_options.constant_poses.insert(pose_it.first);
+  }
+
+  if (!bundle_adjustment.Adjust(local_scene, local_options))
+    return false;
+
+  // Update the refined parameters
+  for (const IndexT pose_id : window_poses)
+  {
+    const auto pose_it = local_scene.poses.find(pose_id);
+    if (pose_it != local_scene.poses.end())
+      sfm_data.poses.at(pose_id) = pose_it->second;
+  }
+  for (const auto & landmark_it : local_scene.structure)
+  {
+    sfm_data.structure.at(landmark_it.first).X = landmark_it.second.X;
+  }
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
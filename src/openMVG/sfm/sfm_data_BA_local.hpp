@@ -0,0 +1,99 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_BA_LOCAL_HPP
+#define OPENMVG_SFM_SFM_DATA_BA_LOCAL_HPP
+
+#include "openMVG/sfm/sfm_data_BA.hpp"
+#include "openMVG/types.hpp"
+
+#include <set>
+
+namespace openMVG { namespace sfm { struct SfM_Data; } }
+
+namespace openMVG {
+namespace sfm {
+
+/// Policy used by the sequential engines to choose between a local and a
+/// global bundle adjustment once some views have been added to the scene.
+struct Local_Bundle_Adjustment_Options
+{
+  bool bUse_local_ba_;
+  // Size of the covisibility neighborhood (in hops) refined around the new poses
+  unsigned int covisibility_hops_;
+  // A global bundle adjustment is run when the number of poses has grown by
+  // this ratio since the last global bundle adjustment
+  double global_ba_growth_ratio_;
+  // Global bundle adjustments are always used below this number of poses
+  unsigned int min_poses_for_local_ba_;
+
+  Local_Bundle_Adjustment_Options
+  (
+    const bool bUse_local_ba = false,
+    const unsigned int covisibility_hops = 1,
+    const double global_ba_growth_ratio = 0.25,
+    const unsigned int min_poses_for_local_ba = 30
+  )
+  : bUse_local_ba_(bUse_local_ba),
+    covisibility_hops_(covisibility_hops),
+    global_ba_growth_ratio_(global_ba_growth_ratio),
+    min_poses_for_local_ba_(min_poses_for_local_ba)
+  {
+  }
+
+  /// Tell if the scene reached a growth milestone (a global adjustment is required)
+  bool RequiresGlobalAdjustment
+  (
+    const size_t nb_poses,
+    const size_t nb_poses_at_last_global_ba
+  ) const
+  {
+    return !bUse_local_ba_ ||
+      nb_poses < min_poses_for_local_ba_ ||
+      nb_poses >= nb_poses_at_last_global_ba * (1.0 + global_ba_growth_ratio_);
+  }
+};
+
+/**
+* @brief List the poses that are within N covisibility hops of the seed poses.
+* Two poses are covisible if they observe at least one common landmark.
+* @param sfm_data The scene
+* @param seed_poses The poses from which the neighborhood is grown (they are part of it)
+* @param hops The size of the neighborhood
+* @return The seed poses and their neighborhood
+*/
+std::set<IndexT> CovisibilityNeighborhood
+(
+  const SfM_Data & sfm_data,
+  const std::set<IndexT> & seed_poses,
+  const unsigned int hops
+);
+
+/**
+* @brief Refine a window of poses and the landmarks they observe.
+* The other poses that observe these landmarks are held constant (they anchor
+* the window to the rest of the scene) and the remaining parameters of the
+* scene are left untouched.
+* @param bundle_adjustment The bundle adjustment engine used for the refinement
+* @param sfm_data The scene to refine
+* @param window_poses The poses to refine
+* @param options Tell which parameter needs to be adjusted
+* @return true if the refinement succeed
+*/
+bool LocalBundleAdjustment
+(
+  Bundle_Adjustment & bundle_adjustment,
+  SfM_Data & sfm_data,
+  const std::set<IndexT> & window_poses,
+  const Optimize_Options & options
+);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_BA_LOCAL_HPP
@@ -0,0 +1,122 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a SfM_Data scene from a synthetic dataset (a ring of cameras,
+//   noisy 2D observations & perturbed rotations) where each landmark is
+//   observed by three consecutive cameras.
+// - Check the covisibility neighborhood for several hop counts.
+// - Check that a local BA refines the window and leaves the other poses
+//   untouched.
+//-----------------
+
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_local.hpp"
+#include "openMVG/sfm/sfm_data_BA_test.hpp"
+
+#include "testing/testing.h"
+
+#include <iostream>
+#include <set>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Synthetic scene (see getInputScene) whose landmarks are seen by three
+// consecutive cameras only: the covisibility graph is a chain.
+SfM_Data ChainScene
+(
+  const int nb_poses,
+  const int points_per_pose
+)
+{
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nb_poses, (nb_poses - 2) * points_per_pose, config);
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  for (auto & landmark_it : sfm_data.structure)
+  {
+    const IndexT first_pose = landmark_it.first % (nb_poses - 2);
+    Observations & obs = landmark_it.second.obs;
+    for (auto obs_it = obs.begin(); obs_it != obs.end();)
+    {
+      if (obs_it->first < first_pose || obs_it->first > first_pose + 2)
+        obs_it = obs.erase(obs_it);
+      else
+        ++obs_it;
+    }
+  }
+  return sfm_data;
+}
+
+TEST(LOCAL_BUNDLE_ADJUSTMENT, CovisibilityNeighborhood_Chain) {
+
+  const SfM_Data sfm_data = ChainScene(12, 4);
+
+  EXPECT_TRUE(std::set<IndexT>({5}) == CovisibilityNeighborhood(sfm_data, {5}, 0));
+  EXPECT_TRUE(std::set<IndexT>({3, 4, 5, 6, 7}) == CovisibilityNeighborhood(sfm_data, {5}, 1));
+  EXPECT_TRUE(std::set<IndexT>({1, 2, 3, 4, 5, 6, 7, 8, 9}) == CovisibilityNeighborhood(sfm_data, {5}, 2));
+  EXPECT_TRUE(std::set<IndexT>({0, 1, 2, 3, 4, 7, 8, 9, 10, 11}) == CovisibilityNeighborhood(sfm_data, {0, 11}, 2));
+  // The whole chain is reached with enough hops
+  EXPECT_EQ(sfm_data.GetPoses().size(), CovisibilityNeighborhood(sfm_data, {0}, 100).size());
+}
+
+TEST(LOCAL_BUNDLE_ADJUSTMENT, EffectiveMinimization_Chain) {
+
+  SfM_Data sfm_data = ChainScene(12, 10);
+  const SfM_Data sfm_data_before = sfm_data;
+  const double dResidual_before = RMSE(sfm_data);
+
+  const std::set<IndexT> window_poses = CovisibilityNeighborhood(sfm_data, {10, 11}, 1);
+  Bundle_Adjustment_Ceres ba_object(Bundle_Adjustment_Ceres::BA_Ceres_options(false, false));
+  EXPECT_TRUE( LocalBundleAdjustment(ba_object, sfm_data, window_poses,
+    Optimize_Options(
+      Intrinsic_Parameter_Type::NONE,
+      Extrinsic_Parameter_Type::ADJUST_ALL,
+      Structure_Parameter_Type::ADJUST_ALL)) );
+
+  const double dResidual_after = RMSE(sfm_data);
+  std::cout << "RMSE before: " << dResidual_before
+    << " after: " << dResidual_after << std::endl;
+  EXPECT_TRUE( dResidual_before > dResidual_after );
+
+  // Only the poses of the window have been refined
+  for (const auto & pose_it : sfm_data.GetPoses())
+  {
+    const Pose3 & pose_before = sfm_data_before.GetPoses().at(pose_it.first);
+    const double pose_change = (pose_it.second.center() - pose_before.center()).norm();
+    if (window_poses.count(pose_it.first))
+    {
+      EXPECT_TRUE(pose_change > 0.0);
+    }
+    else
+    {
+      EXPECT_NEAR(0.0, pose_change, 1e-12);
+    }
+  }
+  // Only the landmarks observed by the window have been refined
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    bool b_in_window = false;
+    for (const auto & obs_it : landmark_it.second.obs)
+      b_in_window |= window_poses.count(obs_it.first) > 0;
+    if (!b_in_window)
+    {
+      EXPECT_NEAR(0.0, (landmark_it.second.X - sfm_data_before.GetLandmarks().at(landmark_it.first).X).norm(), 1e-12);
+    }
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
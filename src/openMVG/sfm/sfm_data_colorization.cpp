@@ -11,128 +11,288 @@
 
 #include "openMVG/image/image_container.hpp"
 #include "openMVG/image/image_io.hpp"
+#include "openMVG/image/image_io_strip.hpp"
 #include "openMVG/image/pixel_types.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
-#include "openMVG/stl/stl.hpp"
 #include "openMVG/system/loggerprogress.hpp"
+#include "openMVG/types.hpp"
 
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <queue>
+#include <utility>
+
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
+
 namespace openMVG {
 namespace sfm {
 
+namespace {
+
+/// An observation to sample in an image
+struct Color_Sample
+{
+  IndexT landmark; // contiguous landmark index
+  int x, y;        // pixel
+};
+
+/**
+* @brief Sample the pixels of an image
+* @param filename Image path
+* @param b_stream_rows Decode the image by rows (up to the last sampled row)
+* @param samples Pixels to sample (sorted by row)
+* @param[out] colors Color of the samples
+*/
+bool SampleImage
+(
+  const std::string & filename,
+  const bool b_stream_rows,
+  const std::vector<Color_Sample> & samples,
+  std::vector<image::RGBColor> & colors
+)
+{
+  colors.resize(samples.size());
+  if (samples.empty())
+    return true;
+
+  image::Image_Strip_Reader reader;
+  if (b_stream_rows && reader.Open(filename.c_str()))
+  {
+    const int width = reader.Width(), height = reader.Height(), depth = reader.Depth();
+    std::vector<unsigned char> row(static_cast<size_t>(width) * depth);
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+      // Decode the rows up to the sample row
+      const int y = std::min(std::max(samples[i].y, 0), height - 1);
+      while (reader.NextRow() <= y)
+      {
+        if (!reader.ReadRows(1, row.data()))
+          return false;
+      }
+      const int x = std::min(std::max(samples[i].x, 0), width - 1);
+      const unsigned char * pixel = &row[static_cast<size_t>(x) * depth];
+      colors[i] = (depth >= 3) ?
+        image::RGBColor(pixel[0], pixel[1], pixel[2]) :
+        image::RGBColor(pixel[0]);
+    }
+    return true;
+  }
+
+  image::Image<image::RGBColor> image_rgb;
+  if (!image::ReadImage(filename.c_str(), &image_rgb)) //try Gray level
+  {
+    image::Image<unsigned char> image_gray;
+    if (!image::ReadImage(filename.c_str(), &image_gray))
+      return false;
+    image::ConvertPixelType(image_gray, &image_rgb);
+  }
+  for (size_t i = 0; i < samples.size(); ++i)
+  {
+    const int y = std::min(std::max(samples[i].y, 0), image_rgb.Height() - 1);
+    const int x = std::min(std::max(samples[i].x, 0), image_rgb.Width() - 1);
+    colors[i] = image_rgb(y, x);
+  }
+  return true;
+}
+
+} // namespace
+
 /// Find the color of the SfM_Data Landmarks/structure
 bool ColorizeTracks(
   const SfM_Data & sfm_data,
   std::vector<Vec3> & vec_3dPoints,
-  std::vector<Vec3> & vec_tracksColor)
+  std::vector<Vec3> & vec_tracksColor,
+  const Colorization_Options & options)
 {
-  // Colorize each track
-  // Start with the most representative image
-  //   and iterate to provide a color to each 3D point
+  const Landmarks & landmarks = sfm_data.GetLandmarks();
+  const IndexT nb_landmarks = static_cast<IndexT>(landmarks.size());
+  vec_3dPoints.resize(nb_landmarks);
+  vec_tracksColor.assign(nb_landmarks, Vec3::Zero());
 
+  // Contiguous index of the views
+  std::vector<const View *> views;
+  Hash_Map<IndexT, IndexT> view_id_to_slot;
+  for (const auto & view_it : sfm_data.GetViews())
   {
-    system::LoggerProgress my_progress_bar(sfm_data.GetLandmarks().size(),"- Compute scene structure color -" );
-
-    vec_tracksColor.resize(sfm_data.GetLandmarks().size());
-    vec_3dPoints.resize(sfm_data.GetLandmarks().size());
+    view_id_to_slot[view_it.first] = static_cast<IndexT>(views.size());
+    views.push_back(view_it.second.get());
+  }
+  const IndexT nb_views = static_cast<IndexT>(views.size());
 
-    //Build a list of contiguous index for the trackIds
-    std::map<IndexT, IndexT> trackIds_to_contiguousIndexes;
-    IndexT cpt = 0;
-    for (Landmarks::const_iterator it = sfm_data.GetLandmarks().begin();
-      it != sfm_data.GetLandmarks().end(); ++it, ++cpt)
+  //--
+  // Group the observations by view (CSR layout).
+  // An entry is an observation, the entries of a view are contiguous.
+  //--
+  // Observations of each landmark: view slot & entry
+  std::vector<IndexT> landmark_offsets(nb_landmarks + 1, 0);
+  std::vector<IndexT> landmark_slots;
+  landmark_slots.reserve(nb_landmarks * 3);
+  std::vector<IndexT> view_offsets(nb_views + 1, 0);
+  {
+    IndexT landmark_index = 0;
+    for (const auto & landmark_it : landmarks)
     {
-      trackIds_to_contiguousIndexes[it->first] = cpt;
-      vec_3dPoints[cpt] = it->second.X;
+      vec_3dPoints[landmark_index] = landmark_it.second.X;
+      for (const auto & obs_it : landmark_it.second.obs)
+      {
+        const auto slot_it = view_id_to_slot.find(obs_it.first);
+        if (slot_it == view_id_to_slot.end())
+          continue;
+        landmark_slots.push_back(slot_it->second);
+        ++view_offsets[slot_it->second + 1];
+      }
+      landmark_offsets[++landmark_index] = static_cast<IndexT>(landmark_slots.size());
     }
+  }
+  for (IndexT i = 0; i < nb_views; ++i)
+    view_offsets[i + 1] += view_offsets[i];
 
-    // The track list that will be colored (point removed during the process)
-    std::set<IndexT> remainingTrackToColor;
-    std::transform(sfm_data.GetLandmarks().begin(), sfm_data.GetLandmarks().end(),
-      std::inserter(remainingTrackToColor, remainingTrackToColor.begin()),
-      stl::RetrieveKey());
-
-    while ( !remainingTrackToColor.empty() )
+  std::vector<Color_Sample> entries(landmark_slots.size());
+  std::vector<IndexT> landmark_entries(landmark_slots.size());
+  {
+    std::vector<IndexT> view_fill(view_offsets.cbegin(), view_offsets.cend() - 1);
+    IndexT landmark_index = 0;
+    for (const auto & landmark_it : landmarks)
     {
-      // Find the most representative image (for the remaining 3D points)
-      //  a. Count the number of observation per view for each 3Dpoint Index
-      //  b. Sort to find the most representative view index
-
-      std::map<IndexT, IndexT> map_IndexCardinal; // ViewId, Cardinal
-      for (const auto & track_to_color_it : remainingTrackToColor)
+      IndexT obs_index = landmark_offsets[landmark_index];
+      for (const auto & obs_it : landmark_it.second.obs)
       {
-        const auto trackId = track_to_color_it;
-        const Observations & obs = sfm_data.GetLandmarks().at(trackId).obs;
-        for (const auto & obs_it : obs)
-        {
-          const auto viewId = obs_it.first;
-          if (map_IndexCardinal.find(viewId) == map_IndexCardinal.end())
-            map_IndexCardinal[viewId] = 1;
-          else
-            ++map_IndexCardinal[viewId];
-        }
+        if (view_id_to_slot.find(obs_it.first) == view_id_to_slot.end())
+          continue;
+        const IndexT entry = view_fill[landmark_slots[obs_index]]++;
+        const Vec2 & pt = obs_it.second.x;
+        entries[entry] = {landmark_index, static_cast<int>(pt.x()), static_cast<int>(pt.y())};
+        landmark_entries[obs_index] = entry;
+        ++obs_index;
       }
+      ++landmark_index;
+    }
+  }
 
-      // Find the View index that is the most represented
-      std::vector<IndexT> vec_cardinal;
-      std::transform(map_IndexCardinal.begin(),
-        map_IndexCardinal.end(),
-        std::back_inserter(vec_cardinal),
-        stl::RetrieveValue());
-      using namespace stl::indexed_sort;
-      std::vector<sort_index_packet_descend<IndexT, IndexT>> packet_vec(vec_cardinal.size());
-      sort_index_helper(packet_vec, &vec_cardinal[0], 1);
-
-      // First image index with the most of occurrence
-      std::map<IndexT, IndexT>::const_iterator iterTT = map_IndexCardinal.begin();
-      std::advance(iterTT, packet_vec[0].index);
-      const size_t view_index = iterTT->first;
-      const View * view = sfm_data.GetViews().at(view_index).get();
-      const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
-        view->s_Img_path);
-      image::Image<image::RGBColor> image_rgb;
-      image::Image<unsigned char> image_gray;
-      const bool b_rgb_image = ReadImage(sView_filename.c_str(), &image_rgb);
-      if (!b_rgb_image) //try Gray level
+  //--
+  // Select the entries to sample
+  //--
+  std::vector<bool> b_selected_entries(entries.size(), true);
+  if (options.views_ == EColorization_Views::GREEDY_COVERAGE)
+  {
+    std::fill(b_selected_entries.begin(), b_selected_entries.end(), false);
+    // Number of uncolored landmarks seen by each view
+    std::vector<IndexT> counts(nb_views);
+    // Max heap of (count, -slot): the ties are broken by the smallest view id
+    std::priority_queue<std::pair<IndexT, int64_t>> queue;
+    for (IndexT i = 0; i < nb_views; ++i)
+    {
+      counts[i] = view_offsets[i + 1] - view_offsets[i];
+      if (counts[i] > 0)
+        queue.emplace(counts[i], -static_cast<int64_t>(i));
+    }
+    std::vector<bool> b_colored(nb_landmarks, false);
+    while (!queue.empty())
+    {
+      const IndexT count = queue.top().first;
+      const IndexT slot = static_cast<IndexT>(-queue.top().second);
+      queue.pop();
+      if (count != counts[slot]) // outdated count
       {
-        const bool b_gray_image = ReadImage(sView_filename.c_str(), &image_gray);
-        if (!b_gray_image)
-        {
-          OPENMVG_LOG_ERROR << "Cannot open provided the image.";
-          return false;
-        }
+        if (counts[slot] > 0)
+          queue.emplace(counts[slot], -static_cast<int64_t>(slot));
+        continue;
       }
-
-      // Iterate through the remaining track to color
-      // - look if the current view is present to color the track
-      std::set<IndexT> set_toRemove;
-      for (const auto & track_to_color_it : remainingTrackToColor)
+      // Color the uncolored landmarks of this view
+      for (IndexT entry = view_offsets[slot]; entry < view_offsets[slot + 1]; ++entry)
       {
-        const auto trackId = track_to_color_it;
-        const Observations & obs = sfm_data.GetLandmarks().at(trackId).obs;
-        Observations::const_iterator it = obs.find(view_index);
-
-        if (it != obs.end())
-        {
-          // Color the track
-          const Vec2 & pt = it->second.x;
-          const image::RGBColor color =
-            b_rgb_image
-            ? image_rgb(pt.y(), pt.x())
-            : image::RGBColor(image_gray(pt.y(), pt.x()));
-
-          vec_tracksColor[trackIds_to_contiguousIndexes.at(trackId)] =
-            Vec3(color.r(), color.g(), color.b());
-          set_toRemove.insert(trackId);
-          ++my_progress_bar;
-        }
+        const IndexT landmark_index = entries[entry].landmark;
+        if (b_colored[landmark_index])
+          continue;
+        b_colored[landmark_index] = true;
+        b_selected_entries[entry] = true;
+        for (IndexT i = landmark_offsets[landmark_index]; i < landmark_offsets[landmark_index + 1]; ++i)
+          --counts[landmark_slots[i]];
       }
-      // Remove colored track
-      for (const auto & to_remove_it : set_toRemove)
+    }
+  }
+
+  // The views to decode & their samples (sorted by row)
+  std::vector<IndexT> selected_views;
+  std::vector<std::vector<IndexT>> view_samples(nb_views);
+  size_t nb_samples = 0;
+  for (IndexT slot = 0; slot < nb_views; ++slot)
+  {
+    for (IndexT entry = view_offsets[slot]; entry < view_offsets[slot + 1]; ++entry)
+    {
+      if (b_selected_entries[entry])
+        view_samples[slot].push_back(entry);
+    }
+    if (!view_samples[slot].empty())
+    {
+      std::stable_sort(view_samples[slot].begin(), view_samples[slot].end(),
+        [&entries](const IndexT a, const IndexT b) { return entries[a].y < entries[b].y; });
+      selected_views.push_back(slot);
+      nb_samples += view_samples[slot].size();
+    }
+  }
+
+  //--
+  // Decode the images concurrently & sample them
+  //--
+  std::vector<image::RGBColor> entry_colors(entries.size(), image::BLACK);
+  std::atomic<bool> b_ok(true);
+  {
+    system::LoggerProgress my_progress_bar(nb_samples, "- Compute scene structure color -");
+#ifdef OPENMVG_USE_OPENMP
+    const int nb_threads = (options.num_threads_ > 0) ?
+      static_cast<int>(options.num_threads_) : omp_get_max_threads();
+    #pragma omp parallel for schedule(dynamic) num_threads(nb_threads)
+#endif
+    for (int i = 0; i < static_cast<int>(selected_views.size()); ++i)
+    {
+      if (!b_ok)
+        continue;
+      const IndexT slot = selected_views[i];
+      const std::vector<IndexT> & sample_entries = view_samples[slot];
+      std::vector<Color_Sample> samples(sample_entries.size());
+      for (size_t j = 0; j < sample_entries.size(); ++j)
+        samples[j] = entries[sample_entries[j]];
+
+      const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
+        views[slot]->s_Img_path);
+      std::vector<image::RGBColor> colors;
+      if (!SampleImage(sView_filename, options.b_stream_rows_, samples, colors))
       {
-        remainingTrackToColor.erase(to_remove_it);
+        OPENMVG_LOG_ERROR << "Cannot open provided the image: " << sView_filename;
+        b_ok = false;
+        continue;
       }
+      for (size_t j = 0; j < sample_entries.size(); ++j)
+        entry_colors[sample_entries[j]] = colors[j];
+      my_progress_bar += static_cast<std::uint32_t>(samples.size());
+    }
+  }
+  if (!b_ok)
+    return false;
+
+  // Color of the landmarks (mean color of their selected observations)
+  for (IndexT landmark_index = 0; landmark_index < nb_landmarks; ++landmark_index)
+  {
+    Vec3 color_sum = Vec3::Zero();
+    int nb_colors = 0;
+    for (IndexT i = landmark_offsets[landmark_index]; i < landmark_offsets[landmark_index + 1]; ++i)
+    {
+      const IndexT entry = landmark_entries[i];
+      if (!b_selected_entries[entry])
+        continue;
+      const image::RGBColor & color = entry_colors[entry];
+      color_sum += Vec3(color.r(), color.g(), color.b());
+      ++nb_colors;
+    }
+    if (nb_colors > 0)
+    {
+      vec_tracksColor[landmark_index] = (color_sum / nb_colors).array().round();
     }
   }
   return true;
@@ -12,15 +12,49 @@
 
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 
+#include <vector>
+
 namespace openMVG {
 namespace sfm {
 
 struct SfM_Data;
 
+/// Choice of the observations used to color the landmarks
+enum class EColorization_Views
+{
+  // Each landmark is colored by a single view. The views that see the most
+  // uncolored landmarks are chosen first (few images are decoded).
+  GREEDY_COVERAGE,
+  // Each landmark color is the mean color of all its observations
+  // (all the images are decoded).
+  AVERAGE_OBSERVATIONS
+};
+
+struct Colorization_Options
+{
+  EColorization_Views views_ = EColorization_Views::GREEDY_COVERAGE;
+  // Decode the images by rows, up to the last sampled row (bounded memory).
+  // The images that cannot be read by rows are loaded entirely.
+  bool b_stream_rows_ = true;
+  // Number of images decoded concurrently (0: all the available threads)
+  unsigned int num_threads_ = 0;
+};
+
+/**
+* @brief Find the color of the SfM_Data Landmarks/structure
+* The observations are first grouped by view in a single pass, then the
+* images are decoded concurrently and sampled at their observations.
+* @param sfm_data Scene
+* @param[out] vec_3dPoints Landmark positions (in the Landmarks order)
+* @param[out] vec_tracksColor Landmark colors (RGB in [0;255])
+* @param options Colorization options
+* @return false if an image cannot be read
+*/
 bool ColorizeTracks(
   const SfM_Data & sfm_data,
   std::vector<Vec3> & vec_3dPoints,
-  std::vector<Vec3> & vec_tracksColor);
+  std::vector<Vec3> & vec_tracksColor,
+  const Colorization_Options & options = Colorization_Options());
 
 } // namespace sfm
 } // namespace openMVG
@@ -0,0 +1,101 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_colorization.hpp"
+
+#include "testing/testing.h"
+
+#include <sstream>
+
+using namespace openMVG;
+using namespace openMVG::image;
+using namespace openMVG::sfm;
+
+// 4 views:
+//  - 0, 1, 2: uniform red, green & blue images,
+//  - 3: gradient image (pixel (x, y) color is (4x, 4y, 0)).
+// Landmarks observations:
+//  0: {0, 1}, 1: {1, 2}, 2: {1}, 3: {2}, 4: {3}
+SfM_Data ColorizationScene()
+{
+  SfM_Data sfm_data;
+  sfm_data.s_root_path = ".";
+  const std::vector<Image<RGBColor>> images = {
+    Image<RGBColor>(32, 24, true, RED),
+    Image<RGBColor>(32, 24, true, GREEN),
+    Image<RGBColor>(32, 24, true, BLUE)};
+  Image<RGBColor> gradient(32, 24);
+  for (int y = 0; y < gradient.Height(); ++y)
+    for (int x = 0; x < gradient.Width(); ++x)
+      gradient(y, x) = RGBColor(4 * x, 4 * y, 0);
+
+  for (IndexT i = 0; i < 4; ++i)
+  {
+    std::ostringstream os;
+    os << "test_colorization_" << i << ".png";
+    WriteImage(os.str().c_str(), (i < 3) ? images[i] : gradient);
+    sfm_data.views[i] = std::make_shared<View>(os.str(), i, 0, i, 32, 24);
+  }
+
+  const std::vector<std::vector<IndexT>> landmark_views = {{0, 1}, {1, 2}, {1}, {2}, {3}};
+  for (IndexT i = 0; i < landmark_views.size(); ++i)
+  {
+    Landmark & landmark = sfm_data.structure[10 * i];
+    landmark.X = Vec3(i, 0, 0);
+    for (const IndexT view : landmark_views[i])
+      landmark.obs[view] = Observation(Vec2(5.7, 3.2), 0);
+  }
+  return sfm_data;
+}
+
+TEST(ColorizeTracks, GreedyCoverage) {
+  const SfM_Data sfm_data = ColorizationScene();
+  for (const bool b_stream_rows : {true, false})
+  {
+    Colorization_Options options;
+    options.b_stream_rows_ = b_stream_rows;
+    std::vector<Vec3> points, colors;
+    EXPECT_TRUE(ColorizeTracks(sfm_data, points, colors, options));
+    EXPECT_EQ(5, points.size());
+    EXPECT_EQ(5, colors.size());
+    EXPECT_MATRIX_NEAR(Vec3(2, 0, 0), points[2], 1e-8);
+    // The view 1 sees the most landmarks, then the view 2 colors the last one
+    EXPECT_MATRIX_NEAR(Vec3(0, 255, 0), colors[0], 1e-8);
+    EXPECT_MATRIX_NEAR(Vec3(0, 255, 0), colors[1], 1e-8);
+    EXPECT_MATRIX_NEAR(Vec3(0, 255, 0), colors[2], 1e-8);
+    EXPECT_MATRIX_NEAR(Vec3(0, 0, 255), colors[3], 1e-8);
+    // Pixel (5, 3)
+    EXPECT_MATRIX_NEAR(Vec3(20, 12, 0), colors[4], 1e-8);
+  }
+}
+
+TEST(ColorizeTracks, AverageObservations) {
+  const SfM_Data sfm_data = ColorizationScene();
+  Colorization_Options options;
+  options.views_ = EColorization_Views::AVERAGE_OBSERVATIONS;
+  std::vector<Vec3> points, colors;
+  EXPECT_TRUE(ColorizeTracks(sfm_data, points, colors, options));
+  EXPECT_MATRIX_NEAR(Vec3(128, 128, 0), colors[0], 1e-8);
+  EXPECT_MATRIX_NEAR(Vec3(0, 128, 128), colors[1], 1e-8);
+  EXPECT_MATRIX_NEAR(Vec3(0, 255, 0), colors[2], 1e-8);
+  EXPECT_MATRIX_NEAR(Vec3(0, 0, 255), colors[3], 1e-8);
+  EXPECT_MATRIX_NEAR(Vec3(20, 12, 0), colors[4], 1e-8);
+}
+
+TEST(ColorizeTracks, MissingImage) {
+  SfM_Data sfm_data = ColorizationScene();
+  sfm_data.views[1]->s_Img_path = "test_colorization_missing.png";
+  std::vector<Vec3> points, colors;
+  EXPECT_FALSE(ColorizeTracks(sfm_data, points, colors));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
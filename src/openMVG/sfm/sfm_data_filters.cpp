@@ -8,11 +8,14 @@
 
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_landmark_store.hpp"
+#include "openMVG/stl/flat_hash_index.hpp"
 #include "openMVG/stl/stl.hpp"
 #include "openMVG/system/logger.hpp"
 #include "openMVG/tracks/union_find.hpp"
 
 #include <utility>
+#include <vector>
 
 namespace openMVG {
 namespace sfm {
@@ -72,6 +75,45 @@ IndexT RemoveOutliers_PixelResidualError
   return outlier_count;
 }
 
+IndexT RemoveOutliers_PixelResidualError
+(
+  const SfM_Data & sfm_data,
+  Landmark_Store & landmarks,
+  const double dThresholdPixel,
+  const unsigned int minTrackLength
+)
+{
+  // Cache the camera of each view (avoid the map lookups per observation)
+  struct Camera
+  {
+    geometry::Pose3 pose;
+    const cameras::IntrinsicBase * intrinsic;
+  };
+  std::vector<Camera> cameras;
+  stl::flat_hash_index camera_index(sfm_data.GetViews().size());
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    const View * view = view_it.second.get();
+    if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+      continue;
+    camera_index.insert(view_it.first, static_cast<IndexT>(cameras.size()));
+    cameras.push_back({sfm_data.GetPoseOrDie(view), sfm_data.GetIntrinsics().at(view->id_intrinsic).get()});
+  }
+
+  const double dThresholdPixel2 = dThresholdPixel * dThresholdPixel;
+  IndexT outlier_count = 0;
+  landmarks.RemoveObservationsIf([&](const IndexT row, const IndexT obs)
+  {
+    const IndexT camera_id = camera_index.find(landmarks.ObservationViewId(obs));
+    const bool b_outlier = (camera_id == stl::flat_hash_index::npos) ||
+      cameras[camera_id].intrinsic->residual(
+        cameras[camera_id].pose(landmarks.X(row)), landmarks.ObservationX(obs)).squaredNorm() > dThresholdPixel2;
+    outlier_count += b_outlier;
+    return b_outlier;
+  }, minTrackLength);
+  return outlier_count;
+}
+
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
 // Return the number of removed tracks
 IndexT RemoveOutliers_AngleError
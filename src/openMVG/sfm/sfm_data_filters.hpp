@@ -14,6 +14,7 @@
 #include "openMVG/types.hpp"
 
 namespace openMVG { namespace sfm { struct SfM_Data; } }
+namespace openMVG { namespace sfm { class Landmark_Store; } }
 
 namespace openMVG {
 namespace sfm {
@@ -51,6 +52,18 @@ IndexT RemoveOutliers_PixelResidualError
   const unsigned int minTrackLength = 2
 );
 
+// Same filter for a Landmark_Store (the views, poses and intrinsics are read
+// from sfm_data, its structure is not used).
+// The observations of the views without a pose or an intrinsic are removed.
+// Return the number of outlier observations
+IndexT RemoveOutliers_PixelResidualError
+(
+  const SfM_Data & sfm_data,
+  Landmark_Store & landmarks,
+  const double dThresholdPixel,
+  const unsigned int minTrackLength = 2
+);
+
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
 // Return the number of removed tracks
 IndexT RemoveOutliers_AngleError
@@ -287,6 +287,70 @@ bool Save_Cereal(
   return true;
 }
 
+bool Save_Cereal_Part(
+  const SfM_Data & data,
+  std::ostream & stream,
+  ESfM_Data part)
+{
+  try
+  {
+    cereal::PortableBinaryOutputArchive archive(stream);
+    switch (part)
+    {
+      case VIEWS:
+        archive(cereal::make_nvp("views", data.views));
+      break;
+      case INTRINSICS:
+        archive(cereal::make_nvp("intrinsics", data.intrinsics));
+      break;
+      case EXTRINSICS:
+        archive(cereal::make_nvp("extrinsics", data.poses));
+      break;
+      default:
+        OPENMVG_LOG_ERROR << "Save_Cereal_Part: unsupported part: " << part;
+        return false;
+    }
+  }
+  catch (const cereal::Exception & e)
+  {
+    OPENMVG_LOG_ERROR << e.what();
+    return false;
+  }
+  return static_cast<bool>(stream);
+}
+
+bool Load_Cereal_Part(
+  SfM_Data & data,
+  std::istream & stream,
+  ESfM_Data part)
+{
+  try
+  {
+    cereal::PortableBinaryInputArchive archive(stream);
+    switch (part)
+    {
+      case VIEWS:
+        archive(cereal::make_nvp("views", data.views));
+      break;
+      case INTRINSICS:
+        archive(cereal::make_nvp("intrinsics", data.intrinsics));
+      break;
+      case EXTRINSICS:
+        archive(cereal::make_nvp("extrinsics", data.poses));
+      break;
+      default:
+        OPENMVG_LOG_ERROR << "Load_Cereal_Part: unsupported part: " << part;
+        return false;
+    }
+  }
+  catch (const cereal::Exception & e)
+  {
+    OPENMVG_LOG_ERROR << e.what();
+    return false;
+  }
+  return true;
+}
+
 //
 // Explicit template instantiation
 //
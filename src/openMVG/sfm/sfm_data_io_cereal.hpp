@@ -9,6 +9,7 @@
 #ifndef OPENMVG_SFM_SFM_DATA_IO_CEREAL_HPP
 #define OPENMVG_SFM_SFM_DATA_IO_CEREAL_HPP
 
+#include <iosfwd>
 #include <string>
 
 #include "openMVG/sfm/sfm_data_io.hpp"
@@ -38,6 +39,20 @@ bool Save_Cereal(
   const std::string & filename,
   ESfM_Data flags_part);
 
+/// Save a single SfM_Data part (VIEWS, INTRINSICS or EXTRINSICS) to a stream
+/// using the Cereal portable binary archive
+bool Save_Cereal_Part(
+  const SfM_Data & data,
+  std::ostream & stream,
+  ESfM_Data part);
+
+/// Load a single SfM_Data part (VIEWS, INTRINSICS or EXTRINSICS) from a stream
+/// using the Cereal portable binary archive
+bool Load_Cereal_Part(
+  SfM_Data & data,
+  std::istream & stream,
+  ESfM_Data part);
+
 } // namespace sfm
 } // namespace openMVG
 
@@ -0,0 +1,576 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_data_io_chunked.hpp"
+
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_io_cereal.hpp"
+#include "openMVG/system/logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace openMVG {
+namespace sfm {
+
+namespace {
+
+const char chunked_magic[8] = {'O', 'M', 'V', 'G', 'S', 'F', 'M', 'C'};
+const uint32_t chunked_version = 1;
+// Section part of the root path (the ESfM_Data parts are the other sections)
+const uint32_t root_path_part = 0;
+// Trailer: table offset + magic
+const std::streamoff trailer_size = sizeof(uint64_t) + sizeof(chunked_magic);
+// Section table: version + entry count, then part, codec, offset, size, count per entry
+const size_t table_header_size = 2 * sizeof(uint32_t);
+const size_t table_entry_size = 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+//--
+// Little-endian encoding of the fields
+//--
+
+class Chunk_Writer
+{
+public:
+  Chunk_Writer(std::string & buffer, const ESfM_Data_Chunk_Codec codec)
+    : buffer_(buffer), b_packed_(codec == ESfM_Data_Chunk_Codec::PACKED)
+  {}
+
+  void PutU32(const uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+      buffer_.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+
+  void PutU64(const uint64_t value)
+  {
+    for (int i = 0; i < 8; ++i)
+      buffer_.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+
+  void PutDouble(const double value)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(double));
+    PutU64(bits);
+  }
+
+  /// Varint (LEB128) with the PACKED codec, 32 bit otherwise
+  void PutIndex(const uint32_t value)
+  {
+    if (!b_packed_)
+    {
+      PutU32(value);
+      return;
+    }
+    uint32_t v = value;
+    while (v >= 0x80)
+    {
+      buffer_.push_back(static_cast<char>((v & 0x7F) | 0x80));
+      v >>= 7;
+    }
+    buffer_.push_back(static_cast<char>(v));
+  }
+
+private:
+  std::string & buffer_;
+  const bool b_packed_;
+};
+
+class Chunk_Reader
+{
+public:
+  Chunk_Reader(const std::string & buffer, const ESfM_Data_Chunk_Codec codec)
+    : buffer_(buffer), b_packed_(codec == ESfM_Data_Chunk_Codec::PACKED)
+  {}
+
+  bool GetU32(uint32_t & value)
+  {
+    if (position_ + 4 > buffer_.size())
+      return false;
+    value = 0;
+    for (int i = 0; i < 4; ++i)
+      value |= uint32_t(static_cast<unsigned char>(buffer_[position_++])) << (8 * i);
+    return true;
+  }
+
+  bool GetU64(uint64_t & value)
+  {
+    if (position_ + 8 > buffer_.size())
+      return false;
+    value = 0;
+    for (int i = 0; i < 8; ++i)
+      value |= uint64_t(static_cast<unsigned char>(buffer_[position_++])) << (8 * i);
+    return true;
+  }
+
+  bool GetDouble(double & value)
+  {
+    uint64_t bits;
+    if (!GetU64(bits))
+      return false;
+    std::memcpy(&value, &bits, sizeof(double));
+    return true;
+  }
+
+  bool GetIndex(uint32_t & value)
+  {
+    if (!b_packed_)
+      return GetU32(value);
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+      if (position_ >= buffer_.size())
+        return false;
+      const unsigned char byte = static_cast<unsigned char>(buffer_[position_++]);
+      value |= uint32_t(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  bool AtEnd() const { return position_ == buffer_.size(); }
+
+private:
+  const std::string & buffer_;
+  size_t position_ = 0;
+  const bool b_packed_;
+};
+
+//--
+// Landmark chunks
+//--
+
+/// Encode the landmarks [first, last) of the sorted ids
+void EncodeLandmarkChunk
+(
+  const Landmarks & landmarks,
+  std::vector<IndexT>::const_iterator first,
+  std::vector<IndexT>::const_iterator last,
+  const ESfM_Data_Chunk_Codec codec,
+  std::string & buffer
+)
+{
+  Chunk_Writer writer(buffer, codec);
+  IndexT previous_id = 0;
+  std::vector<IndexT> view_ids;
+  for (auto it = first; it != last; ++it)
+  {
+    const Landmark & landmark = landmarks.at(*it);
+    // The ids are sorted, the first one is stored as a delta to 0
+    writer.PutIndex(*it - previous_id);
+    previous_id = *it;
+    writer.PutDouble(landmark.X(0));
+    writer.PutDouble(landmark.X(1));
+    writer.PutDouble(landmark.X(2));
+    writer.PutIndex(static_cast<uint32_t>(landmark.obs.size()));
+    // Sorted observations make the output deterministic for the unordered containers
+    view_ids.clear();
+    for (const auto & obs_it : landmark.obs)
+      view_ids.push_back(obs_it.first);
+    std::sort(view_ids.begin(), view_ids.end());
+    for (const IndexT id_view : view_ids)
+    {
+      const Observation & observation = landmark.obs.at(id_view);
+      writer.PutIndex(id_view);
+      writer.PutIndex(observation.id_feat);
+      writer.PutDouble(observation.x(0));
+      writer.PutDouble(observation.x(1));
+    }
+  }
+}
+
+bool DecodeLandmarkChunk
+(
+  const std::string & buffer,
+  const SfM_Data_Chunk_Entry & entry,
+  std::vector<std::pair<IndexT, Landmark>> & landmarks
+)
+{
+  // A landmark uses at least 5 bytes (+ 24 for X)
+  if (entry.count > buffer.size())
+    return false;
+  Chunk_Reader reader(buffer, static_cast<ESfM_Data_Chunk_Codec>(entry.codec));
+  landmarks.resize(entry.count);
+  IndexT id_landmark = 0;
+  for (auto & landmark_it : landmarks)
+  {
+    IndexT delta, nb_observations;
+    Landmark & landmark = landmark_it.second;
+    if (!reader.GetIndex(delta) ||
+        !reader.GetDouble(landmark.X(0)) ||
+        !reader.GetDouble(landmark.X(1)) ||
+        !reader.GetDouble(landmark.X(2)) ||
+        !reader.GetIndex(nb_observations))
+      return false;
+    id_landmark += delta;
+    landmark_it.first = id_landmark;
+    landmark.obs.clear();
+    for (IndexT i = 0; i < nb_observations; ++i)
+    {
+      IndexT id_view;
+      Observation observation;
+      if (!reader.GetIndex(id_view) ||
+          !reader.GetIndex(observation.id_feat) ||
+          !reader.GetDouble(observation.x(0)) ||
+          !reader.GetDouble(observation.x(1)))
+        return false;
+      landmark.obs[id_view] = observation;
+    }
+  }
+  return reader.AtEnd();
+}
+
+//--
+// Sections
+//--
+
+bool IsValidCodec(const uint32_t codec)
+{
+  return codec == static_cast<uint32_t>(ESfM_Data_Chunk_Codec::RAW)
+    || codec == static_cast<uint32_t>(ESfM_Data_Chunk_Codec::PACKED);
+}
+
+bool WriteSection
+(
+  std::ofstream & stream,
+  const uint32_t part,
+  const ESfM_Data_Chunk_Codec codec,
+  const uint64_t count,
+  const std::string & payload,
+  std::vector<SfM_Data_Chunk_Entry> & entries
+)
+{
+  const SfM_Data_Chunk_Entry entry = {
+    part, static_cast<uint32_t>(codec),
+    static_cast<uint64_t>(stream.tellp()), payload.size(), count};
+  stream.write(payload.data(), payload.size());
+  entries.push_back(entry);
+  return static_cast<bool>(stream);
+}
+
+bool ReadSection
+(
+  std::ifstream & stream,
+  const SfM_Data_Chunk_Entry & entry,
+  std::string & payload
+)
+{
+  payload.resize(entry.size);
+  stream.clear();
+  stream.seekg(entry.offset);
+  stream.read(&payload[0], entry.size);
+  return static_cast<bool>(stream);
+}
+
+/// Write the landmarks in chunks of the same part
+bool WriteLandmarkSections
+(
+  std::ofstream & stream,
+  const uint32_t part,
+  const Landmarks & landmarks,
+  const Chunked_Save_Options & options,
+  std::vector<SfM_Data_Chunk_Entry> & entries
+)
+{
+  const ESfM_Data_Chunk_Codec codec = options.b_packed_ ?
+    ESfM_Data_Chunk_Codec::PACKED : ESfM_Data_Chunk_Codec::RAW;
+  const size_t landmarks_per_chunk = std::max(options.landmarks_per_chunk_, size_t(1));
+
+  // Sorted ids (small deltas, deterministic output)
+  std::vector<IndexT> ids;
+  ids.reserve(landmarks.size());
+  for (const auto & landmark_it : landmarks)
+    ids.push_back(landmark_it.first);
+  std::sort(ids.begin(), ids.end());
+
+  std::string payload;
+  for (size_t begin = 0; begin < ids.size(); begin += landmarks_per_chunk)
+  {
+    const size_t end = std::min(begin + landmarks_per_chunk, ids.size());
+    payload.clear();
+    EncodeLandmarkChunk(landmarks, ids.cbegin() + begin, ids.cbegin() + end, codec, payload);
+    if (!WriteSection(stream, part, codec, end - begin, payload, entries))
+      return false;
+  }
+  return true;
+}
+
+bool WriteCerealSection
+(
+  std::ofstream & stream,
+  const SfM_Data & sfm_data,
+  const ESfM_Data part,
+  const uint64_t count,
+  std::vector<SfM_Data_Chunk_Entry> & entries
+)
+{
+  std::ostringstream os;
+  return Save_Cereal_Part(sfm_data, os, part)
+    && WriteSection(stream, part, ESfM_Data_Chunk_Codec::RAW, count, os.str(), entries);
+}
+
+} // namespace
+
+bool Save_Chunked
+(
+  const SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part,
+  const Chunked_Save_Options & options
+)
+{
+  std::ofstream stream(filename, std::ios::binary | std::ios::out);
+  if (!stream)
+    return false;
+
+  stream.write(chunked_magic, sizeof(chunked_magic));
+
+  std::vector<SfM_Data_Chunk_Entry> entries;
+  bool bOk = WriteSection(stream, root_path_part, ESfM_Data_Chunk_Codec::RAW,
+    1, sfm_data.s_root_path, entries);
+  if (bOk && (flags_part & VIEWS) == VIEWS)
+    bOk = WriteCerealSection(stream, sfm_data, VIEWS, sfm_data.views.size(), entries);
+  if (bOk && (flags_part & INTRINSICS) == INTRINSICS)
+    bOk = WriteCerealSection(stream, sfm_data, INTRINSICS, sfm_data.intrinsics.size(), entries);
+  if (bOk && (flags_part & EXTRINSICS) == EXTRINSICS)
+    bOk = WriteCerealSection(stream, sfm_data, EXTRINSICS, sfm_data.poses.size(), entries);
+  if (bOk && (flags_part & STRUCTURE) == STRUCTURE)
+    bOk = WriteLandmarkSections(stream, STRUCTURE, sfm_data.structure, options, entries);
+  if (bOk && (flags_part & CONTROL_POINTS) == CONTROL_POINTS)
+    bOk = WriteLandmarkSections(stream, CONTROL_POINTS, sfm_data.control_points, options, entries);
+  if (!bOk)
+  {
+    OPENMVG_LOG_ERROR << "Cannot write the sfm_data sections: " << filename;
+    return false;
+  }
+
+  // Section table & trailer
+  const uint64_t table_offset = static_cast<uint64_t>(stream.tellp());
+  std::string table;
+  Chunk_Writer writer(table, ESfM_Data_Chunk_Codec::RAW);
+  writer.PutU32(chunked_version);
+  writer.PutU32(static_cast<uint32_t>(entries.size()));
+  for (const SfM_Data_Chunk_Entry & entry : entries)
+  {
+    writer.PutU32(entry.part);
+    writer.PutU32(entry.codec);
+    writer.PutU64(entry.offset);
+    writer.PutU64(entry.size);
+    writer.PutU64(entry.count);
+  }
+  writer.PutU64(table_offset);
+  table.append(chunked_magic, sizeof(chunked_magic));
+  stream.write(table.data(), table.size());
+  return static_cast<bool>(stream);
+}
+
+bool Read_Chunk_Table
+(
+  std::ifstream & stream,
+  std::vector<SfM_Data_Chunk_Entry> & entries
+)
+{
+  entries.clear();
+  char magic[sizeof(chunked_magic)];
+  stream.seekg(0, std::ios::end);
+  const std::streamoff file_size = stream.tellg();
+  if (!stream || file_size < std::streamoff(sizeof(chunked_magic)) + trailer_size)
+    return false;
+
+  // Header & trailer
+  stream.seekg(0);
+  stream.read(magic, sizeof(magic));
+  if (!stream || std::memcmp(magic, chunked_magic, sizeof(magic)) != 0)
+    return false;
+  std::string trailer(trailer_size, '\0');
+  stream.seekg(file_size - trailer_size);
+  stream.read(&trailer[0], trailer_size);
+  if (!stream || std::memcmp(&trailer[sizeof(uint64_t)], chunked_magic, sizeof(chunked_magic)) != 0)
+    return false;
+  uint64_t table_offset;
+  Chunk_Reader(trailer, ESfM_Data_Chunk_Codec::RAW).GetU64(table_offset);
+  if (table_offset > uint64_t(file_size - trailer_size))
+    return false;
+
+  // Section table
+  std::string table(file_size - trailer_size - table_offset, '\0');
+  stream.seekg(table_offset);
+  stream.read(&table[0], table.size());
+  if (!stream)
+    return false;
+  Chunk_Reader reader(table, ESfM_Data_Chunk_Codec::RAW);
+  uint32_t version, nb_entries;
+  if (!reader.GetU32(version) || version != chunked_version || !reader.GetU32(nb_entries))
+    return false;
+  // The entry count is checked against the table size before any allocation
+  if (nb_entries > (table.size() - table_header_size) / table_entry_size)
+    return false;
+  entries.resize(nb_entries);
+  for (SfM_Data_Chunk_Entry & entry : entries)
+  {
+    if (!reader.GetU32(entry.part) || !reader.GetU32(entry.codec) ||
+        !reader.GetU64(entry.offset) || !reader.GetU64(entry.size) ||
+        !reader.GetU64(entry.count) || !IsValidCodec(entry.codec) ||
+        entry.size > table_offset || entry.offset > table_offset - entry.size)
+      return false;
+  }
+  return reader.AtEnd();
+}
+
+bool Load_Chunked
+(
+  SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part
+)
+{
+  std::ifstream stream(filename, std::ios::binary | std::ios::in);
+  if (!stream)
+    return false;
+
+  std::vector<SfM_Data_Chunk_Entry> entries;
+  if (!Read_Chunk_Table(stream, entries))
+  {
+    OPENMVG_LOG_ERROR << "Invalid sfm_data chunked file: " << filename;
+    return false;
+  }
+
+  // Only the sections of the requested parts are read
+  std::string payload;
+  std::vector<std::pair<IndexT, Landmark>> landmarks;
+  for (const SfM_Data_Chunk_Entry & entry : entries)
+  {
+    if (entry.part != root_path_part && (flags_part & entry.part) == 0)
+      continue;
+    if (!ReadSection(stream, entry, payload))
+      return false;
+
+    switch (entry.part)
+    {
+      case root_path_part:
+        sfm_data.s_root_path = payload;
+      break;
+      case VIEWS:
+      case INTRINSICS:
+      case EXTRINSICS:
+      {
+        std::istringstream is(payload);
+        if (!Load_Cereal_Part(sfm_data, is, static_cast<ESfM_Data>(entry.part)))
+          return false;
+      }
+      break;
+      case STRUCTURE:
+      case CONTROL_POINTS:
+      {
+        if (!DecodeLandmarkChunk(payload, entry, landmarks))
+        {
+          OPENMVG_LOG_ERROR << "Invalid landmark chunk in: " << filename;
+          return false;
+        }
+        Landmarks & destination =
+          (entry.part == STRUCTURE) ? sfm_data.structure : sfm_data.control_points;
+        for (auto & landmark_it : landmarks)
+          destination[landmark_it.first] = std::move(landmark_it.second);
+      }
+      break;
+      default: // unknown section (newer file)
+      break;
+    }
+  }
+  return true;
+}
+
+//--
+// Chunked_Landmarks_Reader
+//--
+
+Chunked_Landmarks_Reader::Chunked_Landmarks_Reader
+(
+  const std::string & filename,
+  ESfM_Data part
+):
+  stream_(filename, std::ios::binary | std::ios::in)
+{
+  std::vector<SfM_Data_Chunk_Entry> entries;
+  if (!stream_ || !Read_Chunk_Table(stream_, entries))
+    return;
+  for (const SfM_Data_Chunk_Entry & entry : entries)
+  {
+    if (entry.part == static_cast<uint32_t>(part))
+    {
+      chunks_.push_back(entry);
+      nb_landmarks_ += entry.count;
+    }
+  }
+  b_valid_ = true;
+}
+
+bool Chunked_Landmarks_Reader::ReadChunk
+(
+  const size_t chunk_id,
+  std::vector<std::pair<IndexT, Landmark>> & landmarks
+)
+{
+  std::string payload;
+  return b_valid_ && chunk_id < chunks_.size()
+    && ReadSection(stream_, chunks_[chunk_id], payload)
+    && DecodeLandmarkChunk(payload, chunks_[chunk_id], landmarks);
+}
+
+bool Chunked_Landmarks_Reader::ReadChunk
+(
+  const size_t chunk_id,
+  Landmarks & landmarks
+)
+{
+  std::vector<std::pair<IndexT, Landmark>> chunk;
+  if (!ReadChunk(chunk_id, chunk))
+    return false;
+  for (auto & landmark_it : chunk)
+    landmarks[landmark_it.first] = std::move(landmark_it.second);
+  return true;
+}
+
+bool Chunked_Landmarks_Reader::Next
+(
+  IndexT & id_landmark,
+  Landmark & landmark
+)
+{
+  while (position_in_chunk_ == current_chunk_.size())
+  {
+    if (next_chunk_ == chunks_.size())
+      return false;
+    if (!ReadChunk(next_chunk_, current_chunk_))
+    {
+      OPENMVG_LOG_ERROR << "Invalid landmark chunk: " << next_chunk_;
+      Rewind();
+      b_valid_ = false;
+      return false;
+    }
+    ++next_chunk_;
+    position_in_chunk_ = 0;
+  }
+  id_landmark = current_chunk_[position_in_chunk_].first;
+  landmark = std::move(current_chunk_[position_in_chunk_].second);
+  ++position_in_chunk_;
+  return true;
+}
+
+void Chunked_Landmarks_Reader::Rewind()
+{
+  current_chunk_.clear();
+  next_chunk_ = 0;
+  position_in_chunk_ = 0;
+}
+
+} // namespace sfm
+} // namespace openMVG
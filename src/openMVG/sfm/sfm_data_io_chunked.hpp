@@ -0,0 +1,146 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
+#define OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_landmark.hpp"
+#include "openMVG/types.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+struct SfM_Data;
+
+/**
+* Chunked binary SfM_Data container (".sfmc" files)
+*
+* The file is a sequence of independently addressable sections followed by a
+* section table:
+*  - "OMVGSFMC" magic,
+*  - sections (root path, views, intrinsics, extrinsics, structure chunks,
+*    control point chunks),
+*  - section table: version, number of sections, {part, codec, offset, size, count},
+*  - trailer: table offset, "OMVGSFMC" magic.
+*
+* Views, intrinsics and extrinsics sections are cereal portable binary archives.
+* The landmarks (structure & control points) are split in chunks of a bounded
+* number of landmarks, so they can be streamed without loading the whole scene.
+* Loading seeks only the sections of the requested ESfM_Data parts.
+*/
+
+/// Encoding of the landmark chunk sections
+enum class ESfM_Data_Chunk_Codec : uint32_t
+{
+  RAW = 0,    // fixed size little-endian fields
+  PACKED = 1  // landmark id deltas & indexes encoded as varints (lossless)
+};
+
+/// An entry of the section table
+struct SfM_Data_Chunk_Entry
+{
+  uint32_t part;   // ESfM_Data part (0 for the root path)
+  uint32_t codec;  // ESfM_Data_Chunk_Codec
+  uint64_t offset; // position of the section in the file
+  uint64_t size;   // size of the section in bytes
+  uint64_t count;  // number of elements in the section
+};
+
+struct Chunked_Save_Options
+{
+  size_t landmarks_per_chunk_ = 1 << 16;
+  bool b_packed_ = true;
+};
+
+/// Save a SfM_Data scene to a chunked file
+bool Save_Chunked
+(
+  const SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part,
+  const Chunked_Save_Options & options = Chunked_Save_Options()
+);
+
+/// Load a SfM_Data scene from a chunked file (only the sections of flags_part are read)
+bool Load_Chunked
+(
+  SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part
+);
+
+/// Read the section table of a chunked file
+bool Read_Chunk_Table
+(
+  std::ifstream & stream,
+  std::vector<SfM_Data_Chunk_Entry> & entries
+);
+
+/**
+* @brief Sequential (streaming) access to the landmarks of a chunked file.
+* Only one chunk of landmarks is kept in memory.
+*
+* Usage:
+*  Chunked_Landmarks_Reader reader(filename);
+*  IndexT id; Landmark landmark;
+*  while (reader.Next(id, landmark)) { ... }
+*/
+class Chunked_Landmarks_Reader
+{
+public:
+  /// part: STRUCTURE or CONTROL_POINTS
+  explicit Chunked_Landmarks_Reader
+  (
+    const std::string & filename,
+    ESfM_Data part = STRUCTURE
+  );
+
+  bool IsValid() const { return b_valid_; }
+
+  size_t NumLandmarks() const { return nb_landmarks_; }
+  size_t NumChunks() const { return chunks_.size(); }
+
+  /// Random access to a chunk of landmarks (the chunk landmarks are added to landmarks)
+  bool ReadChunk(const size_t chunk_id, Landmarks & landmarks);
+
+  /// Read the next landmark. Return false at the end of the section or on error.
+  bool Next(IndexT & id_landmark, Landmark & landmark);
+
+  /// Restart the iteration from the first landmark
+  void Rewind();
+
+private:
+  bool ReadChunk
+  (
+    const size_t chunk_id,
+    std::vector<std::pair<IndexT, Landmark>> & landmarks
+  );
+
+  std::ifstream stream_;
+  bool b_valid_ = false;
+  std::vector<SfM_Data_Chunk_Entry> chunks_;
+  size_t nb_landmarks_ = 0;
+
+  // Iteration state
+  std::vector<std::pair<IndexT, Landmark>> current_chunk_;
+  size_t next_chunk_ = 0;
+  size_t position_in_chunk_ = 0;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
@@ -9,11 +9,14 @@
 #include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_data_io_chunked.hpp"
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
 
 #include "testing/testing.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <fstream>
+#include <iterator>
 #include <sstream>
 
 using namespace openMVG;
@@ -63,7 +66,7 @@ SfM_Data create_test_scene(IndexT viewsCount, bool bSharedIntrinsic)
 
 TEST(SfM_Data_IO, SAVE_LOAD_JSON) {
 
-  const std::vector<std::string> ext_Type = {"json", "bin", "xml"};
+  const std::vector<std::string> ext_Type = {"json", "bin", "xml", "sfmc"};
 
   for (size_t i=0; i < ext_Type.size(); ++i)
   {
@@ -164,6 +167,112 @@ TEST(SfM_Data_IO, SAVE_LOAD_JSON) {
   }
 }
 
+TEST(SfM_Data_IO, CHUNKED_STREAMING) {
+
+  // A scene with many landmarks (and non contiguous ids)
+  SfM_Data sfm_data;
+  sfm_data.s_root_path = "./";
+  for (IndexT i = 0; i < 2500; ++i)
+  {
+    Landmark & landmark = sfm_data.structure[3 * i];
+    landmark.X = Vec3(i, 0.5 * i, -1.0 * i);
+    for (IndexT j = 0; j < 2 + i % 4; ++j)
+      landmark.obs[(i + j) % 10] = Observation(Vec2(i + 0.25, j + 0.5), i * 10 + j);
+  }
+  sfm_data.control_points[0] = sfm_data.structure.at(0);
+
+  std::vector<size_t> file_sizes;
+  for (const bool b_packed : {false, true})
+  {
+    const std::string filename = "SAVE_LOAD_CHUNKED.sfmc";
+    Chunked_Save_Options options;
+    options.landmarks_per_chunk_ = 1000;
+    options.b_packed_ = b_packed;
+    EXPECT_TRUE( Save_Chunked(sfm_data, filename, ESfM_Data(STRUCTURE | CONTROL_POINTS), options) );
+    file_sizes.push_back(stlplus::file_size(filename));
+
+    // Partial loading: only the structure
+    {
+      SfM_Data sfm_data_load;
+      EXPECT_TRUE( Load(sfm_data_load, filename, STRUCTURE) );
+      EXPECT_EQ( sfm_data.s_root_path, sfm_data_load.s_root_path );
+      EXPECT_EQ( sfm_data.structure.size(), sfm_data_load.structure.size() );
+      EXPECT_EQ( 0, sfm_data_load.control_points.size() );
+      for (const auto & landmark_it : sfm_data.structure)
+      {
+        const Landmark & landmark = sfm_data_load.structure.at(landmark_it.first);
+        EXPECT_MATRIX_NEAR( landmark_it.second.X, landmark.X, 0.0 );
+        EXPECT_EQ( landmark_it.second.obs.size(), landmark.obs.size() );
+        for (const auto & obs_it : landmark_it.second.obs)
+        {
+          EXPECT_EQ( obs_it.second.id_feat, landmark.obs.at(obs_it.first).id_feat );
+          EXPECT_MATRIX_NEAR( obs_it.second.x, landmark.obs.at(obs_it.first).x, 0.0 );
+        }
+      }
+    }
+
+    // Streaming: the landmarks are read chunk by chunk in increasing id order
+    {
+      Chunked_Landmarks_Reader reader(filename);
+      EXPECT_TRUE( reader.IsValid() );
+      EXPECT_EQ( 3, reader.NumChunks() );
+      EXPECT_EQ( sfm_data.structure.size(), reader.NumLandmarks() );
+      IndexT id_landmark, previous_id = 0;
+      Landmark landmark;
+      size_t count = 0;
+      while (reader.Next(id_landmark, landmark))
+      {
+        EXPECT_TRUE( count == 0 || id_landmark > previous_id );
+        EXPECT_EQ( sfm_data.structure.at(id_landmark).obs.size(), landmark.obs.size() );
+        previous_id = id_landmark;
+        ++count;
+      }
+      EXPECT_EQ( sfm_data.structure.size(), count );
+
+      // Random access to a chunk
+      Landmarks chunk;
+      EXPECT_TRUE( reader.ReadChunk(2, chunk) );
+      EXPECT_EQ( 500, chunk.size() );
+      EXPECT_FALSE( reader.ReadChunk(3, chunk) );
+      reader.Rewind();
+      EXPECT_TRUE( reader.Next(id_landmark, landmark) );
+      EXPECT_EQ( 0, id_landmark );
+
+      Chunked_Landmarks_Reader control_points_reader(filename, CONTROL_POINTS);
+      EXPECT_EQ( 1, control_points_reader.NumLandmarks() );
+    }
+  }
+  // The packed codec is smaller
+  EXPECT_TRUE( file_sizes[1] < file_sizes[0] );
+}
+
+TEST(SfM_Data_IO, CHUNKED_CORRUPTED_TABLE) {
+
+  const std::string filename = "CORRUPTED_CHUNKED.sfmc";
+  EXPECT_TRUE( Save_Chunked(create_test_scene(2, true), filename, ESfM_Data(ALL)) );
+
+  // Replace the entry count of the section table (after the table version)
+  std::string buffer;
+  {
+    std::ifstream stream(filename, std::ios::binary);
+    buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  }
+  uint64_t table_offset = 0;
+  for (int i = 7; i >= 0; --i)
+    table_offset = (table_offset << 8) | static_cast<uint8_t>(buffer[buffer.size() - 16 + i]);
+  EXPECT_TRUE( table_offset + 8 <= buffer.size() - 16 );
+  for (int i = 0; i < 4; ++i)
+    buffer[table_offset + 4 + i] = static_cast<char>(0xFF);
+  {
+    std::ofstream stream(filename, std::ios::binary);
+    stream.write(buffer.data(), buffer.size());
+  }
+
+  SfM_Data sfm_data_load;
+  EXPECT_FALSE( Load(sfm_data_load, filename, ESfM_Data(ALL)) );
+  EXPECT_FALSE( Chunked_Landmarks_Reader(filename).IsValid() );
+}
+
 TEST(SfM_Data_IO, SAVE_PLY) {
 
   // SAVE as PLY
@@ -8,219 +8,475 @@
 
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
 
-#include <deque>
-#include <functional>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
 
 #include "openMVG/geometry/pose3.hpp"
-#include "openMVG/multiview/triangulation_nview.hpp"
 #include "openMVG/multiview/triangulation.hpp"
 #include "openMVG/robust_estimation/rand_sampling.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_landmark.hpp"
 #include "openMVG/system/loggerprogress.hpp"
 
+#include <Eigen/Eigenvalues>
+
 namespace openMVG {
 namespace sfm {
 
 using namespace openMVG::geometry;
 using namespace openMVG::cameras;
 
-SfM_Data_Structure_Computation_Basis::SfM_Data_Structure_Computation_Basis
-(
-  bool bConsoleVerbose
-)
-  :bConsole_verbose_(bConsoleVerbose)
+namespace {
+
+/// Camera of a view with a defined pose and intrinsic
+struct View_Geometry
 {
-}
+  const IntrinsicBase * cam;
+  Pose3 pose;
+};
 
-SfM_Data_Structure_Computation_Blind::SfM_Data_Structure_Computation_Blind
+using View_Geometries = Hash_Map<IndexT, View_Geometry>;
+
+void AddViewGeometry
 (
-  bool bConsoleVerbose
+  const SfM_Data & sfm_data,
+  const IndexT view_id,
+  View_Geometries & geometries
 )
-  :SfM_Data_Structure_Computation_Basis(bConsoleVerbose)
 {
+  const auto view_it = sfm_data.GetViews().find(view_id);
+  if (view_it == sfm_data.GetViews().end() ||
+      !sfm_data.IsPoseAndIntrinsicDefined(view_it->second.get()))
+    return;
+  const View * view = view_it->second.get();
+  geometries[view_id] = {sfm_data.GetIntrinsics().at(view->id_intrinsic).get(),
+                         sfm_data.GetPoseOrDie(view)};
 }
 
-/// Triangulate a given set of observations
-bool track_triangulation
-(
-  const SfM_Data & sfm_data,
-  const Observations & obs,
-  Vec3 & X,
-  const ETriangulationMethod & etri_method = ETriangulationMethod::DEFAULT
-)
+/// Number of tracks flattened at once (bounds the memory of a Track_Batch)
+const size_t kTrack_batch_size = 16384;
+
+/**
+* Observations of a batch of tracks, flattened in contiguous arrays.
+* The observations of a track are contiguous (CSR layout) and stored in the
+* order of its Observations.
+* All the per observation data used by the triangulation is computed once:
+* - the bearing vectors (undistorted for the triangulation, raw for the cheirality test),
+* - the 4x4 block added by the observation to the normal equations of the
+*   N-view algebraic triangulation (see TriangulateNViewAlgebraic).
+* The hypotheses of a track are then triangulated by summing fixed size
+* blocks, without any virtual camera call or dynamic allocation.
+*/
+struct Track_Batch
 {
-  if (obs.size() >= 2)
+  std::vector<IndexT> offsets; // observations of the i-th track: [offsets[i], offsets[i+1])
+  std::vector<const Observations::value_type *> obs;
+  std::vector<const View_Geometry *> geometries; // nullptr: undefined pose or intrinsic
+  std::vector<Vec3> bearings;
+  std::vector<Vec3> rays;
+  std::vector<Mat4, Eigen::aligned_allocator<Mat4>> blocks;
+
+  IndexT size() const { return static_cast<IndexT>(offsets.size() - 1); }
+
+  void Clear()
   {
-    std::vector<Vec3> bearing;
-    std::vector<Mat34> poses;
-    std::vector<Pose3> poses_;
-    bearing.reserve(obs.size());
-    poses.reserve(obs.size());
-    for (const auto& observation : obs)
+    offsets.assign(1, 0);
+    obs.clear();
+    geometries.clear();
+  }
+
+  void Add(const Observations & track, const View_Geometries & view_geometries)
+  {
+    for (const auto & obs_it : track)
     {
-      const View * view = sfm_data.views.at(observation.first).get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        return false;
-      const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      const Pose3 pose = sfm_data.GetPoseOrDie(view);
-      bearing.emplace_back((*cam)(cam->get_ud_pixel(observation.second.x)));
-      poses.emplace_back(pose.asMatrix());
-      poses_.emplace_back(pose);
+      const auto geometry_it = view_geometries.find(obs_it.first);
+      obs.push_back(&obs_it);
+      geometries.push_back(geometry_it != view_geometries.end() ? &geometry_it->second : nullptr);
     }
-    if (bearing.size() > 2)
+    offsets.push_back(static_cast<IndexT>(obs.size()));
+  }
+
+  /// Compute the per observation data (batched per view)
+  void Prepare(const bool b_multithreaded = true)
+  {
+    bearings.resize(obs.size());
+    rays.resize(obs.size());
+    blocks.resize(obs.size());
+
+    Hash_Map<const View_Geometry *, std::vector<IndexT>> view_obs;
+    for (IndexT i = 0; i < static_cast<IndexT>(obs.size()); ++i)
     {
-      const Eigen::Map<const Mat3X> bearing_matrix(bearing[0].data(), 3, bearing.size());
-      Vec4 Xhomogeneous;
-      if (TriangulateNViewAlgebraic
-      (
-        bearing_matrix,
-        poses,
-        &Xhomogeneous))
-      {
-        X = Xhomogeneous.hnormalized();
-        return true;
-      }
+      if (geometries[i])
+        view_obs[geometries[i]].push_back(i);
     }
-    else
+    const std::vector<std::pair<const View_Geometry *, std::vector<IndexT>>> groups(
+      view_obs.cbegin(), view_obs.cend());
+
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic) if (b_multithreaded)
+#endif
+    for (int g = 0; g < static_cast<int>(groups.size()); ++g)
     {
-      return Triangulate2View
-      (
-        poses_.front().rotation(),
-        poses_.front().translation(),
-        bearing.front(),
-        poses_.back().rotation(),
-        poses_.back().translation(),
-        bearing.back(),
-        X,
-        etri_method
-      );
+      const View_Geometry & geometry = *groups[g].first;
+      const std::vector<IndexT> & indexes = groups[g].second;
+      Mat2X pts(2, indexes.size()), ud_pts(2, indexes.size());
+      for (size_t i = 0; i < indexes.size(); ++i)
+      {
+        pts.col(i) = obs[indexes[i]]->second.x;
+        ud_pts.col(i) = geometry.cam->get_ud_pixel(pts.col(i));
+      }
+      const Mat3X ud_bearings = (*geometry.cam)(ud_pts);
+      const Mat3X raw_bearings = (*geometry.cam)(pts);
+      const Mat34 P = geometry.pose.asMatrix();
+      for (size_t i = 0; i < indexes.size(); ++i)
+      {
+        const IndexT index = indexes[i];
+        bearings[index] = ud_bearings.col(i);
+        rays[index] = raw_bearings.col(i);
+        const Vec3 point_norm = bearings[index].normalized();
+        const Mat34 cost = P - point_norm * point_norm.transpose() * P;
+        blocks[index] = cost.transpose() * cost;
+      }
     }
   }
-  return false;
+};
+
+/**
+* Triangulate a subset of the observations of a batch
+* @param batch Flattened observations
+* @param indexes Observations to use (in the track order)
+* @param nb_indexes Number of observations
+* @param etri_method Two view triangulation method
+* @param[out] X The 3D point
+*/
+bool TriangulateObservations
+(
+  const Track_Batch & batch,
+  const IndexT * indexes,
+  const IndexT nb_indexes,
+  const ETriangulationMethod etri_method,
+  Vec3 & X
+)
+{
+  if (nb_indexes < 2)
+    return false;
+  for (IndexT i = 0; i < nb_indexes; ++i)
+  {
+    if (!batch.geometries[indexes[i]])
+      return false;
+  }
+  if (nb_indexes > 2)
+  {
+    // N-view algebraic triangulation
+    Mat4 AtA = Mat4::Zero();
+    for (IndexT i = 0; i < nb_indexes; ++i)
+      AtA += batch.blocks[indexes[i]];
+    const Eigen::SelfAdjointEigenSolver<Mat4> eigen_solver(AtA);
+    if (eigen_solver.info() != Eigen::Success)
+      return false;
+    X = Vec4(eigen_solver.eigenvectors().col(0)).hnormalized();
+    return true;
+  }
+  const Pose3 & pose0 = batch.geometries[indexes[0]]->pose;
+  const Pose3 & pose1 = batch.geometries[indexes[1]]->pose;
+  return Triangulate2View
+  (
+    pose0.rotation(),
+    pose0.translation(),
+    batch.bearings[indexes[0]],
+    pose1.rotation(),
+    pose1.translation(),
+    batch.bearings[indexes[1]],
+    X,
+    etri_method
+  );
 }
 
-// Test if a predicate is true for each observation
-// i.e: predicate could be:
-// - cheirality test (depth test): cheirality_predicate
-// - cheirality and residual error: ResidualAndCheiralityPredicate::predicate
-bool track_check_predicate
+/// Test the cheirality (and the residual error if b_check_residual)
+/// of some observations. Observations without a defined view are ignored.
+/// Return false if no observation is tested.
+bool CheckObservations
 (
-  const Observations & obs,
-  const SfM_Data & sfm_data,
+  const Track_Batch & batch,
+  const IndexT * indexes,
+  const IndexT nb_indexes,
   const Vec3 & X,
-  std::function<bool(
-    const IntrinsicBase&,
-    const Pose3&,
-    const Vec2&,
-    const Vec3&)> predicate
+  const bool b_check_residual = false,
+  const double squared_pixel_threshold = 0.0
 )
 {
   bool visibility = false; // assume that no observation has been looked yet
-  for (const auto & obs_it : obs)
+  for (IndexT i = 0; i < nb_indexes; ++i)
   {
-    const View * view = sfm_data.views.at(obs_it.first).get();
-    if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+    const IndexT index = indexes[i];
+    const View_Geometry * geometry = batch.geometries[index];
+    if (!geometry)
       continue;
     visibility = true; // at least an observation is evaluated
-    const IntrinsicBase * cam = sfm_data.intrinsics.at(view->id_intrinsic).get();
-    const Pose3 pose = sfm_data.GetPoseOrDie(view);
-    if (!predicate(*cam, pose, obs_it.second.x, X))
+    const Vec3 X_cam = geometry->pose(X);
+    if (batch.rays[index].dot(X_cam) <= 0.0) // CheiralityTest
+      return false;
+    if (b_check_residual &&
+        !(geometry->cam->residual(X_cam, batch.obs[index]->second.x).squaredNorm()
+          < squared_pixel_threshold))
       return false;
   }
   return visibility;
 }
 
-bool cheirality_predicate
+/// Blind triangulation of a track (all its observations)
+bool BlindTriangulation
 (
-  const IntrinsicBase& cam,
-  const Pose3& pose,
-  const Vec2& x,
-  const Vec3& X
+  const Track_Batch & batch,
+  const IndexT track,
+  std::vector<IndexT> & indexes,
+  Vec3 & X
 )
 {
-  return CheiralityTest(cam(x), pose, X);
+  indexes.resize(batch.offsets[track + 1] - batch.offsets[track]);
+  for (IndexT i = 0; i < indexes.size(); ++i)
+    indexes[i] = batch.offsets[track] + i;
+  // Keep the point only if it has a positive depth for all obs
+  return TriangulateObservations(batch, indexes.data(), indexes.size(),
+                                 ETriangulationMethod::DEFAULT, X) &&
+         CheckObservations(batch, indexes.data(), indexes.size(), X);
 }
 
-struct ResidualAndCheiralityPredicate
+struct Robust_Parameters
 {
-  const double squared_pixel_threshold_;
+  double squared_pixel_threshold;
+  IndexT min_required_inliers;
+  IndexT min_sample_index;
+  ETriangulationMethod etri_method;
+};
 
-  ResidualAndCheiralityPredicate(const double squared_pixel_threshold)
-    :squared_pixel_threshold_(squared_pixel_threshold){}
+/**
+* Robust triangulation of a track with a ransac scheme
+* @param batch Flattened observations
+* @param track Index of the track in the batch
+* @param params Robust estimation parameters
+* @param[out] X The 3D point
+* @param[out] inliers Inlier flag of each observation of the track
+*/
+bool RobustTriangulation
+(
+  const Track_Batch & batch,
+  const IndexT track,
+  const Robust_Parameters & params,
+  Vec3 & X,
+  std::vector<unsigned char> & inliers
+)
+{
+  const IndexT first = batch.offsets[track];
+  const IndexT nb_obs = batch.offsets[track + 1] - first;
+  if (nb_obs < params.min_required_inliers || nb_obs < params.min_sample_index)
+  {
+    return false;
+  }
 
-  bool predicate
-  (
-    const IntrinsicBase& cam,
-    const Pose3& pose,
-    const Vec2& x,
-    const Vec3& X
-  )
+  std::vector<IndexT> indexes(nb_obs);
+  for (IndexT i = 0; i < nb_obs; ++i)
+    indexes[i] = first + i;
+
+  // Handle the case where all observations must be used
+  if (params.min_required_inliers == params.min_sample_index &&
+      nb_obs == params.min_required_inliers)
   {
-    const Vec2 residual = cam.residual(pose(X), x);
-    return CheiralityTest(cam(x), pose, X) &&
-           residual.squaredNorm() < squared_pixel_threshold_;
+    // Generate the 3D point hypothesis by triangulating all the observations
+    if (TriangulateObservations(batch, indexes.data(), nb_obs, params.etri_method, X) &&
+        CheckObservations(batch, indexes.data(), nb_obs, X, true, params.squared_pixel_threshold))
+    {
+      inliers.assign(nb_obs, 1);
+      return true;
+    }
+    return false;
   }
-};
 
-void SfM_Data_Structure_Computation_Blind::triangulate
+  // else we perform a robust estimation since
+  //  there is more observations than the minimal number of required sample.
+
+  const IndexT nbIter = nb_obs * 2; // TODO: automatic computation of the number of iterations?
+
+  // - Ransac variables
+  bool found = false;
+  double best_error = std::numeric_limits<double>::max();
+  std::vector<unsigned char> current_inliers(nb_obs);
+
+  //--
+  // Random number generation
+  std::mt19937 random_generator(std::mt19937::default_seed);
+
+  // - Ransac loop
+  std::vector<uint32_t> samples;
+  std::vector<IndexT> sample_indexes(params.min_sample_index);
+  for (IndexT i = 0; i < nbIter; ++i)
+  {
+    robust::UniformSample(params.min_sample_index, nb_obs, random_generator, &samples);
+    // The observations are used in the track order
+    std::sort(samples.begin(), samples.end());
+    for (IndexT j = 0; j < params.min_sample_index; ++j)
+      sample_indexes[j] = first + samples[j];
+
+    Vec3 X_hypothesis;
+    // Hypothesis generation
+    if (!TriangulateObservations(batch, sample_indexes.data(), params.min_sample_index,
+                                 params.etri_method, X_hypothesis))
+      continue;
+
+    // Test validity of the hypothesis
+    if (!CheckObservations(batch, sample_indexes.data(), params.min_sample_index,
+                           X_hypothesis, true, params.squared_pixel_threshold))
+      continue;
+
+    IndexT nb_inliers = 0;
+    double current_error = 0.0;
+    // inlier/outlier classification according pixel residual errors.
+    for (IndexT j = 0; j < nb_obs; ++j)
+    {
+      current_inliers[j] = 0;
+      const View_Geometry * geometry = batch.geometries[first + j];
+      if (!geometry)
+        continue;
+      const Vec3 X_cam = geometry->pose(X_hypothesis);
+      if (batch.rays[first + j].dot(X_cam) <= 0.0) // CheiralityTest
+        continue;
+      const double residual_sq =
+        geometry->cam->residual(X_cam, batch.obs[first + j]->second.x).squaredNorm();
+      if (residual_sq < params.squared_pixel_threshold)
+      {
+        current_inliers[j] = 1;
+        ++nb_inliers;
+        current_error += residual_sq;
+      }
+      else
+      {
+        current_error += params.squared_pixel_threshold;
+      }
+    }
+    // Does the hypothesis:
+    // - is the best one we have seen so far.
+    // - has sufficient inliers.
+    if (current_error < best_error &&
+      nb_inliers >= params.min_required_inliers)
+    {
+      X = X_hypothesis;
+      inliers = current_inliers;
+      best_error = current_error;
+      found = nb_inliers > 0;
+    }
+  }
+  return found;
+}
+
+/// Tracks of the scene structure, the longest first (for load balancing)
+std::vector<Landmarks::iterator> SortedTracks(Landmarks & structure)
+{
+  std::vector<Landmarks::iterator> tracks;
+  tracks.reserve(structure.size());
+  for (auto it = structure.begin(); it != structure.end(); ++it)
+    tracks.push_back(it);
+  std::stable_sort(tracks.begin(), tracks.end(),
+    [](const Landmarks::iterator & a, const Landmarks::iterator & b)
+    { return a->second.obs.size() > b->second.obs.size(); });
+  return tracks;
+}
+
+/**
+* Triangulate the scene structure by batches of tracks.
+* @param sfm_data The scene
+* @param functor Track triangulation: bool (const Track_Batch &, IndexT track, Landmark &)
+*   that updates the landmark if the track is valid
+* @param progress_title Progress bar title (no progress if nullptr)
+* Invalid landmarks are removed.
+*/
+template <typename TriangulationFunctor>
+void TriangulateStructure
 (
-  SfM_Data & sfm_data
+  SfM_Data & sfm_data,
+  const TriangulationFunctor & functor,
+  const char * progress_title
 )
-const
 {
-  std::deque<IndexT> rejectedId;
+  View_Geometries view_geometries;
+  for (const auto & view_it : sfm_data.GetViews())
+    AddViewGeometry(sfm_data, view_it.first, view_geometries);
+
   std::unique_ptr<system::ProgressInterface> my_progress_bar;
-  if (bConsole_verbose_)
+  if (progress_title)
     my_progress_bar.reset(
       new system::LoggerProgress(
         sfm_data.structure.size(),
-        "Blind triangulation progress" ));
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel
-#endif
-  for (auto& tracks_it :sfm_data.structure)
+        progress_title ));
+
+  const std::vector<Landmarks::iterator> tracks = SortedTracks(sfm_data.structure);
+  std::vector<unsigned char> keep(tracks.size(), 0);
+  Track_Batch batch;
+  for (size_t batch_start = 0; batch_start < tracks.size(); batch_start += kTrack_batch_size)
   {
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
-#endif
-    {
-      if (bConsole_verbose_)
-      {
-        ++(*my_progress_bar);
-      }
+    const size_t batch_end = std::min(tracks.size(), batch_start + kTrack_batch_size);
+    batch.Clear();
+    for (size_t i = batch_start; i < batch_end; ++i)
+      batch.Add(tracks[i]->second.obs, view_geometries);
+    batch.Prepare();
 
-      const Observations & obs = tracks_it.second.obs;
-      bool bKeep = false;
-      {
-        // Generate the track 3D hypothesis
-        Vec3 X;
-        if (track_triangulation(sfm_data, obs, X))
-        {
-          // Keep the point only if it has a positive depth for all obs
-          if (track_check_predicate(obs, sfm_data, X, cheirality_predicate))
-          {
-            tracks_it.second.X = X;
-            bKeep = true;
-          }
-        }
-      }
-      if (!bKeep)
-      {
+    // Each track updates only its own landmark
 #ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
+    #pragma omp parallel for schedule(dynamic)
 #endif
-        rejectedId.push_front(tracks_it.first);
-      }
+    for (int i = 0; i < static_cast<int>(batch.size()); ++i)
+    {
+      keep[batch_start + i] = functor(batch, i, tracks[batch_start + i]->second);
     }
+    if (my_progress_bar)
+      *my_progress_bar += static_cast<std::uint32_t>(batch_end - batch_start);
   }
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for (size_t i = 0; i < tracks.size(); ++i)
   {
-    sfm_data.structure.erase(it);
+    if (!keep[i])
+      sfm_data.structure.erase(tracks[i]);
   }
 }
 
+} // namespace
+
+SfM_Data_Structure_Computation_Basis::SfM_Data_Structure_Computation_Basis
+(
+  bool bConsoleVerbose
+)
+  :bConsole_verbose_(bConsoleVerbose)
+{
+}
+
+SfM_Data_Structure_Computation_Blind::SfM_Data_Structure_Computation_Blind
+(
+  bool bConsoleVerbose
+)
+  :SfM_Data_Structure_Computation_Basis(bConsoleVerbose)
+{
+}
+
+void SfM_Data_Structure_Computation_Blind::triangulate
+(
+  SfM_Data & sfm_data
+)
+const
+{
+  TriangulateStructure(sfm_data,
+    [](const Track_Batch & batch, const IndexT track, Landmark & landmark)
+    {
+      std::vector<IndexT> indexes;
+      Vec3 X;
+      if (!BlindTriangulation(batch, track, indexes, X))
+        return false;
+      landmark.X = X;
+      return true;
+    },
+    bConsole_verbose_ ? "Blind triangulation progress" : nullptr);
+}
+
 SfM_Data_Structure_Computation_Robust::SfM_Data_Structure_Computation_Robust
 (
   const double max_reprojection_error,
@@ -255,62 +511,28 @@ void SfM_Data_Structure_Computation_Robust::robust_triangulation
 )
 const
 {
-  std::deque<IndexT> rejectedId;
-  std::unique_ptr<system::ProgressInterface> my_progress_bar;
-  if (bConsole_verbose_)
-    my_progress_bar.reset(
-      new system::LoggerProgress(
-        sfm_data.structure.size(),
-        "Robust triangulation" ));
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel
-#endif
-  for (auto& tracks_it :sfm_data.structure)
-  {
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
-#endif
+  const Robust_Parameters params =
+    {Square(max_reprojection_error_), min_required_inliers_, min_sample_index_, etri_method_};
+  TriangulateStructure(sfm_data,
+    [&params](const Track_Batch & batch, const IndexT track, Landmark & landmark)
     {
-      if (bConsole_verbose_)
-      {
-        ++(*my_progress_bar);
-      }
-      Landmark landmark;
-      if (robust_triangulation(sfm_data, tracks_it.second.obs, landmark))
-      {
-        tracks_it.second = landmark;
-      }
-      else
+      Vec3 X;
+      std::vector<unsigned char> inliers;
+      if (!RobustTriangulation(batch, track, params, X, inliers))
+        return false;
+      // Keep only the inlier observations
+      Observations inlier_obs;
+      const IndexT first = batch.offsets[track];
+      for (IndexT i = 0; i < inliers.size(); ++i)
       {
-        // Track must be deleted
-#ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
-#endif
-        rejectedId.push_front(tracks_it.first);
+        if (inliers[i])
+          inlier_obs.insert(inlier_obs.end(), *batch.obs[first + i]);
       }
-    }
-  }
-  // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
-  {
-    sfm_data.structure.erase(it);
-  }
-}
-
-Observations ObservationsSampler
-(
-  const Observations & obs,
-  const std::vector<std::uint32_t> & samples
-)
-{
-  Observations sampled_obs;
-  for (const auto& idx : samples)
-  {
-    Observations::const_iterator obs_it = obs.cbegin();
-    std::advance(obs_it, idx);
-    sampled_obs.insert(*obs_it);
-  }
-  return sampled_obs;
+      landmark.X = X;
+      landmark.obs = std::move(inlier_obs);
+      return true;
+    },
+    bConsole_verbose_ ? "Robust triangulation" : nullptr);
 }
 
 /// Robustly try to estimate the best 3D point using a ransac scheme
@@ -324,113 +546,28 @@ bool SfM_Data_Structure_Computation_Robust::robust_triangulation
 )
 const
 {
-  if (obs.size() < min_required_inliers_ || obs.size() < min_sample_index_)
-  {
-    return false;
-  }
-
-  const double dSquared_pixel_threshold = Square(max_reprojection_error_);
-
-  // Predicate to validate a sample (cheirality and residual error)
-  ResidualAndCheiralityPredicate predicate(dSquared_pixel_threshold);
-  auto predicate_binding = std::bind(&ResidualAndCheiralityPredicate::predicate,
-                                     predicate,
-                                     std::placeholders::_1,
-                                     std::placeholders::_2,
-                                     std::placeholders::_3,
-                                     std::placeholders::_4);
-
-  // Handle the case where all observations must be used
-  if (min_required_inliers_ == min_sample_index_ &&
-      obs.size() == min_required_inliers_)
-  {
-    // Generate the 3D point hypothesis by triangulating all the observations
-    Vec3 X;
-    if (track_triangulation(sfm_data, obs, X, etri_method_) &&
-        track_check_predicate(obs, sfm_data, X, predicate_binding))
-    {
-      landmark.X = X;
-      landmark.obs = obs;
-      return true;
-    }
+  View_Geometries view_geometries;
+  for (const auto & obs_it : obs)
+    AddViewGeometry(sfm_data, obs_it.first, view_geometries);
+  Track_Batch batch;
+  batch.Clear();
+  batch.Add(obs, view_geometries);
+  batch.Prepare(false);
+
+  const Robust_Parameters params =
+    {Square(max_reprojection_error_), min_required_inliers_, min_sample_index_, etri_method_};
+  Vec3 X;
+  std::vector<unsigned char> inliers;
+  if (!RobustTriangulation(batch, 0, params, X, inliers))
     return false;
-  }
-
-  // else we perform a robust estimation since
-  //  there is more observations than the minimal number of required sample.
-
-  const IndexT nbIter = obs.size() * 2; // TODO: automatic computation of the number of iterations?
-
-  // - Ransac variables
-  Vec3 best_model = Vec3::Zero();
-  std::deque<IndexT> best_inlier_set;
-  double best_error = std::numeric_limits<double>::max();
-
-  //--
-  // Random number generation
-  std::mt19937 random_generator(std::mt19937::default_seed);
-
-  // - Ransac loop
-  for (IndexT i = 0; i < nbIter; ++i)
-  {
-    std::vector<uint32_t> samples;
-    robust::UniformSample(min_sample_index_, obs.size(), random_generator, &samples);
-
-    Vec3 X;
-    // Hypothesis generation
-    const auto minimal_sample = ObservationsSampler(obs, samples);
-
-    if (!track_triangulation(sfm_data, minimal_sample, X, etri_method_))
-      continue;
-
-    // Test validity of the hypothesis
-    if (!track_check_predicate(minimal_sample, sfm_data, X, predicate_binding))
-      continue;
-
-    std::deque<IndexT> inlier_set;
-    double current_error = 0.0;
-    // inlier/outlier classification according pixel residual errors.
-    for (const auto & obs_it : obs)
-    {
-      const View * view = sfm_data.views.at(obs_it.first).get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-      const IntrinsicBase & cam =  *sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      const Pose3 pose = sfm_data.GetPoseOrDie(view);
-      if (!CheiralityTest(cam(obs_it.second.x), pose, X))
-        continue;
-      const double residual_sq = cam.residual(pose(X), obs_it.second.x).squaredNorm();
-      if (residual_sq < dSquared_pixel_threshold)
-      {
-        inlier_set.push_front(obs_it.first);
-        current_error += residual_sq;
-      }
-      else
-      {
-        current_error += dSquared_pixel_threshold;
-      }
-    }
-    // Does the hypothesis:
-    // - is the best one we have seen so far.
-    // - has sufficient inliers.
-    if (current_error < best_error &&
-      inlier_set.size() >= min_required_inliers_)
-    {
-      best_model = X;
-      best_inlier_set = inlier_set;
-      best_error = current_error;
-    }
-  }
-  if (!best_inlier_set.empty() && best_inlier_set.size() >= min_required_inliers_)
+  // Update information (3D landmark position & valid observations)
+  landmark.X = X;
+  for (IndexT i = 0; i < inliers.size(); ++i)
   {
-    // Update information (3D landmark position & valid observations)
-    landmark.X = best_model;
-    for (const IndexT & val : best_inlier_set)
-    {
-      landmark.obs[val] = obs.at(val);
-    }
+    if (inliers[i])
+      landmark.obs[batch.obs[i]->first] = batch.obs[i]->second;
   }
-  return !best_inlier_set.empty();
+  return true;
 }
 
 } // namespace sfm
@@ -110,6 +110,48 @@ TEST(SFM_DATA_TRIANGULATION, ROBUST) {
 
 }
 
+TEST(SFM_DATA_TRIANGULATION, ROBUST_OUTLIERS) {
+
+  const int nviews = 6;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data sfm_data = getInputScene(d, config, cameras::PINHOLE_CAMERA);
+
+  // Add an outlier observation to each track
+  SfM_Data sfm_data_2 = sfm_data;
+  for (auto& obs: sfm_data_2.structure)
+  {
+    obs.second.X.fill(0);
+    obs.second.obs[obs.first % nviews].x += Vec2(50, -50);
+  }
+
+  SfM_Data_Structure_Computation_Robust triangulation_engine;
+
+  // The single track triangulation must match the scene triangulation
+  std::map<IndexT, Landmark> track_landmarks;
+  for (const auto& obs: sfm_data_2.structure)
+  {
+    Landmark landmark;
+    EXPECT_TRUE(triangulation_engine.robust_triangulation(sfm_data_2, obs.second.obs, landmark));
+    track_landmarks[obs.first] = landmark;
+  }
+
+  triangulation_engine.triangulate(sfm_data_2);
+  EXPECT_EQ(npoints, sfm_data_2.structure.size());
+  for (const auto& obs: sfm_data_2.structure)
+  {
+    EXPECT_MATRIX_NEAR(sfm_data.structure.at(obs.first).X, obs.second.X, 1e-8);
+    // The outlier observation is not kept
+    EXPECT_EQ(nviews - 1, obs.second.obs.size());
+    EXPECT_EQ(0, obs.second.obs.count(obs.first % nviews));
+    EXPECT_EQ(track_landmarks.at(obs.first).obs.size(), obs.second.obs.size());
+    EXPECT_MATRIX_NEAR(track_landmarks.at(obs.first).X, obs.second.X, 1e-8);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -0,0 +1,176 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_landmark_store.hpp"
+
+#include <algorithm>
+
+namespace openMVG {
+namespace sfm {
+
+Landmark_Store::Landmark_Store(const Landmarks & landmarks)
+{
+  size_t nb_observations = 0;
+  std::vector<IndexT> ids;
+  ids.reserve(landmarks.size());
+  for (const auto & landmark_it : landmarks)
+  {
+    nb_observations += landmark_it.second.obs.size();
+    ids.push_back(landmark_it.first);
+  }
+  Reserve(landmarks.size(), nb_observations);
+  // Sort the rows by id (Landmarks can be an unordered container)
+  std::sort(ids.begin(), ids.end());
+  for (const IndexT id : ids)
+    Insert(id, landmarks.at(id));
+}
+
+Landmarks Landmark_Store::ToLandmarks() const
+{
+  Landmarks landmarks;
+  for (IndexT row = 0; row < size(); ++row)
+    landmarks[landmark_ids_[row]] = GetLandmark(row);
+  return landmarks;
+}
+
+void Landmark_Store::Reserve
+(
+  const size_t nb_landmarks,
+  const size_t nb_observations
+)
+{
+  landmark_ids_.reserve(nb_landmarks);
+  for (auto & coordinates : X_)
+    coordinates.reserve(nb_landmarks);
+  observation_offsets_.reserve(nb_landmarks + 1);
+  observation_view_ids_.reserve(nb_observations);
+  observation_feat_ids_.reserve(nb_observations);
+  for (auto & coordinates : observation_x_)
+    coordinates.reserve(nb_observations);
+  landmark_index_.reserve(nb_landmarks);
+}
+
+void Landmark_Store::Clear()
+{
+  *this = Landmark_Store();
+}
+
+bool Landmark_Store::Insert
+(
+  const IndexT id_landmark,
+  const Landmark & landmark
+)
+{
+  if (!landmark_index_.insert(id_landmark, static_cast<IndexT>(size())))
+    return false;
+
+  landmark_ids_.push_back(id_landmark);
+  for (int axis = 0; axis < 3; ++axis)
+    X_[axis].push_back(landmark.X(axis));
+
+  // The observations are sorted by view id (Observations can be an unordered container)
+  const size_t obs_begin = observation_view_ids_.size();
+  for (const auto & obs_it : landmark.obs)
+    observation_view_ids_.push_back(obs_it.first);
+  std::sort(observation_view_ids_.begin() + obs_begin, observation_view_ids_.end());
+  for (size_t obs = obs_begin; obs < observation_view_ids_.size(); ++obs)
+  {
+    const Observation & observation = landmark.obs.at(observation_view_ids_[obs]);
+    observation_feat_ids_.push_back(observation.id_feat);
+    observation_x_[0].push_back(observation.x(0));
+    observation_x_[1].push_back(observation.x(1));
+  }
+  observation_offsets_.push_back(static_cast<IndexT>(observation_view_ids_.size()));
+  return true;
+}
+
+Observations Landmark_Store::GetObservations
+(
+  const IndexT row
+) const
+{
+  Observations obs;
+  for (IndexT i = ObservationBegin(row); i < ObservationEnd(row); ++i)
+    obs[observation_view_ids_[i]] = Observation(ObservationX(i), observation_feat_ids_[i]);
+  return obs;
+}
+
+Landmark Landmark_Store::GetLandmark
+(
+  const IndexT row
+) const
+{
+  Landmark landmark;
+  landmark.X = X(row);
+  landmark.obs = GetObservations(row);
+  return landmark;
+}
+
+size_t Landmark_Store::MemoryUsage() const
+{
+  size_t memory = landmark_ids_.capacity() * sizeof(IndexT)
+    + observation_offsets_.capacity() * sizeof(IndexT)
+    + observation_view_ids_.capacity() * sizeof(IndexT)
+    + observation_feat_ids_.capacity() * sizeof(IndexT)
+    + landmark_index_.memory_usage();
+  for (const auto & coordinates : X_)
+    memory += coordinates.capacity() * sizeof(double);
+  for (const auto & coordinates : observation_x_)
+    memory += coordinates.capacity() * sizeof(double);
+  return memory;
+}
+
+void Landmark_Store::MoveObservation
+(
+  const IndexT src,
+  const IndexT dst
+)
+{
+  observation_view_ids_[dst] = observation_view_ids_[src];
+  observation_feat_ids_[dst] = observation_feat_ids_[src];
+  observation_x_[0][dst] = observation_x_[0][src];
+  observation_x_[1][dst] = observation_x_[1][src];
+}
+
+void Landmark_Store::MoveLandmark
+(
+  const IndexT src_row,
+  const IndexT dst_row
+)
+{
+  landmark_ids_[dst_row] = landmark_ids_[src_row];
+  X_[0][dst_row] = X_[0][src_row];
+  X_[1][dst_row] = X_[1][src_row];
+  X_[2][dst_row] = X_[2][src_row];
+}
+
+void Landmark_Store::Shrink
+(
+  const size_t nb_landmarks,
+  const size_t nb_observations
+)
+{
+  landmark_ids_.resize(nb_landmarks);
+  for (auto & coordinates : X_)
+    coordinates.resize(nb_landmarks);
+  observation_offsets_.resize(nb_landmarks + 1);
+  observation_offsets_[nb_landmarks] = static_cast<IndexT>(nb_observations);
+  observation_view_ids_.resize(nb_observations);
+  observation_feat_ids_.resize(nb_observations);
+  for (auto & coordinates : observation_x_)
+    coordinates.resize(nb_observations);
+
+  // The rows have been moved
+  landmark_index_.clear();
+  landmark_index_.reserve(nb_landmarks);
+  for (IndexT row = 0; row < nb_landmarks; ++row)
+    landmark_index_.insert(landmark_ids_[row], row);
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,176 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_LANDMARK_STORE_HPP
+#define OPENMVG_SFM_SFM_LANDMARK_STORE_HPP
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/sfm/sfm_landmark.hpp"
+#include "openMVG/stl/flat_hash_index.hpp"
+#include "openMVG/types.hpp"
+
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* @brief Contiguous landmark & observation store (an alternative to the node
+* based Landmarks container for large scenes).
+*
+* Layout (structure of arrays):
+*  - a landmark is a row: its id and its X, Y, Z coordinates are stored in
+*    separate arrays,
+*  - the observations are stored by landmark (CSR layout): the observations of
+*    the landmark row i are in [observation_offsets()[i], observation_offsets()[i+1]),
+*    their view id, feature id, x and y coordinates are stored in separate arrays,
+*  - a flat hash index maps the landmark ids to their row.
+*
+* The rows are compacted when observations are removed (the row of a landmark
+* can change, its id is stable).
+* Landmarks can be converted from/to the Landmarks container, so the
+* algorithms can be ported to the store one by one.
+*/
+class Landmark_Store
+{
+public:
+  Landmark_Store() = default;
+
+  /// Build the store from a Landmarks container (the landmarks are sorted by id)
+  explicit Landmark_Store(const Landmarks & landmarks);
+
+  /// Convert the store to a Landmarks container
+  Landmarks ToLandmarks() const;
+
+  void Reserve(const size_t nb_landmarks, const size_t nb_observations);
+  void Clear();
+
+  /// Append a landmark. Return false if the id is already used.
+  bool Insert(const IndexT id_landmark, const Landmark & landmark);
+
+  /// Number of landmarks
+  size_t size() const { return landmark_ids_.size(); }
+  bool empty() const { return landmark_ids_.empty(); }
+  size_t NumObservations() const { return observation_view_ids_.size(); }
+
+  /// Return the row of a landmark (UndefinedIndexT if the id is not in the store)
+  IndexT Find(const IndexT id_landmark) const
+  {
+    const IndexT row = landmark_index_.find(id_landmark);
+    return row == stl::flat_hash_index::npos ? UndefinedIndexT : row;
+  }
+
+  //--
+  // Row access
+  //--
+
+  IndexT LandmarkId(const IndexT row) const { return landmark_ids_[row]; }
+
+  Vec3 X(const IndexT row) const { return {X_[0][row], X_[1][row], X_[2][row]}; }
+
+  void SetX(const IndexT row, const Vec3 & X)
+  {
+    X_[0][row] = X(0);
+    X_[1][row] = X(1);
+    X_[2][row] = X(2);
+  }
+
+  /// Observation range [ObservationBegin(row), ObservationEnd(row)) of a landmark row
+  IndexT ObservationBegin(const IndexT row) const { return observation_offsets_[row]; }
+  IndexT ObservationEnd(const IndexT row) const { return observation_offsets_[row + 1]; }
+
+  IndexT ObservationViewId(const IndexT obs) const { return observation_view_ids_[obs]; }
+  IndexT ObservationFeatId(const IndexT obs) const { return observation_feat_ids_[obs]; }
+  Vec2 ObservationX(const IndexT obs) const { return {observation_x_[0][obs], observation_x_[1][obs]}; }
+
+  /// Adapters to the Landmarks container types
+  Observations GetObservations(const IndexT row) const;
+  Landmark GetLandmark(const IndexT row) const;
+
+  //--
+  // Raw arrays (for the vectorized or parallel loops)
+  //--
+
+  const std::vector<IndexT> & landmark_ids() const { return landmark_ids_; }
+  /// X, Y or Z coordinates of the landmarks (axis: 0, 1, 2)
+  const std::vector<double> & landmark_coordinates(const int axis) const { return X_[axis]; }
+  std::vector<double> & landmark_coordinates(const int axis) { return X_[axis]; }
+  const std::vector<IndexT> & observation_offsets() const { return observation_offsets_; }
+  const std::vector<IndexT> & observation_view_ids() const { return observation_view_ids_; }
+  const std::vector<IndexT> & observation_feat_ids() const { return observation_feat_ids_; }
+  /// x or y coordinates of the observations (axis: 0, 1)
+  const std::vector<double> & observation_coordinates(const int axis) const { return observation_x_[axis]; }
+
+  /**
+  * @brief Remove the observations for which predicate(row, obs) is true, then
+  * the landmarks that are left with less than min_track_length observations.
+  * The store is compacted in a single pass (the relative order is kept).
+  * @return the number of removed observations
+  */
+  template <typename Predicate>
+  size_t RemoveObservationsIf
+  (
+    Predicate predicate,
+    const unsigned int min_track_length
+  );
+
+  /// Memory used by the store (in bytes)
+  size_t MemoryUsage() const;
+
+private:
+  /// Copy an observation (resp. a landmark row) to a lower position (compaction)
+  void MoveObservation(const IndexT src, const IndexT dst);
+  void MoveLandmark(const IndexT src_row, const IndexT dst_row);
+  /// Resize the arrays & rebuild the hash index after a compaction
+  void Shrink(const size_t nb_landmarks, const size_t nb_observations);
+
+  std::vector<IndexT> landmark_ids_;
+  std::vector<double> X_[3];
+  std::vector<IndexT> observation_offsets_ = {0};
+  std::vector<IndexT> observation_view_ids_;
+  std::vector<IndexT> observation_feat_ids_;
+  std::vector<double> observation_x_[2];
+  stl::flat_hash_index landmark_index_;
+};
+
+template <typename Predicate>
+size_t Landmark_Store::RemoveObservationsIf
+(
+  Predicate predicate,
+  const unsigned int min_track_length
+)
+{
+  const size_t nb_observations_before = NumObservations();
+  IndexT dst_row = 0, dst_obs = 0;
+  for (IndexT row = 0; row < size(); ++row)
+  {
+    const IndexT track_begin = dst_obs;
+    for (IndexT obs = observation_offsets_[row]; obs < observation_offsets_[row + 1]; ++obs)
+    {
+      if (!predicate(row, obs))
+        MoveObservation(obs, dst_obs++);
+    }
+    const IndexT track_length = dst_obs - track_begin;
+    if (track_length == 0 || track_length < min_track_length)
+    {
+      // Remove the landmark (and its remaining observations)
+      dst_obs = track_begin;
+      continue;
+    }
+    MoveLandmark(row, dst_row);
+    observation_offsets_[dst_row] = track_begin;
+    ++dst_row;
+  }
+  Shrink(dst_row, dst_obs);
+  return nb_observations_before - NumObservations();
+}
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_LANDMARK_STORE_HPP
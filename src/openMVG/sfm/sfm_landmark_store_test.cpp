@@ -0,0 +1,201 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Check the conversions between Landmarks and Landmark_Store.
+// - Check the landmark lookup and the observation removal (compaction).
+// - Check that the store outlier filter removes the same observations than
+//   the Landmarks one.
+// - Check that an iteration over the observations visits the same values in
+//   both containers.
+// (see openMVG_sample_sfm_landmark_store for a memory & timing benchmark)
+//-----------------
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_filters.hpp"
+#include "openMVG/sfm/sfm_landmark_store.hpp"
+
+#include "testing/testing.h"
+
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Cameras on a circle looking at the landmarks (some observations are outliers)
+SfM_Data RandomScene
+(
+  const int nb_views,
+  const int nb_landmarks
+)
+{
+  std::mt19937 random_generator(nb_views);
+  std::uniform_real_distribution<double> point_distribution(-1.0, 1.0);
+  std::uniform_int_distribution<int> track_length_distribution(2, 6);
+  std::uniform_int_distribution<int> view_distribution(0, nb_views - 1);
+  std::normal_distribution<double> pixel_noise(0.0, 0.5);
+  std::bernoulli_distribution outlier_distribution(0.05);
+
+  SfM_Data sfm_data;
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic>(1000, 1000, 1000.0, 500.0, 500.0);
+  for (int i = 0; i < nb_views; ++i)
+  {
+    sfm_data.views[i] = std::make_shared<View>("", i, 0, i, 1000, 1000);
+    const double angle = 2.0 * M_PI * i / nb_views;
+    const Vec3 center(10.0 * std::cos(angle), 10.0 * std::sin(angle), 0.0);
+    sfm_data.poses[i] = Pose3(LookAt(-center), center);
+  }
+  for (int k = 0; k < nb_landmarks; ++k)
+  {
+    Landmark & landmark = sfm_data.structure[2 * k]; // non contiguous ids
+    landmark.X = Vec3(point_distribution(random_generator),
+      point_distribution(random_generator), point_distribution(random_generator));
+    const int track_length = track_length_distribution(random_generator);
+    while (landmark.obs.size() < static_cast<size_t>(track_length))
+    {
+      const IndexT id_view = view_distribution(random_generator);
+      Vec2 x = sfm_data.intrinsics.at(0)->project(sfm_data.poses.at(id_view)(landmark.X));
+      x += outlier_distribution(random_generator) ?
+        Vec2(20.0, 0.0) : Vec2(pixel_noise(random_generator), pixel_noise(random_generator));
+      landmark.obs[id_view] = Observation(x, k);
+    }
+  }
+  return sfm_data;
+}
+
+bool operator==(const Landmark & a, const Landmark & b)
+{
+  if (a.X != b.X || a.obs.size() != b.obs.size())
+    return false;
+  for (const auto & obs_it : a.obs)
+  {
+    const auto it = b.obs.find(obs_it.first);
+    if (it == b.obs.end() || it->second.x != obs_it.second.x ||
+        it->second.id_feat != obs_it.second.id_feat)
+      return false;
+  }
+  return true;
+}
+
+bool operator==(const Landmarks & a, const Landmarks & b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (const auto & landmark_it : a)
+  {
+    const auto it = b.find(landmark_it.first);
+    if (it == b.end() || !(it->second == landmark_it.second))
+      return false;
+  }
+  return true;
+}
+
+TEST(LANDMARK_STORE, Conversion) {
+
+  const SfM_Data sfm_data = RandomScene(10, 1000);
+  const Landmark_Store store(sfm_data.structure);
+
+  EXPECT_EQ(sfm_data.structure.size(), store.size());
+  size_t nb_observations = 0;
+  for (const auto & landmark_it : sfm_data.structure)
+  {
+    nb_observations += landmark_it.second.obs.size();
+    const IndexT row = store.Find(landmark_it.first);
+    EXPECT_TRUE(row != UndefinedIndexT);
+    EXPECT_EQ(landmark_it.first, store.LandmarkId(row));
+    EXPECT_TRUE(store.GetLandmark(row) == landmark_it.second);
+  }
+  EXPECT_EQ(nb_observations, store.NumObservations());
+  EXPECT_EQ(UndefinedIndexT, store.Find(1));
+  EXPECT_TRUE(store.ToLandmarks() == sfm_data.structure);
+
+  // A landmark id can be inserted only once
+  Landmark_Store copy = store;
+  EXPECT_FALSE(copy.Insert(0, sfm_data.structure.at(0)));
+  EXPECT_TRUE(copy.Insert(1, sfm_data.structure.at(0)));
+  EXPECT_EQ(store.size() + 1, copy.size());
+}
+
+TEST(LANDMARK_STORE, RemoveObservations) {
+
+  const SfM_Data sfm_data = RandomScene(10, 1000);
+  Landmark_Store store(sfm_data.structure);
+
+  // Remove the observations of the view 0 and the landmarks with less than 3 observations
+  Landmarks expected = sfm_data.structure;
+  size_t nb_expected_removed = 0;
+  for (auto landmark_it = expected.begin(); landmark_it != expected.end();)
+  {
+    const size_t track_length = landmark_it->second.obs.size();
+    landmark_it->second.obs.erase(0);
+    if (landmark_it->second.obs.size() < 3)
+    {
+      nb_expected_removed += track_length;
+      landmark_it = expected.erase(landmark_it);
+    }
+    else
+    {
+      nb_expected_removed += track_length - landmark_it->second.obs.size();
+      ++landmark_it;
+    }
+  }
+
+  const size_t nb_removed = store.RemoveObservationsIf(
+    [&store](IndexT, IndexT obs) { return store.ObservationViewId(obs) == 0; }, 3);
+  EXPECT_EQ(nb_expected_removed, nb_removed);
+  EXPECT_TRUE(store.ToLandmarks() == expected);
+  // The hash index follows the compaction
+  for (const auto & landmark_it : expected)
+  {
+    EXPECT_EQ(landmark_it.first, store.LandmarkId(store.Find(landmark_it.first)));
+  }
+  EXPECT_EQ(UndefinedIndexT, store.Find(sfm_data.structure.size() * 2));
+}
+
+TEST(LANDMARK_STORE, RemoveOutliers_PixelResidualError) {
+
+  SfM_Data sfm_data = RandomScene(10, 2000);
+  Landmark_Store store(sfm_data.structure);
+
+  const IndexT nb_outliers_store = RemoveOutliers_PixelResidualError(sfm_data, store, 4.0, 2);
+  const IndexT nb_outliers = RemoveOutliers_PixelResidualError(sfm_data, 4.0, 2);
+  EXPECT_TRUE(nb_outliers > 0);
+  EXPECT_EQ(nb_outliers, nb_outliers_store);
+  EXPECT_TRUE(store.ToLandmarks() == sfm_data.structure);
+}
+
+TEST(LANDMARK_STORE, Iteration) {
+
+  const SfM_Data sfm_data = RandomScene(10, 1000);
+  const Landmark_Store store(sfm_data.structure);
+
+  // Sum of the reprojected depth over the observations of both containers
+  double landmarks_sum = 0.0;
+  for (const auto & landmark_it : sfm_data.structure)
+    for (const auto & obs_it : landmark_it.second.obs)
+      landmarks_sum += sfm_data.poses.at(obs_it.first)(landmark_it.second.X)(2);
+
+  double store_sum = 0.0;
+  for (IndexT row = 0; row < store.size(); ++row)
+  {
+    const Vec3 X = store.X(row);
+    for (IndexT obs = store.ObservationBegin(row); obs < store.ObservationEnd(row); ++obs)
+      store_sum += sfm_data.poses.at(store.ObservationViewId(obs))(X)(2);
+  }
+  EXPECT_NEAR(landmarks_sum, store_sum, 1e-6 * std::abs(landmarks_sum));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -8,6 +8,7 @@
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/cameras/Camera_Spherical.hpp"
+#include "openMVG/image/image_remap.hpp"
 #include "openMVG/image/sample.hpp"
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 
@@ -16,14 +17,15 @@ namespace openMVG
 namespace spherical
 {
 
-// Backward rendering of a pinhole image for a given rotation in a panorama
-template <typename ImageT, typename SamplerT>
-ImageT SphericalToPinhole
+// Compute the panorama position of each pixel of a pinhole image for a given
+// rotation (the map can be reused for all the panoramas of the same size)
+inline void ComputeSphericalToPinholeMap
 (
-  const ImageT & equirectangular_image,
+  const int equirectangular_width,
+  const int equirectangular_height,
   const openMVG::cameras::Pinhole_Intrinsic & pinhole_camera,
-  const Mat3 & rot_matrix = Mat3::Identity(),
-  const SamplerT sampler = image::Sampler2d<image::SamplerLinear>()
+  const Mat3 & rot_matrix,
+  image::Remap_Map & map
 )
 {
   using namespace openMVG;
@@ -31,19 +33,17 @@ ImageT SphericalToPinhole
   //
   // Initialize a camera model for each image domain
   // - the equirectangular panorama
-  const Intrinsic_Spherical sphere_camera(equirectangular_image.Width()  - 1,
-                                          equirectangular_image.Height() - 1);
+  const Intrinsic_Spherical sphere_camera(equirectangular_width  - 1,
+                                          equirectangular_height - 1);
 
   // Perform backward/inverse rendering:
   // - For each destination pixel in the pinhole image,
   //   compute where to pick the pixel in the panorama image.
   // This is done by using bearing vector computation
 
-  const int renderer_image_size = pinhole_camera.h();
-  ImageT pinhole_image(renderer_image_size, renderer_image_size);
-
-  const int image_width = pinhole_image.Width();
-  const int image_height = pinhole_image.Height();
+  const int image_width = pinhole_camera.h();
+  const int image_height = pinhole_camera.h();
+  map.resize(image_width, image_height, equirectangular_width, equirectangular_height);
 
   // Use image coordinate in a matrix to use OpenMVG camera bearing vector vectorization
   Mat2X xy_coords(2, static_cast<int>(image_width * image_height));
@@ -61,17 +61,52 @@ ImageT SphericalToPinhole
   for (int it = 0; it < rotated_bearings.cols(); ++it)
   {
     // Project the bearing vector to the sphere
-    const Vec2 sphere_proj = sphere_camera.project(rotated_bearings.col(it));
     // and use the corresponding pixel location in the panorama
-    const Vec2 xy = xy_coords.col(it);
-    if (equirectangular_image.Contains(sphere_proj.y(), sphere_proj.x()))
-    {
-      pinhole_image(xy.y(), xy.x()) = sampler(equirectangular_image, sphere_proj.y(), sphere_proj.x());
-    }
+    const Vec2 sphere_proj = sphere_camera.project(rotated_bearings.col(it));
+    map.Set(it / image_width, it % image_width, sphere_proj.x(), sphere_proj.y());
   }
+}
+
+// Backward rendering of a pinhole image for a given rotation in a panorama
+template <typename ImageT, typename SamplerT>
+ImageT SphericalToPinhole
+(
+  const ImageT & equirectangular_image,
+  const openMVG::cameras::Pinhole_Intrinsic & pinhole_camera,
+  const Mat3 & rot_matrix = Mat3::Identity(),
+  const SamplerT sampler = image::Sampler2d<image::SamplerLinear>()
+)
+{
+  image::Remap_Map map;
+  ComputeSphericalToPinholeMap(
+    equirectangular_image.Width(),
+    equirectangular_image.Height(),
+    pinhole_camera,
+    rot_matrix,
+    map);
+  ImageT pinhole_image;
+  image::Remap(equirectangular_image, map, pinhole_image, sampler);
   return pinhole_image;
 }
 
+// Sample pinhole images from a panorama given some precomputed maps
+// (see ComputeSphericalToPinholeMap)
+template <typename ImageT, typename SamplerT>
+void SphericalToPinholes
+(
+  const ImageT & equirectangular_image,
+  const std::vector<image::Remap_Map> & maps,
+  std::vector<ImageT> & pinhole_images,
+  const SamplerT sampler = image::Sampler2d<image::SamplerLinear>()
+)
+{
+  pinhole_images.resize(maps.size());
+  for (size_t i = 0; i < maps.size(); ++i)
+  {
+    image::Remap(equirectangular_image, maps[i], pinhole_images[i], sampler);
+  }
+}
+
 // Sample pinhole image from a panorama given some camera rotations
 template <typename ImageT, typename SamplerT>
 void SphericalToPinholes
@@ -0,0 +1,207 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_STL_FLAT_HASH_INDEX_HPP
+#define OPENMVG_STL_FLAT_HASH_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace stl
+{
+
+/**
+* @brief Hash index mapping 32 bit keys (i.e. openMVG IndexT) to 32 bit values
+*  (i.e. a row in a contiguous array).
+*
+* Open addressing with linear probing: the (key, value) pairs are stored in a
+* single contiguous array (no node allocation, a lookup reads a few adjacent
+* slots). Erase uses backward shift deletion, so there is no tombstone.
+* The key 0xFFFFFFFF (UndefinedIndexT) is reserved to mark the empty slots.
+*/
+class flat_hash_index
+{
+public:
+  using key_type = uint32_t;
+  using value_type = uint32_t;
+
+  /// Reserved key of the empty slots
+  static constexpr key_type empty_key = std::numeric_limits<key_type>::max();
+  /// Value returned by find for the missing keys
+  static constexpr value_type npos = std::numeric_limits<value_type>::max();
+
+  flat_hash_index() = default;
+
+  explicit flat_hash_index(size_t nb_elements)
+  {
+    reserve(nb_elements);
+  }
+
+  size_t size() const { return nb_elements_; }
+  bool empty() const { return nb_elements_ == 0; }
+  size_t capacity() const { return slots_.size(); }
+
+  void clear()
+  {
+    slots_.clear();
+    nb_elements_ = 0;
+    nb_bits_ = 0;
+  }
+
+  /// Allocate the slots to store nb_elements without rehashing
+  void reserve(size_t nb_elements)
+  {
+    size_t capacity = 8;
+    unsigned int nb_bits = 3;
+    while (capacity * max_load_numerator < nb_elements * max_load_denominator)
+    {
+      capacity <<= 1;
+      ++nb_bits;
+    }
+    if (capacity > slots_.size())
+      rehash(nb_bits);
+  }
+
+  /// Insert a (key, value) pair. Return false if the key is already present
+  /// (its value is unchanged) or is the reserved empty_key.
+  bool insert(const key_type key, const value_type value)
+  {
+    if (key == empty_key)
+      return false;
+    if ((nb_elements_ + 1) * max_load_denominator > slots_.size() * max_load_numerator)
+      reserve(nb_elements_ + 1);
+    size_t i = home_slot(key);
+    while (slots_[i].first != empty_key)
+    {
+      if (slots_[i].first == key)
+        return false;
+      i = (i + 1) & mask();
+    }
+    slots_[i] = {key, value};
+    ++nb_elements_;
+    return true;
+  }
+
+  /// Insert or update a (key, value) pair
+  void insert_or_assign(const key_type key, const value_type value)
+  {
+    const size_t i = find_slot(key);
+    if (i != no_slot)
+      slots_[i].second = value;
+    else
+      insert(key, value);
+  }
+
+  /// Return the value associated to key or npos
+  value_type find(const key_type key) const
+  {
+    const size_t i = find_slot(key);
+    return (i != no_slot) ? slots_[i].second : npos;
+  }
+
+  bool contains(const key_type key) const
+  {
+    return find_slot(key) != no_slot;
+  }
+
+  /// Erase a key. Return false if the key is not present.
+  bool erase(const key_type key)
+  {
+    size_t i = find_slot(key);
+    if (i == no_slot)
+      return false;
+    // Backward shift deletion: move back the following elements of the
+    // cluster that can be placed in the hole
+    size_t j = i;
+    while (true)
+    {
+      j = (j + 1) & mask();
+      if (slots_[j].first == empty_key)
+        break;
+      const size_t k = home_slot(slots_[j].first);
+      // Move the element j to the hole i if its home slot k is not in ]i, j]
+      const bool b_movable = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+      if (b_movable)
+      {
+        slots_[i] = slots_[j];
+        i = j;
+      }
+    }
+    slots_[i].first = empty_key;
+    --nb_elements_;
+    return true;
+  }
+
+  /// Call f(key, value) for each stored pair (in an unspecified order)
+  template <typename Functor>
+  void for_each(Functor f) const
+  {
+    for (const auto & slot : slots_)
+      if (slot.first != empty_key)
+        f(slot.first, slot.second);
+  }
+
+  /// Memory used by the slots (in bytes)
+  size_t memory_usage() const
+  {
+    return slots_.capacity() * sizeof(slot_type);
+  }
+
+private:
+  using slot_type = std::pair<key_type, value_type>;
+
+  // Maximum load factor (7/10)
+  static constexpr size_t max_load_numerator = 7;
+  static constexpr size_t max_load_denominator = 10;
+
+  static constexpr size_t no_slot = std::numeric_limits<size_t>::max();
+
+  size_t mask() const { return slots_.size() - 1; }
+
+  /// Fibonacci hashing (spread the consecutive keys)
+  size_t home_slot(const key_type key) const
+  {
+    return static_cast<size_t>((uint64_t(key) * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - nb_bits_));
+  }
+
+  size_t find_slot(const key_type key) const
+  {
+    if (slots_.empty() || key == empty_key)
+      return no_slot;
+    size_t i = home_slot(key);
+    while (slots_[i].first != empty_key)
+    {
+      if (slots_[i].first == key)
+        return i;
+      i = (i + 1) & mask();
+    }
+    return no_slot;
+  }
+
+  void rehash(const unsigned int nb_bits)
+  {
+    std::vector<slot_type> old_slots(size_t(1) << nb_bits, slot_type(key_type(empty_key), value_type(npos)));
+    old_slots.swap(slots_);
+    nb_bits_ = nb_bits;
+    nb_elements_ = 0;
+    for (const auto & slot : old_slots)
+      if (slot.first != empty_key)
+        insert(slot.first, slot.second);
+  }
+
+  std::vector<slot_type> slots_;
+  size_t nb_elements_ = 0;
+  unsigned int nb_bits_ = 0;
+};
+
+} // namespace stl
+
+#endif // OPENMVG_STL_FLAT_HASH_INDEX_HPP
@@ -0,0 +1,104 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "flat_hash_index.hpp"
+
+#include "testing/testing.h"
+
+#include <map>
+#include <random>
+
+using namespace stl;
+
+TEST(FLAT_HASH_INDEX, InsertFind)
+{
+  flat_hash_index index;
+  EXPECT_TRUE(index.empty());
+  EXPECT_TRUE(flat_hash_index::npos == index.find(0));
+
+  for (uint32_t i = 0; i < 1000; ++i)
+    EXPECT_TRUE(index.insert(i * 3, i));
+  EXPECT_EQ(1000, index.size());
+  // The maximum load factor is respected
+  EXPECT_TRUE(index.size() * 10 <= index.capacity() * 7);
+
+  for (uint32_t i = 0; i < 1000; ++i)
+  {
+    EXPECT_EQ(i, index.find(i * 3));
+    EXPECT_FALSE(index.contains(i * 3 + 1));
+  }
+
+  // A present key is not inserted twice
+  EXPECT_FALSE(index.insert(3, 42));
+  EXPECT_EQ(1, index.find(3));
+  index.insert_or_assign(3, 42);
+  EXPECT_EQ(42, index.find(3));
+  // The empty key cannot be inserted
+  EXPECT_FALSE(index.insert(flat_hash_index::empty_key, 0));
+  EXPECT_EQ(1000, index.size());
+}
+
+TEST(FLAT_HASH_INDEX, Reserve)
+{
+  flat_hash_index index(1000);
+  const size_t capacity = index.capacity();
+  for (uint32_t i = 0; i < 1000; ++i)
+    index.insert(i, i);
+  // No rehash
+  EXPECT_EQ(capacity, index.capacity());
+}
+
+TEST(FLAT_HASH_INDEX, RandomInsertErase)
+{
+  // Compare against a std::map after random insertions & deletions
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_int_distribution<uint32_t> key_distribution(0, 5000);
+
+  flat_hash_index index;
+  std::map<uint32_t, uint32_t> reference;
+  for (uint32_t i = 0; i < 20000; ++i)
+  {
+    const uint32_t key = key_distribution(random_generator);
+    if (i % 3 == 0)
+    {
+      EXPECT_EQ(reference.erase(key) == 1, index.erase(key));
+    }
+    else
+    {
+      EXPECT_EQ(reference.insert({key, i}).second, index.insert(key, i));
+    }
+  }
+  EXPECT_EQ(reference.size(), index.size());
+  for (uint32_t key = 0; key <= 5000; ++key)
+  {
+    const auto it = reference.find(key);
+    if (it == reference.end())
+    {
+      EXPECT_FALSE(index.contains(key));
+    }
+    else
+    {
+      EXPECT_EQ(it->second, index.find(key));
+    }
+  }
+
+  size_t count = 0;
+  index.for_each([&](uint32_t key, uint32_t value)
+  {
+    count += (reference.at(key) == value);
+  });
+  EXPECT_EQ(reference.size(), count);
+
+  index.clear();
+  EXPECT_TRUE(index.empty());
+  EXPECT_FALSE(index.contains(reference.begin()->first));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
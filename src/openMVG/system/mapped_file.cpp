@@ -0,0 +1,111 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/system/mapped_file.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace openMVG
+{
+namespace system
+{
+
+Mapped_File::~Mapped_File()
+{
+  Close();
+}
+
+bool Mapped_File::Open( const std::string & filename )
+{
+  Close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+  if ( file == INVALID_HANDLE_VALUE )
+  {
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  if ( !GetFileSizeEx( file, &file_size ) || file_size.QuadPart == 0 )
+  {
+    CloseHandle( file );
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+  if ( !mapping )
+  {
+    CloseHandle( file );
+    return false;
+  }
+  const void * view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+  if ( !view )
+  {
+    CloseHandle( mapping );
+    CloseHandle( file );
+    return false;
+  }
+  file_handle_ = file;
+  mapping_handle_ = mapping;
+  data_ = static_cast<const unsigned char *>( view );
+  size_ = static_cast<size_t>( file_size.QuadPart );
+#else
+  const int fd = open( filename.c_str(), O_RDONLY );
+  if ( fd < 0 )
+  {
+    return false;
+  }
+  struct stat file_stat;
+  if ( fstat( fd, &file_stat ) != 0 || file_stat.st_size == 0 )
+  {
+    close( fd );
+    return false;
+  }
+  void * view = mmap( nullptr, static_cast<size_t>( file_stat.st_size ), PROT_READ, MAP_SHARED, fd, 0 );
+  // The mapping stays valid once the file descriptor is closed
+  close( fd );
+  if ( view == MAP_FAILED )
+  {
+    return false;
+  }
+  data_ = static_cast<const unsigned char *>( view );
+  size_ = static_cast<size_t>( file_stat.st_size );
+#endif
+  return true;
+}
+
+void Mapped_File::Close()
+{
+  if ( !data_ )
+  {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile( data_ );
+  CloseHandle( static_cast<HANDLE>( mapping_handle_ ) );
+  CloseHandle( static_cast<HANDLE>( file_handle_ ) );
+  mapping_handle_ = nullptr;
+  file_handle_ = nullptr;
+#else
+  munmap( const_cast<unsigned char *>( data_ ), size_ );
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+} // namespace system
+} // namespace openMVG
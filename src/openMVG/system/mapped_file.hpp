@@ -0,0 +1,66 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SYSTEM_MAPPED_FILE_HPP
+#define OPENMVG_SYSTEM_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace openMVG
+{
+namespace system
+{
+
+/**
+* @brief Read-only memory mapping of a file.
+* The file content is paged in on demand by the operating system, so opening
+* a large file is immediate and its pages are shared by all the processes
+* that map it.
+*/
+class Mapped_File
+{
+  public:
+
+    Mapped_File() = default;
+    ~Mapped_File();
+
+    // Non copyable
+    Mapped_File( const Mapped_File & ) = delete;
+    Mapped_File & operator=( const Mapped_File & ) = delete;
+
+    /**
+    * @brief Map a file (the previous mapping, if any, is released)
+    * @param filename Path of the file
+    * @return true if the file is mapped
+    */
+    bool Open( const std::string & filename );
+
+    /**
+    * @brief Release the mapping
+    */
+    void Close();
+
+    const unsigned char * data() const { return data_; }
+    size_t size() const { return size_; }
+    bool IsOpen() const { return data_ != nullptr; }
+
+  private:
+
+    const unsigned char * data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void * file_handle_ = nullptr;
+    void * mapping_handle_ = nullptr;
+#endif
+};
+
+} // namespace system
+} // namespace openMVG
+
+#endif // OPENMVG_SYSTEM_MAPPED_FILE_HPP
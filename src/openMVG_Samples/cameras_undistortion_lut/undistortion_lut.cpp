@@ -0,0 +1,71 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole_Brown.hpp"
+#include "openMVG/cameras/Camera_Pinhole_Fisheye.hpp"
+#include "openMVG/cameras/Camera_Pinhole_Radial.hpp"
+#include "openMVG/cameras/Camera_undistortion_lut.hpp"
+#include "openMVG/system/timer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+
+// ----------------------------------------------------
+// Compare the iterative inverse distortion (get_ud_pixel) and the inverse
+// distortion lookup table on random pixels, for each distortion model.
+// ----------------------------------------------------
+int main()
+{
+  const int nb_points = 100000;
+  const std::vector<std::shared_ptr<IntrinsicBase>> cameras = {
+    std::make_shared<Pinhole_Intrinsic_Radial_K3>(1000, 1000, 1000, 500, 500, -0.245442, 0.112603, 0.),
+    std::make_shared<Pinhole_Intrinsic_Brown_T2>(1000, 1000, 1000, 500, 500,
+      -0.054, 0.014, 0.006, 0.001, -0.001),
+    std::make_shared<Pinhole_Intrinsic_Fisheye>(1000, 1000, 1000, 500, 500,
+      -0.054, 0.014, 0.006, 0.011)
+  };
+
+  for (const auto & cam : cameras)
+  {
+    // Random distorted pixels (in the image domain and slightly outside)
+    std::mt19937 random_generator(std::mt19937::default_seed);
+    std::uniform_real_distribution<double>
+      rand_x(-10.0, cam->w() + 10.0),
+      rand_y(-10.0, cam->h() + 10.0);
+    Mat2X points(2, nb_points);
+    for (int i = 0; i < nb_points; ++i)
+      points.col(i) << rand_x(random_generator), rand_y(random_generator);
+
+    system::Timer timer;
+    Mat2X ud_points(2, points.cols());
+    for (int i = 0; i < points.cols(); ++i)
+      ud_points.col(i) = cam->get_ud_pixel(points.col(i));
+    const double exact_time = timer.elapsedMs();
+
+    timer.reset();
+    const Inverse_Distortion_LUT lut(*cam);
+    const double build_time = timer.elapsedMs();
+    timer.reset();
+    const Mat2X lut_ud_points = lut.get_ud_pixels(points);
+    const double lut_time = timer.elapsedMs();
+
+    std::cout
+      << "Camera type: " << cam->getType()
+      << " #points: " << points.cols()
+      << " max difference (pixels): " << (ud_points - lut_ud_points).cwiseAbs().maxCoeff() << "\n"
+      << "  exact (ms): " << exact_time
+      << " lut (ms): " << lut_time << " (build (ms): " << build_time << ")" << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
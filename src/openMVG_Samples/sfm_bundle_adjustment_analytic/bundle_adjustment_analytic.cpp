@@ -0,0 +1,143 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/cameras.hpp"
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_test.hpp"
+#include "openMVG/system/timer.hpp"
+
+// The cost functions are created by IntrinsicsToCostFunction: only the
+// (glog free) ceres::CostFunction interface is required to evaluate them.
+#include <ceres/cost_function.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Time the residual & Jacobian evaluations of a cost function (ms)
+double TimeEvaluations
+(
+  const ceres::CostFunction & cost_function,
+  const std::vector<double> & intrinsic,
+  const int nb_evaluations
+)
+{
+  // A camera at the origin & a point in its field of view
+  const double extrinsics[6] = {0.1, -0.2, 0.05, 0.3, -0.1, 0.2};
+  const double X[3] = {0.2, -0.3, 3.0};
+  const std::vector<const double*> parameters = {intrinsic.data(), extrinsics, X};
+
+  std::vector<std::vector<double>> jacobians;
+  std::vector<double*> jacobian_pointers;
+  for (const int32_t block_size : cost_function.parameter_block_sizes())
+    jacobians.emplace_back(2 * block_size);
+  for (auto & jacobian : jacobians)
+    jacobian_pointers.push_back(jacobian.data());
+
+  double residuals[2], sum = 0.0;
+  system::Timer timer;
+  for (int i = 0; i < nb_evaluations; ++i)
+  {
+    cost_function.Evaluate(parameters.data(), residuals, jacobian_pointers.data());
+    sum += residuals[0];
+  }
+  const double elapsed = timer.elapsedMs();
+  // Use the results (the loop must not be optimized out)
+  return std::isfinite(sum) ? elapsed : -1.0;
+}
+
+// ----------------------------------------------------
+// Compare the AutoDiff and the analytic derivatives of the reprojection cost
+// functions:
+//  - the residual & Jacobian evaluation of each camera model (the
+//    per-iteration cost of a BA),
+//  - a full BA of a synthetic scene with a radial distortion.
+// ----------------------------------------------------
+int main()
+{
+  const int nb_evaluations = 200000;
+  const unsigned int w = 1000, h = 800;
+  const std::vector<std::shared_ptr<IntrinsicBase>> cameras = {
+    std::make_shared<Pinhole_Intrinsic>(w, h, 1000.0, 510.0, 390.0),
+    std::make_shared<Pinhole_Intrinsic_Radial_K1>(w, h, 1000.0, 510.0, 390.0, -0.1),
+    std::make_shared<Pinhole_Intrinsic_Radial_K3>(w, h, 1000.0, 510.0, 390.0, -0.1, 0.05, -0.01),
+    std::make_shared<Pinhole_Intrinsic_Brown_T2>(w, h, 1000.0, 510.0, 390.0, -0.1, 0.05, -0.01, 0.001, -0.002),
+    std::make_shared<Pinhole_Intrinsic_Fisheye>(w, h, 1000.0, 510.0, 390.0, -0.01, 0.02, -0.003, 0.001)
+  };
+  for (const auto & intrinsic : cameras)
+  {
+    const Vec2 observation(500.0, 400.0);
+    const std::unique_ptr<ceres::CostFunction> autodiff_cost(
+      IntrinsicsToCostFunction(intrinsic.get(), observation, 0.0, false));
+    const std::unique_ptr<ceres::CostFunction> analytic_cost(
+      IntrinsicsToCostFunction(intrinsic.get(), observation, 0.0, true));
+
+    const std::vector<double> intrinsic_params = intrinsic->getParams();
+    const double autodiff_time = TimeEvaluations(*autodiff_cost, intrinsic_params, nb_evaluations);
+    const double analytic_time = TimeEvaluations(*analytic_cost, intrinsic_params, nb_evaluations);
+    std::cout << "Camera type: " << intrinsic->getType()
+      << " #evaluations: " << nb_evaluations
+      << " AutoDiff (ms): " << autodiff_time
+      << " Analytic (ms): " << analytic_time
+      << " speedup: " << autodiff_time / analytic_time << std::endl;
+  }
+
+  const Optimize_Options ba_refine_options(
+    Intrinsic_Parameter_Type::NONE,
+    Extrinsic_Parameter_Type::ADJUST_ALL,
+    Structure_Parameter_Type::ADJUST_ALL);
+
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(24, 2000, config);
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+  // Distort the observations: the scene uses a non null radial distortion
+  const Pinhole_Intrinsic_Radial_K3 distorted_intrinsic
+    (config._cx * 2, config._cy * 2, config._fx, config._cx, config._cy, -0.1, 0.05, -0.01);
+  for (auto & landmark_it : sfm_data.structure)
+  {
+    for (auto & obs_it : landmark_it.second.obs)
+    {
+      const Vec3 X_cam = Pose3(d._R[obs_it.first], d._C[obs_it.first])(d._X.col(landmark_it.first));
+      obs_it.second.x += distorted_intrinsic.project(X_cam) - sfm_data.intrinsics.at(0)->project(X_cam);
+    }
+  }
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic_Radial_K3>(distorted_intrinsic);
+
+  double rmse[2], time[2];
+  for (const bool b_analytic : {false, true})
+  {
+    SfM_Data scene = sfm_data;
+    Bundle_Adjustment_Ceres::BA_Ceres_options options(false, false);
+    options.bUse_analytic_derivatives_ = b_analytic;
+    Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
+    system::Timer timer;
+    if (!bundle_adjustment_obj.Adjust(scene, ba_refine_options))
+    {
+      std::cerr << "The bundle adjustment failed." << std::endl;
+      return EXIT_FAILURE;
+    }
+    time[b_analytic] = timer.elapsedMs();
+    rmse[b_analytic] = RMSE(scene);
+  }
+  std::cout << "BA #poses: " << sfm_data.GetPoses().size()
+    << " #landmarks: " << sfm_data.GetLandmarks().size()
+    << " RMSE before: " << RMSE(sfm_data) << "\n"
+    << "  AutoDiff BA (ms): " << time[0] << " RMSE: " << rmse[0] << "\n"
+    << "  Analytic BA (ms): " << time[1] << " RMSE: " << rmse[1] << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_partitioned.hpp"
+#include "openMVG/sfm/sfm_data_BA_test.hpp"
+#include "openMVG/system/timer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Build a city grid scene of grid_size x grid_size cameras
+SfM_Data CityGridScene
+(
+  const int grid_size,
+  const int points_per_cell,
+  const bool b_perturb
+)
+{
+  const double cell_size = 10.0;
+  const double altitude = 20.0;
+  const unsigned int w = 1000, h = 1000;
+
+  std::mt19937 random_generator(grid_size);
+  std::uniform_real_distribution<double> cell_distribution(0.0, cell_size);
+  std::uniform_real_distribution<double> height_distribution(0.0, 8.0);
+  std::normal_distribution<double> pixel_noise(0.0, 0.5);
+  std::normal_distribution<double> pose_noise(0.0, 0.05);
+
+  SfM_Data sfm_data;
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic>(w, h, 1000.0, w / 2.0, h / 2.0);
+
+  // Nadir cameras: looking toward -Z
+  const Mat3 R = Vec3(1.0, -1.0, -1.0).asDiagonal();
+  for (int i = 0; i < grid_size; ++i)
+  {
+    for (int j = 0; j < grid_size; ++j)
+    {
+      const IndexT id = i * grid_size + j;
+      sfm_data.views[id] = std::make_shared<View>("", id, 0, id, w, h);
+      sfm_data.poses[id] = Pose3(R, Vec3(i * cell_size, j * cell_size, altitude));
+    }
+  }
+
+  // Buildings & ground points
+  IndexT landmark_id = 0;
+  for (int i = 0; i < grid_size; ++i)
+  {
+    for (int j = 0; j < grid_size; ++j)
+    {
+      for (int k = 0; k < points_per_cell; ++k)
+      {
+        const Vec3 X(
+          (i - 0.5) * cell_size + cell_distribution(random_generator),
+          (j - 0.5) * cell_size + cell_distribution(random_generator),
+          height_distribution(random_generator));
+
+        Landmark landmark;
+        landmark.X = X;
+        for (const auto & view_it : sfm_data.views)
+        {
+          const Pose3 & pose = sfm_data.poses.at(view_it.second->id_pose);
+          const Vec3 X_cam = pose(X);
+          if (X_cam(2) <= 0)
+            continue;
+          Vec2 x = sfm_data.intrinsics.at(0)->project(X_cam);
+          if (x(0) < 0 || x(1) < 0 || x(0) >= w || x(1) >= h)
+            continue;
+          if (b_perturb)
+            x += Vec2(pixel_noise(random_generator), pixel_noise(random_generator));
+          landmark.obs[view_it.first] = Observation(x, landmark.obs.size());
+        }
+        if (landmark.obs.size() >= 2)
+          sfm_data.structure[landmark_id++] = landmark;
+      }
+    }
+  }
+
+  if (b_perturb)
+  {
+    for (auto & pose_it : sfm_data.poses)
+    {
+      const Vec3 C = pose_it.second.center() +
+        Vec3(pose_noise(random_generator), pose_noise(random_generator), pose_noise(random_generator));
+      const Mat3 dR = RotationAroundX(pose_noise(random_generator) * 0.1) *
+        RotationAroundY(pose_noise(random_generator) * 0.1);
+      pose_it.second = Pose3(dR * pose_it.second.rotation(), C);
+    }
+    for (auto & landmark_it : sfm_data.structure)
+    {
+      landmark_it.second.X +=
+        Vec3(pose_noise(random_generator), pose_noise(random_generator), pose_noise(random_generator));
+    }
+  }
+  return sfm_data;
+}
+
+// ----------------------------------------------------
+// Compare the monolithic and the partitioned (global-local) bundle adjustment
+// on growing synthetic city grid scenes.
+// ----------------------------------------------------
+int main()
+{
+  const Optimize_Options ba_refine_options(
+    Intrinsic_Parameter_Type::NONE,
+    Extrinsic_Parameter_Type::ADJUST_ALL,
+    Structure_Parameter_Type::ADJUST_ALL);
+
+  for (const int grid_size : {4, 8, 16, 24})
+  {
+    const SfM_Data sfm_data = CityGridScene(grid_size, 10, true);
+
+    SfM_Data monolithic_data = sfm_data;
+    system::Timer timer;
+    Bundle_Adjustment_Ceres monolithic_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+    if (!monolithic_ba.Adjust(monolithic_data, ba_refine_options))
+    {
+      std::cerr << "The monolithic BA failed." << std::endl;
+      return EXIT_FAILURE;
+    }
+    const double monolithic_time = timer.elapsedMs();
+
+    SfM_Data partitioned_data = sfm_data;
+    timer.reset();
+    Bundle_Adjustment_Ceres_Partitioned partitioned_ba(
+      Bundle_Adjustment_Ceres_Partitioned::BA_Partition_options(false, 16));
+    if (!partitioned_ba.Adjust(partitioned_data, ba_refine_options))
+    {
+      std::cerr << "The partitioned BA failed." << std::endl;
+      return EXIT_FAILURE;
+    }
+    const double partitioned_time = timer.elapsedMs();
+
+    std::cout
+      << "City grid " << grid_size << "x" << grid_size
+      << " #poses: " << sfm_data.GetPoses().size()
+      << " #landmarks: " << sfm_data.GetLandmarks().size() << "\n"
+      << "  monolithic  (ms): " << monolithic_time << " RMSE: " << RMSE(monolithic_data) << "\n"
+      << "  partitioned (ms): " << partitioned_time << " RMSE: " << RMSE(partitioned_data)
+      << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,83 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_session.hpp"
+#include "openMVG/sfm/sfm_data_BA_test.hpp"
+#include "openMVG/sfm/sfm_data_filters.hpp"
+#include "openMVG/system/timer.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::sfm;
+
+const Optimize_Options ba_refine_options(
+  Intrinsic_Parameter_Type::ADJUST_ALL,
+  Extrinsic_Parameter_Type::ADJUST_ALL,
+  Structure_Parameter_Type::ADJUST_ALL);
+
+// Repeated BA & outlier rejection steps (as done by the sequential SfM engine)
+// Return the elapsed time (ms) or -1 if a BA failed.
+double RepeatedAdjustment
+(
+  Bundle_Adjustment & ba,
+  SfM_Data & sfm_data,
+  const int nb_rejection_steps
+)
+{
+  system::Timer timer;
+  for (int i = 0; i < nb_rejection_steps; ++i)
+  {
+    if (!ba.Adjust(sfm_data, ba_refine_options))
+      return -1.0;
+    RemoveOutliers_PixelResidualError(sfm_data, 1.0 - 0.1 * i, 2);
+  }
+  return timer.elapsedMs();
+}
+
+// ----------------------------------------------------
+// Compare the one-shot and the session bundle adjustment (the ceres::Problem
+// is kept alive across the calls) on repeated BA & outlier rejection steps.
+// ----------------------------------------------------
+int main()
+{
+  const int nb_rejection_steps = 5;
+  for (const int nb_points : {1000, 4000})
+  {
+    const nViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(32, nb_points, config);
+    const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+    SfM_Data one_shot_data = sfm_data;
+    Bundle_Adjustment_Ceres one_shot_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+    const double one_shot_time = RepeatedAdjustment(one_shot_ba, one_shot_data, nb_rejection_steps);
+
+    SfM_Data session_data = sfm_data;
+    Bundle_Adjustment_Ceres_Session session_ba(Bundle_Adjustment_Ceres::BA_Ceres_options(false));
+    const double session_time = RepeatedAdjustment(session_ba, session_data, nb_rejection_steps);
+
+    if (one_shot_time < 0.0 || session_time < 0.0)
+    {
+      std::cerr << "A bundle adjustment failed." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout
+      << "#poses: " << sfm_data.GetPoses().size()
+      << " #landmarks: " << sfm_data.GetLandmarks().size() << "\n"
+      << "  one-shot BA (ms): " << one_shot_time << " RMSE: " << RMSE(one_shot_data) << "\n"
+      << "  session BA  (ms): " << session_time << " RMSE: " << RMSE(session_data)
+      << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
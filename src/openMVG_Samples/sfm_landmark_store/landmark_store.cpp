@@ -0,0 +1,137 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_filters.hpp"
+#include "openMVG/sfm/sfm_landmark_store.hpp"
+#include "openMVG/system/timer.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Cameras on a circle looking at the landmarks (some observations are outliers)
+SfM_Data RandomScene
+(
+  const int nb_views,
+  const int nb_landmarks
+)
+{
+  std::mt19937 random_generator(nb_views);
+  std::uniform_real_distribution<double> point_distribution(-1.0, 1.0);
+  std::uniform_int_distribution<int> track_length_distribution(2, 6);
+  std::uniform_int_distribution<int> view_distribution(0, nb_views - 1);
+  std::normal_distribution<double> pixel_noise(0.0, 0.5);
+  std::bernoulli_distribution outlier_distribution(0.05);
+
+  SfM_Data sfm_data;
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic>(1000, 1000, 1000.0, 500.0, 500.0);
+  for (int i = 0; i < nb_views; ++i)
+  {
+    sfm_data.views[i] = std::make_shared<View>("", i, 0, i, 1000, 1000);
+    const double angle = 2.0 * M_PI * i / nb_views;
+    const Vec3 center(10.0 * std::cos(angle), 10.0 * std::sin(angle), 0.0);
+    sfm_data.poses[i] = Pose3(LookAt(-center), center);
+  }
+  for (int k = 0; k < nb_landmarks; ++k)
+  {
+    Landmark & landmark = sfm_data.structure[2 * k]; // non contiguous ids
+    landmark.X = Vec3(point_distribution(random_generator),
+      point_distribution(random_generator), point_distribution(random_generator));
+    const int track_length = track_length_distribution(random_generator);
+    while (landmark.obs.size() < static_cast<size_t>(track_length))
+    {
+      const IndexT id_view = view_distribution(random_generator);
+      Vec2 x = sfm_data.intrinsics.at(0)->project(sfm_data.poses.at(id_view)(landmark.X));
+      x += outlier_distribution(random_generator) ?
+        Vec2(20.0, 0.0) : Vec2(pixel_noise(random_generator), pixel_noise(random_generator));
+      landmark.obs[id_view] = Observation(x, k);
+    }
+  }
+  return sfm_data;
+}
+
+// ----------------------------------------------------
+// Compare the memory usage, an iteration over the observations and the outlier
+// filter of the Landmarks (node based) and the Landmark_Store containers.
+// ----------------------------------------------------
+int main()
+{
+  const SfM_Data sfm_data = RandomScene(50, 200000);
+
+  // Estimated memory of the node based containers (a node stores its value and
+  // ~3 pointers + color for std::map, ~1 pointer + hash for std::unordered_map)
+  const size_t node_overhead = 4 * sizeof(void*);
+  size_t landmarks_memory = 0;
+  for (const auto & landmark_it : sfm_data.structure)
+  {
+    landmarks_memory += sizeof(Landmarks::value_type) + node_overhead +
+      landmark_it.second.obs.size() * (sizeof(Observations::value_type) + node_overhead);
+  }
+
+  system::Timer timer;
+  Landmark_Store store(sfm_data.structure);
+  const double conversion_time = timer.elapsedMs();
+
+  // Iterate over the observations: sum of the reprojected depth
+  timer.reset();
+  double landmarks_sum = 0.0;
+  for (const auto & landmark_it : sfm_data.structure)
+    for (const auto & obs_it : landmark_it.second.obs)
+      landmarks_sum += sfm_data.poses.at(obs_it.first)(landmark_it.second.X)(2);
+  const double landmarks_iteration_time = timer.elapsedMs();
+
+  timer.reset();
+  double store_sum = 0.0;
+  for (IndexT row = 0; row < store.size(); ++row)
+  {
+    const Vec3 X = store.X(row);
+    for (IndexT obs = store.ObservationBegin(row); obs < store.ObservationEnd(row); ++obs)
+      store_sum += sfm_data.poses.at(store.ObservationViewId(obs))(X)(2);
+  }
+  const double store_iteration_time = timer.elapsedMs();
+  if (std::abs(landmarks_sum - store_sum) > 1e-6 * std::abs(landmarks_sum))
+  {
+    std::cerr << "The iterations over the containers do not match." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Outlier rejection
+  SfM_Data sfm_data_copy = sfm_data;
+  timer.reset();
+  const IndexT nb_outliers = RemoveOutliers_PixelResidualError(sfm_data_copy, 4.0, 2);
+  const double landmarks_filter_time = timer.elapsedMs();
+  timer.reset();
+  const IndexT nb_outliers_store = RemoveOutliers_PixelResidualError(sfm_data, store, 4.0, 2);
+  const double store_filter_time = timer.elapsedMs();
+  if (nb_outliers != nb_outliers_store)
+  {
+    std::cerr << "The outlier filters do not match." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout
+    << "#landmarks: " << sfm_data.structure.size()
+    << " #observations: " << store.NumObservations() << "\n"
+    << "  Landmarks (estimated) memory (MB): " << landmarks_memory / (1024. * 1024.)
+    << " iteration (ms): " << landmarks_iteration_time
+    << " outlier filter (ms): " << landmarks_filter_time << "\n"
+    << "  Landmark_Store memory (MB): " << store.MemoryUsage() / (1024. * 1024.)
+    << " iteration (ms): " << store_iteration_time
+    << " outlier filter (ms): " << store_filter_time
+    << " (conversion (ms): " << conversion_time << ")" << std::endl;
+  return EXIT_SUCCESS;
+}
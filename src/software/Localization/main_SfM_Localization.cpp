@@ -63,6 +63,7 @@ int main(int argc, char **argv)
   std::string sOutDir = "";
   std::string sMatchesOutDir;
   std::string sQueryDir;
+  std::string sLandmark_Index_Filename;
   double dMaxResidualError = std::numeric_limits<double>::infinity();
   int i_User_camera_model = cameras::PINHOLE_CAMERA_RADIAL3;
   bool bUseSingleIntrinsics = false;
@@ -83,6 +84,7 @@ int main(int argc, char **argv)
   cmd.add( make_switch('s', "single_intrinsics"));
   cmd.add( make_switch('e', "export_structure"));
   cmd.add( make_option('R', resection_method, "resection_method"));
+  cmd.add( make_option('x', sLandmark_Index_Filename, "landmark_index"));
 
 #ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
@@ -123,6 +125,8 @@ int main(int argc, char **argv)
       << "\t" << static_cast<int>(resection::SolverType::P3P_KNEIP_CVPR11) << ": P3P_KNEIP_CVPR11\n"
       << "\t" << static_cast<int>(resection::SolverType::P3P_NORDBERG_ECCV18) << ": P3P_NORDBERG_ECCV18\n"
       << "\t" << static_cast<int>(resection::SolverType::UP2P_KUKELOVA_ACCV10)  << ": UP2P_KUKELOVA_ACCV10 | 2Points | upright camera\n"
+    << "[-x|--landmark_index] path to a landmark index file (.lmi) used as retrieval database\n"
+    << "  (it is built and saved if the file does not exist, see openMVG_main_SfM_Localization_Service)\n"
 #ifdef OPENMVG_USE_OPENMP
     << "[-n|--numThreads] number of thread(s)\n"
 #endif
@@ -241,10 +245,39 @@ int main(int argc, char **argv)
 
   std::vector<Vec3> vec_found_poses;
 
-  sfm::SfM_Localization_Single_3DTrackObservation_Database localizer;
-  if (!localizer.Init(sfm_data, *regions_provider.get()))
+  std::unique_ptr<sfm::SfM_Localizer> localizer;
+  if (!sLandmark_Index_Filename.empty() && stlplus::file_exists(sLandmark_Index_Filename))
   {
-    std::cerr << "Cannot initialize the SfM localizer" << std::endl;
+    std::unique_ptr<sfm::SfM_Localization_Landmark_Index> landmark_index(
+      new sfm::SfM_Localization_Landmark_Index);
+    if (!landmark_index->Load(sLandmark_Index_Filename))
+    {
+      std::cerr << "Cannot load the landmark index: " << sLandmark_Index_Filename << std::endl;
+      return EXIT_FAILURE;
+    }
+    localizer = std::move(landmark_index);
+  }
+  else if (!sLandmark_Index_Filename.empty())
+  {
+    std::unique_ptr<sfm::SfM_Localization_Landmark_Index> landmark_index(
+      new sfm::SfM_Localization_Landmark_Index);
+    if (!landmark_index->Init(sfm_data, *regions_provider.get()))
+    {
+      std::cerr << "Cannot initialize the SfM localizer" << std::endl;
+    }
+    else if (!landmark_index->Save(sLandmark_Index_Filename))
+    {
+      std::cerr << "Cannot save the landmark index: " << sLandmark_Index_Filename << std::endl;
+    }
+    localizer = std::move(landmark_index);
+  }
+  else
+  {
+    localizer.reset(new sfm::SfM_Localization_Single_3DTrackObservation_Database);
+    if (!localizer->Init(sfm_data, *regions_provider.get()))
+    {
+      std::cerr << "Cannot initialize the SfM localizer" << std::endl;
+    }
   }
   // Since we have copied interesting data, release some memory
   regions_provider.reset();
@@ -389,7 +422,7 @@ int main(int argc, char **argv)
     bool bSuccessfulLocalization = false;
 
     // Try to localize the image in the database thanks to its regions
-    if (!localizer.Localize(
+    if (!localizer->Localize(
       optional_intrinsic ? static_cast<resection::SolverType>(resection_method) : resection::SolverType::DLT_6POINTS,
       {imageGray.Width(), imageGray.Height()},
       optional_intrinsic.get(),
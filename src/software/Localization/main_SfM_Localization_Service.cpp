@@ -0,0 +1,366 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2022 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// The <cereal/archives> headers are special and must be included first.
+#include <cereal/archives/json.hpp>
+
+#include <openMVG/features/image_describer.hpp>
+#include <openMVG/image/image_io.hpp>
+#include <openMVG/sfm/sfm.hpp>
+#include <openMVG/system/timer.hpp>
+
+using namespace openMVG;
+using namespace openMVG::sfm;
+
+#include "nonFree/sift/SIFT_describer_io.hpp"
+#include "openMVG/features/akaze/image_describer_akaze_io.hpp"
+
+#include "third_party/cmdLine/cmdLine.h"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A localization request (one line of the input stream)
+struct Query
+{
+  std::string id;
+  std::string type; // IMAGE or REGIONS
+  std::vector<std::string> arguments;
+};
+
+// Latency of the processed queries
+class Latency_Statistics
+{
+public:
+  void Add(const double milliseconds, const bool b_localized)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latencies_.push_back(milliseconds);
+    if (b_localized)
+      ++localized_count_;
+  }
+
+  // "<#queries> <#localized> <p50 ms> <p99 ms>"
+  std::string Report() const
+  {
+    std::vector<double> latencies;
+    size_t localized_count;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      latencies = latencies_;
+      localized_count = localized_count_;
+    }
+    std::ostringstream os;
+    os << latencies.size() << ' ' << localized_count << ' '
+      << std::fixed << std::setprecision(3)
+      << Percentile(latencies, 0.50) << ' ' << Percentile(latencies, 0.99);
+    return os.str();
+  }
+
+private:
+  static double Percentile(std::vector<double> & values, const double ratio)
+  {
+    if (values.empty())
+      return 0.0;
+    const size_t rank = std::min(values.size() - 1,
+      static_cast<size_t>(ratio * values.size()));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<double> latencies_;
+  size_t localized_count_ = 0;
+};
+
+// ----------------------------------------------------
+// Resident localization service:
+//  the landmark index is mapped once and the queries are read on the
+//  standard input and localized concurrently by a pool of threads.
+// ----------------------------------------------------
+int main(int argc, char **argv)
+{
+  CmdLine cmd;
+
+  std::string sSfM_Data_Filename;
+  std::string sMatchesDir;
+  std::string sLandmark_Index_Filename;
+  double dMaxResidualError = std::numeric_limits<double>::infinity();
+  int resection_method = static_cast<int>(resection::SolverType::DEFAULT);
+  int iNumThreads = 0;
+  int iProbeCount = SfM_Localization_Landmark_Index::Options().probe_count;
+
+  cmd.add( make_option('x', sLandmark_Index_Filename, "landmark_index") );
+  cmd.add( make_option('m', sMatchesDir, "match_dir") );
+  cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
+  cmd.add( make_option('r', dMaxResidualError, "residual_error"));
+  cmd.add( make_option('R', resection_method, "resection_method"));
+  cmd.add( make_option('p', iProbeCount, "probe_count"));
+  cmd.add( make_switch('s', "single_intrinsics"));
+  cmd.add( make_option('n', iNumThreads, "numThreads") );
+
+  try {
+    if (argc == 1) throw std::string("Invalid parameter.");
+    cmd.process(argc, argv);
+  } catch (const std::string& s) {
+    std::cerr << "Usage: " << argv[0] << '\n'
+    << "[-x|--landmark_index] path to a landmark index file (.lmi)\n"
+    << "  (see openMVG_main_SfM_Localization -x)\n"
+    << "[-m|--match_dir] path to the directory containing the image_describer.json file\n"
+    << "\n"
+    << "(optional)\n"
+    << "[-i|--input_file] path to the SfM_Data scene (required by -s)\n"
+    << "[-s|--single_intrinsics] (switch) use the single intrinsics of the input scene\n"
+    << "  for the query images (else the intrinsics are unknown)\n"
+    << "[-r|--residual_error] upper bound of the residual error tolerance\n"
+    << "[-R|--resection_method] resection/pose estimation method (default=" << resection_method << ")\n"
+    << "  (used with known intrinsics, see openMVG_main_SfM_Localization)\n"
+    << "[-p|--probe_count] number of index clusters visited by a query descriptor (default="
+      << iProbeCount << ")\n"
+    << "[-n|--numThreads] number of concurrent queries (default: hardware concurrency)\n"
+    << "\n"
+    << "Protocol (one request per line on the standard input):\n"
+    << "  <id> IMAGE <image_path>\n"
+    << "  <id> REGIONS <width> <height> <feat_path> <desc_path>\n"
+    << "  STATS\n"
+    << "  QUIT\n"
+    << "Responses (standard output, in completion order):\n"
+    << "  <id> OK <#inliers> <ms> <R (9 values, row major)> <C (3 values)>\n"
+    << "  <id> FAIL <ms>\n"
+    << "  STATS <#queries> <#localized> <p50 ms> <p99 ms>\n"
+    << "To serve a local socket, pipe it, e.g.:\n"
+    << "  socat UNIX-LISTEN:/tmp/localization.sock EXEC:\"" << argv[0] << " ...\"\n"
+    << std::endl;
+
+    std::cerr << s << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const bool bUseSingleIntrinsics = cmd.used('s');
+
+  // Init the regions_type and the feature extractor that have been used for the reconstruction
+  using namespace openMVG::features;
+  const std::string sImage_describer = stlplus::create_filespec(sMatchesDir, "image_describer", "json");
+  std::unique_ptr<Regions> regions_type = Init_region_type_from_file(sImage_describer);
+  if (!regions_type)
+  {
+    std::cerr << "Invalid: "
+      << sImage_describer << " regions type file." << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::unique_ptr<Image_describer> image_describer;
+  {
+    std::ifstream stream(sImage_describer.c_str());
+    if (!stream)
+      return EXIT_FAILURE;
+
+    try
+    {
+      cereal::JSONInputArchive archive(stream);
+      archive(cereal::make_nvp("image_describer", image_describer));
+    }
+    catch (const cereal::Exception & e)
+    {
+      std::cerr << e.what() << std::endl
+        << "Cannot dynamically allocate the Image_describer interface." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::shared_ptr<cameras::IntrinsicBase> single_intrinsic;
+  if (bUseSingleIntrinsics)
+  {
+    SfM_Data sfm_data;
+    if (!Load(sfm_data, sSfM_Data_Filename, ESfM_Data(INTRINSICS)))
+    {
+      std::cerr << std::endl
+        << "The input SfM_Data file \""<< sSfM_Data_Filename << "\" cannot be read." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (sfm_data.GetIntrinsics().size() != 1)
+    {
+      std::cerr << "You choose the single intrinsic mode but the sfm_data scene,"
+        <<" have too few or too much intrinsics." << std::endl;
+      return EXIT_FAILURE;
+    }
+    single_intrinsic = sfm_data.GetIntrinsics().cbegin()->second;
+  }
+
+  // Map the landmark index
+  SfM_Localization_Landmark_Index::Options index_options;
+  index_options.probe_count = static_cast<uint32_t>(std::max(1, iProbeCount));
+  SfM_Localization_Landmark_Index localizer(index_options);
+  {
+    system::Timer timer;
+    if (!localizer.Load(sLandmark_Index_Filename))
+    {
+      std::cerr << "Cannot load the landmark index: " << sLandmark_Index_Filename << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cerr << "Landmark index loaded in " << timer.elapsedMs() << " ms:\n"
+      << "#landmarks: " << localizer.LandmarkCount() << "\n"
+      << "#descriptors: " << localizer.DescriptorCount() << std::endl;
+  }
+
+  std::mutex output_mutex;
+  const auto respond = [&output_mutex](const std::string & response)
+  {
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cout << response << std::endl;
+  };
+
+  // Localize a query, return the response
+  Latency_Statistics statistics;
+  const auto process = [&](const Query & query)
+  {
+    system::Timer timer;
+    std::unique_ptr<Regions> query_regions;
+    Pair image_size(0, 0);
+    if (query.type == "IMAGE" && query.arguments.size() == 1)
+    {
+      image::Image<unsigned char> imageGray;
+      if (image::ReadImage(query.arguments[0].c_str(), &imageGray))
+      {
+        image_describer->Describe(imageGray, query_regions);
+        image_size = {imageGray.Width(), imageGray.Height()};
+      }
+    }
+    else if (query.type == "REGIONS" && query.arguments.size() == 4)
+    {
+      query_regions.reset(regions_type->EmptyClone());
+      image_size = {std::atoi(query.arguments[0].c_str()), std::atoi(query.arguments[1].c_str())};
+      if (!query_regions->Load(query.arguments[2], query.arguments[3]))
+        query_regions.reset();
+    }
+
+    geometry::Pose3 pose;
+    sfm::Image_Localizer_Match_Data matching_data;
+    matching_data.error_max = dMaxResidualError;
+    bool bSuccessfulLocalization = false;
+    if (query_regions && image_size.first > 0 && image_size.second > 0)
+    {
+      const cameras::IntrinsicBase * optional_intrinsic =
+        (single_intrinsic && single_intrinsic->w() == image_size.first
+          && single_intrinsic->h() == image_size.second) ? single_intrinsic.get() : nullptr;
+      bSuccessfulLocalization = localizer.Localize(
+        optional_intrinsic ? static_cast<resection::SolverType>(resection_method)
+          : resection::SolverType::DLT_6POINTS,
+        image_size,
+        optional_intrinsic,
+        *query_regions,
+        pose,
+        &matching_data);
+      // Refine the pose (the intrinsic is shared by the queries: it is not refined)
+      if (bSuccessfulLocalization && optional_intrinsic)
+      {
+        std::unique_ptr<cameras::IntrinsicBase> intrinsic(optional_intrinsic->clone());
+        sfm::SfM_Localizer::RefinePose(intrinsic.get(), pose, matching_data, true, false);
+      }
+    }
+
+    const double milliseconds = timer.elapsedMs();
+    statistics.Add(milliseconds, bSuccessfulLocalization);
+
+    std::ostringstream os;
+    os << query.id;
+    if (bSuccessfulLocalization)
+    {
+      os << " OK " << matching_data.vec_inliers.size() << ' '
+        << std::fixed << std::setprecision(3) << milliseconds
+        << std::setprecision(9);
+      const Mat3 & R = pose.rotation();
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+          os << ' ' << R(r, c);
+      const Vec3 & C = pose.center();
+      os << ' ' << C(0) << ' ' << C(1) << ' ' << C(2);
+    }
+    else
+    {
+      os << " FAIL " << std::fixed << std::setprecision(3) << milliseconds;
+    }
+    return os.str();
+  };
+
+  // Queries are processed by a pool of threads sharing the read-only index
+  std::mutex queue_mutex;
+  std::condition_variable queue_condition;
+  std::deque<Query> queue;
+  bool b_end_of_input = false;
+
+  const unsigned int nb_thread = (iNumThreads > 0) ?
+    static_cast<unsigned int>(iNumThreads) : std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < nb_thread; ++i)
+  {
+    workers.emplace_back([&]
+    {
+      while (true)
+      {
+        Query query;
+        {
+          std::unique_lock<std::mutex> lock(queue_mutex);
+          queue_condition.wait(lock, [&]{ return b_end_of_input || !queue.empty(); });
+          if (queue.empty())
+            return;
+          query = std::move(queue.front());
+          queue.pop_front();
+        }
+        respond(process(query));
+      }
+    });
+  }
+
+  std::string line;
+  while (std::getline(std::cin, line))
+  {
+    std::istringstream is(line);
+    Query query;
+    if (!(is >> query.id))
+      continue;
+    if (query.id == "QUIT")
+      break;
+    if (query.id == "STATS")
+    {
+      respond("STATS " + statistics.Report());
+      continue;
+    }
+    is >> query.type;
+    std::string argument;
+    while (is >> argument)
+      query.arguments.push_back(argument);
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      queue.push_back(std::move(query));
+    }
+    queue_condition.notify_one();
+  }
+
+  // Process the pending queries and stop the workers
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    b_end_of_input = true;
+  }
+  queue_condition.notify_all();
+  for (auto & worker : workers)
+    worker.join();
+
+  std::cerr << "Queries (#queries #localized p50(ms) p99(ms)): "
+    << statistics.Report() << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@
 
 #include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/image/image_io.hpp"
+#include "openMVG/image/image_io_strip.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/system/logger.hpp"
@@ -40,6 +41,7 @@ int main(int argc, char *argv[]) {
   std::string sSfM_Data_Filename;
   std::string sOutDir = "";
   bool bExportOnlyReconstructedViews = false;
+  int iStripHeight = 0;
 #ifdef OPENMVG_USE_OPENMP
   int iNumThreads = 0;
 #endif
@@ -47,6 +49,7 @@ int main(int argc, char *argv[]) {
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutDir, "outdir") );
   cmd.add( make_option('r', bExportOnlyReconstructedViews, "exportOnlyReconstructed") );
+  cmd.add( make_option('s', iStripHeight, "stripHeight") );
 
 #ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
@@ -62,6 +65,9 @@ int main(int argc, char *argv[]) {
       << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
       << "[-o|--outdir] path\n"
       << "[-r|--exportOnlyReconstructed] boolean 1/0 (default = 0)\n"
+      << "[-s|--stripHeight] undistort the images by strips of this number of rows,\n"
+      << "  the images are never entirely loaded in memory (JPG, PNG & TIFF images).\n"
+      << "  (default = 0: the images are entirely loaded)\n"
 #ifdef OPENMVG_USE_OPENMP
       << "[-n|--numThreads] number of thread(s)\n"
 #endif
@@ -88,6 +94,8 @@ int main(int argc, char *argv[]) {
     Image<RGBColor> image, image_ud;
     Image<uint8_t> image_gray, image_gray_ud;
     system::LoggerProgress my_progress_bar( sfm_data.GetViews().size(), "- EXTRACT UNDISTORTED IMAGES -" );
+    // The undistortion map of each camera is computed once and shared by its views
+    Undistortion_Map_Cache undistortion_maps;
 
     #ifdef OPENMVG_USE_OPENMP
     const unsigned int nb_max_thread = omp_get_max_threads();
@@ -124,10 +132,22 @@ int main(int argc, char *argv[]) {
       const IntrinsicBase * cam = iterIntrinsic->second.get();
       if (cam->have_disto())
       {
-        // undistort the image and save it
-        if (ReadImage( srcImage.c_str(), &image))
+        // Decode the gray images only once (the depth is read from the file header)
+        ImageMetadata metadata;
+        const bool b_gray_image =
+          ReadImageMetadata(srcImage.c_str(), &metadata) && metadata.depth == 1;
+        // undistort the image by strips of rows (bounded memory)
+        if (iStripHeight > 0 && RemapImageFile(srcImage.c_str(), dstImage.c_str(),
+              *undistortion_maps.Get(cam, view->ui_width, view->ui_height),
+              ERemap_Interpolation::BILINEAR, iStripHeight))
         {
-          UndistortImage(image, cam, image_ud, BLACK);
+          // done (the images that cannot be read by rows are loaded below)
+        }
+        else // undistort the image and save it
+        if (!b_gray_image && ReadImage( srcImage.c_str(), &image))
+        {
+          const auto map = undistortion_maps.Get(cam, image.Width(), image.Height());
+          Remap(image, *map, image_ud, ERemap_Interpolation::BILINEAR, BLACK);
           const bool bRes = WriteImage(dstImage.c_str(), image_ud);
 #ifdef OPENMVG_USE_OPENMP
           #pragma omp critical
@@ -137,7 +157,8 @@ int main(int argc, char *argv[]) {
         else // If RGBColor reading fails, we try to read a gray image
         if (ReadImage( srcImage.c_str(), &image_gray))
         {
-          UndistortImage(image_gray, cam, image_gray_ud, BLACK);
+          const auto map = undistortion_maps.Get(cam, image_gray.Width(), image_gray.Height());
+          Remap(image_gray, *map, image_gray_ud, ERemap_Interpolation::BILINEAR, uint8_t(0));
           const bool bRes = WriteImage(dstImage.c_str(), image_gray_ud);
 #ifdef OPENMVG_USE_OPENMP
           #pragma omp critical
@@ -208,16 +208,16 @@ bool exportToMVE2Format(
       }
       else // (no distortion)
       {
-        // If extensions match, copy the PNG image
-        if (stlplus::extension_part(srcImage) == "PNG" ||
-            stlplus::extension_part(srcImage) == "png")
+        // If the image is already a PNG file, copy it (the format is read from the file header)
+        ImageMetadata metadata;
+        if (ReadImageMetadata(srcImage.c_str(), &metadata) && metadata.format == Png)
         {
           stlplus::file_copy(srcImage, dstImage);
         }
         else
         {
-          if (!ReadImage( srcImage.c_str(), &image) ||
-              !WriteImage( dstImage.c_str(), image))
+          // The image is already decoded
+          if (!WriteImage( dstImage.c_str(), image))
           {
             OPENMVG_LOG_ERROR << "Unable to read and write the image";
             bOk = false;
@@ -130,9 +130,9 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
       }
       else // (no distortion)
       {
-        // If extensions match, copy the PNG image
-        if ( stlplus::extension_part( srcImage ) == "PNG" ||
-             stlplus::extension_part( srcImage ) == "png" )
+        // If the image is already a PNG file, copy it (the format is read from the file header)
+        ImageMetadata metadata;
+        if ( ReadImageMetadata( srcImage.c_str(), &metadata ) && metadata.format == Png )
         {
           stlplus::file_copy( srcImage, dstImage );
         }
@@ -134,9 +134,9 @@ bool exportToPMVSFormat(
       }
       else // (no distortion)
       {
-        // copy the image if extension match
-        if (stlplus::extension_part(srcImage) == "JPG" ||
-          stlplus::extension_part(srcImage) == "jpg")
+        // copy the image if it is already a JPEG file (the format is read from the file header)
+        ImageMetadata metadata;
+        if (ReadImageMetadata(srcImage.c_str(), &metadata) && metadata.format == Jpg)
         {
           stlplus::file_copy(srcImage, dstImage);
         }
@@ -159,7 +159,11 @@ bool exportToOpenMVS(
         Image<uint8_t> image_gray, image_gray_ud;
         try
         {
-          if (ReadImage(srcImage.c_str(), &imageRGB))
+          // Decode the gray images only once (the depth is read from the file header)
+          ImageMetadata metadata;
+          const bool b_gray_image =
+            ReadImageMetadata(srcImage.c_str(), &metadata) && metadata.depth == 1;
+          if (!b_gray_image && ReadImage(srcImage.c_str(), &imageRGB))
           {
             UndistortImage(imageRGB, cam, imageRGB_ud, BLACK);
             bOk = WriteImage(imageName.c_str(), imageRGB_ud);
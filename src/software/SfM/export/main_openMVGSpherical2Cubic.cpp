@@ -24,6 +24,8 @@
 #include <cstdlib>
 #include <cmath>
 #include <iomanip>
+#include <map>
+#include <memory>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -93,6 +95,9 @@ int main(int argc, char *argv[]) {
     if(size_cubic_images > 0)
         pinhole_camera = spherical::ComputeCubicCameraIntrinsics(size_cubic_images);
 
+    // Cubic sampling maps of each panorama size
+    std::map<std::pair<int, int>, std::shared_ptr<const std::vector<image::Remap_Map>>> cubic_maps;
+
     // generate views and camera poses for each new views
     int error_status = 0;
     #pragma omp parallel for shared(error_status) if(error_status < 1)
@@ -138,11 +143,31 @@ int main(int argc, char *argv[]) {
             rot_matrix_transposed.end(),
             rot_matrix_transposed.begin(),
             [](const Mat3 & mat) -> Mat3 { return mat.transpose(); });
+          // The sampling maps are computed once per panorama size
+          std::shared_ptr<const std::vector<image::Remap_Map>> maps;
+          #pragma omp critical(cubic_maps)
+          {
+            auto & size_maps = cubic_maps[{spherical_image.Width(), spherical_image.Height()}];
+            if (!size_maps)
+            {
+              auto new_maps = std::make_shared<std::vector<image::Remap_Map>>(rot_matrix_transposed.size());
+              for (size_t i_rot = 0; i_rot < rot_matrix_transposed.size(); ++i_rot)
+              {
+                spherical::ComputeSphericalToPinholeMap(
+                  spherical_image.Width(),
+                  spherical_image.Height(),
+                  pinhole_camera,
+                  rot_matrix_transposed[i_rot],
+                  (*new_maps)[i_rot]);
+              }
+              size_maps = new_maps;
+            }
+            maps = size_maps;
+          }
           spherical::SphericalToPinholes(
             spherical_image,
-            pinhole_camera,
+            *maps,
             cube_images,
-            rot_matrix_transposed,
             image::Sampler2d<image::SamplerLinear>());
         }
 
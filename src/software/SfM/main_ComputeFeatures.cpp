@@ -298,7 +298,11 @@ int main(int argc, char **argv)
         // Try to read the local mask
         if (stlplus::file_exists(mask_filename_local))
         {
-          if (!ReadImage(mask_filename_local.c_str(), &imageMask))
+          // The mask pixels are decoded only if the mask fits the current image size
+          ImageHeader mask_header;
+          if (!ReadImageHeader(mask_filename_local.c_str(), &mask_header)
+              || (mask_header.width == imageGray.Width() && mask_header.height == imageGray.Height()
+                  && !ReadImage(mask_filename_local.c_str(), &imageMask)))
           {
             OPENMVG_LOG_ERROR
               << "Invalid mask: " << mask_filename_local << ';'
@@ -315,7 +319,11 @@ int main(int argc, char **argv)
           // Try to read the global mask
           if (stlplus::file_exists(mask_filename_global))
           {
-            if (!ReadImage(mask_filename_global.c_str(), &imageMask))
+            // The mask pixels are decoded only if the mask fits the current image size
+            ImageHeader mask_header;
+            if (!ReadImageHeader(mask_filename_global.c_str(), &mask_header)
+                || (mask_header.width == imageGray.Width() && mask_header.height == imageGray.Height()
+                    && !ReadImage(mask_filename_global.c_str(), &imageMask)))
             {
               OPENMVG_LOG_ERROR
                 << "Invalid mask: " << mask_filename_global << ';'
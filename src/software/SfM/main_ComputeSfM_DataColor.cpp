@@ -43,6 +43,10 @@ int main(int argc, char **argv)
 
   cmd.add(make_option('i', sSfM_Data_Filename_In, "input_file"));
   cmd.add(make_option('o', sOutputPLY_Out, "output_file"));
+  int iColorMode = 0;
+  cmd.add(make_option('m', iColorMode, "color_mode"));
+  unsigned int iNumThreads = 0;
+  cmd.add(make_option('n', iNumThreads, "numThreads"));
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -50,7 +54,12 @@ int main(int argc, char **argv)
   } catch (const std::string& s) {
       OPENMVG_LOG_INFO << "Usage: " << argv[0] << '\n'
         << "[-i|--input_file] path to the input SfM_Data scene\n"
-        << "[-o|--output_file] path to the output PLY file";
+        << "[-o|--output_file] path to the output PLY file\n"
+        << "\n[Optional]\n"
+        << "[-m|--color_mode]\n"
+        << "  0: color each point from one image, the images seeing the most points first (default)\n"
+        << "  1: mean color of all the observations of each point\n"
+        << "[-n|--numThreads] number of images decoded concurrently (default: all the threads)";
 
       OPENMVG_LOG_ERROR << s;
       return EXIT_FAILURE;
@@ -72,7 +81,11 @@ int main(int argc, char **argv)
 
   // Compute the scene structure color
   std::vector<Vec3> vec_3dPoints, vec_tracksColor, vec_camPosition;
-  if (ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor))
+  Colorization_Options options;
+  options.views_ = (iColorMode == 1) ?
+    EColorization_Views::AVERAGE_OBSERVATIONS : EColorization_Views::GREEDY_COVERAGE;
+  options.num_threads_ = iNumThreads;
+  if (ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor, options))
   {
     GetCameraPositions(sfm_data, vec_camPosition);
 
@@ -42,9 +42,9 @@ int main(int argc, char **argv)
     OPENMVG_LOG_INFO << "Usage: " << argv[0] << '\n'
       << "[-i|--input_file] path to the input SfM_Data scene\n"
       << "[-o|--output_file] path to the output SfM_Data scene\n"
-      << "\t .json, .bin, .xml, .ply, .baf\n"
+      << "\t .json, .bin, .xml, .sfmc (chunked binary), .ply, .baf\n"
       << "\n[Options to export partial data (by default all data are exported)]\n"
-      << "\nUsable for json/bin/xml format\n"
+      << "\nUsable for json/bin/xml/sfmc format\n"
       << "[-V|--VIEWS] export views\n"
       << "[-I|--INTRINSICS] export intrinsics\n"
       << "[-E|--EXTRINSICS] export extrinsics (view poses)\n"
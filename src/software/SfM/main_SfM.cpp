@@ -30,6 +30,7 @@
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -151,13 +152,20 @@ int main(int argc, char **argv)
   std::string sExtrinsic_refinement_options = "ADJUST_ALL";
   bool b_use_motion_priors = false;
 
+  // Checkpoint options
+  double checkpoint_interval = 0.0;
+  bool b_resume = false;
+
   // Incremental SfM options
   int triangulation_method = static_cast<int>(ETriangulationMethod::DEFAULT);
   int resection_method  = static_cast<int>(resection::SolverType::DEFAULT);
   int user_camera_model = PINHOLE_CAMERA_RADIAL3;
+  int local_ba_hops = 0;
+  double local_ba_growth_ratio = 0.25;
 
   // SfM v1
   std::pair<std::string,std::string> initial_pair_string("","");
+  int ba_submap_size = 0;
 
   // SfM v2
   std::string sfm_initializer_method = "STELLAR";
@@ -179,15 +187,22 @@ int main(int argc, char **argv)
   cmd.add( make_option('e', sExtrinsic_refinement_options, "refine_extrinsic_config") );
   cmd.add( make_switch('P', "prior_usage") );
 
+  // Checkpoint options
+  cmd.add( make_option('k', checkpoint_interval, "checkpoint_interval") );
+  cmd.add( make_switch('K', "resume") );
+
   // Incremental SfM pipeline options
   cmd.add( make_option('t', triangulation_method, "triangulation_method"));
   cmd.add( make_option('r', resection_method, "resection_method"));
   cmd.add( make_option('c', user_camera_model, "camera_model") );
+  cmd.add( make_option('L', local_ba_hops, "local_ba_hops") );
+  cmd.add( make_option('G', local_ba_growth_ratio, "local_ba_growth_ratio") );
   // Incremental SfM2
   cmd.add( make_option('S', sfm_initializer_method, "sfm_initializer") );
   // Incremental SfM1
   cmd.add( make_option('a', initial_pair_string.first, "initial_pair_a") );
   cmd.add( make_option('b', initial_pair_string.second, "initial_pair_b") );
+  cmd.add( make_option('B', ba_submap_size, "ba_submap_size") );
   // Global SfM
   cmd.add( make_option('R', rotation_averaging_method, "rotationAveraging") );
   cmd.add( make_option('T', translation_averaging_method, "translationAveraging") );
@@ -228,18 +243,27 @@ int main(int argc, char **argv)
       << "\t ADJUST_ALL -> refine all existing parameters (default) \n"
       << "\t NONE -> extrinsic parameters are held as constant\n"
     << "[-P|--prior_usage] Enable usage of motion priors (i.e GPS positions) (default: false)\n"
+    << "[-k|--checkpoint_interval] if > 0, save the engine state every N seconds in output_dir/checkpoint\n"
+      << "\t (INCREMENTAL and GLOBAL engines) (default 0: disabled)\n"
+    << "[-K|--resume] Resume the reconstruction from the last checkpoint of output_dir/checkpoint\n"
     << "\n\n"
     << "[Engine specifics]\n"
     << "\n\n"
     << "[INCREMENTAL]\n"
     << "\t[-a|--initial_pair_a] filename of the first image (without path)\n"
     << "\t[-b|--initial_pair_b] filename of the second image (without path)\n"
+    << "\t[-B|--ba_submap_size] if > 0, scenes with more poses than this value are refined\n"
+      << "\t\t by a partitioned bundle adjustment using submaps of this size (default 0: disabled)\n"
     << "\t[-c|--camera_model] Camera model type for view with unknown intrinsic:\n"
       << "\t\t 1: Pinhole \n"
       << "\t\t 2: Pinhole radial 1\n"
       << "\t\t 3: Pinhole radial 3 (default)\n"
       << "\t\t 4: Pinhole radial 3 + tangential 2\n"
       << "\t\t 5: Pinhole fisheye\n"
+    << "\t[-L|--local_ba_hops] if > 0, a local bundle adjustment refines only the new poses\n"
+      << "\t\t and their covisible neighborhood (within this number of hops) (default 0: disabled)\n"
+    << "\t[-G|--local_ba_growth_ratio] when the local bundle adjustment is enabled, a global one is run\n"
+      << "\t\t each time the number of poses has grown by this ratio (default " << local_ba_growth_ratio << ")\n"
     << "\t[--triangulation_method] triangulation method (default=" << triangulation_method << "):\n"
     << "\t\t" << static_cast<int>(ETriangulationMethod::DIRECT_LINEAR_TRANSFORM) << ": DIRECT_LINEAR_TRANSFORM\n"
     << "\t\t" << static_cast<int>(ETriangulationMethod::L1_ANGULAR) << ": L1_ANGULAR\n"
@@ -264,6 +288,10 @@ int main(int argc, char **argv)
       << "\t\t 3: Pinhole radial 3 (default)\n"
       << "\t\t 4: Pinhole radial 3 + tangential 2\n"
       << "\t\t 5: Pinhole fisheye\n"
+    << "\t[-L|--local_ba_hops] if > 0, a local bundle adjustment refines only the new poses\n"
+      << "\t\t and their covisible neighborhood (within this number of hops) (default 0: disabled)\n"
+    << "\t[-G|--local_ba_growth_ratio] when the local bundle adjustment is enabled, a global one is run\n"
+      << "\t\t each time the number of poses has grown by this ratio (default " << local_ba_growth_ratio << ")\n"
     << "\t[--triangulation_method] triangulation method (default=" << triangulation_method << "):\n"
     << "\t\t" << static_cast<int>(ETriangulationMethod::DIRECT_LINEAR_TRANSFORM) << ": DIRECT_LINEAR_TRANSFORM\n"
     << "\t\t" << static_cast<int>(ETriangulationMethod::L1_ANGULAR) << ": L1_ANGULAR\n"
@@ -290,6 +318,7 @@ int main(int argc, char **argv)
   }
 
   b_use_motion_priors = cmd.used('P');
+  b_resume = cmd.used('K');
 
   // Check validity of command line parameters:
   if ( !isValid(static_cast<ETriangulationMethod>(triangulation_method))) {
@@ -463,6 +492,9 @@ int main(int argc, char **argv)
     engine->Set_Use_Motion_Prior(b_use_motion_priors);
     engine->SetTriangulationMethod(static_cast<ETriangulationMethod>(triangulation_method));
     engine->SetResectionMethod(static_cast<resection::SolverType>(resection_method));
+    engine->SetLocalBundleAdjustmentOptions(
+      Local_Bundle_Adjustment_Options(local_ba_hops > 0, std::max(0, local_ba_hops), local_ba_growth_ratio));
+    engine->SetPartitionedBundleAdjustment(std::max(0, ba_submap_size));
 
     // Handle Initial pair parameter
     if (!initial_pair_string.first.empty() && !initial_pair_string.second.empty())
@@ -499,6 +531,8 @@ int main(int argc, char **argv)
     engine->Set_Use_Motion_Prior(b_use_motion_priors);
     engine->SetTriangulationMethod(static_cast<ETriangulationMethod>(triangulation_method));
     engine->SetResectionMethod(static_cast<resection::SolverType>(resection_method));
+    engine->SetLocalBundleAdjustmentOptions(
+      Local_Bundle_Adjustment_Options(local_ba_hops > 0, std::max(0, local_ba_hops), local_ba_growth_ratio));
 
     sfm_engine.reset(engine);
   }
@@ -538,6 +572,23 @@ int main(int argc, char **argv)
   sfm_engine->Set_Intrinsics_Refinement_Type(intrinsic_refinement_options);
   sfm_engine->Set_Extrinsics_Refinement_Type(extrinsic_refinement_options);
 
+  // Checkpoints (a resumed run keeps saving checkpoints)
+  if (checkpoint_interval > 0.0 || b_resume)
+  {
+    if (sfm_engine_type == ESfMEngine::INCREMENTALV2)
+    {
+      OPENMVG_LOG_WARNING << "The INCREMENTALV2 engine does not support the checkpoints.";
+    }
+    else
+    {
+      const double default_checkpoint_interval = 600.0;
+      sfm_engine->SetCheckpoint(
+        stlplus::create_filespec(directory_output, "checkpoint"),
+        checkpoint_interval > 0.0 ? checkpoint_interval : default_checkpoint_interval,
+        b_resume);
+    }
+  }
+
   //---------------------------------------
   // Sequential reconstruction process
   //---------------------------------------
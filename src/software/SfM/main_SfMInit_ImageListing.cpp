@@ -25,8 +25,14 @@
 
 #include <fstream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
+
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -63,22 +69,20 @@ bool checkIntrinsicStringValidity(const std::string & Kmatrix, double & focal, d
 
 bool getGPS
 (
-  const std::string & filename,
+  const Exif_IO & exifReader,
   const int & GPS_to_XYZ_method,
   Vec3 & pose_center
 )
 {
-  std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
-  if (exifReader)
   {
-    // Try to parse EXIF metada & check existence of EXIF data
-    if ( exifReader->open( filename ) && exifReader->doesHaveExifInfo() )
+    // Check existence of EXIF data
+    if ( exifReader.doesHaveExifInfo() )
     {
       // Check existence of GPS coordinates
       double latitude, longitude, altitude;
-      if ( exifReader->GPSLatitude( &latitude ) &&
-           exifReader->GPSLongitude( &longitude ) &&
-           exifReader->GPSAltitude( &altitude ) )
+      if ( exifReader.GPSLatitude( &latitude ) &&
+           exifReader.GPSLongitude( &longitude ) &&
+           exifReader.GPSAltitude( &altitude ) )
       {
         // Add ECEF or UTM XYZ position to the GPS position array
         switch (GPS_to_XYZ_method)
@@ -98,6 +102,129 @@ bool getGPS
   return false;
 }
 
+/// Image metadata collected by the (parallel) listing stage
+struct Image_Listing_Info
+{
+  bool b_listed = false; // The image can be used
+  double width = -1, height = -1, focal = -1, ppx = -1, ppy = -1;
+  bool b_gps = false; // A GPS pose center is available
+  Vec3 pose_center = Vec3::Zero();
+  std::string error_report; // Warning & error messages
+};
+
+/// Read the metadata of an image (size, focal & GPS pose center)
+/// Return false if the image cannot be listed
+/// (the warning & error messages are written to error_report_stream)
+static bool ListImage
+(
+  const std::string & sImageFilename,
+  const std::string & sKmatrix,
+  const double focal_pixels,
+  const bool b_Use_pose_prior,
+  const int i_GPS_XYZ_method,
+  const Datasheet_Index & database_index,
+  Image_Listing_Info & info,
+  std::ostream & error_report_stream
+)
+{
+  // Read meta data to fill camera parameter (w,h,focal,ppx,ppy) fields.
+  double & width = info.width, & height = info.height, & focal = info.focal,
+    & ppx = info.ppx, & ppy = info.ppy;
+
+  const std::string sImFilenamePart = stlplus::filename_part(sImageFilename);
+
+  // Test if the image format is supported:
+  if (openMVG::image::GetFormat(sImageFilename.c_str()) == openMVG::image::Unknown)
+  {
+    error_report_stream
+        << sImFilenamePart << ": Unkown image file format." << "\n";
+    return false; // image cannot be opened
+  }
+
+  if (sImFilenamePart.find("mask.png") != std::string::npos
+     || sImFilenamePart.find("_mask.png") != std::string::npos)
+  {
+    error_report_stream
+        << sImFilenamePart << " is a mask image" << "\n";
+    return false;
+  }
+
+  // Read the image size and the EXIF data with a single read of the file header
+  ImageMetadata metadata;
+  if (!ReadImageMetadata(sImageFilename.c_str(), &metadata)
+      || metadata.format != GetFormat(sImageFilename.c_str()))
+  {
+    // Unusual header, let the image libraries read the image size
+    metadata = ImageMetadata();
+    if (!ReadImageHeader(sImageFilename.c_str(), &metadata))
+      return false; // image cannot be read
+  }
+
+  width = metadata.width;
+  height = metadata.height;
+  ppx = width / 2.0;
+  ppy = height / 2.0;
+
+  // Consider the case where the focal is provided manually
+  if (sKmatrix.size() > 0) // Known user calibration K matrix
+  {
+    if (!checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy))
+      focal = -1.0;
+  }
+  else // User provided focal length value
+    if (focal_pixels != -1 )
+      focal = focal_pixels;
+
+  // The EXIF data is parsed only if required (unknown focal or pose prior)
+  if (focal != -1 && !b_Use_pose_prior)
+    return true;
+  Exif_IO_EasyExif exifReader;
+  exifReader.parseExifSegment( metadata.exif.data(), metadata.exif.size() );
+
+  // If not manually provided or wrongly provided
+  if (focal == -1)
+  {
+    const bool bHaveValidExifMetadata =
+      exifReader.doesHaveExifInfo()
+      && !exifReader.getModel().empty()
+      && !exifReader.getBrand().empty();
+
+    if (bHaveValidExifMetadata) // If image contains meta data
+    {
+      // Handle case where focal length is equal to 0
+      if (exifReader.getFocal() == 0.0f)
+      {
+        error_report_stream
+          << stlplus::basename_part(sImageFilename) << ": Focal length is missing." << "\n";
+        focal = -1.0;
+      }
+      else
+      // Create the image entry in the list file
+      {
+        const std::string sCamModel = exifReader.getBrand() + " " + exifReader.getModel();
+
+        Datasheet datasheet;
+        if ( database_index.getInfo( sCamModel, datasheet ))
+        {
+          // The camera model was found in the database so we can compute it's approximated focal length
+          const double ccdw = datasheet.sensorSize_;
+          focal = std::max ( width, height ) * exifReader.getFocal() / ccdw;
+        }
+        else
+        {
+          error_report_stream
+            << stlplus::basename_part(sImageFilename)
+            << "\" model \"" << sCamModel << "\" doesn't exist in the database" << "\n"
+            << "Please consider add your camera model and sensor width in the database." << "\n";
+        }
+      }
+    }
+  }
+
+  if (b_Use_pose_prior)
+    info.b_gps = getGPS(exifReader, i_GPS_XYZ_method, info.pose_center);
+  return true;
+}
 
 /// Check string of prior weights
 std::pair<bool, Vec3> checkPriorWeightsString
@@ -151,6 +278,10 @@ int main(int argc, char **argv)
 
   double focal_pixels = -1.0;
 
+#ifdef OPENMVG_USE_OPENMP
+  int iNumThreads = 0;
+#endif
+
   cmd.add( make_option('i', sImageDir, "imageDirectory") );
   cmd.add( make_option('d', sfileDatabase, "sensorWidthDatabase") );
   cmd.add( make_option('o', sOutputDir, "outputDirectory") );
@@ -161,6 +292,9 @@ int main(int argc, char **argv)
   cmd.add( make_switch('P', "use_pose_prior") );
   cmd.add( make_option('W', sPriorWeights, "prior_weights"));
   cmd.add( make_option('m', i_GPS_XYZ_method, "gps_to_xyz_method") );
+#ifdef OPENMVG_USE_OPENMP
+  cmd.add( make_option('n', iNumThreads, "numThreads") );
+#endif
 
   try {
     if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -187,7 +321,11 @@ int main(int argc, char **argv)
       << "[-W|--prior_weights] \"x;y;z;\" of weights for each dimension of the prior (default: 1.0)\n"
       << "[-m|--gps_to_xyz_method] XZY Coordinate system:\n"
       << "\t 0: ECEF (default)\n"
-      << "\t 1: UTM";
+      << "\t 1: UTM\n"
+#ifdef OPENMVG_USE_OPENMP
+      << "[-n|--numThreads] number of parallel image listing (default: all the threads)\n"
+#endif
+      ;
 
       OPENMVG_LOG_ERROR << s;
       return EXIT_FAILURE;
@@ -204,10 +342,11 @@ int main(int argc, char **argv)
     << "\n--group_camera_model " << b_Group_camera_model
     << "\n--use_pose_prior " << b_Use_pose_prior
     << "\n--prior_weights " << sPriorWeights
-    << "\n--gps_to_xyz_method " << i_GPS_XYZ_method;
-
-  // Expected properties for each image
-  double width = -1, height = -1, focal = -1, ppx = -1,  ppy = -1;
+    << "\n--gps_to_xyz_method " << i_GPS_XYZ_method
+#ifdef OPENMVG_USE_OPENMP
+    << "\n--numThreads " << iNumThreads
+#endif
+    ;
 
   const EINTRINSIC e_User_camera_model = EINTRINSIC(i_User_camera_model);
 
@@ -232,11 +371,14 @@ int main(int argc, char **argv)
     }
   }
 
-  if (sKmatrix.size() > 0 &&
-    !checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy) )
+  if (sKmatrix.size() > 0)
   {
-    OPENMVG_LOG_ERROR << "Invalid K matrix input";
-    return EXIT_FAILURE;
+    double focal = -1, ppx = -1,  ppy = -1;
+    if (!checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy))
+    {
+      OPENMVG_LOG_ERROR << "Invalid K matrix input";
+      return EXIT_FAILURE;
+    }
   }
 
   if (sKmatrix.size() > 0 && focal_pixels != -1.0)
@@ -256,6 +398,7 @@ int main(int argc, char **argv)
       return EXIT_FAILURE;
     }
   }
+  const Datasheet_Index database_index(vec_database);
 
   // Check if prior weights are given
   if (b_Use_pose_prior)
@@ -272,96 +415,39 @@ int main(int argc, char **argv)
   Views & views = sfm_data.views;
   Intrinsics & intrinsics = sfm_data.intrinsics;
 
+  // 1. Read the image metadata in parallel (the EXIF data are parsed once)
+  std::vector<Image_Listing_Info> image_infos(vec_image.size());
   system::LoggerProgress my_progress_bar(vec_image.size(), "- Listing images -" );
-  std::ostringstream error_report_stream;
-  for ( std::vector<std::string>::const_iterator iter_image = vec_image.begin();
-    iter_image != vec_image.end();
-    ++iter_image, ++my_progress_bar )
+#ifdef OPENMVG_USE_OPENMP
+  if (iNumThreads > 0)
+    omp_set_num_threads(iNumThreads);
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vec_image.size()); ++i)
   {
-    // Read meta data to fill camera parameter (w,h,focal,ppx,ppy) fields.
-    width = height = ppx = ppy = focal = -1.0;
-
-    const std::string sImageFilename = stlplus::create_filespec( sImageDir, *iter_image );
-    const std::string sImFilenamePart = stlplus::filename_part(sImageFilename);
-
-    // Test if the image format is supported:
-    if (openMVG::image::GetFormat(sImageFilename.c_str()) == openMVG::image::Unknown)
-    {
-      error_report_stream
-          << sImFilenamePart << ": Unkown image file format." << "\n";
-      continue; // image cannot be opened
-    }
+    ++my_progress_bar;
+    Image_Listing_Info & info = image_infos[i];
+    std::ostringstream error_report_stream;
+    info.b_listed = ListImage(
+      stlplus::create_filespec( sImageDir, vec_image[i] ),
+      sKmatrix, focal_pixels, b_Use_pose_prior, i_GPS_XYZ_method,
+      database_index, info, error_report_stream);
+    info.error_report = error_report_stream.str();
+  }
 
-    if (sImFilenamePart.find("mask.png") != std::string::npos
-       || sImFilenamePart.find("_mask.png") != std::string::npos)
-    {
-      error_report_stream
-          << sImFilenamePart << " is a mask image" << "\n";
+  // 2. Fill the views & intrinsics in the image order
+  std::ostringstream error_report_stream;
+  for (size_t i = 0; i < vec_image.size(); ++i)
+  {
+    const Image_Listing_Info & info = image_infos[i];
+    error_report_stream << info.error_report;
+    if (!info.b_listed)
       continue;
-    }
-
-    ImageHeader imgHeader;
-    if (!openMVG::image::ReadImageHeader(sImageFilename.c_str(), &imgHeader))
-      continue; // image cannot be read
-
-    width = imgHeader.width;
-    height = imgHeader.height;
-    ppx = width / 2.0;
-    ppy = height / 2.0;
-
-
-    // Consider the case where the focal is provided manually
-    if (sKmatrix.size() > 0) // Known user calibration K matrix
-    {
-      if (!checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy))
-        focal = -1.0;
-    }
-    else // User provided focal length value
-      if (focal_pixels != -1 )
-        focal = focal_pixels;
-
-    // If not manually provided or wrongly provided
-    if (focal == -1)
-    {
-      std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
-      exifReader->open( sImageFilename );
 
-      const bool bHaveValidExifMetadata =
-        exifReader->doesHaveExifInfo()
-        && !exifReader->getModel().empty()
-        && !exifReader->getBrand().empty();
+    const double
+      width = info.width, height = info.height, focal = info.focal,
+      ppx = info.ppx, ppy = info.ppy;
 
-      if (bHaveValidExifMetadata) // If image contains meta data
-      {
-        // Handle case where focal length is equal to 0
-        if (exifReader->getFocal() == 0.0f)
-        {
-          error_report_stream
-            << stlplus::basename_part(sImageFilename) << ": Focal length is missing." << "\n";
-          focal = -1.0;
-        }
-        else
-        // Create the image entry in the list file
-        {
-          const std::string sCamModel = exifReader->getBrand() + " " + exifReader->getModel();
-
-          Datasheet datasheet;
-          if ( getInfo( sCamModel, vec_database, datasheet ))
-          {
-            // The camera model was found in the database so we can compute it's approximated focal length
-            const double ccdw = datasheet.sensorSize_;
-            focal = std::max ( width, height ) * exifReader->getFocal() / ccdw;
-          }
-          else
-          {
-            error_report_stream
-              << stlplus::basename_part(sImageFilename)
-              << "\" model \"" << sCamModel << "\" doesn't exist in the database" << "\n"
-              << "Please consider add your camera model and sensor width in the database." << "\n";
-          }
-        }
-      }
-    }
     // Build intrinsic parameter related to the view
     std::shared_ptr<IntrinsicBase> intrinsic;
 
@@ -401,10 +487,9 @@ int main(int argc, char **argv)
     }
 
     // Build the view corresponding to the image
-    Vec3 pose_center;
-    if (getGPS(sImageFilename, i_GPS_XYZ_method, pose_center) && b_Use_pose_prior)
+    if (info.b_gps && b_Use_pose_prior)
     {
-      ViewPriors v(*iter_image, views.size(), views.size(), views.size(), width, height);
+      ViewPriors v(vec_image[i], views.size(), views.size(), views.size(), width, height);
 
       // Add intrinsic related to the image (if any)
       if (!intrinsic)
@@ -420,7 +505,7 @@ int main(int argc, char **argv)
       }
 
       v.b_use_pose_center_ = true;
-      v.pose_center_ = pose_center;
+      v.pose_center_ = info.pose_center;
       // prior weights
       if (prior_w_info.first == true)
       {
@@ -432,7 +517,7 @@ int main(int argc, char **argv)
     }
     else
     {
-      View v(*iter_image, views.size(), views.size(), views.size(), width, height);
+      View v(vec_image[i], views.size(), views.size(), views.size(), width, height);
 
       // Add intrinsic related to the image (if any)
       if (!intrinsic)
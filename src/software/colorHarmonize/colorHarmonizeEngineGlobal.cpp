@@ -33,13 +33,21 @@
 #include "openMVG/system/logger.hpp"
 #include "openMVG/system/loggerprogress.hpp"
 
+#include <array>
+#include <atomic>
 #include <numeric>
 #include <iomanip>
 #include <iterator>
+#include <list>
+#include <memory>
 #include <algorithm>
 #include <functional>
+#include <mutex>
 #include <sstream>
 
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
 
 namespace openMVG{
 
@@ -196,9 +204,140 @@ bool ColorHarmonizationEngineGlobal::Process()
     << "\n Remaining cameras after CC filter : \n"
     << map_cameraIndexTocameraNode.size() << " from a total of " << _vec_fileNames.size();
 
-  size_t bin      = 256;
-  double minvalue = 0.0;
-  double maxvalue = 255.0;
+  enum EHistogramSelectionMethod
+  {
+      eHistogramHarmonizeFullFrame     = 0,
+      eHistogramHarmonizeMatchedPoints = 1,
+      eHistogramHarmonizeVLDSegment    = 2,
+  };
+  if (_selectionMethod < eHistogramHarmonizeFullFrame || _selectionMethod > eHistogramHarmonizeVLDSegment)
+  {
+    OPENMVG_LOG_ERROR << "Selection method unsupported";
+    return false;
+  }
+
+  const size_t bin      = 256;
+  const double minvalue = 0.0;
+  const double maxvalue = 255.0;
+
+  // Histograms of the masked pixels for the RGB channels
+  using RGBHistograms = std::array<std::vector<size_t>, 3>;
+  const auto computeHistograms = [&](
+    const Image<unsigned char> & mask,
+    const Image<RGBColor> & image) -> RGBHistograms
+  {
+    RGBHistograms histograms;
+    for (int channelIndex = 0; channelIndex < 3; ++channelIndex) // RED, GREEN & BLUE channels
+    {
+      Histogram< double > histo( minvalue, maxvalue, bin);
+      color_harmonization::commonDataByPair::computeHisto( histo, mask, channelIndex, image );
+      histograms[channelIndex] = histo.GetHist();
+    }
+    return histograms;
+  };
+
+  // The decoded images are shared by the edges. At most nbMaxResidentImages
+  // images are kept: the least recently used one is released first (it is
+  // decoded again if another edge requires it) and an image is released as soon
+  // as all its edges are processed. The edges are listed by first image, so
+  // consecutive edges mostly reuse the resident images.
+  // With the full frame selection the histograms do not depend on the edge:
+  // they are computed once per image and the pixels are not kept.
+  struct DecodedImage
+  {
+    Image< RGBColor > image;
+    Image< unsigned char > imageGray; // Used by the VLD segment selection
+  };
+  struct CachedImage
+  {
+    std::mutex mutex; // An image is decoded by a single thread at a time
+    int remainingEdges = 0;
+    std::shared_ptr<const DecodedImage> decoded; // guarded by residentMutex
+    bool bHistograms = false;
+    RGBHistograms histograms; // Used by the full frame selection
+  };
+  std::vector<CachedImage> vec_cachedImages(_vec_fileNames.size());
+#ifdef OPENMVG_USE_OPENMP
+  const size_t nbMaxResidentImages = 2 * omp_get_max_threads() + 2;
+#else
+  const size_t nbMaxResidentImages = 4;
+#endif
+  std::mutex residentMutex;
+  std::list<size_t> residentImages; // The most recently used image first
+
+  std::vector<matching::PairWiseMatches::const_iterator> vec_edges;
+  vec_edges.reserve(_map_Matches.size());
+  for (matching::PairWiseMatches::const_iterator iter = _map_Matches.begin();
+    iter != _map_Matches.end(); ++iter)
+  {
+    vec_edges.push_back(iter);
+    ++vec_cachedImages[iter->first.first].remainingEdges;
+    ++vec_cachedImages[iter->first.second].remainingEdges;
+  }
+
+  std::atomic<bool> bReadFailure(false);
+  const auto decodeImage = [&](const size_t I) -> std::shared_ptr<DecodedImage>
+  {
+    auto decoded = std::make_shared<DecodedImage>();
+    if (!ReadImage( _vec_fileNames[ I ].c_str(), &decoded->image ))
+    {
+      OPENMVG_LOG_ERROR << "Unable to read the image: " << _vec_fileNames[ I ];
+      bReadFailure = true;
+      decoded->image = Image< RGBColor >( _vec_imageSize[ I ].first, _vec_imageSize[ I ].second, true, BLACK );
+    }
+    if (_selectionMethod == eHistogramHarmonizeVLDSegment)
+    {
+      ConvertPixelType( decoded->image, &decoded->imageGray );
+    }
+    return decoded;
+  };
+  // Full frame selection: histograms of an image (its pixels are released at once)
+  const auto acquireHistograms = [&](const size_t I) -> const RGBHistograms &
+  {
+    CachedImage & cachedImage = vec_cachedImages[I];
+    std::lock_guard<std::mutex> lock(cachedImage.mutex);
+    if (!cachedImage.bHistograms)
+    {
+      const Image< unsigned char > mask( _vec_imageSize[ I ].first, _vec_imageSize[ I ].second, true, WHITE );
+      cachedImage.histograms = computeHistograms( mask, decodeImage( I )->image );
+      cachedImage.bHistograms = true;
+    }
+    return cachedImage.histograms;
+  };
+  // Pixels of an image (they stay valid while the returned pointer is used)
+  const auto acquireImage = [&](const size_t I) -> std::shared_ptr<const DecodedImage>
+  {
+    CachedImage & cachedImage = vec_cachedImages[I];
+    std::lock_guard<std::mutex> decodeLock(cachedImage.mutex);
+    std::shared_ptr<const DecodedImage> decoded;
+    {
+      std::lock_guard<std::mutex> lock(residentMutex);
+      decoded = cachedImage.decoded;
+    }
+    if (!decoded)
+      decoded = decodeImage( I );
+
+    std::lock_guard<std::mutex> lock(residentMutex);
+    cachedImage.decoded = decoded;
+    residentImages.remove(I);
+    residentImages.push_front(I);
+    while (residentImages.size() > nbMaxResidentImages)
+    {
+      vec_cachedImages[residentImages.back()].decoded.reset();
+      residentImages.pop_back();
+    }
+    return decoded;
+  };
+  const auto releaseImage = [&](const size_t I)
+  {
+    std::lock_guard<std::mutex> lock(residentMutex);
+    CachedImage & cachedImage = vec_cachedImages[I];
+    if (--cachedImage.remainingEdges == 0 && cachedImage.decoded)
+    {
+      cachedImage.decoded.reset();
+      residentImages.remove(I);
+    }
+  };
 
   // For each edge computes the selection masks and histograms (for the RGB channels)
   std::vector<relativeColorHistogramEdge> map_relativeHistograms[3];
@@ -206,10 +345,16 @@ bool ColorHarmonizationEngineGlobal::Process()
   map_relativeHistograms[1].resize(_map_Matches.size());
   map_relativeHistograms[2].resize(_map_Matches.size());
 
-  for (size_t i = 0; i < _map_Matches.size(); ++i)
+  OPENMVG_LOG_INFO << "\n Compute the edges histograms";
+  system::LoggerProgress progress_bar_edges( vec_edges.size() );
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vec_edges.size()); ++i)
   {
-    matching::PairWiseMatches::const_iterator iter = _map_Matches.begin();
-    std::advance(iter, i);
+    if (bReadFailure)
+      continue;
+    matching::PairWiseMatches::const_iterator iter = vec_edges[i];
 
     const size_t I = iter->first.first;
     const size_t J = iter->first.second;
@@ -219,111 +364,85 @@ bool ColorHarmonizationEngineGlobal::Process()
     //-- Edges names:
     std::pair<std::string, std::string> p_imaNames;
     p_imaNames = make_pair( _vec_fileNames[ I ], _vec_fileNames[ J ] );
-    OPENMVG_LOG_INFO 
-      << "Current edge : "
-      << stlplus::filename_part(p_imaNames.first) << "\t"
-      << stlplus::filename_part(p_imaNames.second);
 
-    //-- Compute the masks from the data selection:
-    Image< unsigned char > maskI ( _vec_imageSize[ I ].first, _vec_imageSize[ I ].second );
-    Image< unsigned char > maskJ ( _vec_imageSize[ J ].first, _vec_imageSize[ J ].second );
-
-    switch (_selectionMethod)
+    RGBHistograms histogramsI, histogramsJ;
+    if (_selectionMethod == eHistogramHarmonizeFullFrame)
     {
-      enum EHistogramSelectionMethod
-      {
-          eHistogramHarmonizeFullFrame     = 0,
-          eHistogramHarmonizeMatchedPoints = 1,
-          eHistogramHarmonizeVLDSegment    = 2,
-      };
+      histogramsI = acquireHistograms( I );
+      histogramsJ = acquireHistograms( J );
+    }
+    else
+    {
+      const std::shared_ptr<const DecodedImage> imageI = acquireImage( I );
+      const std::shared_ptr<const DecodedImage> imageJ = acquireImage( J );
 
-      case eHistogramHarmonizeFullFrame:
-      {
-        color_harmonization::commonDataByPair_FullFrame  dataSelector(
-          p_imaNames.first,
-          p_imaNames.second);
-        dataSelector.computeMask( maskI, maskJ );
-      }
-      break;
-      case eHistogramHarmonizeMatchedPoints:
+      //-- Compute the masks from the data selection:
+      Image< unsigned char > maskI ( _vec_imageSize[ I ].first, _vec_imageSize[ I ].second );
+      Image< unsigned char > maskJ ( _vec_imageSize[ J ].first, _vec_imageSize[ J ].second );
+
+      if (_selectionMethod == eHistogramHarmonizeMatchedPoints)
       {
         int circleSize = 10;
         color_harmonization::commonDataByPair_MatchedPoints dataSelector(
           p_imaNames.first,
           p_imaNames.second,
           vec_matchesInd,
-          _map_feats[ I ],
-          _map_feats[ J ],
+          _map_feats.at( I ),
+          _map_feats.at( J ),
           circleSize);
         dataSelector.computeMask( maskI, maskJ );
       }
-      break;
-      case eHistogramHarmonizeVLDSegment:
+      else // eHistogramHarmonizeVLDSegment
       {
         color_harmonization::commonDataByPair_VLDSegment dataSelector(
           p_imaNames.first,
           p_imaNames.second,
           vec_matchesInd,
-          _map_feats[ I ],
-          _map_feats[ J ]);
+          _map_feats.at( I ),
+          _map_feats.at( J ),
+          &imageI->imageGray,
+          &imageJ->imageGray);
 
         dataSelector.computeMask( maskI, maskJ );
       }
-      break;
-      default:
-        OPENMVG_LOG_ERROR << "Selection method unsupported";
-        return false;
-    }
 
-    //-- Export the masks
-    bool bExportMask = false;
-    if (bExportMask)
-    {
-      std::string sEdge = _vec_fileNames[ I ] + "_" + _vec_fileNames[ J ];
-      sEdge = stlplus::create_filespec( _sOutDirectory, sEdge );
-      if ( !stlplus::folder_exists( sEdge ) )
-        stlplus::folder_create( sEdge );
+      //-- Export the masks
+      bool bExportMask = false;
+      if (bExportMask)
+      {
+        std::string sEdge = _vec_fileNames[ I ] + "_" + _vec_fileNames[ J ];
+        sEdge = stlplus::create_filespec( _sOutDirectory, sEdge );
+        if ( !stlplus::folder_exists( sEdge ) )
+          stlplus::folder_create( sEdge );
 
-      std::string out_filename_I = "00_mask_I.png";
-      out_filename_I = stlplus::create_filespec( sEdge, out_filename_I );
+        std::string out_filename_I = "00_mask_I.png";
+        out_filename_I = stlplus::create_filespec( sEdge, out_filename_I );
 
-      std::string out_filename_J = "00_mask_J.png";
-      out_filename_J = stlplus::create_filespec( sEdge, out_filename_J );
+        std::string out_filename_J = "00_mask_J.png";
+        out_filename_J = stlplus::create_filespec( sEdge, out_filename_J );
+
+        WriteImage( out_filename_I.c_str(), maskI );
+        WriteImage( out_filename_J.c_str(), maskJ );
+      }
 
-      WriteImage( out_filename_I.c_str(), maskI );
-      WriteImage( out_filename_J.c_str(), maskJ );
+      //-- Compute the histograms
+      histogramsI = computeHistograms( maskI, imageI->image );
+      histogramsJ = computeHistograms( maskJ, imageJ->image );
+      releaseImage( I );
+      releaseImage( J );
     }
 
-    //-- Compute the histograms
-    Image< RGBColor > imageI, imageJ;
-    ReadImage( p_imaNames.first.c_str(), &imageI );
-    ReadImage( p_imaNames.second.c_str(), &imageJ );
-
-    Histogram< double > histoI( minvalue, maxvalue, bin);
-    Histogram< double > histoJ( minvalue, maxvalue, bin);
-
-    int channelIndex = 0; // RED channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeR = map_relativeHistograms[channelIndex][i];
-    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 1; // GREEN channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeG = map_relativeHistograms[channelIndex][i];
-    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 2; // BLUE channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeB = map_relativeHistograms[channelIndex][i];
-    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
+    for (int channelIndex = 0; channelIndex < 3; ++channelIndex) // RED, GREEN & BLUE channels
+    {
+      map_relativeHistograms[channelIndex][i] = relativeColorHistogramEdge(
+        map_cameraNodeToCameraIndex.at(I), map_cameraNodeToCameraIndex.at(J),
+        histogramsI[channelIndex], histogramsJ[channelIndex]);
+    }
+    ++progress_bar_edges;
+  }
+  if (bReadFailure)
+  {
+    return false;
   }
 
   OPENMVG_LOG_INFO << "\n -- \n SOLVE for color consistency with linear programming\n --";
@@ -393,16 +512,22 @@ bool ColorHarmonizationEngineGlobal::Process()
   OPENMVG_LOG_INFO << "\n\nThere is :\n" << set_indeximage.size() << " images to transform.";
 
   //-> convert solution to gain offset and creation of the LUT per image
-  system::LoggerProgress my_progress_bar( set_indeximage.size() );
-  for (std::set<size_t>::const_iterator iterSet = set_indeximage.begin();
-    iterSet != set_indeximage.end(); ++iterSet, ++my_progress_bar)
+  const std::string out_folder = stlplus::create_filespec( _sOutDirectory,
+    vec_selectionMethod[ _selectionMethod ] + "_" + vec_harmonizeMethod[ harmonizeMethod ]);
+  if ( !stlplus::folder_exists( out_folder ) )
+    stlplus::folder_create( out_folder );
+
+  const std::vector<size_t> vec_indeximage(set_indeximage.cbegin(), set_indeximage.cend());
+  system::LoggerProgress my_progress_bar( vec_indeximage.size() );
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int nodeIndex = 0; nodeIndex < static_cast<int>(vec_indeximage.size()); ++nodeIndex)
   {
-    const size_t imaNum = *iterSet;
+    const size_t imaNum = vec_indeximage[nodeIndex];
     using Vec256 = Eigen::Matrix<double, 256, 1>;
     std::vector< Vec256 > vec_map_lut(3);
 
-    const size_t nodeIndex = std::distance(set_indeximage.begin(), iterSet);
-
     const  double g_r = vec_solution_r[nodeIndex*2];
     const  double offset_r = vec_solution_r[nodeIndex*2+1];
     const  double g_g = vec_solution_g[nodeIndex*2];
@@ -420,9 +545,6 @@ bool ColorHarmonizationEngineGlobal::Process()
     Image< RGBColor > image_c;
     ReadImage( _vec_fileNames[ imaNum ].c_str(), &image_c );
 
-#ifdef OPENMVG_USE_OPENMP
-#pragma omp parallel for
-#endif
     for (int j = 0; j < image_c.Height(); ++j)
     {
       for (int i = 0; i < image_c.Width(); ++i)
@@ -433,13 +555,10 @@ bool ColorHarmonizationEngineGlobal::Process()
       }
     }
 
-    const std::string out_folder = stlplus::create_filespec( _sOutDirectory,
-      vec_selectionMethod[ _selectionMethod ] + "_" + vec_harmonizeMethod[ harmonizeMethod ]);
-    if ( !stlplus::folder_exists( out_folder ) )
-      stlplus::folder_create( out_folder );
     const std::string out_filename = stlplus::create_filespec( out_folder, stlplus::filename_part(_vec_fileNames[ imaNum ]) );
 
     WriteImage( out_filename.c_str(), image_c );
+    ++my_progress_bar;
   }
   return true;
 }